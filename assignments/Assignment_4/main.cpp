@@ -1,6 +1,11 @@
 #include <stdio.h>
 #include <math.h>
 #include <ew/external/glad.h>
+#include <ew/normalMatrix.h>
+#include <ew/shader.h>
+#include <ew/shaderReloader.h>
+#include <ew/frameCapture.h>
+#include <ew/jobSystem.h>
 //#include "../../out/build/x64-debug/_deps/glfw-src/include/GLFW/glfw3.h"
 #include "../../out/build/x64-debug/_deps/glm-src/glm/geometric.hpp"
 #include "../../out/build/x64-debug/_deps/glm-src/glm/ext/vector_float3.hpp"
@@ -32,60 +37,11 @@ glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
 glm::vec3 objectColor(1.0f, 0.5f, 0.31f);
 
-// Shader code
-const char* vertexShaderSource = R"(
-    #version 330 core
-    layout(location = 0) in vec3 aPos;
-    layout(location = 1) in vec3 aNormal;
-    
-    out vec3 FragPos;
-    out vec3 Normal;
-
-    uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
-
-    void main() {
-        gl_Position = projection * view * model * vec4(aPos, 1.0);
-        FragPos = vec3(model * vec4(aPos, 1.0));
-        Normal = mat3(transpose(inverse(model))) * aNormal;
-    }
-)";
-
-const char* fragmentShaderSource = R"(
-    #version 330 core
-    out vec4 FragColor;
-
-    in vec3 FragPos;
-    in vec3 Normal;
-    
-    uniform vec3 lightPos;
-    uniform vec3 viewPos;
-    uniform vec3 lightColor;
-    uniform vec3 objectColor;
-
-    void main() {
-        // Ambient
-        float ambientStrength = 0.1;
-        vec3 ambient = ambientStrength * lightColor;
-
-        // Diffuse
-        vec3 norm = normalize(Normal);
-        vec3 lightDir = normalize(lightPos - FragPos);
-        float diff = max(dot(norm, lightDir), 0.0);
-        vec3 diffuse = diff * lightColor;
-
-        // Specular
-        float specularStrength = 0.5;
-        vec3 viewDir = normalize(viewPos - FragPos);
-        vec3 reflectDir = reflect(-lightDir, norm);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-        vec3 specular = specularStrength * spec * lightColor;
-
-        vec3 result = (ambient + diffuse + specular) * objectColor;
-        FragColor = vec4(result, 1.0);
-    }
-)";
+// Shaders live in assets/ and are rebuilt whenever they are saved. CMake points ASSET_DIR
+// at this assignment's source assets folder so edits show up without rebuilding.
+#ifndef ASSET_DIR
+#define ASSET_DIR "assets/"
+#endif
 
 // Initialize and configure GLFW
 void initializeGLFW() {
@@ -172,8 +128,14 @@ int main() {
 
     glEnable(GL_DEPTH_TEST);
 
-    // Shader program setup (using previously defined shaders)
-    unsigned int shaderProgram = setupShaders(); // Replace with shader compilation function
+    // Shader program setup, rebuilt from assets/ when the files change
+    ew::enableParallelShaderCompile(glfwGetProcAddress);
+    ew::ShaderReloader shaders;
+    // Set EW_CAPTURE_DIR to record frames, e.g. for regression images or video
+    ew::JobSystem jobs;
+    ew::FrameCapture capture(jobs);
+    capture.startRecordingFromEnvironment();
+    int shaderId = shaders.add(ASSET_DIR "assignment4.vert", ASSET_DIR "assignment4.frag");
 
     while (!glfwWindowShouldClose(window)) {
         float currentFrame = glfwGetTime();
@@ -181,6 +143,8 @@ int main() {
         lastFrame = currentFrame;
 
         processInput(window);
+        shaders.update();
+        unsigned int shaderProgram = shaders.get(shaderId);
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glUseProgram(shaderProgram);
@@ -191,16 +155,29 @@ int main() {
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
 
+        // Model and normal matrix; the normal matrix is computed here once instead of per vertex
+        glm::mat4 model = glm::mat4(1.0f);
+        glm::mat3 normalMatrix = ew::computeNormalMatrix(model);
+        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
+        glUniformMatrix3fv(glGetUniformLocation(shaderProgram, "normalMatrix"), 1, GL_FALSE, glm::value_ptr(normalMatrix));
+
         // Light and view positions
         glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
         glUniform3f(glGetUniformLocation(shaderProgram, "viewPos"), cameraPos.x, cameraPos.y, cameraPos.z);
         glUniform3f(glGetUniformLocation(shaderProgram, "lightColor"), lightColor.r, lightColor.g, lightColor.b);
         glUniform3f(glGetUniformLocation(shaderProgram, "objectColor"), objectColor.r, objectColor.g, objectColor.b);
 
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        capture.endFrame(framebufferWidth, framebufferHeight);
+        if (capture.isFinished())
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    shaders.clear();
+    capture.clear();
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,8 @@
+#version 330 core
+in vec4 ourColor;
+out vec4 FragColor;
+uniform float uTime;
+void main() {
+    float greenValue = (sin(uTime) / 2.0f) + 0.5f;
+    FragColor = vec4(ourColor.r, greenValue, ourColor.b, ourColor.a);
+}
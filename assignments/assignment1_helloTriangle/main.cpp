@@ -2,33 +2,19 @@
 #include <math.h>
 
 #include <ew/external/glad.h>
+#include <ew/shader.h>
+#include <ew/shaderReloader.h>
+#include <ew/frameCapture.h>
+#include <ew/jobSystem.h>
 #include <ew/ewMath/ewMath.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
-// Vertex and Fragment Shader source code
-const char* vertexShaderSource = R"(
-    #version 330 core
-    layout(location = 0) in vec3 aPos;
-    layout(location = 1) in vec4 aColor;
-    out vec4 ourColor;
-    uniform vec2 uOffset; // Uniform for movement offset
-    void main() {
-        gl_Position = vec4(aPos + vec3(uOffset, 0.0), 1.0);
-        ourColor = aColor;
-    }
-)";
-
-const char* fragmentShaderSource = R"(
-    #version 330 core
-    in vec4 ourColor;
-    out vec4 FragColor;
-    uniform float uTime;
-    void main() {
-        float greenValue = (sin(uTime) / 2.0f) + 0.5f;
-        FragColor = vec4(ourColor.r, greenValue, ourColor.b, ourColor.a);
-    }
-)";
+// Shaders live in assets/ and are rebuilt whenever they are saved. CMake points ASSET_DIR
+// at this assignment's source assets folder so edits show up without rebuilding.
+#ifndef ASSET_DIR
+#define ASSET_DIR "assets/"
+#endif
 
 const int SCREEN_WIDTH = 1080;
 const int SCREEN_HEIGHT = 720;
@@ -39,44 +25,6 @@ float vertices[] = {
      0.0f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f
 };
 
-unsigned int compileShader(unsigned int type, const char* source) {
-    unsigned int shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
-
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        printf("ERROR::SHADER::COMPILATION_FAILED\n%s", infoLog);
-    }
-    return shader;
-}
-
-unsigned int setupShaders() {
-    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    int success;
-    char infoLog[512];
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        printf("ERROR::PROGRAM::LINKING_FAILED\n%s", infoLog);
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return shaderProgram;
-}
-
 unsigned int setupVertexArrayObject() {
     unsigned int VAO, VBO;
     glGenVertexArrays(1, &VAO);
@@ -117,11 +65,19 @@ int main() {
         return 1;
     }
 
-    unsigned int shaderProgram = setupShaders();
+    ew::enableParallelShaderCompile(glfwGetProcAddress);
+    ew::ShaderReloader shaders;
+    // Set EW_CAPTURE_DIR to record frames, e.g. for regression images or video
+    ew::JobSystem jobs;
+    ew::FrameCapture capture(jobs);
+    capture.startRecordingFromEnvironment();
+    int shaderId = shaders.add(ASSET_DIR "assignment1.vert", ASSET_DIR "assignment1.frag");
     unsigned int VAO = setupVertexArrayObject();
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
+        shaders.update();
+        unsigned int shaderProgram = shaders.get(shaderId);
 
         // Clear the screen
         glClearColor(0.3f, 0.4f, 0.9f, 1.0f);
@@ -143,10 +99,17 @@ int main() {
         glBindVertexArray(VAO);
         glDrawArrays(GL_TRIANGLES, 0, 3);
 
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        capture.endFrame(framebufferWidth, framebufferHeight);
+        if (capture.isFinished())
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
         glfwSwapBuffers(window);
     }
 
     printf("Shutting down...\n");
+    shaders.clear();
+    capture.clear();
     glfwTerminate();
     return 0;
 }
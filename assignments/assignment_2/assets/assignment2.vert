@@ -0,0 +1,9 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec4 aColor;
+out vec4 ourColor;
+uniform vec2 uOffset; // Uniform for movement offset
+void main() {
+    gl_Position = vec4(aPos + vec3(uOffset, 0.0), 1.0);
+    ourColor = aColor;
+}
@@ -0,0 +1,17 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 FragPos;
+in vec3 Normal;
+
+uniform vec3 lightPos;
+uniform vec3 viewPos;
+uniform vec3 lightColor;
+uniform vec3 objectColor;
+
+#include "assignment5Lighting.glsl"
+
+void main() {
+    vec3 result = shadePhong(FragPos, Normal, lightPos, viewPos, lightColor) * objectColor;
+    FragColor = vec4(result, 1.0);
+}
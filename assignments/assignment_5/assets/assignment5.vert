@@ -0,0 +1,18 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+
+out vec3 FragPos;
+out vec3 Normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+// transpose(inverse(mat3(model))), computed once per object on the CPU
+uniform mat3 normalMatrix;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0)); // Calculate fragment position
+    Normal = normalMatrix * aNormal; // Transform normal
+    gl_Position = projection * view * model * vec4(aPos, 1.0); // Set vertex position
+}
@@ -0,0 +1,36 @@
+// Phong lighting shared by the assignment 5 shaders.
+// Material constants are injected per permutation with ew::ShaderDefines, so they are
+// compiled in as literals. The defaults below apply when a define is missing.
+#ifndef AMBIENT_STRENGTH
+#define AMBIENT_STRENGTH 0.1
+#endif
+#ifndef SPECULAR_STRENGTH
+#define SPECULAR_STRENGTH 0.5
+#endif
+#ifndef SHININESS
+#define SHININESS 32.0
+#endif
+
+vec3 shadePhong(vec3 fragPos, vec3 normal, vec3 lightPos, vec3 viewPos, vec3 lightColor) {
+    // Ambient lighting
+    vec3 ambient = AMBIENT_STRENGTH * lightColor;
+
+    // Diffuse lighting
+    vec3 norm = normalize(normal);
+    vec3 lightDir = normalize(lightPos - fragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * lightColor;
+
+    // Specular lighting, Blinn-Phong when the BLINN_PHONG permutation is selected
+    vec3 viewDir = normalize(viewPos - fragPos);
+#ifdef BLINN_PHONG
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), SHININESS);
+#else
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), SHININESS);
+#endif
+    vec3 specular = SPECULAR_STRENGTH * spec * lightColor;
+
+    return ambient + diffuse + specular;
+}
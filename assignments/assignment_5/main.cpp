@@ -1,12 +1,24 @@
 #include <stdio.h>
 #include <math.h>
+#include <string>
 #include <ew/external/glad.h>
+#include <ew/clusteredLighting.h>
+#include <ew/deferredRenderer.h>
+#include <ew/normalMatrix.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+#include <ew/shaderReloader.h>
+#include <ew/frameCapture.h>
+#include <ew/jobSystem.h>
 #include "../../out/build/x64-debug/_deps/glfw-src/include/GLFW/glfw3.h"
 #include "../../out/build/x64-debug/_deps/glm-src/glm/geometric.hpp"
 #include "../../out/build/x64-debug/_deps/glm-src/glm/ext/vector_float3.hpp"
 #include "../../out/build/x64-debug/_deps/glm-src/glm/ext/matrix_clip_space.hpp"
 #include "../../out/build/x64-debug/_deps/glm-src/glm/fwd.hpp"
 #include "../../out/build/x64-debug/_deps/glm-src/glm/gtc/type_ptr.hpp"
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
 //#include "../assignment_2/main.cpp"
 
 // Screen settings
@@ -29,61 +41,26 @@ glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
 glm::vec3 objectColor(1.0f, 0.5f, 0.31f);
 
-// Shader code
-const char* vertexShaderSource = R"(
-    #version 330 core
-    layout(location = 0) in vec3 aPos;
-    layout(location = 1) in vec3 aNormal;
-    
-    out vec3 FragPos;
-    out vec3 Normal;
-
-    uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
-
-    void main() {
-        FragPos = vec3(model * vec4(aPos, 1.0)); // Calculate fragment position
-        Normal = mat3(transpose(inverse(model))) * aNormal; // Transform normal
-        gl_Position = projection * view * model * vec4(aPos, 1.0); // Set vertex position
-    }
-)";
-
-const char* fragmentShaderSource = R"(
-    #version 330 core
-    out vec4 FragColor;
-
-    in vec3 FragPos;
-    in vec3 Normal;
-    
-    uniform vec3 lightPos;
-    uniform vec3 viewPos;
-    uniform vec3 lightColor;
-    uniform vec3 objectColor;
-
-    void main() {
-        // Ambient lighting
-        float ambientStrength = 0.1;
-        vec3 ambient = ambientStrength * lightColor;
-
-        // Diffuse lighting
-        vec3 norm = normalize(Normal);
-        vec3 lightDir = normalize(lightPos - FragPos);
-        float diff = max(dot(norm, lightDir), 0.0);
-        vec3 diffuse = diff * lightColor;
-
-        // Specular lighting
-        float specularStrength = 0.5;
-        vec3 viewDir = normalize(viewPos - FragPos);
-        vec3 reflectDir = reflect(-lightDir, norm);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-        vec3 specular = specularStrength * spec * lightColor;
-
-        // Final color
-        vec3 result = (ambient + diffuse + specular) * objectColor;
-        FragColor = vec4(result, 1.0);
-    }
-)";
+// Material properties, compiled into the lighting shader as literals
+float ambientStrength = 0.1f;
+float specularStrength = 0.5f;
+float shininess = 32.0f;
+bool blinnPhong = false;
+
+// Shading path, switched in the ImGui panel or with G. Deferred writes a G-buffer and lights it
+// in one fullscreen pass (ew::DeferredRenderer), so the two can be compared frame by frame.
+bool useDeferred = false;
+// Tab releases the cursor so the panel can be used, and captures it again for mouse look
+bool cursorCaptured = true;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+const float LIGHT_RADIUS = 20.0f;
+
+// Shaders live in assets/ and are rebuilt whenever they are saved. CMake points ASSET_DIR
+// at this assignment's source assets folder so edits show up without rebuilding.
+#ifndef ASSET_DIR
+#define ASSET_DIR "assets/"
+#endif
 
 // Initialize and configure GLFW
 void initializeGLFW() {
@@ -92,6 +69,10 @@ void initializeGLFW() {
         exit(EXIT_FAILURE);
     }
 
+    // The deferred path uses compute shaders and explicit bindings, so ask for 4.5 core
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Camera and Lighting", NULL, NULL);
     if (!window) {
         printf("Failed to create GLFW window\n");
@@ -124,8 +105,23 @@ void processInput(GLFWwindow* window) {
         cameraPos -= cameraSpeed * cameraUp;   
 }
 
+// Toggle lighting model with B, shading path with G, cursor capture with Tab
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_B && action == GLFW_PRESS)
+        blinnPhong = !blinnPhong;
+    if (key == GLFW_KEY_G && action == GLFW_PRESS)
+        useDeferred = !useDeferred;
+    if (key == GLFW_KEY_TAB && action == GLFW_PRESS) {
+        cursorCaptured = !cursorCaptured;
+        glfwSetInputMode(window, GLFW_CURSOR, cursorCaptured ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
+        firstMouse = true;
+    }
+}
+
 // Handle mouse input
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
+    if (!cursorCaptured)
+        return;
     if (firstMouse) {
         lastX = xpos;
         lastY = ypos;
@@ -165,39 +161,39 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
         fov = 45.0f;
 }
 
-// Function to compile shaders
-unsigned int compileShader(unsigned int type, const char* source) {
-    unsigned int shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
-
-    // Check for compilation errors
-    int success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        printf("ERROR::SHADER::COMPILATION_FAILED\n%s\n", infoLog);
-    }
-
-    return shader;
+// Defines selecting one lighting shader permutation
+ew::ShaderDefines lightingDefines(bool blinn) {
+    ew::ShaderDefines defines;
+    defines.set("AMBIENT_STRENGTH", ambientStrength);
+    defines.set("SPECULAR_STRENGTH", specularStrength);
+    defines.set("SHININESS", shininess);
+    if (blinn)
+        defines.set("BLINN_PHONG");
+    return defines;
 }
 
-// Function to create shader program
-unsigned int setupShaders() {
-    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    // Delete the shaders as they're linked now and no longer needed
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+// Geometry pass for the deferred path: assignment 5's vertex shader with a fragment shader
+// writing the G-buffer in place of lighting
+unsigned int createGBufferProgram() {
+    std::string vertexSource = ew::preprocessShader(ASSET_DIR "assignment5.vert", lightingDefines(false));
+    std::string fragmentSource = std::string("#version 450 core\n") + ew::deferredGBufferGlsl() +
+        "in vec3 FragPos;\n"
+        "in vec3 Normal;\n"
+        "uniform vec3 objectColor;\n"
+        "uniform float specularStrength;\n"
+        "void main() {\n"
+        "    writeGBuffer(Normal, objectColor, specularStrength);\n"
+        "}\n";
+    return ew::createShaderProgram(vertexSource.c_str(), fragmentSource.c_str());
+}
 
-    return shaderProgram;
+// Sets the transform uniforms shared by the forward and G-buffer programs
+void setTransformUniforms(unsigned int program, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) {
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glm::mat3 normalMatrix = ew::computeNormalMatrix(model);
+    glUniformMatrix3fv(glGetUniformLocation(program, "normalMatrix"), 1, GL_FALSE, glm::value_ptr(normalMatrix));
 }
 
 int main() {
@@ -206,12 +202,33 @@ int main() {
     GLFWwindow* window = glfwGetCurrentContext();
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     glEnable(GL_DEPTH_TEST);
 
-    // Shader program setup
-    unsigned int shaderProgram = setupShaders();
+    // ImGui chains to the callbacks installed above
+    ImGui::CreateContext();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 450");
+
+    // Shader program setup, rebuilt from assets/ when the files change
+    ew::enableParallelShaderCompile(glfwGetProcAddress);
+    ew::ShaderReloader shaders;
+    // Set EW_CAPTURE_DIR to record frames, e.g. for regression images or video
+    ew::JobSystem jobs;
+    ew::FrameCapture capture(jobs);
+    capture.startRecordingFromEnvironment();
+    // Lighting permutations (Phong, Blinn-Phong), each compiled the first time it is selected
+    int lightingShaders[2] = { -1, -1 };
+
+    // Deferred path, sized to the framebuffer each frame
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    ew::DeferredRenderer deferred(framebufferWidth, framebufferHeight);
+    ew::ClusteredLighting clusteredLighting;
+    unsigned int gBufferProgram = createGBufferProgram();
+    ew::GpuTimer gpuTimer;
 
     // Vertex data for a cube (or any other object)
     float vertices[] = {
@@ -248,32 +265,77 @@ int main() {
         lastFrame = currentFrame;
 
         processInput(window);
-
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glUseProgram(shaderProgram);
+        int& shaderId = lightingShaders[blinnPhong ? 1 : 0];
+        if (shaderId < 0)
+            shaderId = shaders.add(ASSET_DIR "assignment5.vert", ASSET_DIR "assignment5.frag", lightingDefines(blinnPhong));
+        shaders.update();
+        unsigned int shaderProgram = shaders.get(shaderId);
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
 
         // Set up model matrix (example for a rotating cube)
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.5f, 1.0f, 0.0f));
 
         // Camera view and projection setup
-        glm::mat4 projection = glm::perspective(glm::radians(fov), (float)SCREEN_WIDTH / SCREEN_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 projection = glm::perspective(glm::radians(fov), (float)SCREEN_WIDTH / SCREEN_HEIGHT, NEAR_PLANE, FAR_PLANE);
         glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
 
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-
-        // Light and view positions
-        glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
-        glUniform3f(glGetUniformLocation(shaderProgram, "viewPos"), cameraPos.x, cameraPos.y, cameraPos.z);
-        glUniform3f(glGetUniformLocation(shaderProgram, "lightColor"), lightColor.r, lightColor.g, lightColor.b);
-        glUniform3f(glGetUniformLocation(shaderProgram, "objectColor"), objectColor.r, objectColor.g, objectColor.b);
-
-        // Draw the object
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36); // Adjust number of vertices as necessary
-
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        gpuTimer.begin();
+        if (useDeferred) {
+            // The same single light, assigned to clusters so the lighting pass can look it up
+            ew::PointLight light;
+            light.positionRadius = glm::vec4(lightPos, LIGHT_RADIUS);
+            light.colorIntensity = glm::vec4(lightColor, 1.0f);
+            clusteredLighting.setLights(&light, 1);
+            clusteredLighting.build(view, projection, NEAR_PLANE, FAR_PLANE, framebufferWidth, framebufferHeight);
+
+            deferred.resize(framebufferWidth, framebufferHeight);
+            deferred.beginGeometryPass();
+            glUseProgram(gBufferProgram);
+            setTransformUniforms(gBufferProgram, model, view, projection);
+            glUniform3f(glGetUniformLocation(gBufferProgram, "objectColor"), objectColor.r, objectColor.g, objectColor.b);
+            glUniform1f(glGetUniformLocation(gBufferProgram, "specularStrength"), specularStrength);
+            glBindVertexArray(VAO);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            deferred.endGeometryPass();
+            glViewport(0, 0, framebufferWidth, framebufferHeight);
+            deferred.lightingPass(clusteredLighting, view, projection, cameraPos, ambientStrength * lightColor);
+        }
+        else {
+            glUseProgram(shaderProgram);
+            setTransformUniforms(shaderProgram, model, view, projection);
+
+            // Light and view positions
+            glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
+            glUniform3f(glGetUniformLocation(shaderProgram, "viewPos"), cameraPos.x, cameraPos.y, cameraPos.z);
+            glUniform3f(glGetUniformLocation(shaderProgram, "lightColor"), lightColor.r, lightColor.g, lightColor.b);
+            glUniform3f(glGetUniformLocation(shaderProgram, "objectColor"), objectColor.r, objectColor.g, objectColor.b);
+
+            // Draw the object
+            glBindVertexArray(VAO);
+            glDrawArrays(GL_TRIANGLES, 0, 36); // Adjust number of vertices as necessary
+        }
+        gpuTimer.end();
+
+        // Shading path panel, with the cost of the path in use
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+        ImGui::Begin("Shading");
+        ImGui::Checkbox("Deferred (G)", &useDeferred);
+        ImGui::Checkbox("Blinn-Phong (B)", &blinnPhong);
+        ImGui::Text("Frame %.2f ms, shading GPU %.3f ms", deltaTime * 1000.0f, gpuTimer.getMs());
+        if (useDeferred)
+            ImGui::Text("G-buffer %d bytes/pixel", ew::DeferredRenderer::getBytesPerPixel());
+        ImGui::Text("Tab toggles the cursor");
+        ImGui::End();
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        capture.endFrame(framebufferWidth, framebufferHeight);
+        if (capture.isFinished())
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
@@ -281,6 +343,12 @@ int main() {
     // Clean up resources
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    glDeleteProgram(gBufferProgram);
+    shaders.clear();
+    capture.clear();
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
     glfwTerminate();
     return 0;
 }
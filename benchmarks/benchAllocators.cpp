@@ -0,0 +1,139 @@
+#include "benchCommon.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <ew/allocators.h>
+#include <ew/megaBuffer.h>
+#include <ew/profiler.h>
+
+//Counts every global operator new in the benchmarks executable so the allocator
+//benchmark can report malloc traffic. The relaxed increment is negligible elsewhere.
+static std::atomic<long long> heapAllocations{ 0 };
+
+void* operator new(size_t size) {
+	heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = malloc(size ? size : 1);
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	free(ptr);
+}
+
+static const int FRAMES = 200;
+static const int LIST_COUNT = 64;
+static const int ITEMS_PER_LIST = 2000;
+static const int PARTICLES_PER_FRAME = 10000;
+
+struct Particle {
+	float position[3];
+	float velocity[3];
+	float life;
+	unsigned int color;
+};
+
+//Per-frame scratch work: culling lists, indirect commands and sort keys
+template<typename VectorU32, typename VectorCmd, typename VectorKey, typename MakeU32, typename MakeCmd, typename MakeKey>
+static size_t buildFrame(MakeU32 makeU32, MakeCmd makeCmd, MakeKey makeKey) {
+	size_t checksum = 0;
+	for (int list = 0; list < LIST_COUNT; list++) {
+		VectorU32 visible = makeU32();
+		for (int i = 0; i < ITEMS_PER_LIST; i++) {
+			if ((i * 2654435761u + list) % 3 != 0)
+				visible.push_back((unsigned int)i);
+		}
+		VectorCmd commands = makeCmd();
+		for (unsigned int index : visible)
+			commands.push_back({ 36, 1, 0, 0, index });
+		VectorKey keys = makeKey();
+		for (const ew::DrawElementsIndirectCommand& cmd : commands)
+			keys.push_back(((unsigned long long)(cmd.baseInstance * 2654435761u) << 32) | cmd.baseInstance);
+		std::sort(keys.begin(), keys.end());
+		checksum += keys.empty() ? 0 : (size_t)keys[0];
+	}
+	return checksum;
+}
+
+void benchAllocators() {
+	size_t checksum = 0;
+	{
+		ew::CpuTimer timer;
+		double total = 0.0;
+		long long before = heapAllocations.load();
+		for (int frame = 0; frame < FRAMES; frame++) {
+			timer.start();
+			checksum += buildFrame<std::vector<unsigned int>, std::vector<ew::DrawElementsIndirectCommand>, std::vector<unsigned long long>>(
+				[] { return std::vector<unsigned int>(); },
+				[] { return std::vector<ew::DrawElementsIndirectCommand>(); },
+				[] { return std::vector<unsigned long long>(); });
+			total += timer.stop();
+		}
+		bench::report("scratch lists, std::allocator", total / FRAMES);
+		printf("  %-40s %lld\n", "heap allocations per frame", (heapAllocations.load() - before) / FRAMES);
+	}
+	{
+		ew::FrameArena arena;
+		ew::CpuTimer timer;
+		double total = 0.0;
+		long long before = heapAllocations.load();
+		for (int frame = 0; frame < FRAMES; frame++) {
+			timer.start();
+			arena.beginFrame();
+			ew::LinearArena& scratch = arena.current();
+			checksum += buildFrame<ew::ArenaVector<unsigned int>, ew::ArenaVector<ew::DrawElementsIndirectCommand>, ew::ArenaVector<unsigned long long>>(
+				[&] { return ew::ArenaVector<unsigned int>(scratch); },
+				[&] { return ew::ArenaVector<ew::DrawElementsIndirectCommand>(scratch); },
+				[&] { return ew::ArenaVector<unsigned long long>(scratch); });
+			total += timer.stop();
+		}
+		bench::report("scratch lists, frame arena", total / FRAMES);
+		printf("  %-40s %lld\n", "heap allocations per frame", (heapAllocations.load() - before) / FRAMES);
+		arena.beginFrame();
+	}
+
+	std::vector<Particle*> live;
+	live.reserve(PARTICLES_PER_FRAME);
+	{
+		ew::CpuTimer timer;
+		double total = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			timer.start();
+			for (int i = 0; i < PARTICLES_PER_FRAME; i++)
+				live.push_back(new Particle());
+			for (Particle* particle : live)
+				delete particle;
+			live.clear();
+			total += timer.stop();
+		}
+		bench::report("particles, new/delete", total / FRAMES);
+	}
+	{
+		ew::ObjectPool<Particle> pool;
+		ew::CpuTimer timer;
+		double total = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			timer.start();
+			for (int i = 0; i < PARTICLES_PER_FRAME; i++)
+				live.push_back(pool.create());
+			for (Particle* particle : live)
+				pool.destroy(particle);
+			live.clear();
+			total += timer.stop();
+		}
+		bench::report("particles, object pool", total / FRAMES);
+		pool.getAllocator().publishStats("particlePool");
+	}
+
+	//Counters as the profiler would show them at the end of a frame
+	ew::ProfilerCounters::print();
+	printf("  (checksum %zu)\n", checksum);
+}
@@ -0,0 +1,155 @@
+#include "benchCommon.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <ew/assetPack.h>
+#include <ew/jobSystem.h>
+#include <ew/profiler.h>
+
+static const int ASSETS = 400;
+static const int RUNS = 5;
+static const char* SHADER_SNIPPET =
+	"uniform mat4 projection;\nuniform mat4 view;\nlayout(location = 0) in vec3 aPos;\n"
+	"void main() {\n    gl_Position = projection * view * vec4(aPos, 1.0);\n}\n";
+
+//A mix like the assignments ship: small text shaders, medium meshes, images that are already compressed
+static std::vector<unsigned char> makeAsset(int index) {
+	std::vector<unsigned char> data;
+	if (index % 4 < 2) {
+		std::string text;
+		for (int i = 0; i < 20 + index % 50; i++)
+			text += SHADER_SNIPPET + std::to_string(i * index) + "\n";
+		data.assign(text.begin(), text.end());
+	}
+	else if (index % 4 == 2) {
+		//Interleaved position/normal/uv grid
+		int side = 64 + index % 64;
+		std::vector<float> vertices;
+		for (int y = 0; y < side; y++) {
+			for (int x = 0; x < side; x++) {
+				float height = floorf(sinf(x * 0.1f) * cosf(y * 0.1f) * 64.0f) / 64.0f;
+				float vertex[8] = { (float)x, height, (float)y, 0.0f, 1.0f, 0.0f, x / (float)side, y / (float)side };
+				vertices.insert(vertices.end(), vertex, vertex + 8);
+			}
+		}
+		data.resize(vertices.size() * sizeof(float));
+		memcpy(data.data(), vertices.data(), data.size());
+	}
+	else {
+		data.resize(16 * 1024 + index * 64);
+		for (unsigned char& byte : data)
+			byte = (unsigned char)rand();
+	}
+	return data;
+}
+
+static std::string loosePath(int index) {
+	return "assetPackBench_" + std::to_string(index) + ".bin";
+}
+
+static bool readLoose(const std::string& path, std::vector<unsigned char>& data) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file)
+		return false;
+	fseek(file, 0, SEEK_END);
+	data.resize((size_t)ftell(file));
+	fseek(file, 0, SEEK_SET);
+	bool ok = fread(data.data(), 1, data.size(), file) == data.size();
+	fclose(file);
+	return ok;
+}
+
+void benchAssetPack() {
+	srand(7);
+	ew::JobSystem jobs;
+	ew::AssetPackBuilder compressed, stored;
+	std::vector<std::string> paths;
+	size_t totalBytes = 0;
+	for (int i = 0; i < ASSETS; i++) {
+		std::vector<unsigned char> data = makeAsset(i);
+		totalBytes += data.size();
+		FILE* file = fopen(loosePath(i).c_str(), "wb");
+		if (file) {
+			fwrite(data.data(), 1, data.size(), file);
+			fclose(file);
+		}
+		paths.push_back("assets/" + loosePath(i));
+		compressed.addData(paths.back(), data, true);
+		stored.addData(paths.back(), data, false);
+	}
+	ew::CpuTimer timer;
+	timer.start();
+	compressed.write("assetPackBench.ewpk", &jobs);
+	double buildMs = timer.stop();
+	stored.write("assetPackBench_stored.ewpk");
+
+	//Files were just written, so every variant reads from the OS cache; this compares
+	//per-file overhead and decode speed, not disk throughput
+	size_t packBytes = 0;
+	{
+		ew::AssetPack pack("assetPackBench.ewpk");
+		for (size_t i = 0; i < pack.getEntryCount(); i++)
+			packBytes += (size_t)pack.getEntry(i).storedSize;
+	}
+	printf("  %d assets, %.1f MB, packed to %.1f MB in %.2f ms on %u workers\n", ASSETS, totalBytes / (1024.0 * 1024.0),
+		packBytes / (1024.0 * 1024.0), buildMs, jobs.getWorkerCount());
+
+	//Every variant but view() loads into fresh buffers, as loading assets for real would
+	size_t checksum = 0;
+	double looseMs = 0.0, serialMs = 0.0, parallelMs = 0.0, viewMs = 0.0;
+	for (int run = 0; run < RUNS; run++) {
+		timer.start();
+		{
+			std::vector<std::vector<unsigned char>> contents(ASSETS);
+			for (int i = 0; i < ASSETS; i++)
+				readLoose(loosePath(i), contents[i]);
+			checksum += contents.back().size();
+		}
+		looseMs += timer.stop();
+
+		timer.start();
+		{
+			ew::AssetPack pack("assetPackBench.ewpk");
+			std::vector<std::vector<unsigned char>> contents(ASSETS);
+			for (int i = 0; i < ASSETS; i++)
+				pack.read(paths[i], contents[i]);
+			checksum += contents.back().size();
+		}
+		serialMs += timer.stop();
+
+		timer.start();
+		{
+			ew::AssetPack pack("assetPackBench.ewpk");
+			std::vector<std::vector<unsigned char>> contents;
+			pack.readMany(paths, contents, jobs);
+			checksum += contents.back().size();
+		}
+		parallelMs += timer.stop();
+
+		//Touches one byte per page, as an upload straight from the mapping would
+		timer.start();
+		{
+			ew::AssetPack pack("assetPackBench_stored.ewpk");
+			for (const std::string& path : paths) {
+				size_t size = 0;
+				const unsigned char* bytes = pack.view(path, &size);
+				for (size_t offset = 0; bytes && offset < size; offset += 4096)
+					checksum += bytes[offset];
+			}
+		}
+		viewMs += timer.stop();
+	}
+	bench::report("loose files, fopen + fread each", looseMs / RUNS);
+	bench::report("pack, read() one at a time", serialMs / RUNS);
+	bench::report("pack, readMany() on workers", parallelMs / RUNS);
+	bench::report("stored pack, zero-copy view()", viewMs / RUNS);
+	printf("  (checksum %zu)\n", checksum);
+
+	for (int i = 0; i < ASSETS; i++)
+		remove(loosePath(i).c_str());
+	remove("assetPackBench.ewpk");
+	remove("assetPackBench_stored.ewpk");
+}
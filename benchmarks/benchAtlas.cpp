@@ -0,0 +1,169 @@
+#include "benchCommon.h"
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/profiler.h>
+#include <ew/spriteBatch.h>
+#include <ew/textureAtlas.h>
+
+static const int FRAMES = 10;
+static const int PACK_IMAGES = 2000;
+static const int SHEETS = 64;
+static const int SHEET_FRAMES = 8;
+static const int FRAME_SIZE = 32;
+static const unsigned int SPRITES = 20000;
+
+//A horizontal strip of frames, each a disc of a different size, like a small sprite sheet
+static std::vector<unsigned char> makeSheet(int sheet) {
+	int width = FRAME_SIZE * SHEET_FRAMES;
+	std::vector<unsigned char> pixels((size_t)width * FRAME_SIZE * 4);
+	for (int y = 0; y < FRAME_SIZE; y++) {
+		for (int x = 0; x < width; x++) {
+			unsigned char* p = &pixels[((size_t)y * width + x) * 4];
+			int frame = x / FRAME_SIZE;
+			float dx = (x % FRAME_SIZE + 0.5f) / FRAME_SIZE - 0.5f, dy = (y + 0.5f) / FRAME_SIZE - 0.5f;
+			float radius = 0.2f + 0.25f * frame / SHEET_FRAMES;
+			p[0] = (unsigned char)(sheet * 4);
+			p[1] = (unsigned char)(255 - sheet * 4);
+			p[2] = (unsigned char)(frame * 32);
+			p[3] = dx * dx + dy * dy < radius * radius ? 255 : 0;
+		}
+	}
+	return pixels;
+}
+
+//One single-layer texture array per frame, the layout an atlas replaces
+static unsigned int createFrameTexture(const std::vector<unsigned char>& sheet, int frame) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, FRAME_SIZE, FRAME_SIZE, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, FRAME_SIZE * SHEET_FRAMES);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, FRAME_SIZE, FRAME_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, &sheet[(size_t)frame * FRAME_SIZE * 4]);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	return texture;
+}
+
+static void runPacking() {
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<int> size(4, 96);
+	std::vector<unsigned char> pixels(96 * 96 * 4, 255);
+	ew::TextureAtlas atlas;
+	for (int i = 0; i < PACK_IMAGES; i++)
+		atlas.addImage("image" + std::to_string(i), size(rng), size(rng), pixels.data());
+
+	const int mipLevels[] = { 1, 4 };
+	for (int levels : mipLevels) {
+		ew::AtlasSettings settings;
+		settings.pageSize = 2048;
+		settings.mipLevels = levels;
+		ew::CpuTimer timer;
+		timer.start();
+		atlas.build(settings);
+		double ms = timer.stop();
+		char name[96];
+		snprintf(name, sizeof(name), "pack %d images, %d mips (%d pages, %.0f%% used)", PACK_IMAGES, levels, atlas.getPageCount(), atlas.getOccupancy() * 100.0f);
+		bench::report(name, ms);
+	}
+
+	//Cooked atlases skip sorting and packing; loading is a straight read
+	const char* path = "benchAtlas.cooked";
+	atlas.saveCooked(path);
+	ew::TextureAtlas cooked;
+	ew::CpuTimer timer;
+	timer.start();
+	cooked.loadCooked(path);
+	bench::report("load cooked atlas", timer.stop());
+	remove(path);
+}
+
+static void runDrawing(GLFWwindow* window) {
+	ew::TextureAtlas atlas;
+	std::vector<unsigned int> frameTextures;
+	std::vector<ew::SpriteAnimation> animations(SHEETS);
+	for (int sheet = 0; sheet < SHEETS; sheet++) {
+		std::vector<unsigned char> pixels = makeSheet(sheet);
+		std::string name = "sheet" + std::to_string(sheet);
+		atlas.addGrid(name, FRAME_SIZE * SHEET_FRAMES, FRAME_SIZE, pixels.data(), FRAME_SIZE, FRAME_SIZE);
+		for (int frame = 0; frame < SHEET_FRAMES; frame++)
+			frameTextures.push_back(createFrameTexture(pixels, frame));
+	}
+	ew::AtlasSettings settings;
+	settings.mipLevels = 3;
+	atlas.build(settings);
+	unsigned int atlasTexture = atlas.createTexture();
+	for (int sheet = 0; sheet < SHEETS; sheet++) {
+		animations[sheet].frames = atlas.findSequence("sheet" + std::to_string(sheet));
+		animations[sheet].frameDuration = 1.0f / 12.0f;
+	}
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<ew::SpriteAnimator> animators(SPRITES);
+	std::vector<ew::Sprite> sprites(SPRITES);
+	std::vector<int> sheets(SPRITES);
+	for (unsigned int i = 0; i < SPRITES; i++) {
+		sheets[i] = i % SHEETS;
+		animators[i].play(&animations[sheets[i]]);
+		animators[i].update(unit(rng));
+		sprites[i].position = glm::vec2(unit(rng) * bench::SCREEN_WIDTH, unit(rng) * bench::SCREEN_HEIGHT);
+		sprites[i].size = glm::vec2(16.0f);
+	}
+
+	glm::mat4 projection = glm::ortho(0.0f, (float)bench::SCREEN_WIDTH, 0.0f, (float)bench::SCREEN_HEIGHT, -1.0f, 1.0f);
+	ew::SpriteBatch batch;
+	const char* names[] = { "texture per frame", "atlas" };
+	for (int useAtlas = 0; useAtlas < 2; useAtlas++) {
+		ew::CpuTimer cpuTimer;
+		ew::GpuTimer gpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		unsigned int draws = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			cpuTimer.start();
+			gpuTimer.begin();
+			batch.begin(projection);
+			for (unsigned int i = 0; i < SPRITES; i++) {
+				animators[i].update(1.0f / 60.0f);
+				if (useAtlas) {
+					animators[i].apply(atlas, atlasTexture, sprites[i]);
+				}
+				else {
+					//Same animation, but switching between whole textures
+					int region = animators[i].getRegion();
+					int localFrame = region - animations[sheets[i]].frames[0];
+					sprites[i].texture = frameTextures[sheets[i] * SHEET_FRAMES + localFrame];
+					sprites[i].uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+					sprites[i].layer = 0;
+				}
+				batch.draw(sprites[i]);
+			}
+			batch.end();
+			draws = batch.getDrawCount();
+			gpuTimer.end();
+			cpuTotal += cpuTimer.stop();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		char name[96];
+		snprintf(name, sizeof(name), "%u animated sprites, %s (%u draws)", SPRITES, names[useAtlas], draws);
+		bench::report(name, cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+
+	glDeleteTextures((GLsizei)frameTextures.size(), frameTextures.data());
+	glDeleteTextures(1, &atlasTexture);
+}
+
+void benchAtlas() {
+	runPacking();
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runDrawing(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,147 @@
+#include "benchCommon.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <ew/blockCompression.h>
+#include <ew/jobSystem.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+static const char* vertexShaderSource = R"(
+    #version 450 core
+    out vec2 UV;
+    void main() {
+        UV = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(UV * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+//Each layer reads the texture at a different offset so the passes do not share cache lines
+static const char* fragmentShaderSource = R"(
+    #version 450 core
+    in vec2 UV;
+    out vec4 FragColor;
+    layout(binding = 0) uniform sampler2D image;
+    uniform vec2 uOffset;
+    void main() {
+        FragColor = texture(image, UV + uOffset);
+    }
+)";
+
+static const int FRAMES = 10;
+static const int IMAGE_SIZE = 2048;
+static const int PASSES = 16;
+
+//Smooth gradients with some high frequency detail, closer to real albedo than noise
+static std::vector<unsigned char> makeImage() {
+	std::vector<unsigned char> pixels((size_t)IMAGE_SIZE * IMAGE_SIZE * 4);
+	for (int y = 0; y < IMAGE_SIZE; y++) {
+		for (int x = 0; x < IMAGE_SIZE; x++) {
+			unsigned char* p = &pixels[((size_t)y * IMAGE_SIZE + x) * 4];
+			float u = (float)x / IMAGE_SIZE, v = (float)y / IMAGE_SIZE;
+			float detail = 0.5f + 0.5f * sinf(x * 0.35f) * cosf(y * 0.27f);
+			p[0] = (unsigned char)(255.0f * u);
+			p[1] = (unsigned char)(255.0f * (0.6f * v + 0.4f * detail));
+			p[2] = (unsigned char)(255.0f * (0.5f + 0.5f * sinf((u + v) * 12.0f)));
+			p[3] = (unsigned char)(255.0f * detail);
+		}
+	}
+	return pixels;
+}
+
+static void runEncode(const std::vector<unsigned char>& pixels) {
+	ew::JobSystem jobs;
+	const char* names[] = { "BC1", "BC3", "BC4", "BC5" };
+	double megapixels = (double)IMAGE_SIZE * IMAGE_SIZE / 1e6;
+	for (int format = 0; format < 4; format++) {
+		for (int threaded = 0; threaded < 2; threaded++) {
+			ew::CpuTimer timer;
+			timer.start();
+			ew::CompressedImage image = ew::compressImage(pixels.data(), IMAGE_SIZE, IMAGE_SIZE, (ew::BlockFormat)format, false, threaded ? &jobs : nullptr);
+			double ms = timer.stop();
+			char name[96];
+			if (threaded) {
+				snprintf(name, sizeof(name), "encode %s, %u threads (%.1f MP/s)", names[format], jobs.getWorkerCount() + 1, megapixels / (ms / 1000.0));
+			}
+			else {
+				std::vector<unsigned char> decoded = ew::decompressImage(image);
+				double psnr = ew::computePSNR(pixels.data(), decoded.data(), (size_t)IMAGE_SIZE * IMAGE_SIZE, ew::blockChannels((ew::BlockFormat)format));
+				snprintf(name, sizeof(name), "encode %s, 1 thread (%.1f MP/s, %.2f dB)", names[format], megapixels / (ms / 1000.0), psnr);
+			}
+			bench::report(name, ms);
+		}
+	}
+
+	//Row 0 must decode back to row 0. The image's vertical gradient makes a flip cost far more
+	//than compression does, so the flipped comparison scoring higher means the rows were reversed.
+	ew::CompressedImage image = ew::compressImage(pixels.data(), IMAGE_SIZE, IMAGE_SIZE, ew::BlockFormat::BC1, false, &jobs);
+	std::vector<unsigned char> decoded = ew::decompressImage(image);
+	std::vector<unsigned char> flipped(pixels.size());
+	size_t rowBytes = (size_t)IMAGE_SIZE * 4;
+	for (int y = 0; y < IMAGE_SIZE; y++)
+		memcpy(&flipped[(size_t)y * rowBytes], &pixels[(size_t)(IMAGE_SIZE - 1 - y) * rowBytes], rowBytes);
+	double psnr = ew::computePSNR(pixels.data(), decoded.data(), (size_t)IMAGE_SIZE * IMAGE_SIZE, 3);
+	double flippedPsnr = ew::computePSNR(flipped.data(), decoded.data(), (size_t)IMAGE_SIZE * IMAGE_SIZE, 3);
+	printf("  orientation: %.2f dB as encoded, %.2f dB flipped%s\n", psnr, flippedPsnr, flippedPsnr > psnr ? " (ERROR: decoded upside down)" : "");
+}
+
+static void runSampling(GLFWwindow* window, const std::vector<unsigned char>& pixels) {
+	unsigned int program = ew::createShaderProgram(vertexShaderSource, fragmentShaderSource);
+	int offsetLocation = glGetUniformLocation(program, "uOffset");
+	unsigned int vao;
+	glGenVertexArrays(1, &vao);
+
+	//No mips, so every pass reads the full-resolution level and bandwidth dominates
+	unsigned int rgba8;
+	glGenTextures(1, &rgba8);
+	glBindTexture(GL_TEXTURE_2D, rgba8);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, IMAGE_SIZE, IMAGE_SIZE);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, IMAGE_SIZE, IMAGE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	ew::JobSystem jobs;
+	ew::CompressedImage image = ew::compressImage(pixels.data(), IMAGE_SIZE, IMAGE_SIZE, ew::BlockFormat::BC1, false, &jobs);
+	unsigned int bc1 = ew::createCompressedTexture(image);
+	bool s3tc = ew::supportsS3TC();
+
+	const unsigned int textures[] = { rgba8, bc1 };
+	const char* names[] = { "RGBA8", s3tc ? "BC1" : "BC1 (no S3TC, decoded to RGBA8)" };
+	for (int t = 0; t < 2; t++) {
+		ew::CpuTimer cpuTimer;
+		ew::GpuTimer gpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			cpuTimer.start();
+			gpuTimer.begin();
+			glUseProgram(program);
+			glBindVertexArray(vao);
+			glBindTextureUnit(0, textures[t]);
+			for (int pass = 0; pass < PASSES; pass++) {
+				glUniform2f(offsetLocation, pass * 0.061f, pass * 0.043f);
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+			}
+			gpuTimer.end();
+			cpuTotal += cpuTimer.stop();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		char name[96];
+		snprintf(name, sizeof(name), "sample %dx %s %d^2", PASSES, names[t], IMAGE_SIZE);
+		bench::report(name, cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+
+	glDeleteTextures(1, &rgba8);
+	glDeleteTextures(1, &bc1);
+	glDeleteVertexArrays(1, &vao);
+	glDeleteProgram(program);
+}
+
+void benchBlockCompression() {
+	std::vector<unsigned char> pixels = makeImage();
+	runEncode(pixels);
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runSampling(window, pixels);
+	bench::destroyContext(window);
+}
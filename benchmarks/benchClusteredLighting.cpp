@@ -0,0 +1,164 @@
+#include "benchCommon.h"
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/clusteredLighting.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+static const char* clusteredFragmentMain = R"(
+    in vec3 WorldPos;
+    in vec3 Normal;
+    in float ViewDepth;
+    uniform vec3 cameraPos;
+    out vec4 FragColor;
+
+    void main() {
+        vec3 normal = normalize(Normal);
+        vec3 viewDir = normalize(cameraPos - WorldPos);
+        vec3 color = shadeClusteredLights(WorldPos, normal, viewDir, ViewDepth, vec3(0.8));
+        FragColor = vec4(color + vec3(0.02), 1.0);
+    }
+)";
+
+//Baseline: the same light model evaluated for every light in the scene
+static const char* forwardFragmentMain = R"(
+    in vec3 WorldPos;
+    in vec3 Normal;
+    in float ViewDepth;
+    uniform vec3 cameraPos;
+    uniform uint lightCount;
+    out vec4 FragColor;
+
+    void main() {
+        vec3 normal = normalize(Normal);
+        vec3 viewDir = normalize(cameraPos - WorldPos);
+        vec3 color = vec3(0.0);
+        for (uint i = 0u; i < lightCount; i++) {
+            PointLight light = lights[i];
+            vec3 toLight = light.positionRadius.xyz - WorldPos;
+            float distanceSq = dot(toLight, toLight);
+            float radius = light.positionRadius.w;
+            if (distanceSq >= radius * radius)
+                continue;
+            vec3 lightDir = toLight * inversesqrt(distanceSq);
+            float window = 1.0 - distanceSq / (radius * radius);
+            float attenuation = window * window / (1.0 + distanceSq);
+            float diff = max(dot(normal, lightDir), 0.0);
+            float spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), 32.0);
+            color += (vec3(0.8) * diff + 0.3 * spec) * light.colorIntensity.rgb * light.colorIntensity.w * attenuation;
+        }
+        FragColor = vec4(color + vec3(0.02), 1.0);
+    }
+)";
+
+static const int FRAMES = 10;
+static const unsigned int LIGHT_COUNTS[] = { 1, 16, 64, 256, 1024, 4096 };
+//Looping over every light per pixel gets impractically slow under llvmpipe past this
+static const unsigned int MAX_FORWARD_LIGHTS = 1024;
+static const float NEAR_PLANE = 0.1f;
+static const float FAR_PLANE = 100.0f;
+
+static void runClusteredLighting(GLFWwindow* window) {
+	std::string lightingSource = std::string("#version 450 core\n") + ew::clusteredLightingGlsl();
+	unsigned int clusteredProgram = ew::createShaderProgram(bench::sceneVertexSource, (lightingSource + clusteredFragmentMain).c_str());
+	unsigned int forwardProgram = ew::createShaderProgram(bench::sceneVertexSource, (lightingSource + forwardFragmentMain).c_str());
+
+	bench::MeshBuffers plane = bench::createMeshBuffers(ew::createPlane(60.0f, 60.0f, 32));
+	bench::MeshBuffers sphere = bench::createMeshBuffers(ew::createSphere(1.0f, 24));
+	std::vector<bench::SceneObject> objects;
+	objects.push_back({ &plane, glm::mat4(1.0f) });
+	for (int i = 0; i < 64; i++)
+		objects.push_back({ &sphere, glm::translate(glm::mat4(1.0f), glm::vec3((i % 8) * 6.0f - 21.0f, 1.0f, (i / 8) * 6.0f - 21.0f)) });
+
+	//Lights scattered over the floor, small radius so each touches a handful of clusters
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<ew::PointLight> lights(4096);
+	for (ew::PointLight& light : lights) {
+		light.positionRadius = glm::vec4(unit(rng) * 60.0f - 30.0f, 0.5f + unit(rng) * 3.0f, unit(rng) * 60.0f - 30.0f, 3.0f + unit(rng) * 2.0f);
+		light.colorIntensity = glm::vec4(unit(rng), unit(rng), unit(rng), 4.0f);
+	}
+
+	glm::vec3 cameraPos(0.0f, 12.0f, 28.0f);
+	glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, NEAR_PLANE, FAR_PLANE);
+	for (unsigned int program : { clusteredProgram, forwardProgram }) {
+		glUseProgram(program);
+		glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, &view[0][0]);
+		glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &projection[0][0]);
+		glUniform3fv(glGetUniformLocation(program, "cameraPos"), 1, &cameraPos[0]);
+	}
+	glEnable(GL_DEPTH_TEST);
+
+	ew::ClusteredLighting clustered;
+	for (unsigned int lightCount : LIGHT_COUNTS) {
+		clustered.setLights(lights.data(), lightCount);
+		printf("  %u lights\n", lightCount);
+		for (int mode = 0; mode < 2; mode++) {
+			if (mode == 0 && lightCount > MAX_FORWARD_LIGHTS) {
+				printf("  %-40s skipped\n", "forward, all lights per pixel");
+				continue;
+			}
+			ew::GpuTimer buildTimer, shadeTimer;
+			ew::CpuTimer cpuTimer;
+			double cpuTotal = 0.0, buildTotal = 0.0, shadeTotal = 0.0;
+			for (int frame = 0; frame < FRAMES; frame++) {
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				cpuTimer.start();
+				unsigned int program = mode == 0 ? forwardProgram : clusteredProgram;
+				if (mode == 1) {
+					buildTimer.begin();
+					clustered.build(view, projection, NEAR_PLANE, FAR_PLANE, bench::SCREEN_WIDTH, bench::SCREEN_HEIGHT);
+					buildTimer.end();
+				}
+				else {
+					clustered.bind();
+				}
+				shadeTimer.begin();
+				glUseProgram(program);
+				if (mode == 0)
+					glUniform1ui(glGetUniformLocation(program, "lightCount"), lightCount);
+				bench::drawScene(program, objects);
+				shadeTimer.end();
+				cpuTotal += cpuTimer.stop();
+				if (mode == 1)
+					buildTotal += buildTimer.resolve();
+				shadeTotal += shadeTimer.resolve();
+				glfwSwapBuffers(window);
+			}
+			if (mode == 0) {
+				bench::report("forward, all lights per pixel", cpuTotal / FRAMES, shadeTotal / FRAMES);
+			}
+			else {
+				bench::report("clustered (build + shade)", cpuTotal / FRAMES, (buildTotal + shadeTotal) / FRAMES);
+				std::vector<unsigned int> counts = clustered.readClusterCounts();
+				unsigned int maxCount = 0;
+				double sum = 0.0;
+				for (unsigned int count : counts) {
+					maxCount = count > maxCount ? count : maxCount;
+					sum += count;
+				}
+				printf("    build %.3f ms, shade %.3f ms, lights per cluster avg %.1f max %u\n",
+					buildTotal / FRAMES, shadeTotal / FRAMES, sum / counts.size(), maxCount);
+			}
+		}
+	}
+
+	bench::deleteMeshBuffers(plane);
+	bench::deleteMeshBuffers(sphere);
+	glDeleteProgram(clusteredProgram);
+	glDeleteProgram(forwardProgram);
+}
+
+void benchClusteredLighting() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runClusteredLighting(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,151 @@
+#include "benchCommon.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <ew/normalMatrix.h>
+
+namespace bench {
+	GLFWwindow* createContext(int width, int height) {
+		if (!glfwInit()) {
+			printf("GLFW failed to init!\n");
+			return NULL;
+		}
+		glfwWindowHint(GLFW_VISIBLE, 0);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		GLFWwindow* window = glfwCreateWindow(width, height, "Benchmark", NULL, NULL);
+		if (!window) {
+			printf("GLFW failed to create window\n");
+			glfwTerminate();
+			return NULL;
+		}
+		glfwMakeContextCurrent(window);
+		glfwSwapInterval(0);
+		if (!gladLoadGL(glfwGetProcAddress)) {
+			printf("GLAD Failed to load GL headers\n");
+			return NULL;
+		}
+		printf("Renderer: %s\n", (const char*)glGetString(GL_RENDERER));
+		return window;
+	}
+
+	void destroyContext(GLFWwindow* window) {
+		glfwDestroyWindow(window);
+		glfwTerminate();
+	}
+
+	void report(const char* name, double cpuMs, double gpuMs) {
+		if (gpuMs < 0.0)
+			printf("  %-40s cpu %8.3f ms\n", name, cpuMs);
+		else
+			printf("  %-40s cpu %8.3f ms   gpu %8.3f ms\n", name, cpuMs, gpuMs);
+	}
+
+	MeshBuffers createMeshBuffers(const ew::MeshData& mesh) {
+		MeshBuffers buffers;
+		buffers.indexCount = (int)mesh.indices.size();
+		glGenVertexArrays(1, &buffers.vao);
+		glGenBuffers(1, &buffers.vbo);
+		glGenBuffers(1, &buffers.ebo);
+		glBindVertexArray(buffers.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, buffers.vbo);
+		glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(ew::Vertex), mesh.vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ew::Vertex), (const void*)offsetof(ew::Vertex, pos));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ew::Vertex), (const void*)offsetof(ew::Vertex, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(ew::Vertex), (const void*)offsetof(ew::Vertex, uv));
+		glEnableVertexAttribArray(2);
+		glBindVertexArray(0);
+		return buffers;
+	}
+
+	void deleteMeshBuffers(MeshBuffers& buffers) {
+		glDeleteVertexArrays(1, &buffers.vao);
+		glDeleteBuffers(1, &buffers.vbo);
+		glDeleteBuffers(1, &buffers.ebo);
+		buffers = MeshBuffers();
+	}
+
+	void drawMesh(const MeshBuffers& buffers) {
+		glBindVertexArray(buffers.vao);
+		glDrawElements(GL_TRIANGLES, buffers.indexCount, GL_UNSIGNED_INT, 0);
+	}
+
+	void drawSceneObject(int modelLocation, int normalMatrixLocation, const MeshBuffers& mesh, const glm::mat4& model) {
+		glm::mat3 normalMatrix = ew::computeNormalMatrix(model);
+		glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &model[0][0]);
+		glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, &normalMatrix[0][0]);
+		drawMesh(mesh);
+	}
+
+	void drawScene(unsigned int program, const std::vector<SceneObject>& objects) {
+		int modelLocation = glGetUniformLocation(program, "model");
+		int normalMatrixLocation = glGetUniformLocation(program, "normalMatrix");
+		for (const SceneObject& object : objects)
+			drawSceneObject(modelLocation, normalMatrixLocation, *object.mesh, object.model);
+	}
+
+	const char* const megaBufferVertexSource = R"(
+    #version 450 core
+    layout(location = 0) in vec3 aPos;
+    layout(location = 1) in vec3 aNormal;
+    layout(location = 3) in uint aDrawID;
+
+    struct DrawData {
+        mat4 model;
+        vec4 color;
+    };
+    layout(std430, binding = 0) readonly buffer DrawBuffer {
+        DrawData draws[];
+    };
+
+    uniform mat4 viewProjection;
+    out vec3 Normal;
+    out vec3 Color;
+
+    void main() {
+        DrawData draw = draws[aDrawID];
+        Normal = mat3(draw.model) * aNormal;
+        Color = draw.color.rgb;
+        gl_Position = viewProjection * draw.model * vec4(aPos, 1.0);
+    }
+)";
+
+	const char* const megaBufferFragmentSource = R"(
+    #version 450 core
+    in vec3 Normal;
+    in vec3 Color;
+    out vec4 FragColor;
+
+    void main() {
+        float diff = max(dot(normalize(Normal), normalize(vec3(0.3, 1.0, 0.5))), 0.1);
+        FragColor = vec4(Color * diff, 1.0);
+    }
+)";
+
+	const char* const sceneVertexSource = R"(
+    #version 450 core
+    layout(location = 0) in vec3 aPos;
+    layout(location = 1) in vec3 aNormal;
+
+    uniform mat4 model;
+    uniform mat3 normalMatrix;
+    uniform mat4 view;
+    uniform mat4 projection;
+    out vec3 WorldPos;
+    out vec3 Normal;
+    out float ViewDepth;
+
+    void main() {
+        vec4 worldPos = model * vec4(aPos, 1.0);
+        vec4 viewPos = view * worldPos;
+        WorldPos = worldPos.xyz;
+        Normal = normalMatrix * aNormal;
+        ViewDepth = -viewPos.z;
+        gl_Position = projection * viewPos;
+    }
+)";
+}
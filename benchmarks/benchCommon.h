@@ -0,0 +1,45 @@
+#pragma once
+#include <ew/external/glad.h>
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <ew/mesh.h>
+
+namespace bench {
+	const int SCREEN_WIDTH = 1080;
+	const int SCREEN_HEIGHT = 720;
+
+	//Hidden window with a GL 4.5 core context, the highest version llvmpipe exposes
+	GLFWwindow* createContext(int width = SCREEN_WIDTH, int height = SCREEN_HEIGHT);
+	void destroyContext(GLFWwindow* window);
+
+	//Prints one row of a results table. CPU-only benchmarks leave gpuMs negative.
+	void report(const char* name, double cpuMs, double gpuMs = -1.0);
+
+	//Standalone VAO for one mesh: position at location 0, normal at 1, uv at 2
+	struct MeshBuffers {
+		unsigned int vao = 0;
+		unsigned int vbo = 0;
+		unsigned int ebo = 0;
+		int indexCount = 0;
+	};
+	MeshBuffers createMeshBuffers(const ew::MeshData& mesh);
+	void deleteMeshBuffers(MeshBuffers& buffers);
+	void drawMesh(const MeshBuffers& buffers);
+
+	//Draws one mesh with its model and normal matrix uniforms set
+	void drawSceneObject(int modelLocation, int normalMatrixLocation, const MeshBuffers& mesh, const glm::mat4& model);
+
+	struct SceneObject {
+		const MeshBuffers* mesh;
+		glm::mat4 model;
+	};
+	void drawScene(unsigned int program, const std::vector<SceneObject>& objects);
+
+	//MegaBuffer draws: per-draw model and color read from the DrawData SSBO at binding 0 by aDrawID, one directional light
+	extern const char* const megaBufferVertexSource;
+	extern const char* const megaBufferFragmentSource;
+
+	//Lit scene objects: model, normalMatrix, view and projection uniforms; outputs WorldPos, Normal and ViewDepth
+	extern const char* const sceneVertexSource;
+}
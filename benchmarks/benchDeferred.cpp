@@ -0,0 +1,182 @@
+#include "benchCommon.h"
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/clusteredLighting.h>
+#include <ew/deferredRenderer.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+#include <ew/shaderPreprocessor.h>
+
+//The forward reference is assignment 5's own Phong shader, read from its source folder
+#ifndef ASSIGNMENT5_ASSET_DIR
+#define ASSIGNMENT5_ASSET_DIR "assignments/assignment_5/assets/"
+#endif
+
+static const char* clusteredFragmentMain = R"(
+    in vec3 WorldPos;
+    in vec3 Normal;
+    in float ViewDepth;
+    uniform vec3 cameraPos;
+    out vec4 FragColor;
+
+    void main() {
+        vec3 normal = normalize(Normal);
+        vec3 viewDir = normalize(cameraPos - WorldPos);
+        vec3 color = shadeClusteredLights(WorldPos, normal, viewDir, ViewDepth, vec3(0.8), 0.3);
+        FragColor = vec4(color + vec3(0.02) * vec3(0.8), 1.0);
+    }
+)";
+
+static const char* gBufferFragmentMain = R"(
+    in vec3 WorldPos;
+    in vec3 Normal;
+    in float ViewDepth;
+
+    void main() {
+        writeGBuffer(Normal, vec3(0.8), 0.3);
+    }
+)";
+
+enum class ShadingPath {
+	ForwardPhong,
+	ClusteredForward,
+	Deferred
+};
+
+static const int FRAMES = 10;
+static const unsigned int LIGHT_COUNTS[] = { 1, 64, 256, 1024 };
+static const float NEAR_PLANE = 0.1f;
+static const float FAR_PLANE = 100.0f;
+
+static void runDeferred(GLFWwindow* window) {
+	std::string lightingSource = std::string("#version 450 core\n") + ew::clusteredLightingGlsl();
+	std::string gBufferSource = std::string("#version 450 core\n") + ew::deferredGBufferGlsl();
+	//One light, Phong, evaluated for every rasterized fragment
+	ew::ShaderDefines phongDefines;
+	std::string phongVertexSource = ew::preprocessShader(ASSIGNMENT5_ASSET_DIR "assignment5.vert", phongDefines);
+	std::string phongFragmentSource = ew::preprocessShader(ASSIGNMENT5_ASSET_DIR "assignment5.frag", phongDefines);
+	unsigned int phongProgram = ew::createShaderProgram(phongVertexSource.c_str(), phongFragmentSource.c_str());
+	unsigned int clusteredProgram = ew::createShaderProgram(bench::sceneVertexSource, (lightingSource + clusteredFragmentMain).c_str());
+	unsigned int gBufferProgram = ew::createShaderProgram(bench::sceneVertexSource, (gBufferSource + gBufferFragmentMain).c_str());
+
+	//Overlapping rows of spheres in front of a floor so forward shading pays for overdraw
+	bench::MeshBuffers plane = bench::createMeshBuffers(ew::createPlane(60.0f, 60.0f, 32));
+	bench::MeshBuffers sphere = bench::createMeshBuffers(ew::createSphere(1.5f, 24));
+	std::vector<bench::SceneObject> objects;
+	objects.push_back({ &plane, glm::mat4(1.0f) });
+	for (int i = 0; i < 144; i++)
+		objects.push_back({ &sphere, glm::translate(glm::mat4(1.0f), glm::vec3((i % 12) * 2.5f - 14.0f, 1.5f, 14.0f - (i / 12) * 2.5f)) });
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<ew::PointLight> lights(1024);
+	for (ew::PointLight& light : lights) {
+		light.positionRadius = glm::vec4(unit(rng) * 60.0f - 30.0f, 0.5f + unit(rng) * 3.0f, unit(rng) * 60.0f - 30.0f, 3.0f + unit(rng) * 2.0f);
+		light.colorIntensity = glm::vec4(unit(rng), unit(rng), unit(rng), 4.0f);
+	}
+
+	glm::vec3 cameraPos(0.0f, 6.0f, 26.0f);
+	glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, NEAR_PLANE, FAR_PLANE);
+	for (unsigned int program : { phongProgram, clusteredProgram, gBufferProgram }) {
+		glUseProgram(program);
+		glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, &view[0][0]);
+		glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &projection[0][0]);
+		glUniform3fv(glGetUniformLocation(program, "cameraPos"), 1, &cameraPos[0]);
+	}
+	glUseProgram(phongProgram);
+	glUniform3f(glGetUniformLocation(phongProgram, "lightPos"), 0.0f, 8.0f, 10.0f);
+	glUniform3f(glGetUniformLocation(phongProgram, "lightColor"), 1.0f, 1.0f, 1.0f);
+	glUniform3f(glGetUniformLocation(phongProgram, "objectColor"), 0.8f, 0.8f, 0.8f);
+	glUniform3fv(glGetUniformLocation(phongProgram, "viewPos"), 1, &cameraPos[0]);
+
+	ew::ClusteredLighting clustered;
+	ew::DeferredRenderer deferred(bench::SCREEN_WIDTH, bench::SCREEN_HEIGHT);
+	const glm::vec3 ambient(0.02f);
+
+	//Every G-buffer pixel is cleared, written at least once and read once by the lighting pass
+	double gBufferMB = (double)bench::SCREEN_WIDTH * bench::SCREEN_HEIGHT * ew::DeferredRenderer::getBytesPerPixel() * 3.0 / (1024.0 * 1024.0);
+	printf("  G-buffer %d bytes/pixel, >= %.1f MB traffic per frame (clear + write + read)\n", ew::DeferredRenderer::getBytesPerPixel(), gBufferMB);
+
+	for (unsigned int lightCount : LIGHT_COUNTS) {
+		clustered.setLights(lights.data(), lightCount);
+		printf("  %u lights\n", lightCount);
+		for (ShadingPath path : { ShadingPath::ForwardPhong, ShadingPath::ClusteredForward, ShadingPath::Deferred }) {
+			//The assignment shader only has one light, so it is a fixed cost reference
+			if (path == ShadingPath::ForwardPhong && lightCount != 1)
+				continue;
+			ew::GpuTimer buildTimer, geometryTimer, lightingTimer;
+			ew::CpuTimer cpuTimer;
+			double cpuTotal = 0.0, buildTotal = 0.0, geometryTotal = 0.0, lightingTotal = 0.0;
+			for (int frame = 0; frame < FRAMES; frame++) {
+				glEnable(GL_DEPTH_TEST);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				cpuTimer.start();
+				if (path != ShadingPath::ForwardPhong) {
+					buildTimer.begin();
+					clustered.build(view, projection, NEAR_PLANE, FAR_PLANE, bench::SCREEN_WIDTH, bench::SCREEN_HEIGHT);
+					buildTimer.end();
+				}
+				geometryTimer.begin();
+				if (path == ShadingPath::Deferred) {
+					deferred.beginGeometryPass();
+					glUseProgram(gBufferProgram);
+					bench::drawScene(gBufferProgram, objects);
+					deferred.endGeometryPass();
+				}
+				else {
+					unsigned int program = path == ShadingPath::ForwardPhong ? phongProgram : clusteredProgram;
+					glUseProgram(program);
+					bench::drawScene(program, objects);
+				}
+				geometryTimer.end();
+				if (path == ShadingPath::Deferred) {
+					lightingTimer.begin();
+					deferred.lightingPass(clustered, view, projection, cameraPos, ambient);
+					lightingTimer.end();
+				}
+				cpuTotal += cpuTimer.stop();
+				if (path != ShadingPath::ForwardPhong)
+					buildTotal += buildTimer.resolve();
+				geometryTotal += geometryTimer.resolve();
+				if (path == ShadingPath::Deferred)
+					lightingTotal += lightingTimer.resolve();
+				glfwSwapBuffers(window);
+			}
+			double gpuTotal = (buildTotal + geometryTotal + lightingTotal) / FRAMES;
+			switch (path) {
+			case ShadingPath::ForwardPhong:
+				bench::report("forward phong (assignment 5, 1 light)", cpuTotal / FRAMES, gpuTotal);
+				break;
+			case ShadingPath::ClusteredForward:
+				bench::report("clustered forward", cpuTotal / FRAMES, gpuTotal);
+				printf("    build %.3f ms, shade %.3f ms\n", buildTotal / FRAMES, geometryTotal / FRAMES);
+				break;
+			case ShadingPath::Deferred:
+				bench::report("deferred (G-buffer + clustered lighting)", cpuTotal / FRAMES, gpuTotal);
+				printf("    build %.3f ms, geometry %.3f ms, lighting %.3f ms\n",
+					buildTotal / FRAMES, geometryTotal / FRAMES, lightingTotal / FRAMES);
+				break;
+			}
+		}
+	}
+
+	bench::deleteMeshBuffers(plane);
+	bench::deleteMeshBuffers(sphere);
+	glDeleteProgram(phongProgram);
+	glDeleteProgram(clusteredProgram);
+	glDeleteProgram(gBufferProgram);
+}
+
+void benchDeferred() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runDeferred(window);
+	bench::destroyContext(window);
+}
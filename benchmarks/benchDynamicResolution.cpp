@@ -0,0 +1,131 @@
+#include "benchCommon.h"
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/clusteredLighting.h>
+#include <ew/dynamicResolution.h>
+#include <ew/normalMatrix.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+static const char* fragmentMain = R"(
+    in vec3 WorldPos;
+    in vec3 Normal;
+    in float ViewDepth;
+    uniform vec3 cameraPos;
+    out vec4 FragColor;
+
+    void main() {
+        vec3 normal = normalize(Normal);
+        vec3 viewDir = normalize(cameraPos - WorldPos);
+        vec3 color = shadeClusteredLights(WorldPos, normal, viewDir, ViewDepth, vec3(0.8));
+        FragColor = vec4(color + vec3(0.02), 1.0);
+    }
+)";
+
+static const int WARMUP_FRAMES = 10;
+static const int ADAPT_FRAMES = 60;
+static const float NEAR_PLANE = 0.1f;
+static const float FAR_PLANE = 100.0f;
+
+static void runDynamicResolution(GLFWwindow* window) {
+	std::string lightingSource = std::string("#version 450 core\n") + ew::clusteredLightingGlsl();
+	unsigned int program = ew::createShaderProgram(bench::sceneVertexSource, (lightingSource + fragmentMain).c_str());
+
+	bench::MeshBuffers plane = bench::createMeshBuffers(ew::createPlane(60.0f, 60.0f, 32));
+	bench::MeshBuffers sphere = bench::createMeshBuffers(ew::createSphere(1.0f, 24));
+	std::vector<glm::mat4> sphereModels;
+	for (int i = 0; i < 64; i++)
+		sphereModels.push_back(glm::translate(glm::mat4(1.0f), glm::vec3((i % 8) * 6.0f - 21.0f, 1.0f, (i / 8) * 6.0f - 21.0f)));
+
+	//Many overlapping lights make the scene fill-rate bound, which is what resolution scaling helps
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<ew::PointLight> lights(1024);
+	for (ew::PointLight& light : lights) {
+		light.positionRadius = glm::vec4(unit(rng) * 60.0f - 30.0f, 0.5f + unit(rng) * 3.0f, unit(rng) * 60.0f - 30.0f, 6.0f + unit(rng) * 4.0f);
+		light.colorIntensity = glm::vec4(unit(rng), unit(rng), unit(rng), 2.0f);
+	}
+	ew::ClusteredLighting clustered;
+	clustered.setLights(lights.data(), (unsigned int)lights.size());
+
+	glm::vec3 cameraPos(0.0f, 12.0f, 28.0f);
+	glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, NEAR_PLANE, FAR_PLANE);
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, &view[0][0]);
+	glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &projection[0][0]);
+	glUniform3fv(glGetUniformLocation(program, "cameraPos"), 1, &cameraPos[0]);
+	int modelLocation = glGetUniformLocation(program, "model");
+	int normalMatrixLocation = glGetUniformLocation(program, "normalMatrix");
+	glEnable(GL_DEPTH_TEST);
+
+	ew::DynamicResolution resolution(bench::SCREEN_WIDTH, bench::SCREEN_HEIGHT);
+	//The controller's own timer covers the whole frame; a second query around it would nest
+	auto renderFrame = [&]() {
+		resolution.beginFrame();
+		//Clusters are laid out over the scaled viewport, not the window
+		clustered.build(view, projection, NEAR_PLANE, FAR_PLANE, resolution.getRenderWidth(), resolution.getRenderHeight());
+		glUseProgram(program);
+		glm::mat4 planeModel(1.0f);
+		glm::mat3 identity(1.0f);
+		glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &planeModel[0][0]);
+		glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, &identity[0][0]);
+		bench::drawMesh(plane);
+		for (const glm::mat4& model : sphereModels) {
+			glm::mat3 normalMatrix = ew::computeNormalMatrix(model);
+			glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &model[0][0]);
+			glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, &normalMatrix[0][0]);
+			bench::drawMesh(sphere);
+		}
+		resolution.endFrame(0);
+		glfwSwapBuffers(window);
+	};
+
+	//Reference: fixed native resolution
+	resolution.overrideScale(1.0f);
+	double nativeTotal = 0.0;
+	for (int frame = 0; frame < WARMUP_FRAMES; frame++) {
+		renderFrame();
+		nativeTotal += resolution.resolveFrameMs();
+	}
+	double nativeMs = nativeTotal / WARMUP_FRAMES;
+	bench::report("native 1080x720", 0.0, nativeMs);
+
+	//Ask for half the native cost and let the controller find the scale
+	resolution.getSettings().targetFrameMs = (float)(nativeMs * 0.5);
+	resolution.getSettings().minScale = 0.25f;
+	resolution.overrideScale(-1.0f);
+	printf("  target %.3f ms\n", nativeMs * 0.5);
+	double settledTotal = 0.0;
+	int settledFrames = 0;
+	for (int frame = 0; frame < ADAPT_FRAMES; frame++) {
+		renderFrame();
+		double ms = resolution.resolveFrameMs();
+		if (frame % 10 == 9)
+			printf("    frame %2d: scale %.3f (%dx%d), %.3f ms\n", frame + 1, resolution.getScale(), resolution.getRenderWidth(), resolution.getRenderHeight(), ms);
+		if (frame >= ADAPT_FRAMES - 20) {
+			settledTotal += ms;
+			settledFrames++;
+		}
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "dynamic %dx%d", resolution.getRenderWidth(), resolution.getRenderHeight());
+	bench::report(name, 0.0, settledTotal / settledFrames);
+
+	bench::deleteMeshBuffers(plane);
+	bench::deleteMeshBuffers(sphere);
+	glDeleteProgram(program);
+}
+
+void benchDynamicResolution() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runDynamicResolution(window);
+	bench::destroyContext(window);
+}
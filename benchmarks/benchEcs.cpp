@@ -0,0 +1,170 @@
+#include "benchCommon.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/ecs.h>
+#include <ew/ewMath/ewMath.h>
+#include <ew/frustum.h>
+#include <ew/jobSystem.h>
+#include <ew/megaBuffer.h>
+#include <ew/profiler.h>
+
+static const int ENTITY_COUNT = 1000000;
+static const int MESH_COUNT = 8;
+static const int FRAMES = 10;
+static const float DT = 1.0f / 60.0f;
+
+struct Transform {
+	glm::vec3 position;
+	float scale;
+};
+struct Velocity {
+	glm::vec3 value;
+};
+struct WorldMatrix {
+	glm::mat4 value;
+};
+struct Bounds {
+	float radius;
+};
+struct Visible {
+	uint32_t value;
+};
+struct Renderable {
+	uint32_t meshId;
+	glm::vec4 color;
+};
+struct Lifetime {
+	float remaining;
+};
+
+//Object-per-entity baseline: the same data behind individually allocated objects
+struct GameObject {
+	Transform transform;
+	Velocity velocity;
+	WorldMatrix world;
+	Bounds bounds;
+	Visible visible;
+	Renderable renderable;
+	Lifetime lifetime;
+	virtual ~GameObject() {}
+	virtual void update(float dt) {
+		transform.position += velocity.value * dt;
+		lifetime.remaining -= dt;
+	}
+};
+
+static Transform randomTransform() {
+	return { glm::vec3(ew::RandomRange(-500, 500), ew::RandomRange(-50, 50), ew::RandomRange(-500, 500)), ew::RandomRange(0.5f, 2.0f) };
+}
+
+static void buildWorldMatrix(const Transform& t, WorldMatrix& w) {
+	w.value = glm::mat4(t.scale);
+	w.value[3] = glm::vec4(t.position, 1.0f);
+}
+
+static bool isVisible(const ew::Frustum& frustum, const WorldMatrix& w, const Bounds& b) {
+	return ew::sphereInFrustum(frustum, glm::vec3(w.value[3]), b.radius * w.value[0][0]);
+}
+
+void benchEcs() {
+	glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, 0.1f, 1000.0f)
+		* glm::lookAt(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	ew::Frustum frustum = ew::extractFrustum(viewProjection);
+	std::vector<std::vector<ew::DrawData>> renderLists(MESH_COUNT);
+
+	//Baseline: objects allocated one by one and visited in shuffled order, as a scene
+	//built over time ends up
+	{
+		std::vector<std::unique_ptr<GameObject>> objects;
+		for (int i = 0; i < ENTITY_COUNT; i++) {
+			std::unique_ptr<GameObject> object(new GameObject());
+			object->transform = randomTransform();
+			object->velocity.value = glm::vec3(ew::RandomRange(-1, 1), 0.0f, ew::RandomRange(-1, 1));
+			object->bounds.radius = 0.5f;
+			object->renderable = { (uint32_t)(i % MESH_COUNT), glm::vec4(1.0f) };
+			object->lifetime.remaining = ew::RandomRange(1.0f, 10.0f);
+			objects.push_back(std::move(object));
+		}
+		std::shuffle(objects.begin(), objects.end(), std::mt19937(1234));
+		ew::CpuTimer timer;
+		double total = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			timer.start();
+			for (std::vector<ew::DrawData>& list : renderLists)
+				list.clear();
+			for (std::unique_ptr<GameObject>& object : objects) {
+				object->update(DT);
+				if (object->lifetime.remaining <= 0.0f) {
+					object->transform = randomTransform();
+					object->lifetime.remaining = 10.0f;
+				}
+				buildWorldMatrix(object->transform, object->world);
+				object->visible.value = isVisible(frustum, object->world, object->bounds);
+				if (object->visible.value)
+					renderLists[object->renderable.meshId].push_back({ object->world.value, object->renderable.color });
+			}
+			total += timer.stop();
+		}
+		bench::report("object per entity (baseline)", total / FRAMES);
+	}
+
+	ew::World world;
+	for (int i = 0; i < ENTITY_COUNT; i++) {
+		world.create(randomTransform(), Velocity{ glm::vec3(ew::RandomRange(-1, 1), 0.0f, ew::RandomRange(-1, 1)) },
+			WorldMatrix{ glm::mat4(1.0f) }, Bounds{ 0.5f }, Visible{ 0 },
+			Renderable{ (uint32_t)(i % MESH_COUNT), glm::vec4(1.0f) }, Lifetime{ ew::RandomRange(1.0f, 10.0f) });
+	}
+	ew::JobSystem jobs;
+	printf("  %zu entities in %zu archetypes, %u workers\n", world.entityCount(), world.archetypeCount(), jobs.getWorkerCount());
+
+	ew::Scheduler scheduler;
+	scheduler.add({ "movement", ew::signatureOf<Velocity>(), ew::signatureOf<Transform>(), [&](ew::World& w) {
+		w.parallelEach<Transform, Velocity>(jobs, [](Transform& t, Velocity& v) { t.position += v.value * DT; });
+	} });
+	//Disjoint from movement, so it shares its phase. Expired entities respawn through
+	//deferred commands applied after the phase.
+	scheduler.add({ "lifetime", ew::Signature(), ew::signatureOf<Lifetime>(), [&](ew::World& w) {
+		w.eachChunk<Lifetime>([&](size_t count, const ew::Entity* entities, Lifetime* lifetimes) {
+			for (size_t i = 0; i < count; i++) {
+				lifetimes[i].remaining -= DT;
+				if (lifetimes[i].remaining > 0.0f)
+					continue;
+				w.commands().destroy(entities[i]);
+				w.commands().create(randomTransform(), Velocity{ glm::vec3(0.0f) }, WorldMatrix{ glm::mat4(1.0f) }, Bounds{ 0.5f },
+					Visible{ 0 }, Renderable{ (uint32_t)(i % MESH_COUNT), glm::vec4(1.0f) }, Lifetime{ 10.0f });
+			}
+		});
+	} });
+	scheduler.add({ "transform", ew::signatureOf<Transform>(), ew::signatureOf<WorldMatrix>(), [&](ew::World& w) {
+		w.parallelEach<Transform, WorldMatrix>(jobs, [](Transform& t, WorldMatrix& m) { buildWorldMatrix(t, m); });
+	} });
+	scheduler.add({ "culling", ew::signatureOf<WorldMatrix, Bounds>(), ew::signatureOf<Visible>(), [&](ew::World& w) {
+		w.parallelEach<WorldMatrix, Bounds, Visible>(jobs, [&](WorldMatrix& m, Bounds& b, Visible& v) { v.value = isVisible(frustum, m, b); });
+	} });
+	scheduler.add({ "render list", ew::signatureOf<WorldMatrix, Visible, Renderable>(), ew::Signature(), [&](ew::World& w) {
+		for (std::vector<ew::DrawData>& list : renderLists)
+			list.clear();
+		w.eachChunk<WorldMatrix, Visible, Renderable>([&](size_t count, const ew::Entity*, WorldMatrix* m, Visible* v, Renderable* r) {
+			for (size_t i = 0; i < count; i++) {
+				if (v[i].value)
+					renderLists[r[i].meshId].push_back({ m[i].value, r[i].color });
+			}
+		});
+	} });
+	printf("  %zu systems scheduled into %zu phases\n", (size_t)5, scheduler.getPhaseCount());
+
+	ew::CpuTimer timer;
+	double total = 0.0;
+	for (int frame = 0; frame < FRAMES; frame++) {
+		timer.start();
+		scheduler.run(world, &jobs);
+		total += timer.stop();
+	}
+	bench::report("archetype ECS", total / FRAMES);
+	printf("  %zu entities alive after respawns\n", world.entityCount());
+}
@@ -0,0 +1,128 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <ew/frameCapture.h>
+#include <ew/jobSystem.h>
+#include <ew/pngEncoder.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+//Enough fragment work per frame that a blocking readback has something to wait for
+static const char* vertexSource = R"(
+    #version 450 core
+    void main() {
+        vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+static const char* fragmentSource = R"(
+    #version 450 core
+    uniform float uTime;
+    out vec4 FragColor;
+    void main() {
+        vec2 p = gl_FragCoord.xy / 256.0;
+        float v = 0.0;
+        for (int i = 1; i <= 32; i++)
+            v += sin(p.x * float(i) + uTime) * cos(p.y * float(i) - uTime) / float(i);
+        FragColor = vec4(0.5 + 0.5 * v, p.x * 0.1, p.y * 0.1, 1.0);
+    }
+)";
+
+static const int FRAMES = 60;
+static const char* OUTPUT_DIR = "captureBench";
+
+static void runFrameCapture(GLFWwindow* window) {
+	const int width = bench::SCREEN_WIDTH, height = bench::SCREEN_HEIGHT;
+	unsigned int program = ew::createShaderProgram(vertexSource, fragmentSource);
+	int timeLocation = glGetUniformLocation(program, "uTime");
+	unsigned int vao, colorTexture, framebuffer;
+	glGenVertexArrays(1, &vao);
+	glGenTextures(1, &colorTexture);
+	glBindTexture(GL_TEXTURE_2D, colorTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+	glViewport(0, 0, width, height);
+
+	ew::JobSystem jobs;
+	printf("  %d frames at %dx%d, %u encode workers\n", FRAMES, width, height, jobs.getWorkerCount());
+	//FrameCapture runs first because it creates the output directory
+	const char* names[] = {
+		"FrameCapture PNG",
+		"FrameCapture raw",
+		"glReadPixels + PNG on render thread",
+		"glReadPixels + raw on render thread",
+	};
+	for (int mode = 0; mode < 4; mode++) {
+		ew::CaptureFormat format = mode % 2 == 0 ? ew::CaptureFormat::PNG : ew::CaptureFormat::Raw;
+		ew::FrameCapture capture(jobs);
+		if (mode < 2)
+			capture.startRecording(OUTPUT_DIR, format);
+		std::vector<unsigned char> pixels((size_t)width * height * 4);
+		ew::CpuTimer frameTimer, totalTimer;
+		double worstFrame = 0.0;
+		totalTimer.start();
+		for (int frame = 0; frame < FRAMES; frame++) {
+			frameTimer.start();
+			glUseProgram(program);
+			glUniform1f(timeLocation, frame * 0.05f);
+			glBindVertexArray(vao);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			if (mode >= 2) {
+				//Waits for the frame to finish, then encodes before the next one can start
+				glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+				std::string path = std::string(OUTPUT_DIR) + "/sync_" + std::to_string(frame) + (mode == 2 ? ".png" : ".pam");
+				if (mode == 2) {
+					ew::writePNG(path, pixels.data(), width, height, 4);
+				}
+				else {
+					FILE* file = fopen(path.c_str(), "wb");
+					if (file) {
+						fprintf(file, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", width, height);
+						fwrite(pixels.data(), 1, pixels.size(), file);
+						fclose(file);
+					}
+				}
+			}
+			else {
+				capture.endFrame(width, height, framebuffer);
+			}
+			glfwSwapBuffers(window);
+			double frameMs = frameTimer.stop();
+			if (frameMs > worstFrame)
+				worstFrame = frameMs;
+		}
+		double loopMs = totalTimer.stop();
+		capture.flush();
+		double totalMs = totalTimer.stop();
+
+		char label[96];
+		snprintf(label, sizeof(label), "%s (per frame)", names[mode]);
+		bench::report(label, loopMs / FRAMES);
+		if (mode < 2) {
+			const ew::FrameCaptureStats& stats = capture.getStats();
+			printf("    worst frame %.2f ms, %.1f ms until every file was written, stalls %zu readback / %zu write, %.1f MB\n",
+				worstFrame, totalMs, stats.readbackStalls, stats.writeStalls, stats.bytesWritten / (1024.0 * 1024.0));
+		}
+		else {
+			printf("    worst frame %.2f ms\n", worstFrame);
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteTextures(1, &colorTexture);
+	glDeleteVertexArrays(1, &vao);
+	glDeleteProgram(program);
+}
+
+void benchFrameCapture() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runFrameCapture(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,107 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/ewMath/ewMath.h>
+#include <ew/frustum.h>
+#include <ew/gpuCuller.h>
+#include <ew/megaBuffer.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+static const int MESH_COUNT = 8;
+static const int INSTANCE_COUNT = 200000;
+static const int FRAMES = 100;
+
+static void runGpuCulling(GLFWwindow* window) {
+	unsigned int program = ew::createShaderProgram(bench::megaBufferVertexSource, bench::megaBufferFragmentSource);
+	ew::MegaBuffer megaBuffer(INSTANCE_COUNT);
+	for (int i = 0; i < MESH_COUNT; i++) {
+		if (i % 2 == 0)
+			megaBuffer.addMesh(ew::createCube(1.0f));
+		else
+			megaBuffer.addMesh(ew::createSphere(0.5f, 6 + i));
+	}
+	megaBuffer.build();
+
+	//Instances scattered in a shell around the camera so roughly a sixth are in view
+	std::vector<ew::CullInstance> instances(INSTANCE_COUNT);
+	for (int i = 0; i < INSTANCE_COUNT; i++) {
+		glm::vec3 dir = glm::normalize(glm::vec3(ew::RandomRange(-1, 1), ew::RandomRange(-1, 1), ew::RandomRange(-1, 1)) + glm::vec3(0.001f));
+		instances[i].model = glm::translate(glm::mat4(1.0f), dir * ew::RandomRange(10.0f, 150.0f));
+		instances[i].color = glm::vec4(ew::RandomRange(0, 1), ew::RandomRange(0, 1), ew::RandomRange(0, 1), 1.0f);
+		instances[i].meshId = i % MESH_COUNT;
+	}
+	ew::GpuCuller culler(megaBuffer);
+	culler.setInstances(instances);
+
+	//CPU path keeps its instances grouped per mesh like a typical scene would
+	std::vector<std::vector<ew::DrawData>> visibleByMesh(MESH_COUNT);
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, 0.1f, 200.0f);
+	glEnable(GL_DEPTH_TEST);
+	glUseProgram(program);
+	int viewProjectionLoc = glGetUniformLocation(program, "viewProjection");
+
+	printf("  %d instances, %d meshes\n", INSTANCE_COUNT, MESH_COUNT);
+	for (int mode = 0; mode < 2; mode++) {
+		ew::GpuTimer gpuTimer;
+		ew::CpuTimer cpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		unsigned int visibleTotal = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			float angle = frame * 0.05f;
+			glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(cosf(angle), 0.0f, sinf(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+			glm::mat4 viewProjection = projection * view;
+
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			gpuTimer.begin();
+			cpuTimer.start();
+			if (mode == 0) {
+				ew::Frustum frustum = ew::extractFrustum(viewProjection);
+				for (std::vector<ew::DrawData>& list : visibleByMesh)
+					list.clear();
+				for (const ew::CullInstance& instance : instances) {
+					glm::vec4 bounds = megaBuffer.getMesh(instance.meshId).boundingSphere;
+					glm::vec3 center = glm::vec3(instance.model * glm::vec4(glm::vec3(bounds), 1.0f));
+					if (ew::sphereInFrustum(frustum, center, bounds.w))
+						visibleByMesh[instance.meshId].push_back({ instance.model, instance.color });
+				}
+				megaBuffer.begin();
+				for (int m = 0; m < MESH_COUNT; m++) {
+					megaBuffer.submit(m, visibleByMesh[m].data(), (unsigned int)visibleByMesh[m].size());
+					visibleTotal += (unsigned int)visibleByMesh[m].size();
+				}
+				glUseProgram(program);
+				glUniformMatrix4fv(viewProjectionLoc, 1, GL_FALSE, &viewProjection[0][0]);
+				megaBuffer.flush();
+			}
+			else {
+				culler.cull(viewProjection);
+				glUseProgram(program);
+				glUniformMatrix4fv(viewProjectionLoc, 1, GL_FALSE, &viewProjection[0][0]);
+				culler.draw();
+			}
+			cpuTotal += cpuTimer.stop();
+			gpuTimer.end();
+			gpuTotal += gpuTimer.resolve();
+			if (mode == 1)
+				visibleTotal += culler.readVisibleCount();
+			glfwSwapBuffers(window);
+		}
+		printf("  average visible: %u\n", visibleTotal / FRAMES);
+		bench::report(mode == 0 ? "CPU cull + MDI" : "GPU compute cull + MDI", cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+
+	glDeleteProgram(program);
+}
+
+void benchGpuCulling() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runGpuCulling(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,96 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/lod.h>
+#include <ew/megaBuffer.h>
+#include <ew/meshSimplify.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+static const int GRID = 32;
+static const int FRAMES = 100;
+static const float FOV = 45.0f;
+
+static void runLod(GLFWwindow* window) {
+	ew::MeshData source = ew::createSphere(0.5f, 192);
+	ew::CpuTimer buildTimer;
+	buildTimer.start();
+	ew::LodChain chain = ew::generateLodChain(source, 6);
+	double buildMs = buildTimer.stop();
+
+	size_t sourceTriangles = source.indices.size() / 3;
+	printf("  LOD chain built in %.1f ms\n", buildMs);
+	for (size_t i = 0; i < chain.levels.size(); i++) {
+		size_t triangles = chain.levels[i].indices.size() / 3;
+		printf("  LOD%zu %8zu tris (%5.1f%%)  error %.5f\n", i, triangles, 100.0 * triangles / sourceTriangles, chain.errors[i]);
+	}
+
+	unsigned int program = ew::createShaderProgram(bench::megaBufferVertexSource, bench::megaBufferFragmentSource);
+	ew::MegaBuffer megaBuffer(GRID * GRID);
+	for (const ew::MeshData& level : chain.levels)
+		megaBuffer.addMesh(level);
+	megaBuffer.build();
+
+	//Rows recede from the camera so every LOD is in use
+	std::vector<glm::vec3> positions;
+	for (int z = 0; z < GRID; z++) {
+		for (int x = 0; x < GRID; x++)
+			positions.push_back(glm::vec3((x - GRID / 2) * (1.0f + z * 0.5f), -1.0f, -2.0f - z * z * 0.4f));
+	}
+	std::vector<int> currentLod(positions.size(), 0);
+	std::vector<std::vector<ew::DrawData>> byLevel(chain.levels.size());
+
+	glm::mat4 projection = glm::perspective(glm::radians(FOV), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, 0.1f, 1000.0f);
+	glm::vec3 cameraPos(0.0f);
+	glm::mat4 viewProjection = projection * glm::lookAt(cameraPos, glm::vec3(0.0f, -0.2f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glEnable(GL_DEPTH_TEST);
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, &viewProjection[0][0]);
+
+	for (int mode = 0; mode < 2; mode++) {
+		ew::GpuTimer gpuTimer;
+		ew::CpuTimer cpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		size_t trianglesDrawn = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			gpuTimer.begin();
+			cpuTimer.start();
+			for (std::vector<ew::DrawData>& list : byLevel)
+				list.clear();
+			for (size_t i = 0; i < positions.size(); i++) {
+				if (mode == 1) {
+					float distance = glm::length(positions[i] - cameraPos);
+					currentLod[i] = ew::selectLod(chain.errors, currentLod[i], distance, FOV, (float)bench::SCREEN_HEIGHT);
+				}
+				byLevel[currentLod[i]].push_back({ glm::translate(glm::mat4(1.0f), positions[i]), glm::vec4(1.0f, 0.5f, 0.31f, 1.0f) });
+			}
+			megaBuffer.begin();
+			trianglesDrawn = 0;
+			for (size_t level = 0; level < byLevel.size(); level++) {
+				megaBuffer.submit((unsigned int)level, byLevel[level].data(), (unsigned int)byLevel[level].size());
+				trianglesDrawn += byLevel[level].size() * chain.levels[level].indices.size() / 3;
+			}
+			megaBuffer.flush();
+			cpuTotal += cpuTimer.stop();
+			gpuTimer.end();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		printf("  %s: %zu triangles per frame\n", mode == 0 ? "LOD0 only" : "LOD selection", trianglesDrawn);
+		bench::report(mode == 0 ? "full detail" : "screen space error LOD", cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+
+	glDeleteProgram(program);
+}
+
+void benchLod() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runLod(window);
+	bench::destroyContext(window);
+}
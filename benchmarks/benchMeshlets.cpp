@@ -0,0 +1,101 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/megaBuffer.h>
+#include <ew/meshlet.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+static const int OBJECTS = 16;
+static const int FRAMES = 100;
+
+static void runMeshlets(GLFWwindow* window) {
+	ew::MeshData mesh = ew::createSphere(2.0f, 256);
+	ew::CpuTimer buildTimer;
+	buildTimer.start();
+	std::vector<ew::Meshlet> meshlets = ew::buildMeshlets(mesh);
+	printf("  %zu meshlets from %zu triangles in %.1f ms\n", meshlets.size(), mesh.indices.size() / 3, buildTimer.stop());
+
+	unsigned int program = ew::createShaderProgram(bench::megaBufferVertexSource, bench::megaBufferFragmentSource);
+	ew::MegaBuffer megaBuffer(OBJECTS);
+	unsigned int meshId = megaBuffer.addMesh(mesh);
+	megaBuffer.build();
+
+	//A row of large spheres the camera flies along, so many clusters are off-screen or facing away
+	std::vector<ew::DrawData> objects(OBJECTS);
+	for (int i = 0; i < OBJECTS; i++) {
+		objects[i].model = glm::translate(glm::mat4(1.0f), glm::vec3((i % 4) * 5.0f - 7.5f, 0.0f, -(i / 4) * 5.0f));
+		objects[i].color = glm::vec4(1.0f, 0.5f, 0.31f, 1.0f);
+	}
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, 0.1f, 100.0f);
+	glEnable(GL_DEPTH_TEST);
+	glUseProgram(program);
+	int viewProjectionLoc = glGetUniformLocation(program, "viewProjection");
+	std::vector<unsigned int> visible;
+
+	for (int mode = 0; mode < 2; mode++) {
+		ew::GpuTimer gpuTimer;
+		ew::CpuTimer cpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		size_t clustersDrawn = 0, trianglesDrawn = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glm::vec3 cameraPos(sinf(frame * 0.05f) * 6.0f, 1.0f, 4.0f - frame * 0.1f);
+			glm::mat4 viewProjection = projection * glm::lookAt(cameraPos, cameraPos + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			gpuTimer.begin();
+			cpuTimer.start();
+			megaBuffer.begin();
+			for (const ew::DrawData& object : objects) {
+				if (mode == 0) {
+					megaBuffer.submit(meshId, &object, 1);
+					clustersDrawn += meshlets.size();
+					trianglesDrawn += mesh.indices.size() / 3;
+					continue;
+				}
+				visible.clear();
+				ew::cullMeshlets(meshlets, object.model, viewProjection, cameraPos, visible);
+				if (visible.empty())
+					continue;
+				unsigned int baseInstance = megaBuffer.pushInstances(&object, 1);
+				if (baseInstance == ew::MegaBuffer::NO_INSTANCES)
+					continue;
+				//Neighbouring meshlets are contiguous in the index buffer, so merge runs into one command
+				size_t run = 0;
+				for (size_t i = 1; i <= visible.size(); i++) {
+					if (i < visible.size() && visible[i] == visible[i - 1] + 1)
+						continue;
+					const ew::Meshlet& first = meshlets[visible[run]];
+					const ew::Meshlet& last = meshlets[visible[i - 1]];
+					unsigned int indexCount = last.firstIndex + last.triangleCount * 3 - first.firstIndex;
+					megaBuffer.submitRange(meshId, first.firstIndex, indexCount, baseInstance, 1);
+					trianglesDrawn += indexCount / 3;
+					run = i;
+				}
+				clustersDrawn += visible.size();
+			}
+			glUniformMatrix4fv(viewProjectionLoc, 1, GL_FALSE, &viewProjection[0][0]);
+			megaBuffer.flush();
+			cpuTotal += cpuTimer.stop();
+			gpuTimer.end();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		printf("  %s: %zu clusters, %zu triangles per frame\n", mode == 0 ? "whole objects" : "meshlet culling",
+			clustersDrawn / FRAMES, trianglesDrawn / FRAMES);
+		bench::report(mode == 0 ? "object draws" : "frustum + cone culled meshlets", cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+
+	glDeleteProgram(program);
+}
+
+void benchMeshlets() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runMeshlets(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,77 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/megaBuffer.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+//Distinct meshes x instances per mesh
+static const int MESH_COUNT = 512;
+static const int INSTANCES_PER_MESH = 4;
+static const int FRAMES = 200;
+
+static void runMultiDraw(GLFWwindow* window) {
+	unsigned int program = ew::createShaderProgram(bench::megaBufferVertexSource, bench::megaBufferFragmentSource);
+	ew::MegaBuffer megaBuffer(MESH_COUNT * INSTANCES_PER_MESH);
+	for (int i = 0; i < MESH_COUNT; i++) {
+		if (i % 2 == 0)
+			megaBuffer.addMesh(ew::createSphere(0.4f, 4 + i % 24));
+		else
+			megaBuffer.addMesh(ew::createCube(0.3f + (i % 7) * 0.05f));
+	}
+	megaBuffer.build();
+
+	//Lay every instance out on a grid in front of the camera
+	std::vector<ew::DrawData> instances(MESH_COUNT * INSTANCES_PER_MESH);
+	int side = 64;
+	for (size_t i = 0; i < instances.size(); i++) {
+		glm::vec3 pos((int)(i % side) - side / 2, (int)(i / side) % side - side / 2, -40.0f - (float)(i / (side * side)) * 2.0f);
+		instances[i].model = glm::translate(glm::mat4(1.0f), pos);
+		instances[i].color = glm::vec4((i % 3) / 2.0f, 0.5f, 1.0f - (i % 5) / 4.0f, 1.0f);
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, 0.1f, 200.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 viewProjection = projection * view;
+
+	glEnable(GL_DEPTH_TEST);
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, &viewProjection[0][0]);
+
+	printf("  %d meshes x %d instances\n", MESH_COUNT, INSTANCES_PER_MESH);
+	for (int mode = 0; mode < 2; mode++) {
+		ew::GpuTimer gpuTimer;
+		ew::CpuTimer cpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			gpuTimer.begin();
+			cpuTimer.start();
+			megaBuffer.begin();
+			for (int m = 0; m < MESH_COUNT; m++)
+				megaBuffer.submit(m, &instances[m * INSTANCES_PER_MESH], INSTANCES_PER_MESH);
+			if (mode == 0)
+				megaBuffer.flushPerMesh();
+			else
+				megaBuffer.flush();
+			cpuTotal += cpuTimer.stop();
+			gpuTimer.end();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		bench::report(mode == 0 ? "per-mesh draws" : "glMultiDrawElementsIndirect", cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+
+	glDeleteProgram(program);
+}
+
+void benchMultiDraw() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runMultiDraw(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,168 @@
+#include "benchCommon.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/normalMatrix.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+//Same lighting in both programs; only where the normal matrix comes from differs
+static const char* inverseVertexShaderSource = R"(
+    #version 450 core
+    layout(location = 0) in vec3 aPos;
+    layout(location = 1) in vec3 aNormal;
+
+    layout(std430, binding = 0) readonly buffer ModelBuffer {
+        mat4 models[];
+    };
+
+    uniform mat4 viewProjection;
+    out vec3 Normal;
+
+    void main() {
+        mat4 model = models[gl_InstanceID];
+        Normal = mat3(transpose(inverse(model))) * aNormal;
+        gl_Position = viewProjection * model * vec4(aPos, 1.0);
+    }
+)";
+
+static const char* precomputedVertexShaderSource = R"(
+    #version 450 core
+    layout(location = 0) in vec3 aPos;
+    layout(location = 1) in vec3 aNormal;
+
+    layout(std430, binding = 0) readonly buffer ModelBuffer {
+        mat4 models[];
+    };
+    layout(std430, binding = 1) readonly buffer NormalMatrixBuffer {
+        mat3 normalMatrices[];
+    };
+
+    uniform mat4 viewProjection;
+    out vec3 Normal;
+
+    void main() {
+        Normal = normalMatrices[gl_InstanceID] * aNormal;
+        gl_Position = viewProjection * models[gl_InstanceID] * vec4(aPos, 1.0);
+    }
+)";
+
+static const char* fragmentShaderSource = R"(
+    #version 450 core
+    in vec3 Normal;
+    out vec4 FragColor;
+
+    void main() {
+        float diff = max(dot(normalize(Normal), normalize(vec3(0.3, 1.0, 0.5))), 0.1);
+        FragColor = vec4(vec3(diff), 1.0);
+    }
+)";
+
+static const int SPHERE_SEGMENTS = 256;
+static const int INSTANCE_COUNT = 32;
+static const int FRAMES = 30;
+static const int CPU_MATRIX_COUNT = 100000;
+//Small render target so rasterization doesn't hide the vertex cost
+static const int VIEWPORT_SIZE = 64;
+
+static void runNormalMatrix(GLFWwindow* window) {
+	ew::MeshData sphere = ew::createSphere(1.0f, SPHERE_SEGMENTS);
+	unsigned int vao, vbo, ebo, modelBuffer, normalBuffer;
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sphere.vertices.size() * sizeof(ew::Vertex), sphere.vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphere.indices.size() * sizeof(unsigned int), sphere.indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ew::Vertex), (const void*)offsetof(ew::Vertex, pos));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ew::Vertex), (const void*)offsetof(ew::Vertex, normal));
+	glEnableVertexAttribArray(1);
+
+	//Rotated, non-uniformly scaled instances so the normal matrix is not just mat3(model)
+	std::vector<glm::mat4> models(INSTANCE_COUNT);
+	for (int i = 0; i < INSTANCE_COUNT; i++) {
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((i % 8) - 3.5f, (i / 8) - 1.5f, -12.0f));
+		model = glm::rotate(model, i * 0.7f, glm::normalize(glm::vec3(1.0f, (float)(i % 3), 0.5f)));
+		models[i] = glm::scale(model, glm::vec3(0.3f, 0.5f + (i % 4) * 0.1f, 0.4f));
+	}
+	std::vector<ew::NormalMatrix> normalMatrices(INSTANCE_COUNT);
+	glGenBuffers(1, &modelBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, modelBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, models.size() * sizeof(glm::mat4), models.data(), GL_DYNAMIC_DRAW);
+	glGenBuffers(1, &normalBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, normalBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, normalMatrices.size() * sizeof(ew::NormalMatrix), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, modelBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, normalBuffer);
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+	glEnable(GL_DEPTH_TEST);
+	glViewport(0, 0, VIEWPORT_SIZE, VIEWPORT_SIZE);
+
+	double vertices = (double)sphere.vertices.size() * INSTANCE_COUNT;
+	printf("  %zu vertices x %d instances, %dx%d viewport\n", sphere.vertices.size(), INSTANCE_COUNT, VIEWPORT_SIZE, VIEWPORT_SIZE);
+	const char* names[] = { "inverse() per vertex", "precomputed normal matrix" };
+	const char* sources[] = { inverseVertexShaderSource, precomputedVertexShaderSource };
+	for (int mode = 0; mode < 2; mode++) {
+		unsigned int program = ew::createShaderProgram(sources[mode], fragmentShaderSource);
+		glUseProgram(program);
+		glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, &projection[0][0]);
+		ew::GpuTimer gpuTimer;
+		ew::CpuTimer cpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			gpuTimer.begin();
+			cpuTimer.start();
+			if (mode == 1) {
+				//The per-frame cost moved to the CPU: one batch alongside the model matrices
+				ew::computeNormalMatrices(models.data(), normalMatrices.data(), models.size());
+				glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, normalMatrices.size() * sizeof(ew::NormalMatrix), normalMatrices.data());
+			}
+			glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)sphere.indices.size(), GL_UNSIGNED_INT, 0, INSTANCE_COUNT);
+			cpuTotal += cpuTimer.stop();
+			gpuTimer.end();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		double gpuMs = gpuTotal / FRAMES;
+		bench::report(names[mode], cpuTotal / FRAMES, gpuMs);
+		printf("  %.1f Mverts/s\n", vertices / (gpuMs * 1000.0));
+		glDeleteProgram(program);
+	}
+
+	//CPU side: SIMD batch against glm's general inverse
+	std::vector<glm::mat4> cpuModels(CPU_MATRIX_COUNT);
+	for (int i = 0; i < CPU_MATRIX_COUNT; i++)
+		cpuModels[i] = models[i % INSTANCE_COUNT];
+	std::vector<ew::NormalMatrix> cpuNormals(CPU_MATRIX_COUNT);
+	std::vector<glm::mat3> glmNormals(CPU_MATRIX_COUNT);
+	ew::CpuTimer cpuTimer;
+	cpuTimer.start();
+	for (int i = 0; i < CPU_MATRIX_COUNT; i++)
+		glmNormals[i] = glm::transpose(glm::inverse(glm::mat3(cpuModels[i])));
+	bench::report("100k glm transpose(inverse())", cpuTimer.stop());
+	cpuTimer.start();
+	ew::computeNormalMatrices(cpuModels.data(), cpuNormals.data(), cpuModels.size());
+	bench::report("100k computeNormalMatrices", cpuTimer.stop());
+
+	glDeleteBuffers(1, &modelBuffer);
+	glDeleteBuffers(1, &normalBuffer);
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ebo);
+	glDeleteVertexArrays(1, &vao);
+}
+
+void benchNormalMatrix() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runNormalMatrix(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,133 @@
+#include "benchCommon.h"
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/clusteredLighting.h>
+#include <ew/normalMatrix.h>
+#include <ew/postProcess.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+//Unclamped output so the HDR target holds highlights well above 1 for bloom to pick up
+static const char* fragmentMain = R"(
+    in vec3 WorldPos;
+    in vec3 Normal;
+    in float ViewDepth;
+    uniform vec3 cameraPos;
+    out vec4 FragColor;
+
+    void main() {
+        vec3 normal = normalize(Normal);
+        vec3 viewDir = normalize(cameraPos - WorldPos);
+        vec3 color = shadeClusteredLights(WorldPos, normal, viewDir, ViewDepth, vec3(0.8), 1.0);
+        FragColor = vec4(color + vec3(0.02), 1.0);
+    }
+)";
+
+static const int FRAMES = 20;
+static const float NEAR_PLANE = 0.1f;
+static const float FAR_PLANE = 100.0f;
+
+static void runPostProcess(GLFWwindow* window) {
+	std::string lightingSource = std::string("#version 450 core\n") + ew::clusteredLightingGlsl();
+	unsigned int program = ew::createShaderProgram(bench::sceneVertexSource, (lightingSource + fragmentMain).c_str());
+
+	bench::MeshBuffers plane = bench::createMeshBuffers(ew::createPlane(60.0f, 60.0f, 32));
+	bench::MeshBuffers sphere = bench::createMeshBuffers(ew::createSphere(1.0f, 24));
+	std::vector<glm::mat4> sphereModels;
+	for (int i = 0; i < 64; i++)
+		sphereModels.push_back(glm::translate(glm::mat4(1.0f), glm::vec3((i % 8) * 6.0f - 21.0f, 1.0f, (i / 8) * 6.0f - 21.0f)));
+
+	//Few, bright lights so highlights go well past the bloom threshold
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<ew::PointLight> lights(128);
+	for (ew::PointLight& light : lights) {
+		light.positionRadius = glm::vec4(unit(rng) * 60.0f - 30.0f, 0.5f + unit(rng) * 2.0f, unit(rng) * 60.0f - 30.0f, 4.0f + unit(rng) * 2.0f);
+		light.colorIntensity = glm::vec4(unit(rng), unit(rng), unit(rng), 20.0f);
+	}
+	ew::ClusteredLighting clustered;
+	clustered.setLights(lights.data(), (unsigned int)lights.size());
+
+	glm::vec3 cameraPos(0.0f, 12.0f, 28.0f);
+	glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, NEAR_PLANE, FAR_PLANE);
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, &view[0][0]);
+	glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &projection[0][0]);
+	glUniform3fv(glGetUniformLocation(program, "cameraPos"), 1, &cameraPos[0]);
+	int modelLocation = glGetUniformLocation(program, "model");
+	int normalMatrixLocation = glGetUniformLocation(program, "normalMatrix");
+	glEnable(GL_DEPTH_TEST);
+
+	ew::PostProcessStack post(bench::SCREEN_WIDTH, bench::SCREEN_HEIGHT);
+	printf("  bloom chain: %d levels starting at %dx%d\n", post.getBloomLevelCount(), bench::SCREEN_WIDTH / 2, bench::SCREEN_HEIGHT / 2);
+
+	struct Configuration {
+		const char* name;
+		bool bloom;
+		bool fxaa;
+	};
+	const Configuration configurations[] = {
+		{ "tonemap only", false, false },
+		{ "bloom + tonemap", true, false },
+		{ "bloom + tonemap + fxaa", true, true },
+	};
+	for (const Configuration& configuration : configurations) {
+		post.getSettings().bloom = configuration.bloom;
+		post.getSettings().fxaa = configuration.fxaa;
+		//The stack times each effect itself; GL_TIME_ELAPSED queries cannot nest
+		ew::GpuTimer sceneTimer;
+		double sceneTotal = 0.0, postTotal = 0.0;
+		ew::PostProcessTimings effectTotals;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			sceneTimer.begin();
+			post.beginScene();
+			clustered.build(view, projection, NEAR_PLANE, FAR_PLANE, bench::SCREEN_WIDTH, bench::SCREEN_HEIGHT);
+			glUseProgram(program);
+			glm::mat3 identity(1.0f);
+			glm::mat4 planeModel(1.0f);
+			glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &planeModel[0][0]);
+			glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, &identity[0][0]);
+			bench::drawMesh(plane);
+			for (const glm::mat4& model : sphereModels) {
+				glm::mat3 normalMatrix = ew::computeNormalMatrix(model);
+				glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &model[0][0]);
+				glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, &normalMatrix[0][0]);
+				bench::drawMesh(sphere);
+			}
+			post.endScene();
+			sceneTimer.end();
+
+			post.apply(0);
+			sceneTotal += sceneTimer.resolve();
+			post.resolveTimings();
+			ew::PostProcessTimings timings = post.getTimings();
+			effectTotals.bloomMs += timings.bloomMs;
+			effectTotals.tonemapMs += timings.tonemapMs;
+			effectTotals.fxaaMs += timings.fxaaMs;
+			postTotal += timings.bloomMs + timings.tonemapMs + timings.fxaaMs;
+			glfwSwapBuffers(window);
+		}
+		printf("  %s (scene %.3f ms)\n", configuration.name, sceneTotal / FRAMES);
+		bench::report("post-processing total", 0.0, postTotal / FRAMES);
+		printf("    bloom %.3f ms, tonemap %.3f ms, fxaa %.3f ms\n",
+			effectTotals.bloomMs / FRAMES, effectTotals.tonemapMs / FRAMES, effectTotals.fxaaMs / FRAMES);
+	}
+
+	bench::deleteMeshBuffers(plane);
+	bench::deleteMeshBuffers(sphere);
+	glDeleteProgram(program);
+}
+
+void benchPostProcess() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runPostProcess(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,193 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <ew/profiler.h>
+#include <ew/renderGraph.h>
+#include <ew/shader.h>
+
+static const char* vertexShaderSource = R"(
+    #version 450 core
+    out vec2 UV;
+    void main() {
+        UV = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(UV * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+//Stand-in for every pass: samples up to two inputs and writes up to two color targets
+static const char* fragmentShaderSource = R"(
+    #version 450 core
+    in vec2 UV;
+    layout(binding = 0) uniform sampler2D inputA;
+    layout(binding = 1) uniform sampler2D inputB;
+    uniform vec4 tint;
+    layout(location = 0) out vec4 Color0;
+    layout(location = 1) out vec4 Color1;
+    void main() {
+        vec4 color = texture(inputA, UV) + texture(inputB, UV) * 0.5 + tint;
+        Color0 = color;
+        Color1 = color.bgra;
+    }
+)";
+
+static const int FRAMES = 30;
+
+//Handles are filled in by setup and read by execute, so they must outlive buildFrame
+struct FrameTextures {
+	ew::RenderGraphTexture backbuffer, albedo, normal, depth, ao, hdr, bloomHalf, bloomQuarter, bloom, ldr, debugView;
+};
+
+//The frame of a deferred renderer with post-processing, rebuilt every frame as a real renderer would
+static void buildFrame(ew::RenderGraph& graph, FrameTextures& t, unsigned int program, unsigned int emptyVAO, int width, int height) {
+	ew::RenderTargetDesc albedoDesc = { width, height, GL_RGBA8 };
+	ew::RenderTargetDesc normalDesc = { width, height, GL_RG16 };
+	ew::RenderTargetDesc depthDesc = { width, height, GL_DEPTH_COMPONENT32F };
+	ew::RenderTargetDesc hdrDesc = { width, height, GL_RGBA16F };
+	ew::RenderTargetDesc ldrDesc = { width, height, GL_RGBA8 };
+	ew::RenderTargetDesc aoDesc = { width / 2, height / 2, GL_R8 };
+	int tintLocation = glGetUniformLocation(program, "tint");
+
+	//Every pass is a fullscreen triangle over its inputs
+	struct Fullscreen {
+		unsigned int program;
+		unsigned int vao;
+		int tintLocation;
+		void operator()(const ew::RenderPassContext& context, ew::RenderGraphTexture a, ew::RenderGraphTexture b, float tint) const {
+			glUseProgram(program);
+			glUniform4f(tintLocation, tint, tint, tint, 0.0f);
+			glBindTextureUnit(0, a.isValid() ? context.getTexture(a) : 0);
+			glBindTextureUnit(1, b.isValid() ? context.getTexture(b) : 0);
+			glBindVertexArray(vao);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+		}
+	};
+	Fullscreen fullscreen = { program, emptyVAO, tintLocation };
+	ew::RenderGraphTexture none;
+
+	t.backbuffer = graph.importBackbuffer(width, height);
+
+	graph.addPass("gbuffer", [&](ew::RenderPassBuilder& builder) {
+		t.albedo = builder.create("albedo", albedoDesc);
+		t.normal = builder.create("normal", normalDesc);
+		t.depth = builder.create("depth", depthDesc);
+	}, [fullscreen, none](const ew::RenderPassContext& context) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		fullscreen(context, none, none, 0.1f);
+	});
+	graph.addPass("ssao", [&](ew::RenderPassBuilder& builder) {
+		builder.read(t.normal);
+		builder.read(t.depth);
+		t.ao = builder.create("ao", aoDesc);
+	}, [&t, fullscreen, none](const ew::RenderPassContext& context) {
+		fullscreen(context, t.normal, none, 0.0f);
+	});
+	graph.addPass("lighting", [&](ew::RenderPassBuilder& builder) {
+		builder.read(t.albedo);
+		builder.read(t.normal);
+		builder.read(t.ao);
+		t.hdr = builder.create("hdr", hdrDesc);
+	}, [&t, fullscreen, none](const ew::RenderPassContext& context) {
+		fullscreen(context, t.albedo, t.ao, 0.0f);
+	});
+	//Nothing consumes this one; the graph drops it
+	graph.addPass("debug normals", [&](ew::RenderPassBuilder& builder) {
+		builder.read(t.normal);
+		t.debugView = builder.create("debug view", ldrDesc);
+	}, [&t, fullscreen, none](const ew::RenderPassContext& context) {
+		fullscreen(context, t.normal, none, 0.0f);
+	});
+	graph.addPass("bloom down 1", [&](ew::RenderPassBuilder& builder) {
+		builder.read(t.hdr);
+		t.bloomHalf = builder.create("bloom half", { width / 2, height / 2, GL_RGBA16F });
+	}, [&t, fullscreen, none](const ew::RenderPassContext& context) {
+		fullscreen(context, t.hdr, none, -0.5f);
+	});
+	graph.addPass("bloom down 2", [&](ew::RenderPassBuilder& builder) {
+		builder.read(t.bloomHalf);
+		t.bloomQuarter = builder.create("bloom quarter", { width / 4, height / 4, GL_RGBA16F });
+	}, [&t, fullscreen, none](const ew::RenderPassContext& context) {
+		fullscreen(context, t.bloomHalf, none, 0.0f);
+	});
+	graph.addPass("bloom up", [&](ew::RenderPassBuilder& builder) {
+		builder.read(t.bloomHalf);
+		builder.read(t.bloomQuarter);
+		t.bloom = builder.create("bloom", { width / 2, height / 2, GL_RGBA16F });
+	}, [&t, fullscreen, none](const ew::RenderPassContext& context) {
+		fullscreen(context, t.bloomHalf, t.bloomQuarter, 0.0f);
+	});
+	graph.addPass("tonemap", [&](ew::RenderPassBuilder& builder) {
+		builder.read(t.hdr);
+		builder.read(t.bloom);
+		t.ldr = builder.create("ldr", ldrDesc);
+	}, [&t, fullscreen, none](const ew::RenderPassContext& context) {
+		fullscreen(context, t.hdr, t.bloom, 0.0f);
+	});
+	graph.addPass("fxaa", [&](ew::RenderPassBuilder& builder) {
+		builder.read(t.ldr);
+		builder.write(t.backbuffer);
+	}, [&t, fullscreen, none](const ew::RenderPassContext& context) {
+		fullscreen(context, t.ldr, none, 0.0f);
+	});
+	graph.addPass("ui", [&](ew::RenderPassBuilder& builder) {
+		builder.write(t.backbuffer);
+	}, [fullscreen, none](const ew::RenderPassContext& context) {
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		fullscreen(context, none, none, 0.05f);
+		glDisable(GL_BLEND);
+	});
+}
+
+static void runRenderGraph(GLFWwindow* window) {
+	unsigned int program = ew::createShaderProgram(vertexShaderSource, fragmentShaderSource);
+	unsigned int emptyVAO;
+	glGenVertexArrays(1, &emptyVAO);
+	//Depth is cleared but never tested; the passes only stand in for real bandwidth
+	glDisable(GL_DEPTH_TEST);
+
+	ew::RenderGraph graph;
+	FrameTextures textures;
+	ew::GpuTimer gpuTimer;
+	ew::CpuTimer buildTimer, compileTimer;
+	double buildTotal = 0.0, compileTotal = 0.0, gpuTotal = 0.0;
+	for (int frame = 0; frame < FRAMES; frame++) {
+		buildTimer.start();
+		graph.reset();
+		buildFrame(graph, textures, program, emptyVAO, bench::SCREEN_WIDTH, bench::SCREEN_HEIGHT);
+		buildTotal += buildTimer.stop();
+		compileTimer.start();
+		graph.compile();
+		compileTotal += compileTimer.stop();
+		gpuTimer.begin();
+		graph.execute();
+		gpuTimer.end();
+		gpuTotal += gpuTimer.resolve();
+		glfwSwapBuffers(window);
+	}
+
+	const ew::RenderGraphStats& stats = graph.getStats();
+	std::vector<std::string> order = graph.getExecutionOrder();
+	printf("  order:");
+	for (const std::string& name : order)
+		printf(" %s", name.c_str());
+	printf("\n  %u passes, %u culled, %u transient textures on %u physical textures\n",
+		stats.passCount, stats.culledPassCount, stats.transientTextures, stats.physicalTextures);
+	printf("  render target memory per frame: %.1f MB without aliasing, %.1f MB aliased\n",
+		stats.unaliasedBytes / (1024.0 * 1024.0), stats.aliasedBytes / (1024.0 * 1024.0));
+	bench::report("build graph", buildTotal / FRAMES);
+	bench::report("compile graph", compileTotal / FRAMES);
+	bench::report("execute graph", 0.0, gpuTotal / FRAMES);
+
+	graph.releaseTextures();
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(program);
+}
+
+void benchRenderGraph() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runRenderGraph(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,110 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <vector>
+#include <ew/profiler.h>
+#include <ew/resourceManager.h>
+
+static const int FRAMES = 300;
+static const int BUFFERS_PER_FRAME = 64;
+static const int TEXTURES_PER_FRAME = 8;
+//Streamed content stays resident this many frames before it is released
+static const int LIFETIME = 3;
+static const size_t BUFFER_SIZE = 48 * 1024;
+static const int TEXTURE_SIZE = 256;
+
+struct StreamedFrame {
+	std::vector<unsigned int> buffers;
+	std::vector<unsigned int> textures;
+	std::vector<ew::BufferHandle> bufferHandles;
+	std::vector<ew::TextureHandle> textureHandles;
+};
+
+static void runResources(GLFWwindow* window) {
+	std::vector<unsigned char> bufferData(BUFFER_SIZE, 0x5a);
+	std::vector<unsigned char> texels(TEXTURE_SIZE * TEXTURE_SIZE * 4, 0x80);
+
+	printf("  %d buffers (%zu KB) + %d textures (%dx%d) streamed per frame, %d frame lifetime\n",
+		BUFFERS_PER_FRAME, BUFFER_SIZE / 1024, TEXTURES_PER_FRAME, TEXTURE_SIZE, TEXTURE_SIZE, LIFETIME);
+	for (int mode = 0; mode < 2; mode++) {
+		ew::ResourceManager resources;
+		std::vector<StreamedFrame> ring(LIFETIME);
+		size_t rawCreates = 0;
+		ew::CpuTimer cpuTimer;
+		double cpuTotal = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			cpuTimer.start();
+			StreamedFrame& slot = ring[frame % LIFETIME];
+			if (mode == 0) {
+				glDeleteBuffers((GLsizei)slot.buffers.size(), slot.buffers.data());
+				glDeleteTextures((GLsizei)slot.textures.size(), slot.textures.data());
+				slot.buffers.assign(BUFFERS_PER_FRAME, 0);
+				slot.textures.assign(TEXTURES_PER_FRAME, 0);
+				glGenBuffers(BUFFERS_PER_FRAME, slot.buffers.data());
+				for (unsigned int buffer : slot.buffers) {
+					glBindBuffer(GL_ARRAY_BUFFER, buffer);
+					glBufferData(GL_ARRAY_BUFFER, BUFFER_SIZE, bufferData.data(), GL_STATIC_DRAW);
+				}
+				glGenTextures(TEXTURES_PER_FRAME, slot.textures.data());
+				for (unsigned int texture : slot.textures) {
+					glBindTexture(GL_TEXTURE_2D, texture);
+					glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE);
+					glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+				}
+				rawCreates += BUFFERS_PER_FRAME + TEXTURES_PER_FRAME;
+			}
+			else {
+				for (ew::BufferHandle handle : slot.bufferHandles)
+					resources.destroy(handle);
+				for (ew::TextureHandle handle : slot.textureHandles)
+					resources.destroy(handle);
+				slot.bufferHandles.clear();
+				slot.textureHandles.clear();
+				ew::BufferDesc bufferDesc;
+				bufferDesc.size = BUFFER_SIZE;
+				bufferDesc.data = bufferData.data();
+				for (int i = 0; i < BUFFERS_PER_FRAME; i++)
+					slot.bufferHandles.push_back(resources.createBuffer(bufferDesc));
+				ew::TextureDesc textureDesc;
+				textureDesc.width = textureDesc.height = TEXTURE_SIZE;
+				for (int i = 0; i < TEXTURES_PER_FRAME; i++) {
+					ew::TextureHandle handle = resources.createTexture(textureDesc);
+					glBindTexture(GL_TEXTURE_2D, resources.get(handle));
+					glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+					slot.textureHandles.push_back(handle);
+				}
+				resources.endFrame();
+			}
+			cpuTotal += cpuTimer.stop();
+			glClear(GL_COLOR_BUFFER_BIT);
+			glfwSwapBuffers(window);
+		}
+
+		if (mode == 0) {
+			bench::report("glGen*/glDelete* per object", cpuTotal / FRAMES);
+			printf("  GL objects created: %zu\n", rawCreates);
+			for (StreamedFrame& slot : ring) {
+				glDeleteBuffers((GLsizei)slot.buffers.size(), slot.buffers.data());
+				glDeleteTextures((GLsizei)slot.textures.size(), slot.textures.data());
+			}
+		}
+		else {
+			bench::report("ResourceManager pooled", cpuTotal / FRAMES);
+			const ew::ResourceStats& buffers = resources.getStats(ew::ResourceType::Buffer);
+			const ew::ResourceStats& textures = resources.getStats(ew::ResourceType::Texture);
+			printf("  GL objects created: %zu, live %zu, pooled %zu (%zu KB), pending %zu\n",
+				buffers.glCreates + textures.glCreates, buffers.liveCount + textures.liveCount,
+				buffers.pooledCount + textures.pooledCount, (buffers.pooledBytes + textures.pooledBytes) / 1024,
+				buffers.pendingCount + textures.pendingCount);
+			resources.publishStats();
+			ew::ProfilerCounters::print();
+		}
+	}
+}
+
+void benchResources() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runResources(window);
+	bench::destroyContext(window);
+}
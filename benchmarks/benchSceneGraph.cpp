@@ -0,0 +1,47 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <ew/ewMath/ewMath.h>
+#include <ew/jobSystem.h>
+#include <ew/profiler.h>
+#include <ew/sceneGraph.h>
+
+static const int NODE_COUNT = 100000;
+static const float CHANGED_FRACTION = 0.03f;
+static const int FRAMES = 100;
+
+void benchSceneGraph() {
+	//Wide, shallow hierarchy like a level: a few roots, objects several levels deep
+	ew::SceneGraph graph;
+	std::vector<unsigned int> nodes;
+	for (int i = 0; i < NODE_COUNT; i++) {
+		unsigned int parent = i < 16 ? ew::SceneGraph::NO_PARENT : nodes[(size_t)(i * 0.25f)];
+		glm::vec3 position(ew::RandomRange(-5, 5), ew::RandomRange(-5, 5), ew::RandomRange(-5, 5));
+		nodes.push_back(graph.createNode(parent, position));
+	}
+	ew::JobSystem jobs;
+	graph.update();
+	printf("  %d nodes, %u levels, %.0f%% animated per frame, %u workers\n", NODE_COUNT, graph.getDepthCount(),
+		CHANGED_FRACTION * 100.0f, jobs.getWorkerCount());
+
+	int changedPerFrame = (int)(NODE_COUNT * CHANGED_FRACTION);
+	const char* names[] = { "full recompute", "dirty subtrees", "dirty subtrees + jobs" };
+	for (int mode = 0; mode < 3; mode++) {
+		ew::CpuTimer timer;
+		double total = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			for (int i = 0; i < changedPerFrame; i++) {
+				unsigned int node = nodes[rand() % NODE_COUNT];
+				graph.setRotation(node, glm::angleAxis(frame * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)));
+			}
+			timer.start();
+			if (mode == 0)
+				graph.markAllDirty();
+			graph.update(mode == 2 ? &jobs : nullptr);
+			total += timer.stop();
+		}
+		bench::report(names[mode], total / FRAMES);
+	}
+}
@@ -0,0 +1,110 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <string>
+#include <time.h>
+#include <vector>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+#include <ew/shaderBuildQueue.h>
+
+static const int PROGRAM_COUNT = 48;
+static const int LIGHTS_PER_PROGRAM = 12;
+
+static const char* vertexShaderSource = R"(
+#version 450 core
+layout(location = 0) in vec3 vPos;
+layout(location = 1) in vec3 vNormal;
+uniform mat4 model;
+uniform mat4 viewProjection;
+out vec3 worldPos;
+out vec3 worldNormal;
+void main() {
+	worldPos = (model * vec4(vPos, 1.0)).xyz;
+	worldNormal = mat3(model) * vNormal;
+	gl_Position = viewProjection * vec4(worldPos, 1.0);
+}
+)";
+
+//Unrolled lights with per-program constants, so every program is a distinct compile.
+//The seed keeps the driver's on-disk shader cache from hiding the cost between runs.
+static std::string makeFragmentSource(int index, unsigned int seed) {
+	char line[256];
+	std::string source = "#version 450 core\nin vec3 worldPos;\nin vec3 worldNormal;\nout vec4 FragColor;\n";
+	snprintf(line, sizeof(line), "const float SEED = %u.0;\n", seed);
+	source += line;
+	source += "void main() {\n\tvec3 n = normalize(worldNormal);\n\tvec3 color = vec3(0.0);\n";
+	for (int light = 0; light < LIGHTS_PER_PROGRAM; light++) {
+		float x = (float)((index * 7 + light * 3) % 11) - 5.0f;
+		float z = (float)((index * 5 + light * 13) % 9) - 4.0f;
+		snprintf(line, sizeof(line),
+			"\t{\n\t\tvec3 l = vec3(%.1f, 2.0, %.1f) - worldPos;\n\t\tfloat d = length(l);\n"
+			"\t\tfloat ndotl = max(dot(n, l / d), 0.0);\n\t\tcolor += vec3(%.2f, %.2f, 0.5) * ndotl / (1.0 + d * d * %.3f);\n\t}\n",
+			x, z, (light % 4) / 3.0f, (index % 5) / 4.0f, 0.05f + light * 0.01f);
+		source += line;
+	}
+	source += "\tFragColor = vec4(color + SEED * 1e-9, 1.0);\n}\n";
+	return source;
+}
+
+static void presentFrame(GLFWwindow* window, float progress) {
+	//Loading screen: clear color fades in as programs complete
+	glClearColor(0.1f, 0.1f + 0.4f * progress, 0.2f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glfwSwapBuffers(window);
+	glFinish();
+}
+
+static void runShaderBuild(GLFWwindow* window, bool parallel, unsigned int seed) {
+	std::vector<std::string> fragmentSources;
+	for (int i = 0; i < PROGRAM_COUNT; i++)
+		fragmentSources.push_back(makeFragmentSource(i, seed));
+
+	if (parallel && !ew::enableParallelShaderCompile(glfwGetProcAddress))
+		printf("  GL_KHR_parallel_shader_compile not supported, queue falls back to one build per frame\n");
+
+	ew::CpuTimer timer;
+	timer.start();
+	std::vector<unsigned int> programs;
+	double firstFrameMs = 0.0, allReadyMs = 0.0;
+	int loadingFrames = 0;
+	if (!parallel) {
+		//Previous behaviour: every program compiled and linked before the first frame
+		for (int i = 0; i < PROGRAM_COUNT; i++)
+			programs.push_back(ew::createShaderProgram(vertexShaderSource, fragmentSources[i].c_str()));
+		presentFrame(window, 1.0f);
+		firstFrameMs = allReadyMs = timer.stop();
+	}
+	else {
+		ew::ShaderBuildQueue queue;
+		for (int i = 0; i < PROGRAM_COUNT; i++)
+			queue.addProgram(vertexShaderSource, fragmentSources[i].c_str(), "bench");
+		while (!queue.poll()) {
+			presentFrame(window, 1.0f - (float)queue.getPendingCount() / PROGRAM_COUNT);
+			if (loadingFrames++ == 0)
+				firstFrameMs = timer.stop();
+		}
+		allReadyMs = timer.stop();
+		if (loadingFrames == 0)
+			firstFrameMs = allReadyMs;
+		for (int i = 0; i < PROGRAM_COUNT; i++)
+			programs.push_back(queue.get(i));
+	}
+
+	printf("  %s: first frame %.1f ms, all %d programs ready %.1f ms, %d loading frames\n",
+		parallel ? "build queue" : "synchronous", firstFrameMs, PROGRAM_COUNT, allReadyMs, loadingFrames);
+	bench::report(parallel ? "time-to-first-frame (queue)" : "time-to-first-frame (sync)", firstFrameMs);
+	for (unsigned int program : programs)
+		glDeleteProgram(program);
+}
+
+void benchShaderBuild() {
+	//Separate contexts so the parallel compile setting of one run can't leak into the other
+	unsigned int seed = (unsigned int)time(NULL);
+	for (int mode = 0; mode < 2; mode++) {
+		GLFWwindow* window = bench::createContext();
+		if (!window)
+			return;
+		runShaderBuild(window, mode == 1, seed + mode);
+		bench::destroyContext(window);
+	}
+}
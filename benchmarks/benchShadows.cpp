@@ -0,0 +1,179 @@
+#include "benchCommon.h"
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/cascadedShadows.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+
+//Directional Phong with the shadow term applied to diffuse and specular
+static const char* fragmentMain = R"(
+    in vec3 WorldPos;
+    in vec3 Normal;
+    in float ViewDepth;
+    uniform vec3 cameraPos;
+    uniform vec3 lightDir;
+    out vec4 FragColor;
+
+    void main() {
+        vec3 normal = normalize(Normal);
+        vec3 toLight = -lightDir;
+        float diff = max(dot(normal, toLight), 0.0);
+        vec3 viewDir = normalize(cameraPos - WorldPos);
+        float spec = pow(max(dot(viewDir, reflect(lightDir, normal)), 0.0), 32.0);
+        float shadow = sampleShadow(WorldPos, normal, ViewDepth);
+        vec3 color = vec3(0.8) * (0.1 + diff * shadow) + 0.5 * spec * shadow;
+        FragColor = vec4(color, 1.0);
+    }
+)";
+
+static const int FRAMES = 30;
+static const float NEAR_PLANE = 0.1f;
+static const float FAR_PLANE = 200.0f;
+static const float SHADOW_DISTANCE = 120.0f;
+static const float FOVY = glm::radians(60.0f);
+
+enum class ShadowMode {
+	NoCache,
+	CachedStill,
+	CachedMoving
+};
+
+static void runShadows(GLFWwindow* window) {
+	std::string shadingSource = std::string("#version 450 core\n") + ew::cascadedShadowGlsl() + fragmentMain;
+	unsigned int program = ew::createShaderProgram(bench::sceneVertexSource, shadingSource.c_str());
+
+	bench::MeshBuffers plane = bench::createMeshBuffers(ew::createPlane(240.0f, 240.0f, 8));
+	bench::MeshBuffers cube = bench::createMeshBuffers(ew::createCube(1.0f));
+	bench::MeshBuffers sphere = bench::createMeshBuffers(ew::createSphere(1.0f, 24));
+
+	//A city of static boxes with a few dynamic spheres orbiting through it
+	std::vector<ew::ShadowCaster> casters;
+	std::vector<const bench::MeshBuffers*> meshes;
+	ew::ShadowCaster floor;
+	floor.model = glm::mat4(1.0f);
+	floor.bounds = glm::vec4(0.0f, 0.0f, 0.0f, 170.0f);
+	floor.isStatic = true;
+	casters.push_back(floor);
+	meshes.push_back(&plane);
+	for (int z = 0; z < 24; z++) {
+		for (int x = 0; x < 24; x++) {
+			float height = 1.0f + (float)((x * 7 + z * 13) % 9);
+			ew::ShadowCaster box;
+			box.model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(x * 8.0f - 92.0f, height * 0.5f, z * 8.0f - 92.0f)), glm::vec3(3.0f, height, 3.0f));
+			box.bounds = glm::vec4(0.0f, 0.0f, 0.0f, 0.87f);
+			box.isStatic = true;
+			casters.push_back(box);
+			meshes.push_back(&cube);
+		}
+	}
+	const unsigned int firstDynamic = (unsigned int)casters.size();
+	for (int i = 0; i < 16; i++) {
+		ew::ShadowCaster ball;
+		ball.bounds = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		ball.isStatic = false;
+		casters.push_back(ball);
+		meshes.push_back(&sphere);
+	}
+
+	ew::CascadedShadowMaps shadows(2048, 4);
+	glm::vec3 lightDir = glm::normalize(glm::vec3(-0.4f, -1.0f, -0.3f));
+	shadows.setLightDirection(lightDir);
+	glm::mat4 projection = glm::perspective(FOVY, (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, NEAR_PLANE, FAR_PLANE);
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &projection[0][0]);
+	glUniform3fv(glGetUniformLocation(program, "lightDir"), 1, &lightDir[0]);
+	int viewLocation = glGetUniformLocation(program, "view");
+	int cameraPosLocation = glGetUniformLocation(program, "cameraPos");
+	int modelLocation = glGetUniformLocation(program, "model");
+	int normalMatrixLocation = glGetUniformLocation(program, "normalMatrix");
+	glEnable(GL_DEPTH_TEST);
+
+	struct Scenario {
+		const char* name;
+		ShadowMode mode;
+	};
+	const Scenario scenarios[] = {
+		{ "no cache, camera still", ShadowMode::NoCache },
+		{ "static cache, camera still", ShadowMode::CachedStill },
+		{ "static cache, camera moving", ShadowMode::CachedMoving },
+	};
+	for (const Scenario& scenario : scenarios) {
+		shadows.invalidateStaticCache();
+		//The shadow pass is timed per cascade inside CascadedShadowMaps; GL_TIME_ELAPSED queries cannot nest
+		ew::GpuTimer shadeTimer;
+		ew::CpuTimer cpuTimer;
+		double cpuTotal = 0.0, shadowTotal = 0.0, shadeTotal = 0.0;
+		double cascadeMs[ew::MAX_SHADOW_CASCADES] = {};
+		unsigned int staticDrawn[ew::MAX_SHADOW_CASCADES] = {};
+		unsigned int dynamicDrawn[ew::MAX_SHADOW_CASCADES] = {};
+		unsigned int culled[ew::MAX_SHADOW_CASCADES] = {};
+		int cacheHits[ew::MAX_SHADOW_CASCADES] = {};
+		for (int frame = 0; frame < FRAMES; frame++) {
+			float t = frame / 30.0f;
+			for (int i = 0; i < 16; i++) {
+				float angle = t + i * 0.3927f;
+				casters[firstDynamic + i].model = glm::translate(glm::mat4(1.0f), glm::vec3(cosf(angle) * (10.0f + i * 3.0f), 3.0f, sinf(angle) * (10.0f + i * 3.0f)));
+			}
+			float dolly = scenario.mode == ShadowMode::CachedMoving ? frame * 0.25f : 0.0f;
+			glm::vec3 cameraPos(dolly, 14.0f, 40.0f - dolly);
+			glm::mat4 view = glm::lookAt(cameraPos, cameraPos + glm::vec3(0.0f, -0.35f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			cpuTimer.start();
+			if (scenario.mode == ShadowMode::NoCache)
+				shadows.invalidateStaticCache();
+			shadows.update(view, FOVY, (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, NEAR_PLANE, SHADOW_DISTANCE);
+			shadows.render(casters.data(), (unsigned int)casters.size(), [&](unsigned int i) {
+				bench::drawMesh(*meshes[i]);
+			});
+
+			shadeTimer.begin();
+			glUseProgram(program);
+			glUniformMatrix4fv(viewLocation, 1, GL_FALSE, &view[0][0]);
+			glUniform3fv(cameraPosLocation, 1, &cameraPos[0]);
+			shadows.bind();
+			for (size_t i = 0; i < casters.size(); i++)
+				bench::drawSceneObject(modelLocation, normalMatrixLocation, *meshes[i], casters[i].model);
+			shadeTimer.end();
+			cpuTotal += cpuTimer.stop();
+			shadeTotal += shadeTimer.resolve();
+			shadows.resolveTimings();
+			for (int c = 0; c < shadows.getCascadeCount(); c++) {
+				ew::ShadowCascadeStats stats = shadows.getStats(c);
+				cascadeMs[c] += stats.gpuMs;
+				shadowTotal += stats.gpuMs;
+				staticDrawn[c] += stats.staticCasters;
+				dynamicDrawn[c] += stats.dynamicCasters;
+				culled[c] += stats.culledCasters;
+				cacheHits[c] += stats.staticCacheHit ? 1 : 0;
+			}
+			glfwSwapBuffers(window);
+		}
+		printf("  %s\n", scenario.name);
+		bench::report("shadow pass (all cascades)", cpuTotal / FRAMES, shadowTotal / FRAMES);
+		bench::report("shaded frame", 0.0, shadeTotal / FRAMES);
+		for (int c = 0; c < shadows.getCascadeCount(); c++) {
+			printf("    cascade %d (to %5.1f): gpu %.3f ms, static %5.1f dynamic %4.1f culled %5.1f per frame, cache hits %d/%d\n",
+				c, shadows.getStats(c).splitFar, cascadeMs[c] / FRAMES, (double)staticDrawn[c] / FRAMES,
+				(double)dynamicDrawn[c] / FRAMES, (double)culled[c] / FRAMES, cacheHits[c], FRAMES);
+		}
+	}
+
+	bench::deleteMeshBuffers(plane);
+	bench::deleteMeshBuffers(cube);
+	bench::deleteMeshBuffers(sphere);
+	glDeleteProgram(program);
+}
+
+void benchShadows() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runShadows(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,203 @@
+#include "benchCommon.h"
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+#include <ew/spriteBatch.h>
+
+//Baseline in the style of the 2D assignments: one static quad, per-sprite uniforms, one draw each
+static const char* vertexShaderSource = R"(
+    #version 450 core
+    layout(location = 0) in vec2 aPos;
+    uniform mat4 projection;
+    uniform vec2 uOffset;
+    uniform vec2 uSize;
+    uniform float uRotation;
+    uniform vec4 uUVRect;
+    out vec2 UV;
+    void main() {
+        vec2 local = aPos * uSize;
+        float c = cos(uRotation), s = sin(uRotation);
+        vec2 world = vec2(c * local.x - s * local.y, s * local.x + c * local.y) + uOffset;
+        UV = mix(uUVRect.xy, uUVRect.zw, aPos + 0.5);
+        gl_Position = projection * vec4(world, 0.0, 1.0);
+    }
+)";
+
+static const char* fragmentShaderSource = R"(
+    #version 450 core
+    in vec2 UV;
+    out vec4 FragColor;
+    layout(binding = 0) uniform sampler2DArray sprites;
+    uniform vec4 uColor;
+    uniform float uLayer;
+    void main() {
+        FragColor = texture(sprites, vec3(UV, uLayer)) * uColor;
+    }
+)";
+
+static const int FRAMES = 10;
+static const unsigned int BASELINE_SPRITES = 10000;
+static const unsigned int MAX_SPRITES = 100000;
+
+//Layers of flat colored circles, standing in for the frames of an animated sprite sheet
+static unsigned int createSpriteArray(int size, int layers) {
+	std::vector<unsigned char> pixels((size_t)size * size * 4 * layers);
+	for (int layer = 0; layer < layers; layer++) {
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				unsigned char* p = &pixels[(((size_t)layer * size + y) * size + x) * 4];
+				float dx = (x + 0.5f) / size - 0.5f, dy = (y + 0.5f) / size - 0.5f;
+				float radius = 0.25f + 0.2f * layer / layers;
+				p[0] = (unsigned char)(255 * layer / layers);
+				p[1] = (unsigned char)(255 - 255 * layer / layers);
+				p[2] = 200;
+				p[3] = dx * dx + dy * dy < radius * radius ? 255 : 0;
+			}
+		}
+	}
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, size, size, layers);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, size, size, layers, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	return texture;
+}
+
+struct SpriteState {
+	glm::vec2 origin;
+	float phase;
+	float speed;
+	int sheet;
+};
+
+static void animate(const std::vector<SpriteState>& states, unsigned int count, const unsigned int* sheets, const int* sheetLayers, float time, std::vector<ew::Sprite>& sprites) {
+	sprites.resize(count);
+	for (unsigned int i = 0; i < count; i++) {
+		const SpriteState& state = states[i];
+		ew::Sprite& sprite = sprites[i];
+		float t = time * state.speed + state.phase;
+		sprite.position = state.origin + glm::vec2(cosf(t), sinf(t)) * 20.0f;
+		sprite.size = glm::vec2(12.0f);
+		sprite.rotation = t;
+		sprite.texture = sheets[state.sheet];
+		sprite.layer = (unsigned int)(t * 4.0f) % sheetLayers[state.sheet];
+		sprite.color = glm::vec4(1.0f, 1.0f, 1.0f, 0.8f);
+	}
+}
+
+static void runSprites(GLFWwindow* window) {
+	unsigned int baselineProgram = ew::createShaderProgram(vertexShaderSource, fragmentShaderSource);
+	unsigned int sheets[2] = { createSpriteArray(64, 8), createSpriteArray(32, 4) };
+	const int sheetLayers[2] = { 8, 4 };
+
+	float quad[] = { -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f };
+	unsigned int quadVAO, quadVBO;
+	glGenVertexArrays(1, &quadVAO);
+	glGenBuffers(1, &quadVBO);
+	glBindVertexArray(quadVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+
+	//Sheets interleaved in submission order, the worst case for an unsorted batcher
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<SpriteState> states(MAX_SPRITES);
+	for (unsigned int i = 0; i < MAX_SPRITES; i++) {
+		states[i].origin = glm::vec2(unit(rng) * bench::SCREEN_WIDTH, unit(rng) * bench::SCREEN_HEIGHT);
+		states[i].phase = unit(rng) * 6.28f;
+		states[i].speed = 0.5f + unit(rng);
+		states[i].sheet = i % 2;
+	}
+
+	glm::mat4 projection = glm::ortho(0.0f, (float)bench::SCREEN_WIDTH, 0.0f, (float)bench::SCREEN_HEIGHT, -1.0f, 1.0f);
+	glUseProgram(baselineProgram);
+	glUniformMatrix4fv(glGetUniformLocation(baselineProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
+	int offsetLocation = glGetUniformLocation(baselineProgram, "uOffset");
+	int sizeLocation = glGetUniformLocation(baselineProgram, "uSize");
+	int rotationLocation = glGetUniformLocation(baselineProgram, "uRotation");
+	int uvRectLocation = glGetUniformLocation(baselineProgram, "uUVRect");
+	int colorLocation = glGetUniformLocation(baselineProgram, "uColor");
+	int layerLocation = glGetUniformLocation(baselineProgram, "uLayer");
+
+	ew::SpriteBatch batch;
+	std::vector<ew::Sprite> sprites;
+	struct Run {
+		const char* name;
+		unsigned int count;
+		//-1 baseline, otherwise an ew::SpriteSortMode
+		int mode;
+	};
+	const Run runs[] = {
+		{ "one draw per sprite", BASELINE_SPRITES, -1 },
+		{ "batched, sorted by texture", BASELINE_SPRITES, (int)ew::SpriteSortMode::Texture },
+		{ "batched, sorted by texture", MAX_SPRITES, (int)ew::SpriteSortMode::Texture },
+		{ "batched, submission order", MAX_SPRITES, (int)ew::SpriteSortMode::Submission },
+	};
+	for (const Run& run : runs) {
+		ew::CpuTimer cpuTimer;
+		ew::GpuTimer gpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		unsigned int draws = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			cpuTimer.start();
+			gpuTimer.begin();
+			animate(states, run.count, sheets, sheetLayers, frame / 60.0f, sprites);
+			if (run.mode < 0) {
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				glUseProgram(baselineProgram);
+				glBindVertexArray(quadVAO);
+				for (const ew::Sprite& sprite : sprites) {
+					glBindTextureUnit(0, sprite.texture);
+					glUniform2fv(offsetLocation, 1, &sprite.position[0]);
+					glUniform2fv(sizeLocation, 1, &sprite.size[0]);
+					glUniform1f(rotationLocation, sprite.rotation);
+					glUniform4fv(uvRectLocation, 1, &sprite.uvRect[0]);
+					glUniform4fv(colorLocation, 1, &sprite.color[0]);
+					glUniform1f(layerLocation, (float)sprite.layer);
+					glDrawArrays(GL_TRIANGLES, 0, 6);
+				}
+				glDisable(GL_BLEND);
+				draws = run.count;
+			}
+			else {
+				batch.begin(projection, (ew::SpriteSortMode)run.mode);
+				for (const ew::Sprite& sprite : sprites)
+					batch.draw(sprite);
+				batch.end();
+				draws = batch.getDrawCount();
+			}
+			gpuTimer.end();
+			cpuTotal += cpuTimer.stop();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		char name[96];
+		snprintf(name, sizeof(name), "%s, %u sprites (%u draws)", run.name, run.count, draws);
+		bench::report(name, cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+
+	glDeleteVertexArrays(1, &quadVAO);
+	glDeleteBuffers(1, &quadVBO);
+	glDeleteTextures(2, sheets);
+	glDeleteProgram(baselineProgram);
+}
+
+void benchSprites() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runSprites(window);
+	bench::destroyContext(window);
+}
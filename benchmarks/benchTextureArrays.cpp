@@ -0,0 +1,209 @@
+#include "benchCommon.h"
+#include <stdio.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/profiler.h>
+#include <ew/samplerCache.h>
+#include <ew/shader.h>
+#include <ew/textureArrayManager.h>
+
+//Baseline: a GL_TEXTURE_2D per image, rebound before every quad
+static const char* separateVertexSource = R"(
+    #version 450 core
+    layout(location = 0) in vec2 aPos;
+    uniform mat4 projection;
+    uniform vec2 uOffset;
+    out vec2 UV;
+    void main() {
+        UV = aPos + 0.5;
+        gl_Position = projection * vec4(aPos * 8.0 + uOffset, 0.0, 1.0);
+    }
+)";
+
+static const char* separateFragmentSource = R"(
+    #version 450 core
+    in vec2 UV;
+    out vec4 FragColor;
+    layout(binding = 0) uniform sampler2D image;
+    void main() {
+        FragColor = texture(image, UV);
+    }
+)";
+
+//Arrays: offset and layer per instance, one draw per array
+static const char* arrayVertexSource = R"(
+    #version 450 core
+    layout(location = 0) in vec2 aPos;
+    layout(location = 1) in vec3 aInstance;
+    uniform mat4 projection;
+    out vec3 UV;
+    void main() {
+        UV = vec3(aPos + 0.5, aInstance.z);
+        gl_Position = projection * vec4(aPos * 8.0 + aInstance.xy, 0.0, 1.0);
+    }
+)";
+
+static const char* arrayFragmentSource = R"(
+    #version 450 core
+    in vec3 UV;
+    out vec4 FragColor;
+    layout(binding = 0) uniform sampler2DArray images;
+    void main() {
+        FragColor = texture(images, UV);
+    }
+)";
+
+static const int FRAMES = 10;
+static const int TEXTURES = 256;
+static const int TEXTURE_SIZE = 64;
+static const int QUADS = 16384;
+
+static std::vector<unsigned char> makeImage(int seed) {
+	std::vector<unsigned char> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+	for (int i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++) {
+		int x = i % TEXTURE_SIZE, y = i / TEXTURE_SIZE;
+		pixels[i * 4 + 0] = (unsigned char)(seed * 7);
+		pixels[i * 4 + 1] = (unsigned char)(((x / 8) ^ (y / 8)) & 1 ? 255 : 64);
+		pixels[i * 4 + 2] = (unsigned char)(255 - seed);
+		pixels[i * 4 + 3] = 255;
+	}
+	return pixels;
+}
+
+static void runTextureArrays(GLFWwindow* window) {
+	unsigned int separateProgram = ew::createShaderProgram(separateVertexSource, separateFragmentSource);
+	unsigned int arrayProgram = ew::createShaderProgram(arrayVertexSource, arrayFragmentSource);
+	glm::mat4 projection = glm::ortho(0.0f, (float)bench::SCREEN_WIDTH, 0.0f, (float)bench::SCREEN_HEIGHT, -1.0f, 1.0f);
+
+	//Both layouts hold the same images; the separate textures carry their own sampling state
+	ew::TextureArrayManager arrays(128);
+	std::vector<unsigned int> separate(TEXTURES);
+	std::vector<ew::TextureLayer> layers(TEXTURES);
+	glGenTextures(TEXTURES, separate.data());
+	for (int i = 0; i < TEXTURES; i++) {
+		std::vector<unsigned char> pixels = makeImage(i);
+		glBindTexture(GL_TEXTURE_2D, separate[i]);
+		glTexStorage2D(GL_TEXTURE_2D, 7, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		layers[i] = arrays.add(TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA8, pixels.data());
+	}
+	arrays.generateMipmaps();
+	ew::SamplerCache samplers;
+	ew::SamplerDesc trilinear;
+
+	//Quads scattered over the screen, texture chosen round-robin
+	std::vector<glm::vec2> offsets(QUADS);
+	for (int i = 0; i < QUADS; i++)
+		offsets[i] = glm::vec2((i * 37) % bench::SCREEN_WIDTH, (i * 53) % bench::SCREEN_HEIGHT);
+
+	float quad[] = { -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f };
+	unsigned int vao, quadVBO, instanceVBO;
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &quadVBO);
+	glGenBuffers(1, &instanceVBO);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+
+	//Instances grouped by array, so each array is one instanced draw
+	struct ArrayRange {
+		unsigned int texture;
+		int first;
+		int count;
+	};
+	std::vector<glm::vec3> instances;
+	std::vector<ArrayRange> ranges;
+	for (int i = 0; i < QUADS; i++) {
+		const ew::TextureLayer& layer = layers[i % TEXTURES];
+		bool found = false;
+		for (const ArrayRange& range : ranges)
+			found = found || range.texture == layer.texture;
+		if (found)
+			continue;
+		ArrayRange range = { layer.texture, (int)instances.size(), 0 };
+		for (int j = i; j < QUADS; j++) {
+			if (layers[j % TEXTURES].texture == layer.texture)
+				instances.push_back(glm::vec3(offsets[j], (float)layers[j % TEXTURES].layer));
+		}
+		range.count = (int)instances.size() - range.first;
+		ranges.push_back(range);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::vec3), instances.data(), GL_STATIC_DRAW);
+
+	glUseProgram(separateProgram);
+	glUniformMatrix4fv(glGetUniformLocation(separateProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
+	int offsetLocation = glGetUniformLocation(separateProgram, "uOffset");
+	glUseProgram(arrayProgram);
+	glUniformMatrix4fv(glGetUniformLocation(arrayProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
+
+	const char* names[] = { "bind per quad", "texture arrays + sampler" };
+	for (int mode = 0; mode < 2; mode++) {
+		ew::CpuTimer cpuTimer;
+		ew::GpuTimer gpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		int draws = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			cpuTimer.start();
+			gpuTimer.begin();
+			glBindVertexArray(vao);
+			if (mode == 0) {
+				glBindSampler(0, 0);
+				glUseProgram(separateProgram);
+				for (int i = 0; i < QUADS; i++) {
+					glBindTexture(GL_TEXTURE_2D, separate[i % TEXTURES]);
+					glUniform2fv(offsetLocation, 1, &offsets[i][0]);
+					glDrawArrays(GL_TRIANGLES, 0, 6);
+				}
+				draws = QUADS;
+			}
+			else {
+				glUseProgram(arrayProgram);
+				samplers.bind(0, trilinear);
+				for (const ArrayRange& range : ranges) {
+					glBindTextureUnit(0, range.texture);
+					glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, range.count, range.first);
+				}
+				draws = (int)ranges.size();
+			}
+			gpuTimer.end();
+			cpuTotal += cpuTimer.stop();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		char name[96];
+		snprintf(name, sizeof(name), "%d quads, %d textures, %s (%d draws)", QUADS, TEXTURES, names[mode], draws);
+		bench::report(name, cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+	glBindSampler(0, 0);
+
+	const ew::TextureArrayStats& stats = arrays.getStats();
+	printf("  %zu arrays, %zu/%zu layers used, %.1f MB\n", stats.arrays, stats.layersUsed, stats.layersAllocated, stats.bytes / (1024.0 * 1024.0));
+
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &quadVBO);
+	glDeleteBuffers(1, &instanceVBO);
+	glDeleteTextures(TEXTURES, separate.data());
+	glDeleteProgram(separateProgram);
+	glDeleteProgram(arrayProgram);
+}
+
+void benchTextureArrays() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runTextureArrays(window);
+	bench::destroyContext(window);
+}
@@ -0,0 +1,219 @@
+#include "benchCommon.h"
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <ew/external/stb_image.h>
+#include <ew/jobSystem.h>
+#include <ew/procGen.h>
+#include <ew/profiler.h>
+#include <ew/shader.h>
+#include <ew/virtualTexture.h>
+
+//Shared images in core/JP; CMake points this at the source folder
+#ifndef JP_DIR
+#define JP_DIR "core/JP/"
+#endif
+
+static const char* vertexShaderSource = R"(
+    #version 450 core
+    layout(location = 0) in vec3 aPos;
+    layout(location = 2) in vec2 aUV;
+    uniform mat4 viewProjection;
+    out vec2 UV;
+    void main() {
+        UV = aUV;
+        gl_Position = viewProjection * vec4(aPos, 1.0);
+    }
+)";
+
+static const char* fullTextureFragmentSource = R"(
+    #version 450 core
+    in vec2 UV;
+    out vec4 FragColor;
+    layout(binding = 0) uniform sampler2D image;
+    void main() {
+        FragColor = texture(image, UV);
+    }
+)";
+
+static const char* virtualFragmentMain = R"(
+    in vec2 UV;
+    out vec4 FragColor;
+    void main() {
+        FragColor = sampleVirtual(UV);
+    }
+)";
+
+static const char* feedbackFragmentMain = R"(
+    in vec2 UV;
+    out vec4 FragColor;
+    void main() {
+        FragColor = virtualFeedback(UV);
+    }
+)";
+
+static const int FRAMES = 120;
+//waves.jpg blown up to a size that no longer fits comfortably in GPU memory with mips
+static const int VIRTUAL_WIDTH = 8192;
+static const int VIRTUAL_HEIGHT = 4608;
+
+//Bilinear upscale of waves.jpg, or a procedural pattern if it cannot be loaded
+static std::vector<unsigned char> makeLargeImage() {
+	std::vector<unsigned char> result((size_t)VIRTUAL_WIDTH * VIRTUAL_HEIGHT * 4);
+	int width, height, channels;
+	unsigned char* source = stbi_load(JP_DIR "waves.jpg", &width, &height, &channels, 4);
+	for (int y = 0; y < VIRTUAL_HEIGHT; y++) {
+		for (int x = 0; x < VIRTUAL_WIDTH; x++) {
+			unsigned char* p = &result[((size_t)y * VIRTUAL_WIDTH + x) * 4];
+			if (!source) {
+				p[0] = (unsigned char)(x >> 5);
+				p[1] = (unsigned char)(y >> 5);
+				p[2] = ((x >> 6) ^ (y >> 6)) & 1 ? 255 : 0;
+				p[3] = 255;
+				continue;
+			}
+			//Image rows are top-down; row 0 of the virtual texture is v = 0, the bottom
+			float sx = (x + 0.5f) * width / VIRTUAL_WIDTH - 0.5f;
+			float sy = (VIRTUAL_HEIGHT - 1 - y + 0.5f) * height / VIRTUAL_HEIGHT - 0.5f;
+			int x0 = glm::clamp((int)floorf(sx), 0, width - 1), y0 = glm::clamp((int)floorf(sy), 0, height - 1);
+			int x1 = glm::min(x0 + 1, width - 1), y1 = glm::min(y0 + 1, height - 1);
+			float fx = glm::clamp(sx - x0, 0.0f, 1.0f), fy = glm::clamp(sy - y0, 0.0f, 1.0f);
+			for (int c = 0; c < 4; c++) {
+				float top = source[((size_t)y0 * width + x0) * 4 + c] * (1.0f - fx) + source[((size_t)y0 * width + x1) * 4 + c] * fx;
+				float bottom = source[((size_t)y1 * width + x0) * 4 + c] * (1.0f - fx) + source[((size_t)y1 * width + x1) * 4 + c] * fx;
+				p[c] = (unsigned char)(top * (1.0f - fy) + bottom * fy + 0.5f);
+			}
+		}
+	}
+	if (source)
+		stbi_image_free(source);
+	return result;
+}
+
+//Low flight over the plane, looking ahead, so near tiles need level 0 and far ones coarse levels
+static glm::mat4 cameraViewProjection(int frame) {
+	float t = (float)frame / FRAMES;
+	glm::vec3 position(sinf(t * 6.28f) * 30.0f, 4.0f, 50.0f - t * 100.0f);
+	glm::mat4 view = glm::lookAt(position, position + glm::vec3(0.2f, -0.3f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)bench::SCREEN_WIDTH / bench::SCREEN_HEIGHT, 0.1f, 500.0f);
+	return projection * view;
+}
+
+static void runVirtualTexture(GLFWwindow* window) {
+	std::vector<unsigned char> image = makeLargeImage();
+	const char* path = "benchVirtualTexture.vt";
+	ew::CpuTimer buildTimer;
+	buildTimer.start();
+	ew::buildVirtualTexture(path, image.data(), VIRTUAL_WIDTH, VIRTUAL_HEIGHT);
+	bench::report("build tile pyramid", buildTimer.stop());
+
+	std::string virtualSource = std::string("#version 450 core\n") + ew::virtualTextureGlsl();
+	unsigned int fullProgram = ew::createShaderProgram(vertexShaderSource, fullTextureFragmentSource);
+	unsigned int virtualProgram = ew::createShaderProgram(vertexShaderSource, (virtualSource + virtualFragmentMain).c_str());
+	unsigned int feedbackProgram = ew::createShaderProgram(vertexShaderSource, (virtualSource + feedbackFragmentMain).c_str());
+	bench::MeshBuffers plane = bench::createMeshBuffers(ew::createPlane(200.0f, 112.5f, 16));
+	glEnable(GL_DEPTH_TEST);
+
+	//Baseline: the whole image resident, decoded and uploaded up front
+	ew::CpuTimer uploadTimer;
+	uploadTimer.start();
+	int levels = 1;
+	while ((VIRTUAL_WIDTH >> levels) > 0)
+		levels++;
+	unsigned int fullTexture;
+	glGenTextures(1, &fullTexture);
+	glBindTexture(GL_TEXTURE_2D, fullTexture);
+	glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, VIRTUAL_WIDTH, VIRTUAL_HEIGHT);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, VIRTUAL_WIDTH, VIRTUAL_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glFinish();
+	char name[96];
+	size_t fullBytes = (size_t)VIRTUAL_WIDTH * VIRTUAL_HEIGHT * 4 * 4 / 3;
+	snprintf(name, sizeof(name), "upload full texture (%.0f MB)", fullBytes / (1024.0 * 1024.0));
+	bench::report(name, uploadTimer.stop());
+	image.clear();
+	image.shrink_to_fit();
+
+	int viewProjectionLocation[3] = {
+		glGetUniformLocation(fullProgram, "viewProjection"),
+		glGetUniformLocation(virtualProgram, "viewProjection"),
+		glGetUniformLocation(feedbackProgram, "viewProjection"),
+	};
+
+	{
+		ew::CpuTimer cpuTimer;
+		ew::GpuTimer gpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glm::mat4 viewProjection = cameraViewProjection(frame);
+			cpuTimer.start();
+			gpuTimer.begin();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glUseProgram(fullProgram);
+			glUniformMatrix4fv(viewProjectionLocation[0], 1, GL_FALSE, &viewProjection[0][0]);
+			glBindTextureUnit(0, fullTexture);
+			bench::drawMesh(plane);
+			gpuTimer.end();
+			cpuTotal += cpuTimer.stop();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		bench::report("full texture, per frame", cpuTotal / FRAMES, gpuTotal / FRAMES);
+	}
+	glDeleteTextures(1, &fullTexture);
+
+	{
+		ew::JobSystem jobs;
+		ew::VirtualTexture virtualTexture(path, jobs);
+		ew::CpuTimer cpuTimer;
+		ew::GpuTimer gpuTimer;
+		double cpuTotal = 0.0, gpuTotal = 0.0;
+		unsigned int maxUploads = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glm::mat4 viewProjection = cameraViewProjection(frame);
+			cpuTimer.start();
+			gpuTimer.begin();
+			virtualTexture.beginFeedback(bench::SCREEN_WIDTH, bench::SCREEN_HEIGHT);
+			glUseProgram(feedbackProgram);
+			glUniformMatrix4fv(viewProjectionLocation[2], 1, GL_FALSE, &viewProjection[0][0]);
+			bench::drawMesh(plane);
+			virtualTexture.endFeedback();
+			virtualTexture.update();
+			maxUploads = glm::max(maxUploads, virtualTexture.getStats().uploadsLastUpdate);
+
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glUseProgram(virtualProgram);
+			glUniformMatrix4fv(viewProjectionLocation[1], 1, GL_FALSE, &viewProjection[0][0]);
+			virtualTexture.bind();
+			bench::drawMesh(plane);
+			gpuTimer.end();
+			cpuTotal += cpuTimer.stop();
+			gpuTotal += gpuTimer.resolve();
+			glfwSwapBuffers(window);
+		}
+		const ew::VirtualTextureStats& stats = virtualTexture.getStats();
+		snprintf(name, sizeof(name), "virtual texture, per frame (%.0f MB resident)", virtualTexture.getResidentBytes() / (1024.0 * 1024.0));
+		bench::report(name, cpuTotal / FRAMES, gpuTotal / FRAMES);
+		printf("  %zu tiles loaded, %zu evicted, %u resident, at most %u uploads in a frame\n",
+			stats.tilesLoaded, stats.tilesEvicted, stats.residentTiles, maxUploads);
+	}
+
+	bench::deleteMeshBuffers(plane);
+	glDeleteProgram(fullProgram);
+	glDeleteProgram(virtualProgram);
+	glDeleteProgram(feedbackProgram);
+	glDisable(GL_DEPTH_TEST);
+	remove(path);
+}
+
+void benchVirtualTexture() {
+	GLFWwindow* window = bench::createContext();
+	if (!window)
+		return;
+	runVirtualTexture(window);
+	bench::destroyContext(window);
+}
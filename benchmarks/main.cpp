@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <string.h>
+
+//Each benchmark lives in its own bench*.cpp file
+void benchMultiDraw();
+void benchGpuCulling();
+void benchLod();
+void benchMeshlets();
+void benchSceneGraph();
+void benchEcs();
+void benchAllocators();
+void benchResources();
+void benchShaderBuild();
+void benchNormalMatrix();
+void benchClusteredLighting();
+void benchDeferred();
+void benchShadows();
+void benchRenderGraph();
+void benchPostProcess();
+void benchDynamicResolution();
+void benchSprites();
+void benchAtlas();
+void benchTextureArrays();
+void benchBlockCompression();
+void benchVirtualTexture();
+void benchFrameCapture();
+void benchAssetPack();
+
+struct Benchmark {
+	const char* name;
+	void (*run)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+	{ "multidraw", benchMultiDraw },
+	{ "gpucull", benchGpuCulling },
+	{ "lod", benchLod },
+	{ "meshlets", benchMeshlets },
+	{ "scenegraph", benchSceneGraph },
+	{ "ecs", benchEcs },
+	{ "allocators", benchAllocators },
+	{ "resources", benchResources },
+	{ "shaderbuild", benchShaderBuild },
+	{ "normalmatrix", benchNormalMatrix },
+	{ "clustered", benchClusteredLighting },
+	{ "deferred", benchDeferred },
+	{ "shadows", benchShadows },
+	{ "rendergraph", benchRenderGraph },
+	{ "postprocess", benchPostProcess },
+	{ "dynres", benchDynamicResolution },
+	{ "sprites", benchSprites },
+	{ "atlas", benchAtlas },
+	{ "texarrays", benchTextureArrays },
+	{ "bcencode", benchBlockCompression },
+	{ "virtualtexture", benchVirtualTexture },
+	{ "capture", benchFrameCapture },
+	{ "assetpack", benchAssetPack },
+};
+
+int main(int argc, char** argv) {
+	const int count = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+	if (argc > 1 && strcmp(argv[1], "--list") == 0) {
+		for (int i = 0; i < count; i++)
+			printf("%s\n", BENCHMARKS[i].name);
+		return 0;
+	}
+	//No arguments runs everything, otherwise only the named benchmarks
+	bool ranAny = false;
+	for (int i = 0; i < count; i++) {
+		bool selected = argc <= 1;
+		for (int a = 1; a < argc; a++) {
+			if (strcmp(argv[a], BENCHMARKS[i].name) == 0)
+				selected = true;
+		}
+		if (!selected)
+			continue;
+		printf("== %s ==\n", BENCHMARKS[i].name);
+		BENCHMARKS[i].run();
+		ranAny = true;
+	}
+	if (!ranAny) {
+		printf("No benchmark matched. Use --list to see available benchmarks.\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include "allocators.h"
+#include "profiler.h"
+#include <stdlib.h>
+
+namespace ew {
+	static uint8_t* alignPointer(uint8_t* ptr, size_t alignment) {
+		uintptr_t value = reinterpret_cast<uintptr_t>(ptr);
+		return reinterpret_cast<uint8_t*>((value + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	}
+
+	LinearArena::LinearArena(size_t blockSize)
+		: m_blockSize(blockSize) {
+	}
+
+	LinearArena::~LinearArena() {
+		for (Block& block : m_blocks)
+			free(block.data);
+	}
+
+	void* LinearArena::allocate(size_t size, size_t alignment) {
+		m_allocations++;
+		while (true) {
+			if (m_currentBlock < m_blocks.size()) {
+				Block& block = m_blocks[m_currentBlock];
+				uint8_t* start = alignPointer(block.data + m_offset, alignment);
+				if (start + size <= block.data + block.size) {
+					size_t used = (start + size) - (block.data + m_offset);
+					m_offset += used;
+					m_bytesUsed += used;
+					if (m_bytesUsed > m_highWater)
+						m_highWater = m_bytesUsed;
+					return start;
+				}
+				//Try the next retained block before allocating a new one
+				if (m_currentBlock + 1 < m_blocks.size()) {
+					m_currentBlock++;
+					m_offset = 0;
+					continue;
+				}
+			}
+			size_t blockSize = size + alignment > m_blockSize ? size + alignment : m_blockSize;
+			Block block = { static_cast<uint8_t*>(malloc(blockSize)), blockSize };
+			if (!block.data)
+				throw std::bad_alloc();
+			m_blocks.push_back(block);
+			m_currentBlock = m_blocks.size() - 1;
+			m_offset = 0;
+		}
+	}
+
+	void LinearArena::reset() {
+		m_currentBlock = 0;
+		m_offset = 0;
+		m_bytesUsed = 0;
+		m_allocations = 0;
+	}
+
+	size_t LinearArena::getCapacity() const {
+		size_t capacity = 0;
+		for (const Block& block : m_blocks)
+			capacity += block.size;
+		return capacity;
+	}
+
+	FrameArena::FrameArena(size_t blockSize)
+		: m_first(blockSize), m_second(blockSize) {
+	}
+
+	void FrameArena::beginFrame(const char* name) {
+		std::string prefix = name;
+		ProfilerCounters::set((prefix + ".allocations").c_str(), (long long)current().getAllocationCount());
+		ProfilerCounters::set((prefix + ".bytes").c_str(), (long long)current().getBytesUsed());
+		ProfilerCounters::set((prefix + ".capacity").c_str(), (long long)(m_first.getCapacity() + m_second.getCapacity()));
+		m_index ^= 1;
+		current().reset();
+	}
+
+	PoolAllocator::PoolAllocator(size_t blockSize, size_t alignment, size_t blocksPerPage)
+		: m_alignment(alignment), m_blocksPerPage(blocksPerPage) {
+		//Every block must hold the free list pointer and keep the next block aligned
+		if (blockSize < sizeof(void*))
+			blockSize = sizeof(void*);
+		m_blockSize = (blockSize + alignment - 1) & ~(alignment - 1);
+	}
+
+	PoolAllocator::~PoolAllocator() {
+		for (uint8_t* page : m_pages)
+			free(page);
+	}
+
+	void PoolAllocator::addPage() {
+		uint8_t* page = static_cast<uint8_t*>(malloc(m_blockSize * m_blocksPerPage + m_alignment));
+		if (!page)
+			throw std::bad_alloc();
+		m_pages.push_back(page);
+		uint8_t* first = alignPointer(page, m_alignment);
+		//Thread the new blocks onto the free list, lowest address first
+		for (size_t i = m_blocksPerPage; i-- > 0;) {
+			void* block = first + i * m_blockSize;
+			*static_cast<void**>(block) = m_freeList;
+			m_freeList = block;
+		}
+	}
+
+	void* PoolAllocator::allocate() {
+		if (!m_freeList)
+			addPage();
+		void* block = m_freeList;
+		m_freeList = *static_cast<void**>(block);
+		m_live++;
+		m_allocations++;
+		return block;
+	}
+
+	void PoolAllocator::deallocate(void* block) {
+		*static_cast<void**>(block) = m_freeList;
+		m_freeList = block;
+		m_live--;
+	}
+
+	void PoolAllocator::publishStats(const char* name) {
+		std::string prefix = name;
+		ProfilerCounters::set((prefix + ".allocations").c_str(), (long long)m_allocations);
+		ProfilerCounters::set((prefix + ".live").c_str(), (long long)m_live);
+		ProfilerCounters::set((prefix + ".pages").c_str(), (long long)m_pages.size());
+		m_allocations = 0;
+	}
+}
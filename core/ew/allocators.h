@@ -0,0 +1,133 @@
+#pragma once
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ew {
+	//Bump allocator. Allocation is a pointer increment; everything is released at once by reset().
+	//When the current block is full another block is chained on and kept for later frames, so
+	//after warm-up a frame performs no heap allocation at all. Not thread safe: use one per thread.
+	class LinearArena {
+	public:
+		explicit LinearArena(size_t blockSize = 1 << 20);
+		~LinearArena();
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		void* allocate(size_t size, size_t alignment = alignof(max_align_t));
+		template<typename T>
+		T* allocateArray(size_t count) { return static_cast<T*>(allocate(sizeof(T) * count, alignof(T))); }
+		//Releases every allocation. Destructors are not run; store trivially destructible data.
+		void reset();
+
+		size_t getBytesUsed() const { return m_bytesUsed; }
+		size_t getHighWater() const { return m_highWater; }
+		size_t getAllocationCount() const { return m_allocations; }
+		size_t getCapacity() const;
+
+	private:
+		struct Block {
+			uint8_t* data;
+			size_t size;
+		};
+		size_t m_blockSize;
+		std::vector<Block> m_blocks;
+		size_t m_currentBlock = 0;
+		size_t m_offset = 0;
+		size_t m_bytesUsed = 0;
+		size_t m_highWater = 0;
+		size_t m_allocations = 0;
+	};
+
+	//Two arenas used alternately. Data allocated in frame N stays valid through frame N + 1,
+	//which covers anything read back a frame late (e.g. data the GPU consumes next frame).
+	class FrameArena {
+	public:
+		explicit FrameArena(size_t blockSize = 1 << 20);
+		//Swaps arenas and resets the one becoming current. Publishes the finished frame's
+		//allocation count and bytes to ProfilerCounters under name.
+		void beginFrame(const char* name = "frameArena");
+		LinearArena& current() { return m_index == 0 ? m_first : m_second; }
+		LinearArena& previous() { return m_index == 0 ? m_second : m_first; }
+		void* allocate(size_t size, size_t alignment = alignof(max_align_t)) { return current().allocate(size, alignment); }
+	private:
+		LinearArena m_first;
+		LinearArena m_second;
+		int m_index = 0;
+	};
+
+	//Fixed-size block allocator with an intrusive free list. Grows a page at a time and
+	//never returns pages to the system, so recycled objects cost a pointer swap.
+	class PoolAllocator {
+	public:
+		PoolAllocator(size_t blockSize, size_t alignment = alignof(max_align_t), size_t blocksPerPage = 256);
+		~PoolAllocator();
+		PoolAllocator(const PoolAllocator&) = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+		void* allocate();
+		void deallocate(void* block);
+
+		size_t getLiveCount() const { return m_live; }
+		size_t getPageCount() const { return m_pages.size(); }
+		//Allocations since the last publish, reported to ProfilerCounters under name
+		void publishStats(const char* name);
+
+	private:
+		void addPage();
+		size_t m_blockSize;
+		size_t m_alignment;
+		size_t m_blocksPerPage;
+		std::vector<uint8_t*> m_pages;
+		void* m_freeList = nullptr;
+		size_t m_live = 0;
+		size_t m_allocations = 0;
+	};
+
+	//Typed front end for PoolAllocator that constructs and destroys objects
+	template<typename T>
+	class ObjectPool {
+	public:
+		explicit ObjectPool(size_t objectsPerPage = 256)
+			: m_pool(sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T), alignof(T) < alignof(void*) ? alignof(void*) : alignof(T), objectsPerPage) {}
+		template<typename... Args>
+		T* create(Args&&... args) { return new (m_pool.allocate()) T(std::forward<Args>(args)...); }
+		void destroy(T* object) {
+			if (!object)
+				return;
+			object->~T();
+			m_pool.deallocate(object);
+		}
+		PoolAllocator& getAllocator() { return m_pool; }
+	private:
+		PoolAllocator m_pool;
+	};
+
+	//STL allocator drawing from a LinearArena. deallocate is a no-op; memory comes back on reset.
+	//Containers using it must not outlive the arena's next reset.
+	template<typename T>
+	class ArenaAllocator {
+	public:
+		typedef T value_type;
+		ArenaAllocator(LinearArena& arena) : m_arena(&arena) {}
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.getArena()) {}
+
+		T* allocate(size_t count) { return m_arena->allocateArray<T>(count); }
+		void deallocate(T*, size_t) {}
+		LinearArena* getArena() const { return m_arena; }
+
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& other) const { return m_arena == other.getArena(); }
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const { return m_arena != other.getArena(); }
+	private:
+		LinearArena* m_arena;
+	};
+
+	//Scratch vector for per-frame lists (culling results, commands, sort keys)
+	template<typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
@@ -0,0 +1,426 @@
+#include "assetPack.h"
+#include "jobSystem.h"
+#include "lzCompression.h"
+#include "shaderPreprocessor.h"
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ew {
+	static const uint32_t PACK_MAGIC = 0x4B505745; //"EWPK"
+	static const uint32_t PACK_VERSION = 1;
+	static const size_t PACK_ALIGNMENT = 16;
+	static const uint32_t STORED_BLOCK_BIT = 0x80000000u;
+	//A match costs at least one byte per 255 it produces, so no valid entry expands further
+	static const uint64_t MAX_EXPANSION = 256;
+	static_assert(sizeof(PackEntry) == 48, "PackEntry is written to disk as is");
+
+	struct PackHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t pathBytes;
+	};
+
+	std::string normalizePackPath(const std::string& path) {
+		std::string normalized = path;
+		std::replace(normalized.begin(), normalized.end(), '\\', '/');
+		while (normalized.compare(0, 2, "./") == 0)
+			normalized.erase(0, 2);
+		return normalized;
+	}
+
+	static bool readFile(const std::string& path, std::vector<unsigned char>& data) {
+		FILE* file = fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		data.resize(size > 0 ? (size_t)size : 0);
+		bool ok = size >= 0 && fread(data.data(), 1, data.size(), file) == data.size();
+		fclose(file);
+		return ok;
+	}
+
+	//Block table then blocks, or the data as is when compression doesn't pay
+	static PackCompression compressEntry(const std::vector<unsigned char>& data, std::vector<unsigned char>& stored) {
+		size_t blockCount = (data.size() + PACK_BLOCK_SIZE - 1) / PACK_BLOCK_SIZE;
+		stored.assign(blockCount * sizeof(uint32_t), 0);
+		std::vector<unsigned char> block(PACK_BLOCK_SIZE);
+		for (size_t b = 0; b < blockCount; b++) {
+			size_t begin = b * PACK_BLOCK_SIZE;
+			size_t size = std::min(PACK_BLOCK_SIZE, data.size() - begin);
+			//Capacity one short of the input, so anything that doesn't shrink comes back as 0
+			size_t compressedSize = lzCompress(&data[begin], size, block.data(), size - 1);
+			uint32_t tableValue;
+			if (compressedSize == 0) {
+				stored.insert(stored.end(), data.begin() + begin, data.begin() + begin + size);
+				tableValue = (uint32_t)size | STORED_BLOCK_BIT;
+			}
+			else {
+				stored.insert(stored.end(), block.begin(), block.begin() + compressedSize);
+				tableValue = (uint32_t)compressedSize;
+			}
+			memcpy(&stored[b * sizeof(uint32_t)], &tableValue, sizeof(uint32_t));
+		}
+		if (data.empty() || stored.size() > data.size() - data.size() / 8) {
+			stored = data;
+			return PackCompression::None;
+		}
+		return PackCompression::LZ;
+	}
+
+	void AssetPackBuilder::addFile(const std::string& packPath, const std::string& filePath, bool compress) {
+		Input input;
+		input.packPath = normalizePackPath(packPath);
+		input.filePath = filePath;
+		input.compress = compress;
+		m_inputs.push_back(std::move(input));
+	}
+
+	void AssetPackBuilder::addData(const std::string& packPath, std::vector<unsigned char> data, bool compress) {
+		Input input;
+		input.packPath = normalizePackPath(packPath);
+		input.data = std::move(data);
+		input.compress = compress;
+		m_inputs.push_back(std::move(input));
+	}
+
+	bool AssetPackBuilder::write(const std::string& path, JobSystem* jobs) {
+		struct Built {
+			const Input* input;
+			uint64_t hash;
+			std::vector<unsigned char> stored;
+			PackCompression compression;
+			uint64_t size;
+		};
+		std::vector<Built> built(m_inputs.size());
+		for (size_t i = 0; i < m_inputs.size(); i++) {
+			built[i].input = &m_inputs[i];
+			built[i].hash = hashString(m_inputs[i].packPath);
+		}
+
+		std::atomic<bool> readFailed{ false };
+		auto buildRange = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const Input& input = m_inputs[i];
+				std::vector<unsigned char> fileData;
+				if (!input.filePath.empty() && !readFile(input.filePath, fileData)) {
+					printf("ERROR::PACK::Failed to read %s\n", input.filePath.c_str());
+					readFailed = true;
+					continue;
+				}
+				const std::vector<unsigned char>& data = input.filePath.empty() ? input.data : fileData;
+				built[i].size = data.size();
+				if (input.compress) {
+					built[i].compression = compressEntry(data, built[i].stored);
+				}
+				else {
+					built[i].compression = PackCompression::None;
+					built[i].stored = data;
+				}
+			}
+		};
+		if (jobs)
+			jobs->parallelFor(built.size(), 1, buildRange);
+		else
+			buildRange(0, built.size());
+		if (readFailed)
+			return false;
+
+		std::sort(built.begin(), built.end(), [](const Built& a, const Built& b) {
+			return a.hash != b.hash ? a.hash < b.hash : a.input->packPath < b.input->packPath;
+		});
+		for (size_t i = 1; i < built.size(); i++) {
+			if (built[i].hash == built[i - 1].hash) {
+				printf("ERROR::PACK::%s and %s have the same path hash\n", built[i - 1].input->packPath.c_str(), built[i].input->packPath.c_str());
+				return false;
+			}
+		}
+
+		std::vector<PackEntry> entries(built.size());
+		std::string paths;
+		for (size_t i = 0; i < built.size(); i++) {
+			entries[i].pathHash = built[i].hash;
+			entries[i].pathOffset = (uint32_t)paths.size();
+			entries[i].pathLength = (uint32_t)built[i].input->packPath.size();
+			entries[i].compression = built[i].compression;
+			entries[i].size = built[i].size;
+			entries[i].storedSize = built[i].stored.size();
+			entries[i].reserved = 0;
+			paths += built[i].input->packPath;
+		}
+		uint64_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry) + paths.size();
+		for (PackEntry& entry : entries) {
+			offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+			entry.offset = offset;
+			offset += entry.storedSize;
+		}
+
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file) {
+			printf("ERROR::PACK::Failed to open %s for writing\n", path.c_str());
+			return false;
+		}
+		PackHeader header = { PACK_MAGIC, PACK_VERSION, (uint32_t)entries.size(), (uint32_t)paths.size() };
+		bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+		ok = ok && fwrite(entries.data(), sizeof(PackEntry), entries.size(), file) == entries.size();
+		ok = ok && fwrite(paths.data(), 1, paths.size(), file) == paths.size();
+		uint64_t written = sizeof(PackHeader) + entries.size() * sizeof(PackEntry) + paths.size();
+		const unsigned char padding[PACK_ALIGNMENT] = {};
+		for (size_t i = 0; i < built.size() && ok; i++) {
+			ok = fwrite(padding, 1, (size_t)(entries[i].offset - written), file) == entries[i].offset - written;
+			ok = ok && (built[i].stored.empty() || fwrite(built[i].stored.data(), 1, built[i].stored.size(), file) == built[i].stored.size());
+			written = entries[i].offset + entries[i].storedSize;
+		}
+		fclose(file);
+		if (!ok)
+			printf("ERROR::PACK::Failed to write %s\n", path.c_str());
+		return ok;
+	}
+
+	AssetPack::~AssetPack() {
+		close();
+	}
+
+	bool AssetPack::open(const std::string& path) {
+		close();
+		//Handles can be closed once the view exists; the mapping keeps the file open
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			printf("ERROR::PACK::Failed to open %s\n", path.c_str());
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(file, &fileSize);
+		HANDLE mapping = fileSize.QuadPart > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+		void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+		if (mapping)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		size_t size = (size_t)fileSize.QuadPart;
+#else
+		int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0) {
+			printf("ERROR::PACK::Failed to open %s\n", path.c_str());
+			return false;
+		}
+		struct stat info;
+		size_t size = fstat(file, &info) == 0 ? (size_t)info.st_size : 0;
+		void* data = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+		::close(file);
+		if (data == MAP_FAILED)
+			data = nullptr;
+#endif
+		if (!data) {
+			printf("ERROR::PACK::Failed to map %s\n", path.c_str());
+			return false;
+		}
+		m_data = (const unsigned char*)data;
+		m_size = size;
+
+		PackHeader header;
+		bool valid = m_size >= sizeof(header);
+		if (valid) {
+			memcpy(&header, m_data, sizeof(header));
+			valid = header.magic == PACK_MAGIC && header.version == PACK_VERSION
+				&& sizeof(header) + (uint64_t)header.entryCount * sizeof(PackEntry) + header.pathBytes <= m_size;
+		}
+		if (valid) {
+			m_entries = (const PackEntry*)(m_data + sizeof(header));
+			m_entryCount = header.entryCount;
+			m_paths = (const char*)(m_entries + m_entryCount);
+			for (size_t i = 0; i < m_entryCount && valid; i++) {
+				const PackEntry& entry = m_entries[i];
+				valid = (uint64_t)entry.pathOffset + entry.pathLength <= header.pathBytes
+					&& entry.offset <= m_size && entry.storedSize <= m_size - entry.offset
+					&& (entry.compression == PackCompression::None ? entry.storedSize == entry.size
+						: entry.compression == PackCompression::LZ && entry.size / MAX_EXPANSION <= entry.storedSize)
+					&& (i == 0 || m_entries[i - 1].pathHash < entry.pathHash);
+			}
+		}
+		if (!valid) {
+			printf("ERROR::PACK::%s is not a valid asset pack\n", path.c_str());
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void AssetPack::close() {
+		if (m_data) {
+#ifdef _WIN32
+			UnmapViewOfFile(m_data);
+#else
+			munmap((void*)m_data, m_size);
+#endif
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_entries = nullptr;
+		m_entryCount = 0;
+		m_paths = nullptr;
+	}
+
+	const PackEntry* AssetPack::find(const std::string& path) const {
+		if (!m_data)
+			return nullptr;
+		std::string normalized = normalizePackPath(path);
+		uint64_t hash = hashString(normalized);
+		const PackEntry* end = m_entries + m_entryCount;
+		const PackEntry* entry = std::lower_bound(m_entries, end, hash, [](const PackEntry& e, uint64_t value) {
+			return e.pathHash < value;
+		});
+		//The hash only finds the candidate; the stored path rules out collisions with unknown names
+		if (entry == end || entry->pathHash != hash || entry->pathLength != normalized.size()
+			|| memcmp(m_paths + entry->pathOffset, normalized.data(), normalized.size()) != 0)
+			return nullptr;
+		return entry;
+	}
+
+	size_t AssetPack::getSize(const std::string& path) const {
+		const PackEntry* entry = find(path);
+		return entry ? (size_t)entry->size : 0;
+	}
+
+	const unsigned char* AssetPack::view(const std::string& path, size_t* size) const {
+		const PackEntry* entry = find(path);
+		if (!entry || entry->compression != PackCompression::None)
+			return nullptr;
+		if (size)
+			*size = (size_t)entry->size;
+		return m_data + entry->offset;
+	}
+
+	std::vector<uint64_t> AssetPack::blockOffsets(const PackEntry& entry) const {
+		size_t blockCount = (size_t)((entry.size + PACK_BLOCK_SIZE - 1) / PACK_BLOCK_SIZE);
+		uint64_t tableBytes = (uint64_t)blockCount * sizeof(uint32_t);
+		if (tableBytes > entry.storedSize)
+			return std::vector<uint64_t>();
+		std::vector<uint64_t> offsets(blockCount + 1);
+		offsets[0] = tableBytes;
+		const unsigned char* table = m_data + entry.offset;
+		for (size_t b = 0; b < blockCount; b++) {
+			uint32_t value;
+			memcpy(&value, table + b * sizeof(uint32_t), sizeof(uint32_t));
+			offsets[b + 1] = offsets[b] + (value & ~STORED_BLOCK_BIT);
+		}
+		if (offsets[blockCount] != entry.storedSize)
+			return std::vector<uint64_t>();
+		return offsets;
+	}
+
+	bool AssetPack::decodeBlock(const PackEntry& entry, const std::vector<uint64_t>& offsets, size_t block, unsigned char* out) const {
+		size_t begin = block * PACK_BLOCK_SIZE;
+		size_t size = std::min(PACK_BLOCK_SIZE, (size_t)entry.size - begin);
+		const unsigned char* src = m_data + entry.offset + offsets[block];
+		size_t srcSize = (size_t)(offsets[block + 1] - offsets[block]);
+		uint32_t tableValue;
+		memcpy(&tableValue, m_data + entry.offset + block * sizeof(uint32_t), sizeof(uint32_t));
+		if (tableValue & STORED_BLOCK_BIT) {
+			if (srcSize != size)
+				return false;
+			memcpy(out + begin, src, size);
+			return true;
+		}
+		return lzDecompress(src, srcSize, out + begin, size);
+	}
+
+	bool AssetPack::read(const std::string& path, std::vector<unsigned char>& out, JobSystem* jobs) const {
+		const PackEntry* entry = find(path);
+		if (!entry)
+			return false;
+		out.resize((size_t)entry->size);
+		if (entry->compression == PackCompression::None) {
+			if (!out.empty())
+				memcpy(out.data(), m_data + entry->offset, out.size());
+			return true;
+		}
+		std::vector<uint64_t> offsets = blockOffsets(*entry);
+		if (offsets.empty()) {
+			printf("ERROR::PACK::Corrupt block table in %s\n", path.c_str());
+			return false;
+		}
+		std::atomic<bool> ok{ true };
+		auto decodeRange = [&](size_t begin, size_t end) {
+			for (size_t b = begin; b < end; b++) {
+				if (!decodeBlock(*entry, offsets, b, out.data()))
+					ok = false;
+			}
+		};
+		if (jobs)
+			jobs->parallelFor(offsets.size() - 1, 1, decodeRange);
+		else
+			decodeRange(0, offsets.size() - 1);
+		if (!ok)
+			printf("ERROR::PACK::Corrupt data in %s\n", path.c_str());
+		return ok;
+	}
+
+	bool AssetPack::readMany(const std::vector<std::string>& paths, std::vector<std::vector<unsigned char>>& out, JobSystem& jobs) const {
+		out.resize(paths.size());
+		//Kept alive here until every job has finished with them
+		std::vector<std::vector<uint64_t>> offsets(paths.size());
+		std::atomic<bool> ok{ true };
+		JobCounter counter;
+		for (size_t i = 0; i < paths.size(); i++) {
+			const PackEntry* entry = find(paths[i]);
+			if (!entry) {
+				ok = false;
+				out[i].clear();
+				continue;
+			}
+			out[i].resize((size_t)entry->size);
+			unsigned char* destination = out[i].data();
+			if (out[i].empty())
+				continue;
+			if (entry->compression == PackCompression::None) {
+				//Still a job: the copy is where the mapping pages in from disk
+				const unsigned char* source = m_data + entry->offset;
+				size_t size = out[i].size();
+				jobs.submit([destination, source, size]() { memcpy(destination, source, size); }, &counter);
+				continue;
+			}
+			offsets[i] = blockOffsets(*entry);
+			if (offsets[i].empty()) {
+				printf("ERROR::PACK::Corrupt block table in %s\n", paths[i].c_str());
+				ok = false;
+				continue;
+			}
+			const std::vector<uint64_t>* entryOffsets = &offsets[i];
+			for (size_t b = 0; b + 1 < offsets[i].size(); b++) {
+				jobs.submit([this, entry, entryOffsets, b, destination, &ok]() {
+					if (!decodeBlock(*entry, *entryOffsets, b, destination))
+						ok = false;
+				}, &counter);
+			}
+		}
+		jobs.wait(counter);
+		return ok;
+	}
+
+	std::string AssetPack::readText(const std::string& path) const {
+		std::vector<unsigned char> data;
+		if (!read(path, data))
+			return std::string();
+		return std::string(data.begin(), data.end());
+	}
+
+	std::string AssetPack::getPath(size_t index) const {
+		const PackEntry& entry = m_entries[index];
+		return std::string(m_paths + entry.pathOffset, entry.pathLength);
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ew {
+	class JobSystem;
+
+	enum class PackCompression : uint32_t {
+		None,
+		//lzCompression, in independently decodable blocks of PACK_BLOCK_SIZE
+		LZ
+	};
+
+	//Uncompressed bytes per compressed block; the unit of parallel decompression
+	const size_t PACK_BLOCK_SIZE = 64 * 1024;
+
+	//Pack layout, native endianness:
+	//  uint32 magic "EWPK", version, entryCount, pathBytes
+	//  PackEntry[entryCount], sorted by pathHash
+	//  char paths[pathBytes], the entries' paths without terminators
+	//  entry data, each entry starting on a 16 byte boundary
+	//A compressed entry is uint32 blockSizes[ceil(size / PACK_BLOCK_SIZE)] followed by the
+	//blocks. A block size with the top bit set marks a block stored as is.
+	struct PackEntry {
+		//hashString() of the normalized path
+		uint64_t pathHash;
+		uint64_t offset;
+		//Bytes in the file
+		uint64_t storedSize;
+		//Bytes once decompressed
+		uint64_t size;
+		uint32_t pathOffset;
+		uint32_t pathLength;
+		PackCompression compression;
+		uint32_t reserved;
+	};
+
+	//Forward slashes, no leading "./", so "assets\\a.png" and "./assets/a.png" name the same entry
+	std::string normalizePackPath(const std::string& path);
+
+	//Collects files and writes them as one pack
+	class AssetPackBuilder {
+	public:
+		//Compressed entries fall back to stored when LZ saves less than an eighth, which keeps
+		//already compressed data (PNG, JPG) zero-copy
+		void addFile(const std::string& packPath, const std::string& filePath, bool compress = true);
+		void addData(const std::string& packPath, std::vector<unsigned char> data, bool compress = true);
+		//Compresses entries on jobs when given. Returns false after printing an error if a file
+		//can't be read or written, or two entries have the same path or path hash.
+		bool write(const std::string& path, JobSystem* jobs = nullptr);
+		size_t getEntryCount() const { return m_inputs.size(); }
+
+	private:
+		struct Input {
+			std::string packPath;
+			std::string filePath;
+			std::vector<unsigned char> data;
+			bool compress;
+		};
+		std::vector<Input> m_inputs;
+	};
+
+	//Read-only view of a pack through a memory mapping, so opening it costs one open and
+	//the OS pages in only the entries that are touched
+	class AssetPack {
+	public:
+		AssetPack() = default;
+		explicit AssetPack(const std::string& path) { open(path); }
+		~AssetPack();
+		AssetPack(const AssetPack&) = delete;
+		AssetPack& operator=(const AssetPack&) = delete;
+
+		//Maps the pack and validates its index. Returns false after printing an error.
+		bool open(const std::string& path);
+		void close();
+		bool isOpen() const { return m_data != nullptr; }
+
+		bool contains(const std::string& path) const { return find(path) != nullptr; }
+		//Decompressed size, 0 for missing entries
+		size_t getSize(const std::string& path) const;
+		//Zero-copy pointer into the mapping, valid until close(). nullptr for missing entries
+		//and entries stored compressed, which need read().
+		const unsigned char* view(const std::string& path, size_t* size = nullptr) const;
+		//Copies or decompresses an entry. With jobs, the blocks of a compressed entry are
+		//decompressed in parallel. Returns false for missing or corrupt entries.
+		bool read(const std::string& path, std::vector<unsigned char>& out, JobSystem* jobs = nullptr) const;
+		//Reads several entries at once with every block of every entry as its own job, which
+		//keeps workers busy even when each entry is small. Returns false if any entry failed.
+		bool readMany(const std::vector<std::string>& paths, std::vector<std::vector<unsigned char>>& out, JobSystem& jobs) const;
+		//Entry as a string, e.g. a shader source. Empty if missing.
+		std::string readText(const std::string& path) const;
+
+		size_t getEntryCount() const { return m_entryCount; }
+		const PackEntry& getEntry(size_t index) const { return m_entries[index]; }
+		std::string getPath(size_t index) const;
+
+	private:
+		const PackEntry* find(const std::string& path) const;
+		//Offsets of each block's data relative to the entry, plus the end; empty if the block table is corrupt
+		std::vector<uint64_t> blockOffsets(const PackEntry& entry) const;
+		bool decodeBlock(const PackEntry& entry, const std::vector<uint64_t>& offsets, size_t block, unsigned char* out) const;
+
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+		const PackEntry* m_entries = nullptr;
+		size_t m_entryCount = 0;
+		const char* m_paths = nullptr;
+	};
+}
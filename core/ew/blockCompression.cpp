@@ -0,0 +1,561 @@
+#include "blockCompression.h"
+#include "jobSystem.h"
+#include "external/glad.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EW_BLOCK_COMPRESSION_SSE
+#include <emmintrin.h>
+#endif
+
+//S3TC is an extension, so the core profile header leaves these out
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace ew {
+	static const uint32_t COMPRESSED_MAGIC = 0x43425745; //"EWBC"
+	static const uint32_t COMPRESSED_VERSION = 1;
+
+	size_t blockBytes(BlockFormat format) {
+		return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+	}
+
+	int blockChannels(BlockFormat format) {
+		switch (format) {
+		case BlockFormat::BC1: return 3;
+		case BlockFormat::BC3: return 4;
+		case BlockFormat::BC4: return 1;
+		default: return 2;
+		}
+	}
+
+	static uint16_t quantize565(const float color[3]) {
+		int r = std::min(std::max((int)(color[0] * 31.0f / 255.0f + 0.5f), 0), 31);
+		int g = std::min(std::max((int)(color[1] * 63.0f / 255.0f + 0.5f), 0), 63);
+		int b = std::min(std::max((int)(color[2] * 31.0f / 255.0f + 0.5f), 0), 31);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static void expand565(uint16_t color, int out[3]) {
+		int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+		out[0] = (r << 3) | (r >> 2);
+		out[1] = (g << 2) | (g >> 4);
+		out[2] = (b << 3) | (b >> 2);
+	}
+
+	//Palette as decoded in four-color mode (c0 > c1)
+	static void colorPalette(uint16_t c0, uint16_t c1, float palette[4][3]) {
+		int a[3], b[3];
+		expand565(c0, a);
+		expand565(c1, b);
+		for (int c = 0; c < 3; c++) {
+			palette[0][c] = (float)a[c];
+			palette[1][c] = (float)b[c];
+			palette[2][c] = (float)((2 * a[c] + b[c]) / 3);
+			palette[3][c] = (float)((a[c] + 2 * b[c]) / 3);
+		}
+	}
+
+	//Picks the nearest palette entry for every texel. Returns the summed squared error.
+#ifdef EW_BLOCK_COMPRESSION_SSE
+	static float fitIndices(const float* r, const float* g, const float* b, const float palette[4][3], uint32_t& indices) {
+		__m128 total = _mm_setzero_ps();
+		indices = 0;
+		for (int group = 0; group < 4; group++) {
+			__m128 pr = _mm_loadu_ps(r + group * 4);
+			__m128 pg = _mm_loadu_ps(g + group * 4);
+			__m128 pb = _mm_loadu_ps(b + group * 4);
+			__m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+			__m128i bestIndex = _mm_setzero_si128();
+			for (int k = 0; k < 4; k++) {
+				__m128 dr = _mm_sub_ps(pr, _mm_set1_ps(palette[k][0]));
+				__m128 dg = _mm_sub_ps(pg, _mm_set1_ps(palette[k][1]));
+				__m128 db = _mm_sub_ps(pb, _mm_set1_ps(palette[k][2]));
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+				best = _mm_min_ps(distance, best);
+				bestIndex = _mm_or_si128(_mm_andnot_si128(closer, bestIndex), _mm_and_si128(closer, _mm_set1_epi32(k)));
+			}
+			total = _mm_add_ps(total, best);
+			int lanes[4];
+			_mm_storeu_si128((__m128i*)lanes, bestIndex);
+			for (int i = 0; i < 4; i++)
+				indices |= (uint32_t)lanes[i] << ((group * 4 + i) * 2);
+		}
+		float sums[4];
+		_mm_storeu_ps(sums, total);
+		return sums[0] + sums[1] + sums[2] + sums[3];
+	}
+#else
+	static float fitIndices(const float* r, const float* g, const float* b, const float palette[4][3], uint32_t& indices) {
+		float total = 0.0f;
+		indices = 0;
+		for (int i = 0; i < 16; i++) {
+			float best = std::numeric_limits<float>::max();
+			uint32_t bestIndex = 0;
+			for (uint32_t k = 0; k < 4; k++) {
+				float dr = r[i] - palette[k][0], dg = g[i] - palette[k][1], db = b[i] - palette[k][2];
+				float distance = dr * dr + dg * dg + db * db;
+				if (distance < best) {
+					best = distance;
+					bestIndex = k;
+				}
+			}
+			total += best;
+			indices |= bestIndex << (i * 2);
+		}
+		return total;
+	}
+#endif
+
+	//BC1 color block: endpoints along the principal axis of the texels, then one least squares
+	//refinement of the endpoints for the indices that axis produced
+	static void encodeColorBlock(const unsigned char* texels, unsigned char* out) {
+		float r[16], g[16], b[16];
+		float mean[3] = { 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++) {
+			r[i] = texels[i * 4 + 0];
+			g[i] = texels[i * 4 + 1];
+			b[i] = texels[i * 4 + 2];
+			mean[0] += r[i];
+			mean[1] += g[i];
+			mean[2] += b[i];
+		}
+		for (int c = 0; c < 3; c++)
+			mean[c] /= 16.0f;
+
+		//Covariance rr, rg, rb, gg, gb, bb
+		float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++) {
+			float dr = r[i] - mean[0], dg = g[i] - mean[1], db = b[i] - mean[2];
+			cov[0] += dr * dr;
+			cov[1] += dr * dg;
+			cov[2] += dr * db;
+			cov[3] += dg * dg;
+			cov[4] += dg * db;
+			cov[5] += db * db;
+		}
+		//Power iteration, started from the covariance row with the largest variance
+		float axis[3];
+		if (cov[0] >= cov[3] && cov[0] >= cov[5]) {
+			axis[0] = cov[0]; axis[1] = cov[1]; axis[2] = cov[2];
+		}
+		else if (cov[3] >= cov[5]) {
+			axis[0] = cov[1]; axis[1] = cov[3]; axis[2] = cov[4];
+		}
+		else {
+			axis[0] = cov[2]; axis[1] = cov[4]; axis[2] = cov[5];
+		}
+		for (int iteration = 0; iteration < 8; iteration++) {
+			float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+			float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+			float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+			float largest = std::max(fabsf(x), std::max(fabsf(y), fabsf(z)));
+			if (largest < 1e-6f)
+				break;
+			axis[0] = x / largest;
+			axis[1] = y / largest;
+			axis[2] = z / largest;
+		}
+		float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		for (int c = 0; c < 3; c++)
+			axis[c] = length > 1e-6f ? axis[c] / length : 0.0f;
+
+		float minT = std::numeric_limits<float>::max(), maxT = -minT;
+		for (int i = 0; i < 16; i++) {
+			float t = (r[i] - mean[0]) * axis[0] + (g[i] - mean[1]) * axis[1] + (b[i] - mean[2]) * axis[2];
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+		//Pull the endpoints in slightly; extreme texels then land on the interpolated entries
+		float inset = (maxT - minT) / 16.0f;
+		float end0[3], end1[3];
+		for (int c = 0; c < 3; c++) {
+			end0[c] = mean[c] + axis[c] * (maxT - inset);
+			end1[c] = mean[c] + axis[c] * (minT + inset);
+		}
+		uint16_t c0 = quantize565(end0), c1 = quantize565(end1);
+		float palette[4][3];
+		colorPalette(c0, c1, palette);
+		uint32_t indices;
+		float error = fitIndices(r, g, b, palette, indices);
+
+		//Solve for the endpoints minimizing error with these indices fixed
+		static const float WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++) {
+			float wa = WEIGHTS[(indices >> (i * 2)) & 3], wb = 1.0f - wa;
+			aa += wa * wa;
+			bb += wb * wb;
+			ab += wa * wb;
+			const float texel[3] = { r[i], g[i], b[i] };
+			for (int c = 0; c < 3; c++) {
+				ax[c] += wa * texel[c];
+				bx[c] += wb * texel[c];
+			}
+		}
+		float det = aa * bb - ab * ab;
+		if (fabsf(det) > 1e-6f) {
+			for (int c = 0; c < 3; c++) {
+				end0[c] = (ax[c] * bb - bx[c] * ab) / det;
+				end1[c] = (bx[c] * aa - ax[c] * ab) / det;
+			}
+			uint16_t refined0 = quantize565(end0), refined1 = quantize565(end1);
+			float refinedPalette[4][3];
+			colorPalette(refined0, refined1, refinedPalette);
+			uint32_t refinedIndices;
+			float refinedError = fitIndices(r, g, b, refinedPalette, refinedIndices);
+			if (refinedError < error) {
+				c0 = refined0;
+				c1 = refined1;
+				indices = refinedIndices;
+			}
+		}
+
+		//Four-color mode needs c0 > c1. Swapping the endpoints swaps entries 0/1 and 2/3.
+		if (c0 < c1) {
+			std::swap(c0, c1);
+			indices ^= 0x55555555u;
+		}
+		else if (c0 == c1) {
+			indices = 0;
+		}
+		out[0] = (unsigned char)(c0 & 0xFF);
+		out[1] = (unsigned char)(c0 >> 8);
+		out[2] = (unsigned char)(c1 & 0xFF);
+		out[3] = (unsigned char)(c1 >> 8);
+		for (int i = 0; i < 4; i++)
+			out[4 + i] = (unsigned char)(indices >> (i * 8));
+	}
+
+	//BC4 block for one channel, also the alpha half of BC3 and each half of BC5. Eight-value
+	//mode spaces the palette evenly between the extremes, so the nearest entry is a rounding.
+	static void encodeChannelBlock(const unsigned char* texels, int channel, unsigned char* out) {
+		int low = 255, high = 0;
+		for (int i = 0; i < 16; i++) {
+			low = std::min(low, (int)texels[i * 4 + channel]);
+			high = std::max(high, (int)texels[i * 4 + channel]);
+		}
+		out[0] = (unsigned char)high;
+		out[1] = (unsigned char)low;
+		uint64_t bits = 0;
+		if (high > low) {
+			int range = high - low;
+			for (int i = 0; i < 16; i++) {
+				//Steps up from low, 0..7
+				int step = ((texels[i * 4 + channel] - low) * 14 + range) / (range * 2);
+				uint64_t index = step == 7 ? 0 : step == 0 ? 1 : (uint64_t)(8 - step);
+				bits |= index << (i * 3);
+			}
+		}
+		for (int i = 0; i < 6; i++)
+			out[2 + i] = (unsigned char)(bits >> (i * 8));
+	}
+
+	static void decodeColorBlock(const unsigned char* in, unsigned char* texels) {
+		uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8));
+		uint16_t c1 = (uint16_t)(in[2] | (in[3] << 8));
+		uint32_t indices = (uint32_t)in[4] | ((uint32_t)in[5] << 8) | ((uint32_t)in[6] << 16) | ((uint32_t)in[7] << 24);
+		int a[3], b[3], palette[4][3];
+		expand565(c0, a);
+		expand565(c1, b);
+		for (int c = 0; c < 3; c++) {
+			palette[0][c] = a[c];
+			palette[1][c] = b[c];
+			if (c0 > c1) {
+				palette[2][c] = (2 * a[c] + b[c]) / 3;
+				palette[3][c] = (a[c] + 2 * b[c]) / 3;
+			}
+			else {
+				palette[2][c] = (a[c] + b[c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		for (int i = 0; i < 16; i++) {
+			const int* color = palette[(indices >> (i * 2)) & 3];
+			for (int c = 0; c < 3; c++)
+				texels[i * 4 + c] = (unsigned char)color[c];
+			texels[i * 4 + 3] = 255;
+		}
+	}
+
+	static void decodeChannelBlock(const unsigned char* in, int channel, unsigned char* texels) {
+		int a = in[0], b = in[1];
+		int palette[8] = { a, b };
+		if (a > b) {
+			for (int i = 2; i < 8; i++)
+				palette[i] = ((8 - i) * a + (i - 1) * b) / 7;
+		}
+		else {
+			for (int i = 2; i < 6; i++)
+				palette[i] = ((6 - i) * a + (i - 1) * b) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++)
+			bits |= (uint64_t)in[2 + i] << (i * 8);
+		for (int i = 0; i < 16; i++)
+			texels[i * 4 + channel] = (unsigned char)palette[(bits >> (i * 3)) & 7];
+	}
+
+	static void encodeLevel(const unsigned char* rgba, int width, int height, BlockFormat format, unsigned char* out, JobSystem* jobs) {
+		int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+		size_t bytes = blockBytes(format);
+		auto encodeRows = [&](size_t begin, size_t end) {
+			unsigned char texels[64];
+			for (size_t by = begin; by < end; by++) {
+				for (int bx = 0; bx < blocksX; bx++) {
+					//Blocks overhanging the edge repeat the last row/column
+					for (int y = 0; y < 4; y++) {
+						int sy = std::min((int)by * 4 + y, height - 1);
+						for (int x = 0; x < 4; x++) {
+							int sx = std::min(bx * 4 + x, width - 1);
+							memcpy(&texels[(y * 4 + x) * 4], &rgba[((size_t)sy * width + sx) * 4], 4);
+						}
+					}
+					unsigned char* block = out + (by * blocksX + bx) * bytes;
+					switch (format) {
+					case BlockFormat::BC1:
+						encodeColorBlock(texels, block);
+						break;
+					case BlockFormat::BC3:
+						encodeChannelBlock(texels, 3, block);
+						encodeColorBlock(texels, block + 8);
+						break;
+					case BlockFormat::BC4:
+						encodeChannelBlock(texels, 0, block);
+						break;
+					case BlockFormat::BC5:
+						encodeChannelBlock(texels, 0, block);
+						encodeChannelBlock(texels, 1, block + 8);
+						break;
+					}
+				}
+			}
+		};
+		if (jobs)
+			jobs->parallelFor(blocksY, 1, encodeRows);
+		else
+			encodeRows(0, blocksY);
+	}
+
+	//2x2 box filter; odd edges reuse the last texel
+	static std::vector<unsigned char> downsample(const unsigned char* rgba, int width, int height, int& outWidth, int& outHeight) {
+		outWidth = std::max(width / 2, 1);
+		outHeight = std::max(height / 2, 1);
+		std::vector<unsigned char> result((size_t)outWidth * outHeight * 4);
+		for (int y = 0; y < outHeight; y++) {
+			int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < outWidth; x++) {
+				int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+				for (int c = 0; c < 4; c++) {
+					int sum = rgba[((size_t)y0 * width + x0) * 4 + c] + rgba[((size_t)y0 * width + x1) * 4 + c]
+						+ rgba[((size_t)y1 * width + x0) * 4 + c] + rgba[((size_t)y1 * width + x1) * 4 + c];
+					result[((size_t)y * outWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+		return result;
+	}
+
+	//Bytes of one mip level: whole 4x4 blocks, partial blocks at the edges included
+	static size_t levelBytes(BlockFormat format, int width, int height) {
+		return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+	}
+
+	CompressedImage compressImage(const unsigned char* rgba, int width, int height, BlockFormat format, bool mipmaps, JobSystem* jobs) {
+		CompressedImage image;
+		image.format = format;
+		image.width = width;
+		image.height = height;
+		std::vector<unsigned char> mip;
+		const unsigned char* level = rgba;
+		int levelWidth = width, levelHeight = height;
+		while (true) {
+			image.levels.push_back(std::vector<unsigned char>(levelBytes(format, levelWidth, levelHeight)));
+			encodeLevel(level, levelWidth, levelHeight, format, image.levels.back().data(), jobs);
+			if (!mipmaps || (levelWidth == 1 && levelHeight == 1))
+				break;
+			mip = downsample(level, levelWidth, levelHeight, levelWidth, levelHeight);
+			level = mip.data();
+		}
+		return image;
+	}
+
+	std::vector<unsigned char> decompressImage(const CompressedImage& image, int level) {
+		int width = std::max(image.width >> level, 1), height = std::max(image.height >> level, 1);
+		int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+		size_t bytes = blockBytes(image.format);
+		std::vector<unsigned char> rgba((size_t)width * height * 4);
+		unsigned char texels[64];
+		for (int by = 0; by < blocksY; by++) {
+			for (int bx = 0; bx < blocksX; bx++) {
+				const unsigned char* block = &image.levels[level][((size_t)by * blocksX + bx) * bytes];
+				for (int i = 0; i < 16; i++) {
+					texels[i * 4 + 0] = texels[i * 4 + 1] = texels[i * 4 + 2] = 0;
+					texels[i * 4 + 3] = 255;
+				}
+				switch (image.format) {
+				case BlockFormat::BC1:
+					decodeColorBlock(block, texels);
+					break;
+				case BlockFormat::BC3:
+					decodeColorBlock(block + 8, texels);
+					decodeChannelBlock(block, 3, texels);
+					break;
+				case BlockFormat::BC4:
+					decodeChannelBlock(block, 0, texels);
+					break;
+				case BlockFormat::BC5:
+					decodeChannelBlock(block, 0, texels);
+					decodeChannelBlock(block + 8, 1, texels);
+					break;
+				}
+				for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+					for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+						memcpy(&rgba[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], &texels[(y * 4 + x) * 4], 4);
+				}
+			}
+		}
+		return rgba;
+	}
+
+	double computePSNR(const unsigned char* a, const unsigned char* b, size_t pixelCount, int channels) {
+		double sum = 0.0;
+		for (size_t i = 0; i < pixelCount; i++) {
+			for (int c = 0; c < channels; c++) {
+				double difference = (double)a[i * 4 + c] - (double)b[i * 4 + c];
+				sum += difference * difference;
+			}
+		}
+		double mse = sum / ((double)pixelCount * channels);
+		if (mse == 0.0)
+			return std::numeric_limits<double>::infinity();
+		return 10.0 * log10(255.0 * 255.0 / mse);
+	}
+
+	//File layout, native endianness: magic, version, format, width, height, levelCount (uint32
+	//each), then per level its byte count (uint32) and blocks
+	bool saveCompressedImage(const std::string& path, const CompressedImage& image) {
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file) {
+			printf("ERROR::BLOCK_COMPRESSION::Failed to open %s for writing\n", path.c_str());
+			return false;
+		}
+		uint32_t header[6] = { COMPRESSED_MAGIC, COMPRESSED_VERSION, (uint32_t)image.format,
+			(uint32_t)image.width, (uint32_t)image.height, (uint32_t)image.levels.size() };
+		fwrite(header, sizeof(header), 1, file);
+		for (const std::vector<unsigned char>& level : image.levels) {
+			uint32_t size = (uint32_t)level.size();
+			fwrite(&size, sizeof(size), 1, file);
+			fwrite(level.data(), 1, level.size(), file);
+		}
+		bool ok = ferror(file) == 0;
+		fclose(file);
+		return ok;
+	}
+
+	bool loadCompressedImage(const std::string& path, CompressedImage& image) {
+		FILE* file = fopen(path.c_str(), "rb");
+		if (!file) {
+			printf("ERROR::BLOCK_COMPRESSION::Failed to open %s\n", path.c_str());
+			return false;
+		}
+		fseek(file, 0, SEEK_END);
+		uint64_t fileSize = (uint64_t)ftell(file);
+		fseek(file, 0, SEEK_SET);
+		uint32_t header[6];
+		if (fread(header, sizeof(header), 1, file) != 1 || header[0] != COMPRESSED_MAGIC || header[1] != COMPRESSED_VERSION || header[2] > (uint32_t)BlockFormat::BC5) {
+			printf("ERROR::BLOCK_COMPRESSION::%s is not a compressed image\n", path.c_str());
+			fclose(file);
+			return false;
+		}
+		//Checked before allocating, so a corrupt header can't ask for a huge level count
+		int fullLevels = 1;
+		while ((header[3] | header[4]) >> fullLevels)
+			fullLevels++;
+		if (header[3] == 0 || header[3] > 65536 || header[4] == 0 || header[4] > 65536 || header[5] == 0 || header[5] > (uint32_t)fullLevels) {
+			printf("ERROR::BLOCK_COMPRESSION::%s has an invalid header\n", path.c_str());
+			fclose(file);
+			return false;
+		}
+		image.format = (BlockFormat)header[2];
+		image.width = (int)header[3];
+		image.height = (int)header[4];
+		image.levels.assign(header[5], std::vector<unsigned char>());
+		//Every level must hold exactly its blocks, which decompressImage() and
+		//createCompressedTexture() rely on, and fit in what is left of the file
+		uint64_t used = sizeof(header);
+		bool ok = true;
+		for (size_t i = 0; i < image.levels.size() && ok; i++) {
+			size_t expected = levelBytes(image.format, std::max(image.width >> i, 1), std::max(image.height >> i, 1));
+			uint32_t size = 0;
+			ok = fread(&size, sizeof(size), 1, file) == 1 && size == expected;
+			used += sizeof(size) + size;
+			ok = ok && used <= fileSize;
+			if (!ok)
+				break;
+			image.levels[i].resize(size);
+			ok = fread(image.levels[i].data(), 1, size, file) == size;
+		}
+		fclose(file);
+		if (!ok) {
+			printf("ERROR::BLOCK_COMPRESSION::%s is truncated or has invalid level sizes\n", path.c_str());
+			image.levels.clear();
+		}
+		return ok;
+	}
+
+	bool supportsS3TC() {
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i = 0; i < count; i++) {
+			const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+			if (name && strcmp(name, "GL_EXT_texture_compression_s3tc") == 0)
+				return true;
+		}
+		return false;
+	}
+
+	unsigned int createCompressedTexture(const CompressedImage& image) {
+		if (image.levels.empty())
+			return 0;
+		GLenum internalFormat = GL_COMPRESSED_RED_RGTC1;
+		switch (image.format) {
+		case BlockFormat::BC1: internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+		case BlockFormat::BC3: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+		case BlockFormat::BC4: internalFormat = GL_COMPRESSED_RED_RGTC1; break;
+		case BlockFormat::BC5: internalFormat = GL_COMPRESSED_RG_RGTC2; break;
+		}
+		bool decode = (image.format == BlockFormat::BC1 || image.format == BlockFormat::BC3) && !supportsS3TC();
+		GLsizei levels = (GLsizei)image.levels.size();
+
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexStorage2D(GL_TEXTURE_2D, levels, decode ? GL_RGBA8 : internalFormat, image.width, image.height);
+		for (GLsizei level = 0; level < levels; level++) {
+			int width = std::max(image.width >> level, 1), height = std::max(image.height >> level, 1);
+			if (decode) {
+				std::vector<unsigned char> rgba = decompressImage(image, level);
+				glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+			}
+			else {
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, internalFormat,
+					(GLsizei)image.levels[level].size(), image.levels[level].data());
+			}
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+}
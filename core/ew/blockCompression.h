@@ -0,0 +1,51 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ew {
+	class JobSystem;
+
+	enum class BlockFormat {
+		//RGB, 4 bits per texel
+		BC1,
+		//RGBA: a BC1 color block plus an interpolated alpha block, 8 bits per texel
+		BC3,
+		//Red only, 4 bits per texel. Roughness, height, occlusion
+		BC4,
+		//Red and green, 8 bits per texel. Tangent space normal XY
+		BC5
+	};
+
+	//Bytes per 4x4 block
+	size_t blockBytes(BlockFormat format);
+	//How many leading RGBA channels the format keeps
+	int blockChannels(BlockFormat format);
+
+	struct CompressedImage {
+		BlockFormat format = BlockFormat::BC1;
+		int width = 0;
+		int height = 0;
+		//Largest first; level n holds ceil(w / 4) * ceil(h / 4) blocks of its own size
+		std::vector<std::vector<unsigned char>> levels;
+	};
+
+	//Encodes width x height RGBA8 texels (row 0 is sampled at v = 0) and, optionally, a box
+	//filtered mip chain. GL cannot generate mips for compressed textures, so they are built here.
+	//With jobs, rows of blocks are encoded on all workers.
+	CompressedImage compressImage(const unsigned char* rgba, int width, int height, BlockFormat format, bool mipmaps = true, JobSystem* jobs = nullptr);
+	//Decodes one level to RGBA8. Channels the format drops come back as 0, alpha as 255.
+	std::vector<unsigned char> decompressImage(const CompressedImage& image, int level = 0);
+	//Peak signal-to-noise ratio in dB over the first channels of two RGBA8 images, infinite if equal
+	double computePSNR(const unsigned char* a, const unsigned char* b, size_t pixelCount, int channels);
+
+	bool saveCompressedImage(const std::string& path, const CompressedImage& image);
+	bool loadCompressedImage(const std::string& path, CompressedImage& image);
+
+	//BC1/BC3 need GL_EXT_texture_compression_s3tc; BC4/BC5 are core as RGTC
+	bool supportsS3TC();
+	//GL_TEXTURE_2D with every level uploaded as is. Without S3TC, BC1/BC3 levels are decoded and
+	//uploaded as RGBA8 instead, so callers never need a separate path. Owned by the caller.
+	unsigned int createCompressedTexture(const CompressedImage& image);
+}
@@ -0,0 +1,293 @@
+#include "cascadedShadows.h"
+#include "external/glad.h"
+#include "frustum.h"
+#include "shader.h"
+#include <math.h>
+#include <string.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace ew {
+	//std140 mirror of the ShadowParams block
+	struct ShadowParams {
+		glm::mat4 matrices[MAX_SHADOW_CASCADES];
+		//View space far distance of each cascade
+		glm::vec4 splits;
+		//World space size of one shadow texel per cascade
+		glm::vec4 texelSizes;
+		//x cascade count, y normal bias in texels
+		glm::vec4 info;
+	};
+
+	static const char* shadowSamplingSource = R"(
+		layout(std140, binding = 1) uniform ShadowParams {
+			mat4 shadowMatrices[4];
+			vec4 cascadeSplits;
+			vec4 cascadeTexelSizes;
+			vec4 shadowInfo;
+		};
+		layout(binding = 4) uniform sampler2DArrayShadow shadowMap;
+
+		int shadowCascade(float viewDepth) {
+			int count = int(shadowInfo.x);
+			for (int i = 0; i < count - 1; i++) {
+				if (viewDepth < cascadeSplits[i])
+					return i;
+			}
+			return count - 1;
+		}
+
+		float sampleShadow(vec3 worldPos, vec3 normal, float viewDepth) {
+			int cascade = shadowCascade(viewDepth);
+			if (viewDepth >= cascadeSplits[cascade])
+				return 1.0;
+			//Normal offset scaled to the cascade's texel size hides acne without peter-panning
+			vec3 offsetPos = worldPos + normal * cascadeTexelSizes[cascade] * shadowInfo.y;
+			vec4 shadowPos = shadowMatrices[cascade] * vec4(offsetPos, 1.0);
+			vec3 uvw = shadowPos.xyz * 0.5 + 0.5;
+			vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+			float lit = 0.0;
+			for (int y = -1; y <= 1; y++) {
+				for (int x = -1; x <= 1; x++)
+					lit += texture(shadowMap, vec4(uvw.xy + vec2(x, y) * texel, float(cascade), uvw.z));
+			}
+			return lit / 9.0;
+		}
+	)";
+
+	static const char* depthVertexSource = R"(
+		#version 450 core
+		layout(location = 0) in vec3 aPos;
+		uniform mat4 model;
+		uniform mat4 lightViewProjection;
+		void main() {
+			gl_Position = lightViewProjection * model * vec4(aPos, 1.0);
+		}
+	)";
+
+	static const char* depthFragmentSource = R"(
+		#version 450 core
+		void main() {
+		}
+	)";
+
+	const char* cascadedShadowGlsl() {
+		return shadowSamplingSource;
+	}
+
+	static unsigned int createDepthArray(int resolution, int layers, bool comparison) {
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F, resolution, resolution, layers);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, comparison ? GL_LINEAR : GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, comparison ? GL_LINEAR : GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		if (comparison) {
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		}
+		return texture;
+	}
+
+	CascadedShadowMaps::CascadedShadowMaps(int resolution, int cascadeCount)
+		: m_resolution(resolution) {
+		m_cascadeCount = cascadeCount < 1 ? 1 : (cascadeCount > MAX_SHADOW_CASCADES ? MAX_SHADOW_CASCADES : cascadeCount);
+		m_program = createShaderProgram(depthVertexSource, depthFragmentSource);
+		m_modelLocation = glGetUniformLocation(m_program, "model");
+		m_lightViewProjectionLocation = glGetUniformLocation(m_program, "lightViewProjection");
+		m_shadowMap = createDepthArray(resolution, m_cascadeCount, true);
+		m_staticCache = createDepthArray(resolution, m_cascadeCount, false);
+		glGenFramebuffers(1, &m_framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glGenBuffers(1, &m_paramsBuffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadowParams), NULL, GL_DYNAMIC_DRAW);
+	}
+
+	CascadedShadowMaps::~CascadedShadowMaps() {
+		glDeleteProgram(m_program);
+		unsigned int textures[] = { m_shadowMap, m_staticCache };
+		glDeleteTextures(2, textures);
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteBuffers(1, &m_paramsBuffer);
+	}
+
+	void CascadedShadowMaps::setLightDirection(const glm::vec3& direction) {
+		m_lightDirection = glm::normalize(direction);
+	}
+
+	void CascadedShadowMaps::update(const glm::mat4& view, float fovy, float aspect, float nearPlane, float shadowDistance) {
+		glm::mat4 inverseView = glm::inverse(view);
+		float tanHalfY = tanf(fovy * 0.5f);
+		float tanHalfX = tanHalfY * aspect;
+		//Any up vector works as long as it is fixed; the rotation must not follow the camera
+		glm::vec3 up = fabsf(m_lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), m_lightDirection, up);
+
+		ShadowParams params;
+		for (int c = 0; c < MAX_SHADOW_CASCADES; c++)
+			params.matrices[c] = glm::mat4(1.0f);
+		params.splits = glm::vec4(0.0f);
+		params.texelSizes = glm::vec4(0.0f);
+		float splitNear = nearPlane;
+		for (int c = 0; c < m_cascadeCount; c++) {
+			float t = (float)(c + 1) / m_cascadeCount;
+			float uniformSplit = nearPlane + (shadowDistance - nearPlane) * t;
+			float logSplit = nearPlane * powf(shadowDistance / nearPlane, t);
+			float splitFar = uniformSplit + (logSplit - uniformSplit) * m_splitLambda;
+
+			//Bounding sphere of the slice's eight corners
+			glm::vec3 corners[8];
+			glm::vec3 center(0.0f);
+			for (int i = 0; i < 8; i++) {
+				float z = (i & 4) ? splitFar : splitNear;
+				glm::vec4 viewCorner((i & 1 ? 1.0f : -1.0f) * tanHalfX * z, (i & 2 ? 1.0f : -1.0f) * tanHalfY * z, -z, 1.0f);
+				corners[i] = glm::vec3(inverseView * viewCorner);
+				center += corners[i] * 0.125f;
+			}
+			float radius = 0.0f;
+			for (int i = 0; i < 8; i++)
+				radius = fmaxf(radius, glm::length(corners[i] - center));
+			//Quantized so floating point noise never changes the projection size
+			radius = ceilf(radius * 16.0f) / 16.0f;
+
+			float texelSize = 2.0f * radius / m_resolution;
+			glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+			lightCenter = glm::floor(lightCenter / texelSize) * texelSize;
+			//Depth range covers the sphere; casters between it and the light are kept by depth clamping
+			glm::mat4 projection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius, lightCenter.y - radius, lightCenter.y + radius,
+				-lightCenter.z - radius, -lightCenter.z + radius);
+
+			Cascade& cascade = m_cascades[c];
+			cascade.lightViewProjection = projection * lightView;
+			cascade.splitFar = splitFar;
+			cascade.texelWorldSize = texelSize;
+			params.matrices[c] = cascade.lightViewProjection;
+			params.splits[c] = splitFar;
+			params.texelSizes[c] = texelSize;
+			splitNear = splitFar;
+		}
+		params.info = glm::vec4((float)m_cascadeCount, m_normalBias, 0.0f, 0.0f);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ShadowParams), &params);
+	}
+
+	static uint64_t hashStaticCasters(const ShadowCaster* casters, unsigned int count) {
+		//FNV-1a over the transforms and bounds of static casters, in order
+		uint64_t hash = 14695981039346656037ull;
+		for (unsigned int i = 0; i < count; i++) {
+			if (!casters[i].isStatic)
+				continue;
+			const unsigned char* bytes = (const unsigned char*)&casters[i];
+			for (size_t b = 0; b < sizeof(glm::mat4) + sizeof(glm::vec4); b++) {
+				hash ^= bytes[b];
+				hash *= 1099511628211ull;
+			}
+		}
+		return hash;
+	}
+
+	void CascadedShadowMaps::drawCasters(const ShadowCaster* casters, unsigned int count, const glm::mat4& lightViewProjection, bool isStatic, const std::function<void(unsigned int)>& drawCaster, ShadowCascadeStats& stats) {
+		Frustum frustum = extractFrustum(lightViewProjection);
+		for (unsigned int i = 0; i < count; i++) {
+			const ShadowCaster& caster = casters[i];
+			if (caster.isStatic != isStatic)
+				continue;
+			glm::vec3 center = glm::vec3(caster.model * glm::vec4(glm::vec3(caster.bounds), 1.0f));
+			float scale = fmaxf(glm::length(glm::vec3(caster.model[0])), fmaxf(glm::length(glm::vec3(caster.model[1])), glm::length(glm::vec3(caster.model[2]))));
+			float radius = caster.bounds.w * scale;
+			//Skip the near plane (index 4): casters towards the light still throw shadows into the cascade
+			bool visible = true;
+			for (int p = 0; p < 6 && visible; p++) {
+				if (p != 4 && glm::dot(glm::vec3(frustum.planes[p]), center) + frustum.planes[p].w < -radius)
+					visible = false;
+			}
+			if (!visible) {
+				stats.culledCasters++;
+				continue;
+			}
+			glUniformMatrix4fv(m_modelLocation, 1, GL_FALSE, &caster.model[0][0]);
+			drawCaster(i);
+			if (isStatic)
+				stats.staticCasters++;
+			else
+				stats.dynamicCasters++;
+		}
+	}
+
+	void CascadedShadowMaps::render(const ShadowCaster* casters, unsigned int count, const std::function<void(unsigned int)>& drawCaster) {
+		uint64_t staticHash = hashStaticCasters(casters, count);
+		if (staticHash != m_staticHash) {
+			invalidateStaticCache();
+			m_staticHash = staticHash;
+		}
+
+		GLint previousFramebuffer = 0;
+		GLint previousViewport[4];
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+		glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		glViewport(0, 0, m_resolution, m_resolution);
+		glEnable(GL_DEPTH_TEST);
+		glDepthMask(GL_TRUE);
+		glEnable(GL_DEPTH_CLAMP);
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(2.0f, 4.0f);
+		glUseProgram(m_program);
+
+		for (int c = 0; c < m_cascadeCount; c++) {
+			Cascade& cascade = m_cascades[c];
+			cascade.stats = ShadowCascadeStats();
+			cascade.stats.splitFar = cascade.splitFar;
+			m_timers[c].begin();
+			glUniformMatrix4fv(m_lightViewProjectionLocation, 1, GL_FALSE, &cascade.lightViewProjection[0][0]);
+
+			cascade.stats.staticCacheHit = cascade.cacheValid &&
+				memcmp(&cascade.cachedLightViewProjection, &cascade.lightViewProjection, sizeof(glm::mat4)) == 0;
+			if (!cascade.stats.staticCacheHit) {
+				glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_staticCache, 0, c);
+				glClear(GL_DEPTH_BUFFER_BIT);
+				drawCasters(casters, count, cascade.lightViewProjection, true, drawCaster, cascade.stats);
+				cascade.cachedLightViewProjection = cascade.lightViewProjection;
+				cascade.cacheValid = true;
+			}
+			//Start from the static depth, then add what moves
+			glCopyImageSubData(m_staticCache, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c,
+				m_shadowMap, GL_TEXTURE_2D_ARRAY, 0, 0, 0, c, m_resolution, m_resolution, 1);
+			glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_shadowMap, 0, c);
+			drawCasters(casters, count, cascade.lightViewProjection, false, drawCaster, cascade.stats);
+			m_timers[c].end();
+		}
+
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		glDisable(GL_DEPTH_CLAMP);
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+		glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	}
+
+	void CascadedShadowMaps::invalidateStaticCache() {
+		for (int c = 0; c < MAX_SHADOW_CASCADES; c++)
+			m_cascades[c].cacheValid = false;
+	}
+
+	void CascadedShadowMaps::bind() const {
+		glBindBufferBase(GL_UNIFORM_BUFFER, SHADOW_PARAMS_UBO_BINDING, m_paramsBuffer);
+		glBindTextureUnit(SHADOW_MAP_TEXTURE_UNIT, m_shadowMap);
+	}
+
+	ShadowCascadeStats CascadedShadowMaps::getStats(int cascade) const {
+		ShadowCascadeStats stats = m_cascades[cascade].stats;
+		stats.gpuMs = m_timers[cascade].getMs();
+		return stats;
+	}
+
+	void CascadedShadowMaps::resolveTimings() {
+		for (int c = 0; c < m_cascadeCount; c++)
+			m_timers[c].resolve();
+	}
+}
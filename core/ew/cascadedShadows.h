@@ -0,0 +1,115 @@
+#pragma once
+#include <functional>
+#include <stdint.h>
+#include <glm/glm.hpp>
+#include "profiler.h"
+
+namespace ew {
+	const int MAX_SHADOW_CASCADES = 4;
+	//Bindings used by cascadedShadowGlsl(). UBO 0 is ClusterParams, texture units 0-2 the G-buffer.
+	const unsigned int SHADOW_PARAMS_UBO_BINDING = 1;
+	const unsigned int SHADOW_MAP_TEXTURE_UNIT = 4;
+
+	//GLSL (450) for fragment shaders: the cascade parameters, the shadow map sampler and
+	//	float sampleShadow(vec3 worldPos, vec3 normal, float viewDepth)
+	//returning 0 (shadowed) to 1 (lit) with 3x3 PCF. normal is the normalized world normal,
+	//viewDepth the positive view space distance. Insert it after #version.
+	const char* cascadedShadowGlsl();
+
+	struct ShadowCaster {
+		glm::mat4 model;
+		//Object space bounding sphere, xyz center, w radius
+		glm::vec4 bounds;
+		//Static casters are rendered into a per-cascade cache and only redrawn when a static
+		//caster or the cascade itself changes
+		bool isStatic = false;
+	};
+
+	struct ShadowCascadeStats {
+		//View space distance where this cascade ends
+		float splitFar = 0.0f;
+		//Casters drawn this frame. staticCasters is 0 when the cache was reused.
+		unsigned int staticCasters = 0;
+		unsigned int dynamicCasters = 0;
+		//Casters rejected by the cascade's frustum
+		unsigned int culledCasters = 0;
+		bool staticCacheHit = false;
+		//Most recent GPU time for this cascade, a few frames late unless resolveTimings() was called
+		double gpuMs = 0.0;
+	};
+
+	//Cascaded shadow maps for one directional light.
+	//
+	//The view frustum is split between near and shadowDistance (blend of logarithmic and uniform
+	//splits) and each slice gets an orthographic light projection fitted to its bounding sphere.
+	//The sphere radius is quantized and its center snapped to whole shadow texels, so the
+	//projection only translates in texel steps and does not change size as the camera rotates:
+	//edges no longer shimmer, and a cascade's matrix stays bit-identical while the camera moves
+	//within a texel.
+	//
+	//That stability is what makes caching work. Static casters are drawn into a separate depth
+	//layer that is kept as long as the cascade matrix and the static caster set are unchanged;
+	//each frame the cached layer is copied into the shadow map and only dynamic casters are drawn
+	//on top. Far cascades have large texels and hit the cache almost every frame.
+	class CascadedShadowMaps {
+	public:
+		explicit CascadedShadowMaps(int resolution = 2048, int cascadeCount = MAX_SHADOW_CASCADES);
+		~CascadedShadowMaps();
+		CascadedShadowMaps(const CascadedShadowMaps&) = delete;
+		CascadedShadowMaps& operator=(const CascadedShadowMaps&) = delete;
+
+		//Direction the light travels, does not need to be normalized
+		void setLightDirection(const glm::vec3& direction);
+		//0 gives uniform splits, 1 logarithmic
+		void setSplitLambda(float lambda) { m_splitLambda = lambda; }
+		//Normal offset applied to receivers, in shadow texels
+		void setNormalBias(float texels) { m_normalBias = texels; }
+
+		//Fits the cascades to the camera. fovy in radians.
+		void update(const glm::mat4& view, float fovy, float aspect, float nearPlane, float shadowDistance);
+		//Renders the cascades. drawCaster(i) must issue the draw for casters[i] with position at
+		//attribute location 0; the model matrix and depth-only program are already set.
+		//Restores the previous framebuffer binding and viewport.
+		void render(const ShadowCaster* casters, unsigned int count, const std::function<void(unsigned int)>& drawCaster);
+		//Forces every cascade to redraw its static casters next frame
+		void invalidateStaticCache();
+		//Binds the shadow map and parameters for shaders using cascadedShadowGlsl()
+		void bind() const;
+
+		int getCascadeCount() const { return m_cascadeCount; }
+		int getResolution() const { return m_resolution; }
+		const glm::mat4& getLightViewProjection(int cascade) const { return m_cascades[cascade].lightViewProjection; }
+		ShadowCascadeStats getStats(int cascade) const;
+		//Blocks until every cascade's timer has answered. Only for benchmarks.
+		void resolveTimings();
+
+	private:
+		struct Cascade {
+			glm::mat4 lightViewProjection = glm::mat4(1.0f);
+			glm::mat4 cachedLightViewProjection = glm::mat4(0.0f);
+			float splitFar = 0.0f;
+			float texelWorldSize = 0.0f;
+			bool cacheValid = false;
+			ShadowCascadeStats stats;
+		};
+
+		void drawCasters(const ShadowCaster* casters, unsigned int count, const glm::mat4& lightViewProjection, bool isStatic, const std::function<void(unsigned int)>& drawCaster, ShadowCascadeStats& stats);
+
+		int m_resolution = 0;
+		int m_cascadeCount = 0;
+		float m_splitLambda = 0.75f;
+		float m_normalBias = 1.5f;
+		glm::vec3 m_lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+		Cascade m_cascades[MAX_SHADOW_CASCADES];
+		GpuTimer m_timers[MAX_SHADOW_CASCADES];
+		uint64_t m_staticHash = 0;
+
+		unsigned int m_shadowMap = 0;
+		unsigned int m_staticCache = 0;
+		unsigned int m_framebuffer = 0;
+		unsigned int m_paramsBuffer = 0;
+		unsigned int m_program = 0;
+		int m_modelLocation = -1;
+		int m_lightViewProjectionLocation = -1;
+	};
+}
@@ -0,0 +1,223 @@
+#include "clusteredLighting.h"
+#include "external/glad.h"
+#include "shader.h"
+#include <math.h>
+#include <string>
+
+namespace ew {
+	static const unsigned int WORKGROUP_SIZE = 64;
+
+	//Shared by the build pass and clusteredLightingGlsl() so both see the same layout
+	static const char* clusterInterfaceSource = R"(
+		struct PointLight {
+			vec4 positionRadius;
+			vec4 colorIntensity;
+		};
+		layout(std140, binding = 0) uniform ClusterParams {
+			mat4 clusterView;
+			mat4 clusterInverseProjection;
+			//Grid size, w = maxLightsPerCluster
+			uvec4 clusterGrid;
+			//near, far, slice scale, slice bias
+			vec4 clusterDepth;
+			//Tile size in pixels
+			vec4 clusterTile;
+		};
+	)";
+
+	struct ClusterParams {
+		glm::mat4 view;
+		glm::mat4 inverseProjection;
+		unsigned int grid[4];
+		glm::vec4 depth;
+		glm::vec4 tile;
+	};
+
+	static const char* buildComputeSource = R"(
+		layout(local_size_x = 64) in;
+		layout(std430, binding = 4) readonly buffer LightBuffer { PointLight lights[]; };
+		layout(std430, binding = 5) writeonly buffer ClusterCountBuffer { uint clusterCounts[]; };
+		layout(std430, binding = 6) writeonly buffer ClusterIndexBuffer { uint clusterIndices[]; };
+
+		uniform uint lightCount;
+		//View space lights, loaded cooperatively one batch per iteration
+		shared vec4 sharedLights[64];
+
+		//Point on the view ray through ndc at view depth d
+		vec3 rayPoint(vec2 ndc, float d) {
+			vec4 p = clusterInverseProjection * vec4(ndc, -1.0, 1.0);
+			p.xyz /= p.w;
+			return p.xyz * (d / -p.z);
+		}
+
+		void main() {
+			uint clusterTotal = clusterGrid.x * clusterGrid.y * clusterGrid.z;
+			uint cluster = gl_GlobalInvocationID.x;
+			//No early return: every invocation has to reach the barriers
+			bool active = cluster < clusterTotal;
+
+			uvec3 cell = uvec3(cluster % clusterGrid.x, (cluster / clusterGrid.x) % clusterGrid.y, cluster / (clusterGrid.x * clusterGrid.y));
+			vec2 ndcMin = vec2(cell.xy) / vec2(clusterGrid.xy) * 2.0 - 1.0;
+			vec2 ndcMax = vec2(cell.xy + 1u) / vec2(clusterGrid.xy) * 2.0 - 1.0;
+			float depthRatio = clusterDepth.y / clusterDepth.x;
+			float sliceNear = clusterDepth.x * pow(depthRatio, float(cell.z) / float(clusterGrid.z));
+			float sliceFar = clusterDepth.x * pow(depthRatio, float(cell.z + 1u) / float(clusterGrid.z));
+			vec3 boxMin = vec3(1e30);
+			vec3 boxMax = vec3(-1e30);
+			for (int corner = 0; corner < 4; corner++) {
+				vec2 ndc = vec2((corner & 1) != 0 ? ndcMax.x : ndcMin.x, (corner & 2) != 0 ? ndcMax.y : ndcMin.y);
+				vec3 a = rayPoint(ndc, sliceNear);
+				vec3 b = rayPoint(ndc, sliceFar);
+				boxMin = min(boxMin, min(a, b));
+				boxMax = max(boxMax, max(a, b));
+			}
+
+			uint count = 0u;
+			uint base = cluster * clusterGrid.w;
+			for (uint first = 0u; first < lightCount; first += 64u) {
+				uint light = first + gl_LocalInvocationIndex;
+				if (light < lightCount) {
+					vec4 positionRadius = lights[light].positionRadius;
+					sharedLights[gl_LocalInvocationIndex] = vec4((clusterView * vec4(positionRadius.xyz, 1.0)).xyz, positionRadius.w);
+				}
+				barrier();
+				uint batch = min(64u, lightCount - first);
+				if (active) {
+					for (uint i = 0u; i < batch; i++) {
+						//Sphere vs AABB: distance from the center to the closest point of the box
+						vec4 sphere = sharedLights[i];
+						vec3 offset = clamp(sphere.xyz, boxMin, boxMax) - sphere.xyz;
+						if (dot(offset, offset) <= sphere.w * sphere.w && count < clusterGrid.w) {
+							clusterIndices[base + count] = first + i;
+							count++;
+						}
+					}
+				}
+				barrier();
+			}
+			if (active)
+				clusterCounts[cluster] = count;
+		}
+	)";
+
+	static const char* shadingSource = R"(
+		layout(std430, binding = 4) readonly buffer LightBuffer { PointLight lights[]; };
+		layout(std430, binding = 5) readonly buffer ClusterCountBuffer { uint clusterCounts[]; };
+		layout(std430, binding = 6) readonly buffer ClusterIndexBuffer { uint clusterIndices[]; };
+
+		uint clusterIndex(vec2 fragCoord, float viewDepth) {
+			uint slice = uint(max(log(viewDepth) * clusterDepth.z + clusterDepth.w, 0.0));
+			slice = min(slice, clusterGrid.z - 1u);
+			uvec2 tile = min(uvec2(fragCoord / clusterTile.xy), clusterGrid.xy - 1u);
+			return tile.x + clusterGrid.x * (tile.y + clusterGrid.y * slice);
+		}
+
+		vec3 shadeClusteredLights(vec3 worldPos, vec3 normal, vec3 viewDir, float viewDepth, vec3 albedo, float specular) {
+			uint cluster = clusterIndex(gl_FragCoord.xy, viewDepth);
+			uint count = clusterCounts[cluster];
+			uint base = cluster * clusterGrid.w;
+			vec3 color = vec3(0.0);
+			for (uint i = 0u; i < count; i++) {
+				PointLight light = lights[clusterIndices[base + i]];
+				vec3 toLight = light.positionRadius.xyz - worldPos;
+				float distanceSq = dot(toLight, toLight);
+				float radius = light.positionRadius.w;
+				if (distanceSq >= radius * radius)
+					continue;
+				vec3 lightDir = toLight * inversesqrt(distanceSq);
+				//Inverse square falloff windowed to reach zero at the radius
+				float window = 1.0 - distanceSq / (radius * radius);
+				float attenuation = window * window / (1.0 + distanceSq);
+				float diff = max(dot(normal, lightDir), 0.0);
+				float spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), 32.0);
+				color += (albedo * diff + specular * spec) * light.colorIntensity.rgb * light.colorIntensity.w * attenuation;
+			}
+			return color;
+		}
+
+		vec3 shadeClusteredLights(vec3 worldPos, vec3 normal, vec3 viewDir, float viewDepth, vec3 albedo) {
+			return shadeClusteredLights(worldPos, normal, viewDir, viewDepth, albedo, 0.3);
+		}
+	)";
+
+	const char* clusteredLightingGlsl() {
+		static const std::string source = std::string(clusterInterfaceSource) + shadingSource;
+		return source.c_str();
+	}
+
+	ClusteredLighting::ClusteredLighting(unsigned int maxLightsPerCluster)
+		: m_maxLightsPerCluster(maxLightsPerCluster) {
+		std::string computeSource = std::string("#version 450 core\n") + clusterInterfaceSource + buildComputeSource;
+		m_program = createComputeProgram(computeSource.c_str());
+		m_lightCountLocation = glGetUniformLocation(m_program, "lightCount");
+		glGenBuffers(1, &m_lightBuffer);
+		glGenBuffers(1, &m_countBuffer);
+		glGenBuffers(1, &m_indexBuffer);
+		glGenBuffers(1, &m_paramsBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, CLUSTER_COUNT * sizeof(unsigned int), NULL, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_indexBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (size_t)CLUSTER_COUNT * maxLightsPerCluster * sizeof(unsigned int), NULL, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(ClusterParams), NULL, GL_DYNAMIC_DRAW);
+		//A valid, empty light buffer so shaders can bind before the first setLights()
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(PointLight), NULL, GL_DYNAMIC_DRAW);
+		m_lightCapacity = 1;
+	}
+
+	ClusteredLighting::~ClusteredLighting() {
+		glDeleteProgram(m_program);
+		unsigned int buffers[] = { m_lightBuffer, m_countBuffer, m_indexBuffer, m_paramsBuffer };
+		glDeleteBuffers(4, buffers);
+	}
+
+	void ClusteredLighting::setLights(const PointLight* lights, unsigned int count) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightBuffer);
+		if (count > m_lightCapacity) {
+			m_lightCapacity = count;
+			glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(PointLight), lights, GL_DYNAMIC_DRAW);
+		}
+		else if (count > 0) {
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(PointLight), lights);
+		}
+		m_lightCount = count;
+	}
+
+	void ClusteredLighting::build(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, int screenWidth, int screenHeight) {
+		ClusterParams params;
+		params.view = view;
+		params.inverseProjection = glm::inverse(projection);
+		params.grid[0] = CLUSTER_GRID_X;
+		params.grid[1] = CLUSTER_GRID_Y;
+		params.grid[2] = CLUSTER_GRID_Z;
+		params.grid[3] = m_maxLightsPerCluster;
+		//slice = log(depth) * scale + bias, exponential slices between near and far
+		float logRatio = logf(farPlane / nearPlane);
+		params.depth = glm::vec4(nearPlane, farPlane, CLUSTER_GRID_Z / logRatio, -(float)CLUSTER_GRID_Z * logf(nearPlane) / logRatio);
+		params.tile = glm::vec4((float)screenWidth / CLUSTER_GRID_X, (float)screenHeight / CLUSTER_GRID_Y, 0.0f, 0.0f);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ClusterParams), &params);
+
+		glUseProgram(m_program);
+		glUniform1ui(m_lightCountLocation, m_lightCount);
+		bind();
+		glDispatchCompute((CLUSTER_COUNT + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	void ClusteredLighting::bind() const {
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_LIGHTS_BINDING, m_lightBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_COUNTS_BINDING, m_countBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_INDICES_BINDING, m_indexBuffer);
+		glBindBufferBase(GL_UNIFORM_BUFFER, CLUSTER_PARAMS_UBO_BINDING, m_paramsBuffer);
+	}
+
+	std::vector<unsigned int> ClusteredLighting::readClusterCounts() {
+		std::vector<unsigned int> counts(CLUSTER_COUNT);
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glBindBuffer(GL_COPY_READ_BUFFER, m_countBuffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, counts.size() * sizeof(unsigned int), counts.data());
+		return counts;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace ew {
+	//Point light as stored on the GPU, std430 layout, world space
+	struct PointLight {
+		//xyz position, w radius of influence
+		glm::vec4 positionRadius;
+		//rgb color, w intensity
+		glm::vec4 colorIntensity;
+	};
+
+	//Froxel grid: screen tiles in x/y, exponential slices in view depth
+	const unsigned int CLUSTER_GRID_X = 16;
+	const unsigned int CLUSTER_GRID_Y = 9;
+	const unsigned int CLUSTER_GRID_Z = 24;
+	const unsigned int CLUSTER_COUNT = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+
+	//Binding points used by clusteredLightingGlsl(). SSBO 0-3 are taken by MegaBuffer/GpuCuller.
+	const unsigned int CLUSTER_LIGHTS_BINDING = 4;
+	const unsigned int CLUSTER_COUNTS_BINDING = 5;
+	const unsigned int CLUSTER_INDICES_BINDING = 6;
+	const unsigned int CLUSTER_PARAMS_UBO_BINDING = 0;
+
+	//GLSL (450) for fragment shaders: the buffer interface plus
+	//	vec3 shadeClusteredLights(vec3 worldPos, vec3 normal, vec3 viewDir, float viewDepth, vec3 albedo[, float specular])
+	//where normal and viewDir are normalized and viewDepth is the positive view space distance
+	//along -z. Insert it after #version.
+	const char* clusteredLightingGlsl();
+
+	//Clustered forward shading. Every frame a compute shader assigns lights to the froxels
+	//their sphere overlaps, writing a light index list per cluster. Fragment shaders then only
+	//loop over the lights of the cluster they fall in instead of every light in the scene.
+	//
+	//Each cluster owns a fixed region of maxLightsPerCluster indices, so building needs no
+	//atomics or resets; lights beyond the capacity of a cluster are dropped.
+	class ClusteredLighting {
+	public:
+		explicit ClusteredLighting(unsigned int maxLightsPerCluster = 256);
+		~ClusteredLighting();
+		ClusteredLighting(const ClusteredLighting&) = delete;
+		ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+		void setLights(const PointLight* lights, unsigned int count);
+		//Rebuilds the cluster lists for this camera. nearPlane/farPlane must match projection.
+		void build(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, int screenWidth, int screenHeight);
+		//Binds the lights, cluster lists and parameters for shaders using clusteredLightingGlsl()
+		void bind() const;
+
+		unsigned int getLightCount() const { return m_lightCount; }
+		unsigned int getMaxLightsPerCluster() const { return m_maxLightsPerCluster; }
+		//Reads back per-cluster light counts. Stalls the pipeline, debug/benchmark only.
+		std::vector<unsigned int> readClusterCounts();
+
+	private:
+		unsigned int m_program = 0;
+		unsigned int m_lightBuffer = 0;
+		unsigned int m_countBuffer = 0;
+		unsigned int m_indexBuffer = 0;
+		unsigned int m_paramsBuffer = 0;
+		unsigned int m_lightCount = 0;
+		unsigned int m_lightCapacity = 0;
+		unsigned int m_maxLightsPerCluster = 0;
+		int m_lightCountLocation = -1;
+	};
+}
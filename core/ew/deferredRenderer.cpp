@@ -0,0 +1,177 @@
+#include "deferredRenderer.h"
+#include "external/glad.h"
+#include "shader.h"
+#include <stdio.h>
+#include <string>
+
+namespace ew {
+	//Octahedral mapping: the unit sphere folded onto a square, uniform precision in two channels
+	static const char* octahedralSource = R"(
+		vec2 signNotZero(vec2 v) {
+			return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+		}
+		vec2 octEncode(vec3 n) {
+			n /= abs(n.x) + abs(n.y) + abs(n.z);
+			vec2 e = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+			return e * 0.5 + 0.5;
+		}
+		vec3 octDecode(vec2 e) {
+			e = e * 2.0 - 1.0;
+			vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+			if (n.z < 0.0)
+				n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+			return normalize(n);
+		}
+	)";
+
+	static const char* gBufferWriteSource = R"(
+		layout(location = 0) out vec4 gAlbedoSpecular;
+		layout(location = 1) out vec2 gNormal;
+
+		void writeGBuffer(vec3 normal, vec3 albedo, float specular) {
+			gAlbedoSpecular = vec4(albedo, specular);
+			gNormal = octEncode(normalize(normal));
+		}
+	)";
+
+	static const char* fullscreenVertexSource = R"(
+		#version 450 core
+		out vec2 UV;
+		void main() {
+			//One triangle covering the screen, no vertex buffer needed
+			UV = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+			gl_Position = vec4(UV * 2.0 - 1.0, 0.0, 1.0);
+		}
+	)";
+
+	static const char* lightingFragmentMain = R"(
+		in vec2 UV;
+		out vec4 FragColor;
+
+		layout(binding = 0) uniform sampler2D gAlbedoSpecular;
+		layout(binding = 1) uniform sampler2D gNormal;
+		layout(binding = 2) uniform sampler2D gDepth;
+		uniform mat4 inverseViewProjection;
+		uniform vec3 cameraPos;
+		uniform vec3 ambient;
+
+		void main() {
+			ivec2 pixel = ivec2(gl_FragCoord.xy);
+			float depth = texelFetch(gDepth, pixel, 0).r;
+			if (depth == 1.0)
+				discard;
+			vec4 albedoSpecular = texelFetch(gAlbedoSpecular, pixel, 0);
+			vec3 normal = octDecode(texelFetch(gNormal, pixel, 0).rg);
+
+			vec4 clipPos = vec4(UV * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+			vec4 worldPos = inverseViewProjection * clipPos;
+			worldPos /= worldPos.w;
+			float viewDepth = -(clusterView * worldPos).z;
+			vec3 viewDir = normalize(cameraPos - worldPos.xyz);
+
+			vec3 color = ambient * albedoSpecular.rgb;
+			color += shadeClusteredLights(worldPos.xyz, normal, viewDir, viewDepth, albedoSpecular.rgb, albedoSpecular.a);
+			FragColor = vec4(color, 1.0);
+		}
+	)";
+
+	const char* deferredGBufferGlsl() {
+		static const std::string source = std::string(octahedralSource) + gBufferWriteSource;
+		return source.c_str();
+	}
+
+	DeferredRenderer::DeferredRenderer(int width, int height)
+		: m_width(width), m_height(height) {
+		std::string fragmentSource = std::string("#version 450 core\n") + clusteredLightingGlsl() + octahedralSource + lightingFragmentMain;
+		m_lightingProgram = createShaderProgram(fullscreenVertexSource, fragmentSource.c_str());
+		m_inverseViewProjectionLocation = glGetUniformLocation(m_lightingProgram, "inverseViewProjection");
+		m_cameraPosLocation = glGetUniformLocation(m_lightingProgram, "cameraPos");
+		m_ambientLocation = glGetUniformLocation(m_lightingProgram, "ambient");
+		glGenVertexArrays(1, &m_emptyVAO);
+		createTargets();
+	}
+
+	DeferredRenderer::~DeferredRenderer() {
+		destroyTargets();
+		glDeleteProgram(m_lightingProgram);
+		glDeleteVertexArrays(1, &m_emptyVAO);
+	}
+
+	static unsigned int createTarget(GLenum internalFormat, int width, int height) {
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return texture;
+	}
+
+	void DeferredRenderer::createTargets() {
+		m_albedoSpecular = createTarget(GL_RGBA8, m_width, m_height);
+		m_normal = createTarget(GL_RG16, m_width, m_height);
+		m_depth = createTarget(GL_DEPTH_COMPONENT32F, m_width, m_height);
+		glGenFramebuffers(1, &m_framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedoSpecular, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normal, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+		GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, drawBuffers);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			printf("ERROR::FRAMEBUFFER::GBUFFER_INCOMPLETE\n");
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void DeferredRenderer::destroyTargets() {
+		glDeleteFramebuffers(1, &m_framebuffer);
+		unsigned int textures[] = { m_albedoSpecular, m_normal, m_depth };
+		glDeleteTextures(3, textures);
+	}
+
+	void DeferredRenderer::resize(int width, int height) {
+		if (width == m_width && height == m_height)
+			return;
+		destroyTargets();
+		m_width = width;
+		m_height = height;
+		createTargets();
+	}
+
+	void DeferredRenderer::beginGeometryPass() {
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		glViewport(0, 0, m_width, m_height);
+		glEnable(GL_DEPTH_TEST);
+		glDepthMask(GL_TRUE);
+		static const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		glClearBufferfv(GL_COLOR, 0, zero);
+		glClearBufferfv(GL_COLOR, 1, zero);
+		glClear(GL_DEPTH_BUFFER_BIT);
+	}
+
+	void DeferredRenderer::endGeometryPass() {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void DeferredRenderer::lightingPass(const ClusteredLighting& lighting, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos, const glm::vec3& ambient) {
+		glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+		glUseProgram(m_lightingProgram);
+		glUniformMatrix4fv(m_inverseViewProjectionLocation, 1, GL_FALSE, &inverseViewProjection[0][0]);
+		glUniform3fv(m_cameraPosLocation, 1, &cameraPos[0]);
+		glUniform3fv(m_ambientLocation, 1, &ambient[0]);
+		lighting.bind();
+		glBindTextureUnit(0, m_albedoSpecular);
+		glBindTextureUnit(1, m_normal);
+		glBindTextureUnit(2, m_depth);
+
+		//Fullscreen pass: no depth test, and the G-buffer depth must not be written anywhere
+		GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+		glDisable(GL_DEPTH_TEST);
+		glBindVertexArray(m_emptyVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		if (depthTest)
+			glEnable(GL_DEPTH_TEST);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "clusteredLighting.h"
+
+namespace ew {
+	//GLSL (450) for geometry pass fragment shaders. Declares the G-buffer outputs and
+	//	void writeGBuffer(vec3 normal, vec3 albedo, float specular)
+	//Insert it after #version.
+	const char* deferredGBufferGlsl();
+
+	//Deferred shading with a 12 byte per pixel G-buffer:
+	//	RGBA8  albedo.rgb + specular intensity
+	//	RG16   octahedral encoded world normal
+	//	D32F   depth, from which the lighting pass reconstructs position
+	//Lighting is one fullscreen pass that looks up each pixel's lights in a ClusteredLighting
+	//grid, so every pixel is shaded once no matter how much overdraw the geometry had.
+	class DeferredRenderer {
+	public:
+		DeferredRenderer(int width, int height);
+		~DeferredRenderer();
+		DeferredRenderer(const DeferredRenderer&) = delete;
+		DeferredRenderer& operator=(const DeferredRenderer&) = delete;
+
+		void resize(int width, int height);
+		//Binds and clears the G-buffer. Draw opaque geometry with shaders using deferredGBufferGlsl().
+		void beginGeometryPass();
+		//Rebinds the default framebuffer
+		void endGeometryPass();
+		//Shades every covered pixel into the currently bound framebuffer. lighting must have been
+		//built for the same view and projection. Background pixels are left untouched.
+		void lightingPass(const ClusteredLighting& lighting, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos, const glm::vec3& ambient);
+
+		//G-buffer storage per pixel, written once per covered fragment and read once when lighting
+		static int getBytesPerPixel() { return 4 + 4 + 4; }
+		unsigned int getAlbedoSpecularTexture() const { return m_albedoSpecular; }
+		unsigned int getNormalTexture() const { return m_normal; }
+		unsigned int getDepthTexture() const { return m_depth; }
+		int getWidth() const { return m_width; }
+		int getHeight() const { return m_height; }
+
+	private:
+		void createTargets();
+		void destroyTargets();
+
+		int m_width = 0;
+		int m_height = 0;
+		unsigned int m_framebuffer = 0;
+		unsigned int m_albedoSpecular = 0;
+		unsigned int m_normal = 0;
+		unsigned int m_depth = 0;
+		unsigned int m_lightingProgram = 0;
+		//Core profile needs a bound VAO even for the attributeless fullscreen triangle
+		unsigned int m_emptyVAO = 0;
+		int m_inverseViewProjectionLocation = -1;
+		int m_cameraPosLocation = -1;
+		int m_ambientLocation = -1;
+	};
+}
@@ -0,0 +1,165 @@
+#include "dynamicResolution.h"
+#include "shader.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace ew {
+	static const char* upscaleVertexSource = R"(
+		#version 450 core
+		out vec2 UV;
+		void main() {
+			UV = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+			gl_Position = vec4(UV * 2.0 - 1.0, 0.0, 1.0);
+		}
+	)";
+
+	//Bilinear upscale with a simplified AMD FidelityFX CAS: the negative lobe of the sharpening
+	//kernel is scaled by local contrast so edges that are already hard do not ring
+	static const char* upscaleFragmentSource = R"(
+		#version 450 core
+		in vec2 UV;
+		out vec4 FragColor;
+		layout(binding = 0) uniform sampler2D source;
+		//Fraction of the target covered by the scene
+		uniform vec2 uvScale;
+		uniform vec2 texelSize;
+		uniform float sharpness;
+
+		vec3 fetch(vec2 uv) {
+			//Stay inside the rendered region; the rest of the target holds stale pixels
+			return texture(source, clamp(uv, texelSize * 0.5, uvScale - texelSize * 0.5)).rgb;
+		}
+
+		void main() {
+			vec2 uv = UV * uvScale;
+			vec3 c = fetch(uv);
+			vec3 n = fetch(uv + vec2(0.0, texelSize.y));
+			vec3 s = fetch(uv - vec2(0.0, texelSize.y));
+			vec3 e = fetch(uv + vec2(texelSize.x, 0.0));
+			vec3 w = fetch(uv - vec2(texelSize.x, 0.0));
+			vec3 minColor = min(c, min(min(n, s), min(e, w)));
+			vec3 maxColor = max(c, max(max(n, s), max(e, w)));
+			vec3 amount = sqrt(clamp(min(minColor, 1.0 - maxColor) / max(maxColor, vec3(1e-4)), 0.0, 1.0));
+			vec3 lobe = -amount / mix(8.0, 5.0, sharpness);
+			vec3 color = (c + (n + s + e + w) * lobe) / (1.0 + 4.0 * lobe);
+			FragColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+		}
+	)";
+
+	DynamicResolution::DynamicResolution(int width, int height, GLenum colorFormat)
+		: m_width(width), m_height(height), m_colorFormat(colorFormat) {
+		m_program = createShaderProgram(upscaleVertexSource, upscaleFragmentSource);
+		m_uvScaleLocation = glGetUniformLocation(m_program, "uvScale");
+		m_texelSizeLocation = glGetUniformLocation(m_program, "texelSize");
+		m_sharpnessLocation = glGetUniformLocation(m_program, "sharpness");
+		glGenVertexArrays(1, &m_emptyVAO);
+		createTargets();
+		applyScale(m_settings.maxScale);
+	}
+
+	DynamicResolution::~DynamicResolution() {
+		destroyTargets();
+		glDeleteProgram(m_program);
+		glDeleteVertexArrays(1, &m_emptyVAO);
+	}
+
+	void DynamicResolution::createTargets() {
+		glGenTextures(1, &m_color);
+		glBindTexture(GL_TEXTURE_2D, m_color);
+		glTexStorage2D(GL_TEXTURE_2D, 1, m_colorFormat, m_width, m_height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glGenTextures(1, &m_depth);
+		glBindTexture(GL_TEXTURE_2D, m_depth);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, m_width, m_height);
+		glGenFramebuffers(1, &m_framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			printf("ERROR::FRAMEBUFFER::DYNAMIC_RESOLUTION_INCOMPLETE\n");
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void DynamicResolution::destroyTargets() {
+		glDeleteFramebuffers(1, &m_framebuffer);
+		unsigned int textures[] = { m_color, m_depth };
+		glDeleteTextures(2, textures);
+	}
+
+	void DynamicResolution::resize(int width, int height) {
+		if (width == m_width && height == m_height)
+			return;
+		destroyTargets();
+		m_width = width;
+		m_height = height;
+		createTargets();
+		applyScale(m_scale);
+	}
+
+	void DynamicResolution::applyScale(float scale) {
+		scale = fminf(fmaxf(scale, m_settings.minScale), m_settings.maxScale);
+		scale = fminf(fmaxf(scale, 0.1f), 1.0f);
+		//Whole multiples of 8 pixels keep tiled rasterizers and the sharpening taps aligned
+		int renderWidth = ((int)(m_width * scale) + 7) / 8 * 8;
+		int renderHeight = ((int)(m_height * scale) + 7) / 8 * 8;
+		renderWidth = renderWidth > m_width ? m_width : renderWidth;
+		renderHeight = renderHeight > m_height ? m_height : renderHeight;
+		if (renderWidth != m_renderWidth || renderHeight != m_renderHeight)
+			m_cooldown = GpuTimer::RING_SIZE;
+		m_scale = scale;
+		m_renderWidth = renderWidth;
+		m_renderHeight = renderHeight;
+	}
+
+	void DynamicResolution::updateScale() {
+		if (m_override > 0.0f) {
+			applyScale(m_override);
+			return;
+		}
+		if (m_cooldown > 0) {
+			m_cooldown--;
+			return;
+		}
+		double measured = m_timer.getMs();
+		if (measured <= 0.0)
+			return;
+		double ratio = m_settings.targetFrameMs / measured;
+		if (fabs(ratio - 1.0) <= m_settings.tolerance)
+			return;
+		float step = (float)sqrt(ratio) * m_scale - m_scale;
+		step = fminf(fmaxf(step, -0.1f), 0.1f);
+		applyScale(m_scale + step);
+	}
+
+	void DynamicResolution::beginFrame() {
+		updateScale();
+		m_timer.begin();
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		glViewport(0, 0, m_renderWidth, m_renderHeight);
+		//Scissor limits the clear to the region that will be shown
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(0, 0, m_renderWidth, m_renderHeight);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glDisable(GL_SCISSOR_TEST);
+	}
+
+	void DynamicResolution::endFrame(unsigned int outputFramebuffer) {
+		GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+		glDisable(GL_DEPTH_TEST);
+		glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+		glViewport(0, 0, m_width, m_height);
+		glUseProgram(m_program);
+		glUniform2f(m_uvScaleLocation, (float)m_renderWidth / m_width, (float)m_renderHeight / m_height);
+		glUniform2f(m_texelSizeLocation, 1.0f / m_width, 1.0f / m_height);
+		glUniform1f(m_sharpnessLocation, m_settings.sharpness);
+		glBindTextureUnit(0, m_color);
+		glBindVertexArray(m_emptyVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		if (depthTest)
+			glEnable(GL_DEPTH_TEST);
+		m_timer.end();
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "external/glad.h"
+#include "profiler.h"
+
+namespace ew {
+	struct DynamicResolutionSettings {
+		//GPU time the controller steers towards, in milliseconds
+		float targetFrameMs = 16.6f;
+		float minScale = 0.5f;
+		float maxScale = 1.0f;
+		//No change while the measured time is within this fraction of the target
+		float tolerance = 0.05f;
+		//0 soft, 1 strongest sharpening during upscale
+		float sharpness = 0.5f;
+	};
+
+	//Renders the scene at a fraction of the window resolution and picks that fraction from GPU
+	//timer feedback. The offscreen target is allocated once at window size and the scene draws
+	//into its lower left corner, so changing the scale never reallocates anything.
+	//
+	//GPU timings arrive a few frames late, so after each change the controller waits for a result
+	//measured at the new scale before deciding again. Cost is assumed to follow pixel count, so the
+	//new scale is scale * sqrt(target / measured), limited to a step of 0.1 per decision.
+	//
+	//The upscale to the window is bilinear with contrast adaptive sharpening, which restores
+	//most of the detail lost between 0.7 and 1.0 scale.
+	class DynamicResolution {
+	public:
+		DynamicResolution(int width, int height, GLenum colorFormat = GL_RGBA8);
+		~DynamicResolution();
+		DynamicResolution(const DynamicResolution&) = delete;
+		DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+		void resize(int width, int height);
+		//Updates the scale, starts the frame timer and binds the scaled target
+		void beginFrame();
+		//Upscales into outputFramebuffer at window size and stops the frame timer
+		void endFrame(unsigned int outputFramebuffer = 0);
+
+		DynamicResolutionSettings& getSettings() { return m_settings; }
+		//Fixes the scale until the next call with a negative value
+		void overrideScale(float scale) { m_override = scale; }
+		float getScale() const { return m_scale; }
+		int getRenderWidth() const { return m_renderWidth; }
+		int getRenderHeight() const { return m_renderHeight; }
+		//Latest measured GPU time of a whole frame (scene plus upscale)
+		double getFrameMs() const { return m_timer.getMs(); }
+		//Blocks until the frame timer has answered. Only for benchmarks.
+		double resolveFrameMs() { return m_timer.resolve(); }
+		unsigned int getColorTexture() const { return m_color; }
+
+	private:
+		void createTargets();
+		void destroyTargets();
+		void updateScale();
+		void applyScale(float scale);
+
+		int m_width = 0;
+		int m_height = 0;
+		GLenum m_colorFormat = GL_RGBA8;
+		DynamicResolutionSettings m_settings;
+		float m_scale = 1.0f;
+		float m_override = -1.0f;
+		int m_renderWidth = 0;
+		int m_renderHeight = 0;
+		//Frames to wait before the timer reflects the current scale
+		int m_cooldown = 0;
+
+		unsigned int m_framebuffer = 0;
+		unsigned int m_color = 0;
+		unsigned int m_depth = 0;
+		unsigned int m_program = 0;
+		unsigned int m_emptyVAO = 0;
+		int m_uvScaleLocation = -1;
+		int m_texelSizeLocation = -1;
+		int m_sharpnessLocation = -1;
+		GpuTimer m_timer;
+	};
+}
@@ -0,0 +1,224 @@
+#include "ecs.h"
+#include <algorithm>
+#include <assert.h>
+
+namespace ew {
+	namespace detail {
+		static std::mutex registryMutex;
+		static std::vector<size_t> registrySizes;
+
+		ComponentId registerComponent(size_t size) {
+			std::lock_guard<std::mutex> lock(registryMutex);
+			assert(registrySizes.size() < MAX_COMPONENTS && "Too many ECS component types");
+			registrySizes.push_back(size);
+			return (ComponentId)registrySizes.size() - 1;
+		}
+
+		size_t componentSize(ComponentId id) {
+			std::lock_guard<std::mutex> lock(registryMutex);
+			return registrySizes[id];
+		}
+	}
+
+	void CommandBuffer::push(std::function<void(World&)> command) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_commands.push_back(std::move(command));
+	}
+
+	void CommandBuffer::destroy(Entity entity) {
+		push([entity](World& world) { world.destroy(entity); });
+	}
+
+	void CommandBuffer::apply(World& world) {
+		std::vector<std::function<void(World&)>> commands;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			commands.swap(m_commands);
+		}
+		for (std::function<void(World&)>& command : commands)
+			command(world);
+	}
+
+	World::World() {
+		m_emptyArchetype = getArchetype(Signature());
+	}
+
+	void World::checkNotIterating() const {
+		assert(m_iterating.load() == 0 && "Structural ECS changes during iteration must go through World::commands()");
+	}
+
+	Archetype* World::getArchetype(const Signature& signature) {
+		auto found = m_archetypeLookup.find(signature);
+		if (found != m_archetypeLookup.end())
+			return found->second;
+		std::unique_ptr<Archetype> archetype(new Archetype());
+		archetype->signature = signature;
+		for (ComponentId id = 0; id < MAX_COMPONENTS; id++) {
+			if (!signature.test(id))
+				continue;
+			archetype->types.push_back(id);
+			archetype->sizes.push_back(detail::componentSize(id));
+		}
+		archetype->columns.resize(archetype->types.size());
+		Archetype* result = archetype.get();
+		m_archetypes.push_back(std::move(archetype));
+		m_archetypeLookup[signature] = result;
+		return result;
+	}
+
+	Archetype* World::addTarget(Archetype* from, ComponentId id) {
+		auto edge = from->addEdges.find(id);
+		if (edge != from->addEdges.end())
+			return edge->second;
+		Signature signature = from->signature;
+		signature.set(id);
+		Archetype* to = getArchetype(signature);
+		from->addEdges[id] = to;
+		return to;
+	}
+
+	Archetype* World::removeTarget(Archetype* from, ComponentId id) {
+		auto edge = from->removeEdges.find(id);
+		if (edge != from->removeEdges.end())
+			return edge->second;
+		Signature signature = from->signature;
+		signature.reset(id);
+		Archetype* to = getArchetype(signature);
+		from->removeEdges[id] = to;
+		return to;
+	}
+
+	Entity World::allocate() {
+		Entity entity;
+		if (!m_freeIndices.empty()) {
+			entity.index = m_freeIndices.back();
+			m_freeIndices.pop_back();
+		}
+		else {
+			entity.index = (uint32_t)m_records.size();
+			m_records.push_back(Record());
+		}
+		entity.generation = m_records[entity.index].generation;
+		m_aliveCount++;
+		return entity;
+	}
+
+	size_t World::pushRow(Archetype* archetype, Entity entity) {
+		size_t row = archetype->entities.size();
+		archetype->entities.push_back(entity);
+		for (size_t c = 0; c < archetype->columns.size(); c++)
+			archetype->columns[c].resize((row + 1) * archetype->sizes[c]);
+		Record& record = m_records[entity.index];
+		record.archetype = archetype;
+		record.row = row;
+		return row;
+	}
+
+	void World::removeRow(Archetype* archetype, size_t row) {
+		//Swap the last row into the hole to keep columns dense
+		size_t last = archetype->entities.size() - 1;
+		if (row != last) {
+			for (size_t c = 0; c < archetype->columns.size(); c++) {
+				size_t size = archetype->sizes[c];
+				memcpy(&archetype->columns[c][row * size], &archetype->columns[c][last * size], size);
+			}
+			Entity moved = archetype->entities[last];
+			archetype->entities[row] = moved;
+			m_records[moved.index].row = row;
+		}
+		archetype->entities.pop_back();
+		for (size_t c = 0; c < archetype->columns.size(); c++)
+			archetype->columns[c].resize(last * archetype->sizes[c]);
+	}
+
+	void* World::componentPtr(Archetype* archetype, size_t row, ComponentId id) {
+		int column = archetype->columnIndex(id);
+		return &archetype->columns[column][row * archetype->sizes[column]];
+	}
+
+	void World::moveEntity(Entity entity, Archetype* to) {
+		Record& record = m_records[entity.index];
+		Archetype* from = record.archetype;
+		size_t fromRow = record.row;
+		size_t toRow = pushRow(to, entity);
+		//Copy every component both archetypes share
+		for (size_t c = 0; c < from->types.size(); c++) {
+			int column = to->columnIndex(from->types[c]);
+			if (column < 0)
+				continue;
+			memcpy(&to->columns[column][toRow * to->sizes[column]], &from->columns[c][fromRow * from->sizes[c]], from->sizes[c]);
+		}
+		removeRow(from, fromRow);
+		//removeRow may have moved another entity, but never this one's new row
+		record.archetype = to;
+		record.row = toRow;
+	}
+
+	Entity World::create() {
+		checkNotIterating();
+		Entity entity = allocate();
+		pushRow(m_emptyArchetype, entity);
+		return entity;
+	}
+
+	void World::destroy(Entity entity) {
+		checkNotIterating();
+		if (!isAlive(entity))
+			return;
+		Record& record = m_records[entity.index];
+		removeRow(record.archetype, record.row);
+		record.archetype = nullptr;
+		record.generation++;
+		m_freeIndices.push_back(entity.index);
+		m_aliveCount--;
+	}
+
+	bool World::isAlive(Entity entity) const {
+		return entity.index < m_records.size() && m_records[entity.index].archetype != nullptr
+			&& m_records[entity.index].generation == entity.generation;
+	}
+
+	void World::flush() {
+		checkNotIterating();
+		m_commands.apply(*this);
+	}
+
+	void Scheduler::add(const System& system) {
+		size_t index = m_systems.size();
+		m_systems.push_back(system);
+		//Join the last phase if nothing in it conflicts, otherwise start a new one.
+		//Earlier phases are not considered so a system never runs before one added ahead of it.
+		if (!m_phases.empty()) {
+			bool conflict = false;
+			for (size_t other : m_phases.back()) {
+				const System& o = m_systems[other];
+				if ((system.writes & (o.reads | o.writes)).any() || (o.writes & system.reads).any())
+					conflict = true;
+			}
+			if (!conflict) {
+				m_phases.back().push_back(index);
+				return;
+			}
+		}
+		m_phases.push_back({ index });
+	}
+
+	void Scheduler::run(World& world, JobSystem* jobs) {
+		for (const std::vector<size_t>& phase : m_phases) {
+			if (!jobs || phase.size() == 1) {
+				for (size_t index : phase)
+					m_systems[index].run(world);
+			}
+			else {
+				JobCounter counter;
+				for (size_t i = 1; i < phase.size(); i++) {
+					System* system = &m_systems[phase[i]];
+					jobs->submit([system, &world] { system->run(world); }, &counter);
+				}
+				m_systems[phase[0]].run(world);
+				jobs->wait(counter);
+			}
+			world.flush();
+		}
+	}
+}
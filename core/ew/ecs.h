@@ -0,0 +1,284 @@
+#pragma once
+#include <atomic>
+#include <bitset>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "jobSystem.h"
+
+namespace ew {
+	//Archetype entity-component-system. Entities with the same set of components share an
+	//archetype whose components live in tightly packed per-type columns, so queries walk
+	//contiguous arrays instead of chasing objects.
+	//Components must be trivially copyable; rows are moved between archetypes with memcpy.
+
+	const unsigned int MAX_COMPONENTS = 64;
+	typedef unsigned int ComponentId;
+	typedef std::bitset<MAX_COMPONENTS> Signature;
+
+	struct Entity {
+		uint32_t index = ~0u;
+		uint32_t generation = 0;
+		bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Entity& other) const { return !(*this == other); }
+	};
+
+	namespace detail {
+		ComponentId registerComponent(size_t size);
+		size_t componentSize(ComponentId id);
+	}
+
+	template<typename T>
+	ComponentId componentId() {
+		static_assert(std::is_trivially_copyable<T>::value, "ECS components must be trivially copyable");
+		static const ComponentId id = detail::registerComponent(sizeof(T));
+		return id;
+	}
+
+	template<typename... Cs>
+	Signature signatureOf() {
+		Signature signature;
+		int expand[] = { 0, (signature.set(componentId<Cs>()), 0)... };
+		(void)expand;
+		return signature;
+	}
+
+	struct Archetype {
+		Signature signature;
+		//Sorted component ids; columns[i] stores types[i]
+		std::vector<ComponentId> types;
+		std::vector<std::vector<uint8_t>> columns;
+		std::vector<size_t> sizes;
+		std::vector<Entity> entities;
+		//Cached transitions when a component is added or removed
+		std::unordered_map<ComponentId, Archetype*> addEdges;
+		std::unordered_map<ComponentId, Archetype*> removeEdges;
+
+		int columnIndex(ComponentId id) const {
+			for (size_t i = 0; i < types.size(); i++) {
+				if (types[i] == id)
+					return (int)i;
+			}
+			return -1;
+		}
+		template<typename T>
+		T* column() { return reinterpret_cast<T*>(columns[columnIndex(componentId<T>())].data()); }
+		size_t size() const { return entities.size(); }
+	};
+
+	class World;
+
+	//Structural changes recorded during iteration and applied by World::flush().
+	//Recording is thread safe so parallel systems can share one buffer.
+	class CommandBuffer {
+	public:
+		void destroy(Entity entity);
+		template<typename T>
+		void add(Entity entity, const T& component);
+		template<typename T>
+		void remove(Entity entity);
+		template<typename... Cs>
+		void create(const Cs&... components);
+
+		void apply(World& world);
+		bool empty() const { return m_commands.empty(); }
+
+	private:
+		void push(std::function<void(World&)> command);
+		std::vector<std::function<void(World&)>> m_commands;
+		std::mutex m_mutex;
+	};
+
+	class World {
+	public:
+		World();
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		Entity create();
+		template<typename... Cs>
+		Entity create(const Cs&... components);
+		void destroy(Entity entity);
+		bool isAlive(Entity entity) const;
+
+		template<typename T>
+		void add(Entity entity, const T& component);
+		template<typename T>
+		void remove(Entity entity);
+		template<typename T>
+		bool has(Entity entity) const;
+		//Pointer into the component column. Invalidated by any structural change.
+		template<typename T>
+		T* get(Entity entity);
+
+		//Calls fn(count, entities, Cs* columns...) once per matching archetype. This is the
+		//tightest loop the ECS offers; each column is a plain array of count components.
+		template<typename... Cs, typename Fn>
+		void eachChunk(Fn&& fn);
+		//Calls fn(Cs&...) for every entity that has all of Cs
+		template<typename... Cs, typename Fn>
+		void each(Fn&& fn);
+		//Like each(), with each archetype's rows split across the job system
+		template<typename... Cs, typename Fn>
+		void parallelEach(JobSystem& jobs, Fn&& fn, size_t minBatch = 4096);
+
+		//Deferred structural changes; applied by flush()
+		CommandBuffer& commands() { return m_commands; }
+		void flush();
+
+		size_t entityCount() const { return m_aliveCount; }
+		size_t archetypeCount() const { return m_archetypes.size(); }
+
+	private:
+		struct Record {
+			Archetype* archetype = nullptr;
+			size_t row = 0;
+			uint32_t generation = 0;
+		};
+
+		Archetype* getArchetype(const Signature& signature);
+		Archetype* addTarget(Archetype* from, ComponentId id);
+		Archetype* removeTarget(Archetype* from, ComponentId id);
+		Entity allocate();
+		size_t pushRow(Archetype* archetype, Entity entity);
+		void removeRow(Archetype* archetype, size_t row);
+		void moveEntity(Entity entity, Archetype* to);
+		void* componentPtr(Archetype* archetype, size_t row, ComponentId id);
+		void checkNotIterating() const;
+
+		std::vector<std::unique_ptr<Archetype>> m_archetypes;
+		std::unordered_map<Signature, Archetype*> m_archetypeLookup;
+		Archetype* m_emptyArchetype = nullptr;
+		std::vector<Record> m_records;
+		std::vector<uint32_t> m_freeIndices;
+		size_t m_aliveCount = 0;
+		//Queries may run concurrently from parallel systems
+		std::atomic<int> m_iterating{ 0 };
+		CommandBuffer m_commands;
+	};
+
+	//A system declares which components it reads and writes. Scheduler groups systems into
+	//phases with no write conflicts, runs each phase's systems in parallel and applies
+	//deferred commands between phases. Systems keep their insertion order across phases.
+	struct System {
+		const char* name;
+		Signature reads;
+		Signature writes;
+		std::function<void(World&)> run;
+	};
+
+	class Scheduler {
+	public:
+		void add(const System& system);
+		void run(World& world, JobSystem* jobs = nullptr);
+		size_t getPhaseCount() const { return m_phases.size(); }
+	private:
+		std::vector<System> m_systems;
+		std::vector<std::vector<size_t>> m_phases;
+	};
+
+	//Template implementations
+
+	template<typename T>
+	void CommandBuffer::add(Entity entity, const T& component) {
+		push([entity, component](World& world) { world.add<T>(entity, component); });
+	}
+
+	template<typename T>
+	void CommandBuffer::remove(Entity entity) {
+		push([entity](World& world) { world.remove<T>(entity); });
+	}
+
+	template<typename... Cs>
+	void CommandBuffer::create(const Cs&... components) {
+		std::tuple<Cs...> values(components...);
+		push([values](World& world) {
+			Entity entity = world.create();
+			int expand[] = { 0, (world.add<Cs>(entity, std::get<Cs>(values)), 0)... };
+			(void)expand;
+		});
+	}
+
+	template<typename... Cs>
+	Entity World::create(const Cs&... components) {
+		checkNotIterating();
+		Entity entity = allocate();
+		Archetype* archetype = getArchetype(signatureOf<Cs...>());
+		size_t row = pushRow(archetype, entity);
+		int expand[] = { 0, (memcpy(componentPtr(archetype, row, componentId<Cs>()), &components, sizeof(Cs)), 0)... };
+		(void)expand;
+		return entity;
+	}
+
+	template<typename T>
+	void World::add(Entity entity, const T& component) {
+		checkNotIterating();
+		if (!isAlive(entity))
+			return;
+		ComponentId id = componentId<T>();
+		Record& record = m_records[entity.index];
+		if (!record.archetype->signature.test(id))
+			moveEntity(entity, addTarget(record.archetype, id));
+		memcpy(componentPtr(record.archetype, record.row, id), &component, sizeof(T));
+	}
+
+	template<typename T>
+	void World::remove(Entity entity) {
+		checkNotIterating();
+		if (!isAlive(entity))
+			return;
+		ComponentId id = componentId<T>();
+		Record& record = m_records[entity.index];
+		if (record.archetype->signature.test(id))
+			moveEntity(entity, removeTarget(record.archetype, id));
+	}
+
+	template<typename T>
+	bool World::has(Entity entity) const {
+		return isAlive(entity) && m_records[entity.index].archetype->signature.test(componentId<T>());
+	}
+
+	template<typename T>
+	T* World::get(Entity entity) {
+		if (!has<T>(entity))
+			return nullptr;
+		const Record& record = m_records[entity.index];
+		return reinterpret_cast<T*>(componentPtr(record.archetype, record.row, componentId<T>()));
+	}
+
+	template<typename... Cs, typename Fn>
+	void World::eachChunk(Fn&& fn) {
+		Signature required = signatureOf<Cs...>();
+		m_iterating++;
+		for (const std::unique_ptr<Archetype>& archetype : m_archetypes) {
+			if (archetype->size() == 0 || (archetype->signature & required) != required)
+				continue;
+			fn(archetype->size(), archetype->entities.data(), archetype->template column<Cs>()...);
+		}
+		m_iterating--;
+	}
+
+	template<typename... Cs, typename Fn>
+	void World::each(Fn&& fn) {
+		eachChunk<Cs...>([&fn](size_t count, const Entity*, Cs*... columns) {
+			for (size_t i = 0; i < count; i++)
+				fn(columns[i]...);
+		});
+	}
+
+	template<typename... Cs, typename Fn>
+	void World::parallelEach(JobSystem& jobs, Fn&& fn, size_t minBatch) {
+		eachChunk<Cs...>([&](size_t count, const Entity*, Cs*... columns) {
+			jobs.parallelFor(count, minBatch, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					fn(columns[i]...);
+			});
+		});
+	}
+}
@@ -0,0 +1,120 @@
+#include "fileWatcher.h"
+#include <stdio.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace ew {
+	static long long modifiedTime(const std::string& path) {
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0)
+			return -1;
+		return (long long)info.st_mtime;
+	}
+
+	FileWatcher::FileWatcher(int debounceMs) : m_debounce(debounceMs) {
+#ifdef __linux__
+		m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_inotify < 0)
+			printf("ERROR::FILEWATCHER::INOTIFY_INIT_FAILED, falling back to polling\n");
+#endif
+		m_thread = std::thread(&FileWatcher::run, this);
+	}
+
+	FileWatcher::~FileWatcher() {
+		m_running = false;
+		m_thread.join();
+#ifdef __linux__
+		if (m_inotify >= 0)
+			close(m_inotify);
+#endif
+	}
+
+	void FileWatcher::watch(const std::string& path) {
+		WatchedFile file;
+		file.path = path;
+		size_t slash = path.find_last_of("/\\");
+		file.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+		file.name = slash == std::string::npos ? path : path.substr(slash + 1);
+		file.modifiedTime = modifiedTime(path);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const WatchedFile& existing : m_files) {
+			if (existing.path == path)
+				return;
+		}
+#ifdef __linux__
+		if (m_inotify >= 0 && m_directoryWatches.find(file.directory) == m_directoryWatches.end()) {
+			int wd = inotify_add_watch(m_inotify, file.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+			if (wd < 0)
+				printf("ERROR::FILEWATCHER::WATCH_FAILED %s\n", file.directory.c_str());
+			m_directoryWatches[file.directory] = wd;
+		}
+#endif
+		m_files.push_back(file);
+	}
+
+	std::vector<std::string> FileWatcher::poll() {
+		std::vector<std::string> changed;
+		Clock::time_point now = Clock::now();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto it = m_changed.begin(); it != m_changed.end();) {
+			if (now - it->second >= m_debounce) {
+				changed.push_back(it->first);
+				it = m_changed.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+		return changed;
+	}
+
+	//Caller holds m_mutex
+	void FileWatcher::markChanged(const std::string& path) {
+		m_changed[path] = Clock::now();
+	}
+
+	void FileWatcher::run() {
+		while (m_running) {
+#ifdef __linux__
+			if (m_inotify >= 0) {
+				pollfd descriptor = { m_inotify, POLLIN, 0 };
+				//Wake up periodically to notice shutdown
+				if (::poll(&descriptor, 1, 100) <= 0)
+					continue;
+				alignas(inotify_event) char buffer[4096];
+				ssize_t length;
+				while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0) {
+					std::lock_guard<std::mutex> lock(m_mutex);
+					for (char* ptr = buffer; ptr < buffer + length;) {
+						const inotify_event* event = (const inotify_event*)ptr;
+						ptr += sizeof(inotify_event) + event->len;
+						if (event->len == 0)
+							continue;
+						for (const WatchedFile& file : m_files) {
+							auto watch = m_directoryWatches.find(file.directory);
+							if (watch != m_directoryWatches.end() && watch->second == event->wd && file.name == event->name)
+								markChanged(file.path);
+						}
+					}
+				}
+				continue;
+			}
+#endif
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (WatchedFile& file : m_files) {
+				long long time = modifiedTime(file.path);
+				if (time != file.modifiedTime) {
+					file.modifiedTime = time;
+					if (time >= 0)
+						markChanged(file.path);
+				}
+			}
+		}
+	}
+}
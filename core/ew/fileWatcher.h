@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ew {
+	//Watches individual files for modification on a background thread. Uses inotify on Linux
+	//(directory watches, so editors that save by rename are caught) and polls timestamps
+	//elsewhere. Changes are debounced so a save that writes the file in several steps is
+	//reported once.
+	class FileWatcher {
+	public:
+		explicit FileWatcher(int debounceMs = 50);
+		~FileWatcher();
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		void watch(const std::string& path);
+		//Paths, exactly as passed to watch(), that changed since the last call. Never blocks.
+		std::vector<std::string> poll();
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+		struct WatchedFile {
+			std::string path;
+			std::string directory;
+			std::string name;
+			long long modifiedTime;
+		};
+		void run();
+		void markChanged(const std::string& path);
+
+		std::mutex m_mutex;
+		std::vector<WatchedFile> m_files;
+		std::map<std::string, int> m_directoryWatches;
+		//Last change time per path, reported once it is older than the debounce interval
+		std::map<std::string, Clock::time_point> m_changed;
+		std::chrono::milliseconds m_debounce;
+		int m_inotify = -1;
+		std::atomic<bool> m_running{ true };
+		std::thread m_thread;
+	};
+}
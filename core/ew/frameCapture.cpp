@@ -0,0 +1,220 @@
+#include "frameCapture.h"
+#include "pngEncoder.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace ew {
+	static void makeDirectory(const std::string& path) {
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+
+	//Runs on a worker: GL rows are bottom-up RGBA, image files are top-down RGB
+	static void writeCapture(const std::vector<unsigned char>& rgba, int width, int height, const std::string& path, CaptureFormat format, FrameCaptureStats& stats) {
+		std::vector<unsigned char> rgb((size_t)width * height * 3);
+		for (int y = 0; y < height; y++) {
+			const unsigned char* src = &rgba[(size_t)(height - 1 - y) * width * 4];
+			unsigned char* dst = &rgb[(size_t)y * width * 3];
+			for (int x = 0; x < width; x++) {
+				dst[x * 3 + 0] = src[x * 4 + 0];
+				dst[x * 3 + 1] = src[x * 4 + 1];
+				dst[x * 3 + 2] = src[x * 4 + 2];
+			}
+		}
+
+		std::vector<unsigned char> encoded;
+		if (format == CaptureFormat::PNG) {
+			encoded = encodePNG(rgb.data(), width, height, 3);
+		}
+		else {
+			char header[64];
+			int headerSize = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+			encoded.reserve(headerSize + rgb.size());
+			encoded.insert(encoded.end(), header, header + headerSize);
+			encoded.insert(encoded.end(), rgb.begin(), rgb.end());
+		}
+
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file || fwrite(encoded.data(), 1, encoded.size(), file) != encoded.size()) {
+			printf("ERROR::CAPTURE::Failed to write %s\n", path.c_str());
+			stats.writeFailures++;
+			if (file)
+				fclose(file);
+			return;
+		}
+		fclose(file);
+		stats.framesWritten++;
+		stats.bytesWritten += encoded.size();
+	}
+
+	FrameCapture::FrameCapture(JobSystem& jobs, const FrameCaptureSettings& settings)
+		: m_jobs(jobs), m_settings(settings) {
+		if (m_settings.ringSize < 1)
+			m_settings.ringSize = 1;
+		m_ring.resize(m_settings.ringSize);
+	}
+
+	FrameCapture::~FrameCapture() {
+		clear();
+	}
+
+	void FrameCapture::capture(const std::string& path, int width, int height, CaptureFormat format, unsigned int framebuffer) {
+		if (width <= 0 || height <= 0)
+			return;
+		Readback& readback = m_ring[m_next];
+		if (readback.fence) {
+			//Every buffer is still in flight: wait for the oldest rather than drop a frame
+			m_stats.readbackStalls++;
+			collect(readback);
+		}
+		waitForWriters(m_settings.maxPendingWrites);
+
+		size_t size = (size_t)width * height * 4;
+		if (!readback.buffer)
+			glGenBuffers(1, &readback.buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		if (readback.bufferSize != size) {
+			glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_READ);
+			readback.bufferSize = size;
+		}
+
+		GLint previousFramebuffer = 0, previousAlignment = 4;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFramebuffer);
+		glGetIntegerv(GL_PACK_ALIGNMENT, &previousAlignment);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		//Into a bound pack buffer this only queues the copy; nothing waits for the GPU here
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+		glPixelStorei(GL_PACK_ALIGNMENT, previousAlignment);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, previousFramebuffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		readback.path = path;
+		readback.width = width;
+		readback.height = height;
+		readback.format = format;
+		m_next = (m_next + 1) % m_settings.ringSize;
+		m_stats.framesCaptured++;
+	}
+
+	void FrameCapture::startRecording(const std::string& directory, CaptureFormat format, int frameCount, int skipFrames) {
+		makeDirectory(directory);
+		m_directory = directory;
+		m_format = format;
+		m_framesLeft = frameCount;
+		m_skipFrames = skipFrames;
+		m_frameIndex = 0;
+		m_finished = false;
+		m_recording = frameCount != 0;
+	}
+
+	bool FrameCapture::startRecordingFromEnvironment() {
+		const char* directory = getenv("EW_CAPTURE_DIR");
+		if (!directory || !directory[0])
+			return false;
+		const char* format = getenv("EW_CAPTURE_FORMAT");
+		const char* count = getenv("EW_CAPTURE_COUNT");
+		const char* skip = getenv("EW_CAPTURE_SKIP");
+		CaptureFormat captureFormat = format && strcmp(format, "raw") == 0 ? CaptureFormat::Raw : CaptureFormat::PNG;
+		startRecording(directory, captureFormat, count ? atoi(count) : -1, skip ? atoi(skip) : 0);
+		printf("Recording frames to %s\n", directory);
+		return true;
+	}
+
+	void FrameCapture::endFrame(int width, int height, unsigned int framebuffer) {
+		if (m_recording) {
+			if (m_skipFrames > 0) {
+				m_skipFrames--;
+			}
+			else {
+				char name[32];
+				snprintf(name, sizeof(name), "/frame_%06d.%s", m_frameIndex++, m_format == CaptureFormat::PNG ? "png" : "ppm");
+				capture(m_directory + name, width, height, m_format, framebuffer);
+				if (m_framesLeft > 0 && --m_framesLeft == 0) {
+					m_recording = false;
+					m_finished = true;
+				}
+			}
+		}
+		collectFinished();
+	}
+
+	void FrameCapture::flush() {
+		//Oldest first so files are handed to workers in capture order
+		for (int i = 0; i < m_settings.ringSize; i++) {
+			Readback& readback = m_ring[(m_next + i) % m_settings.ringSize];
+			if (readback.fence)
+				collect(readback);
+		}
+		m_jobs.wait(m_writes);
+	}
+
+	void FrameCapture::clear() {
+		flush();
+		for (Readback& readback : m_ring) {
+			if (readback.buffer)
+				glDeleteBuffers(1, &readback.buffer);
+			readback.buffer = 0;
+			readback.bufferSize = 0;
+		}
+	}
+
+	void FrameCapture::collectFinished() {
+		for (int i = 0; i < m_settings.ringSize; i++) {
+			Readback& readback = m_ring[(m_next + i) % m_settings.ringSize];
+			if (readback.fence && glClientWaitSync(readback.fence, 0, 0) != GL_TIMEOUT_EXPIRED)
+				collect(readback);
+		}
+	}
+
+	void FrameCapture::collect(Readback& readback) {
+		//Returns at once when already signaled; otherwise waits, flushing so the fence can complete
+		while (glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+		glDeleteSync(readback.fence);
+		readback.fence = nullptr;
+
+		//Copied out so the buffer can be reused next frame while workers encode
+		std::shared_ptr<std::vector<unsigned char>> pixels = std::make_shared<std::vector<unsigned char>>(readback.bufferSize);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)readback.bufferSize, GL_MAP_READ_BIT);
+		bool ok = mapped != nullptr;
+		if (ok) {
+			memcpy(pixels->data(), mapped, readback.bufferSize);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		if (!ok) {
+			printf("ERROR::CAPTURE::Failed to map readback for %s\n", readback.path.c_str());
+			m_stats.writeFailures++;
+			return;
+		}
+
+		std::string path = readback.path;
+		int width = readback.width, height = readback.height;
+		CaptureFormat format = readback.format;
+		FrameCaptureStats* stats = &m_stats;
+		m_jobs.submit([pixels, width, height, path, format, stats]() {
+			writeCapture(*pixels, width, height, path, format, *stats);
+		}, &m_writes);
+	}
+
+	void FrameCapture::waitForWriters(int maxPending) {
+		if (m_writes.pending.load() < maxPending)
+			return;
+		m_stats.writeStalls++;
+		while (m_writes.pending.load() >= maxPending)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "external/glad.h"
+#include "jobSystem.h"
+
+namespace ew {
+	enum class CaptureFormat {
+		PNG,
+		//Binary PPM: uncompressed RGB behind a short text header, cheapest to write
+		Raw
+	};
+
+	struct FrameCaptureSettings {
+		//Pixel pack buffers in flight; a readback is collected this many captures later at most
+		int ringSize = 4;
+		//Frames read back but not yet written. Capturing past this waits for the workers
+		//rather than letting memory grow without bound when encoding can't keep up.
+		int maxPendingWrites = 16;
+	};
+
+	struct FrameCaptureStats {
+		size_t framesCaptured = 0;
+		std::atomic<size_t> framesWritten{ 0 };
+		std::atomic<size_t> writeFailures{ 0 };
+		std::atomic<size_t> bytesWritten{ 0 };
+		//Captures that had to wait on the GPU because every pixel pack buffer was busy
+		size_t readbackStalls = 0;
+		//Captures that had to wait for workers to drain maxPendingWrites
+		size_t writeStalls = 0;
+	};
+
+	//Screenshots and frame sequences without stalling the pipeline. Each capture copies the
+	//framebuffer into a pixel pack buffer and fences it; later frames map buffers whose fence
+	//has signaled, and workers flip, convert and encode the pixels and write the file.
+	//Call endFrame() once per frame after drawing and before swapping buffers.
+	class FrameCapture {
+	public:
+		explicit FrameCapture(JobSystem& jobs, const FrameCaptureSettings& settings = FrameCaptureSettings());
+		//Writes everything still queued
+		~FrameCapture();
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		//Queues a readback of the lower-left width x height of framebuffer (0 = back buffer)
+		//to be written to path
+		void capture(const std::string& path, int width, int height, CaptureFormat format = CaptureFormat::PNG, unsigned int framebuffer = 0);
+
+		//Captures frames to directory/frame_000000.png and so on, one per endFrame().
+		//frameCount < 0 records until stopRecording(); skipFrames are rendered first without capturing.
+		void startRecording(const std::string& directory, CaptureFormat format = CaptureFormat::PNG, int frameCount = -1, int skipFrames = 0);
+		void stopRecording() { m_recording = false; }
+		bool isRecording() const { return m_recording; }
+		//True once a recording started with a frame count has captured all of its frames
+		bool isFinished() const { return m_finished; }
+
+		//Starts a recording from EW_CAPTURE_DIR if it is set, so any executable calling
+		//endFrame() can be captured without code changes:
+		//  EW_CAPTURE_FORMAT  png (default) or raw
+		//  EW_CAPTURE_COUNT   frames to record, all frames if unset
+		//  EW_CAPTURE_SKIP    frames to render before the first capture
+		//Returns true if a recording was started.
+		bool startRecordingFromEnvironment();
+
+		//Records this frame from framebuffer if recording and hands finished readbacks to workers
+		void endFrame(int width, int height, unsigned int framebuffer = 0);
+		//Blocks until every queued capture is on disk
+		void flush();
+		//Flushes and deletes the pack buffers now, for mains that destroy the GL context before this goes out of scope
+		void clear();
+
+		const FrameCaptureStats& getStats() const { return m_stats; }
+
+	private:
+		struct Readback {
+			unsigned int buffer = 0;
+			size_t bufferSize = 0;
+			GLsync fence = nullptr;
+			std::string path;
+			int width = 0;
+			int height = 0;
+			CaptureFormat format = CaptureFormat::PNG;
+		};
+		//Maps a finished readback and queues its conversion and write
+		void collect(Readback& readback);
+		void collectFinished();
+		void waitForWriters(int maxPending);
+
+		JobSystem& m_jobs;
+		FrameCaptureSettings m_settings;
+		std::vector<Readback> m_ring;
+		int m_next = 0;
+		JobCounter m_writes;
+		FrameCaptureStats m_stats;
+
+		bool m_recording = false;
+		bool m_finished = false;
+		std::string m_directory;
+		CaptureFormat m_format = CaptureFormat::PNG;
+		int m_framesLeft = -1;
+		int m_skipFrames = 0;
+		int m_frameIndex = 0;
+	};
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <math.h>
+#include <glm/glm.hpp>
+
+namespace ew {
+	//Six normalized planes (xyz normal pointing inside, w distance) in the order
+	//left, right, bottom, top, near, far. Extracted from a view-projection matrix.
+	struct Frustum {
+		glm::vec4 planes[6];
+	};
+
+	inline Frustum extractFrustum(const glm::mat4& viewProjection) {
+		//Rows of the matrix (glm is column major)
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++)
+			rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		Frustum frustum;
+		frustum.planes[0] = rows[3] + rows[0];
+		frustum.planes[1] = rows[3] - rows[0];
+		frustum.planes[2] = rows[3] + rows[1];
+		frustum.planes[3] = rows[3] - rows[1];
+		frustum.planes[4] = rows[3] + rows[2];
+		frustum.planes[5] = rows[3] - rows[2];
+		for (int i = 0; i < 6; i++)
+			frustum.planes[i] /= glm::length(glm::vec3(frustum.planes[i]));
+		return frustum;
+	}
+
+	inline bool sphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius) {
+		for (int i = 0; i < 6; i++) {
+			if (glm::dot(glm::vec3(frustum.planes[i]), center) + frustum.planes[i].w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	//Bounding sphere of a point cloud as xyz center, w radius. Centered on the AABB, not minimal.
+	template<typename It, typename GetPos>
+	glm::vec4 computeBoundingSphere(It begin, It end, GetPos getPos) {
+		if (begin == end)
+			return glm::vec4(0.0f);
+		glm::vec3 minPos = getPos(*begin), maxPos = minPos;
+		for (It it = begin; it != end; ++it) {
+			minPos = glm::min(minPos, getPos(*it));
+			maxPos = glm::max(maxPos, getPos(*it));
+		}
+		glm::vec3 center = (minPos + maxPos) * 0.5f;
+		float radiusSq = 0.0f;
+		for (It it = begin; it != end; ++it) {
+			glm::vec3 d = getPos(*it) - center;
+			radiusSq = glm::max(radiusSq, glm::dot(d, d));
+		}
+		return glm::vec4(center, sqrtf(radiusSq));
+	}
+}
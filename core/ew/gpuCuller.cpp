@@ -0,0 +1,187 @@
+#include "gpuCuller.h"
+#include "external/glad.h"
+#include "frustum.h"
+#include "shader.h"
+#include <stdio.h>
+
+namespace ew {
+	static const unsigned int WORKGROUP_SIZE = 64;
+
+	//Binding 0 is left for the output so draw() can reuse it as the MegaBuffer draw data
+	static const char* cullComputeSource = R"(
+		#version 450 core
+		layout(local_size_x = 64) in;
+
+		struct DrawData {
+			mat4 model;
+			vec4 color;
+		};
+		struct CullInstance {
+			mat4 model;
+			vec4 color;
+			uint meshId;
+		};
+		struct DrawCommand {
+			uint count;
+			uint instanceCount;
+			uint firstIndex;
+			int baseVertex;
+			uint baseInstance;
+		};
+
+		layout(std430, binding = 0) writeonly buffer VisibleBuffer { DrawData visible[]; };
+		layout(std430, binding = 1) readonly buffer InstanceBuffer { CullInstance instances[]; };
+		layout(std430, binding = 2) readonly buffer MeshBoundsBuffer { vec4 meshBounds[]; };
+		layout(std430, binding = 3) buffer CommandBuffer { DrawCommand commands[]; };
+
+		uniform vec4 planes[6];
+		uniform uint instanceCount;
+
+		void main() {
+			uint id = gl_GlobalInvocationID.x;
+			if (id >= instanceCount)
+				return;
+			CullInstance instance = instances[id];
+			vec4 bounds = meshBounds[instance.meshId];
+
+			//World space sphere, conservatively scaled by the largest axis
+			vec3 center = (instance.model * vec4(bounds.xyz, 1.0)).xyz;
+			float scale = max(length(instance.model[0].xyz), max(length(instance.model[1].xyz), length(instance.model[2].xyz)));
+			float radius = bounds.w * scale;
+			for (int i = 0; i < 6; i++) {
+				if (dot(planes[i].xyz, center) + planes[i].w < -radius)
+					return;
+			}
+
+			uint slot = atomicAdd(commands[instance.meshId].instanceCount, 1u);
+			uint index = commands[instance.meshId].baseInstance + slot;
+			visible[index].model = instance.model;
+			visible[index].color = instance.color;
+		}
+	)";
+
+	GpuCuller::GpuCuller(const MegaBuffer& megaBuffer)
+		: m_megaBuffer(megaBuffer) {
+		m_program = createComputeProgram(cullComputeSource);
+		m_planesLocation = glGetUniformLocation(m_program, "planes");
+		m_instanceCountLocation = glGetUniformLocation(m_program, "instanceCount");
+		glGenBuffers(1, &m_instanceBuffer);
+		glGenBuffers(1, &m_meshBoundsBuffer);
+		glGenBuffers(1, &m_templateCommandBuffer);
+		glGenBuffers(1, &m_commandBuffer);
+		glGenBuffers(1, &m_visibleBuffer);
+	}
+
+	GpuCuller::~GpuCuller() {
+		glDeleteProgram(m_program);
+		unsigned int buffers[] = { m_instanceBuffer, m_meshBoundsBuffer, m_templateCommandBuffer, m_commandBuffer, m_visibleBuffer };
+		glDeleteBuffers(5, buffers);
+	}
+
+	void GpuCuller::setInstances(const std::vector<CullInstance>& instances) {
+		m_instanceCount = (unsigned int)instances.size();
+		m_commandCount = m_megaBuffer.getMeshCount();
+		m_droppedInstances = 0;
+		if (m_instanceCount > m_megaBuffer.getMaxInstances()) {
+			m_droppedInstances = m_instanceCount - m_megaBuffer.getMaxInstances();
+			//Once per culler; scenes that re-upload instances every frame would otherwise flood the log
+			if (!m_warnedOverflow) {
+				printf("ERROR::GPU_CULLER::%u instances exceed the MegaBuffer limit of %u, the rest are not drawn\n", m_instanceCount, m_megaBuffer.getMaxInstances());
+				m_warnedOverflow = true;
+			}
+			m_instanceCount = m_megaBuffer.getMaxInstances();
+		}
+
+		//One command per mesh, sized to hold every instance of that mesh. The cull shader indexes
+		//commands by meshId too, so a set with a bad id is rejected whole.
+		std::vector<unsigned int> capacity(m_commandCount, 0);
+		for (unsigned int i = 0; i < m_instanceCount; i++) {
+			if (instances[i].meshId >= m_commandCount) {
+				printf("ERROR::GPU_CULLER::Instance %u has mesh id %u, but the MegaBuffer has %u meshes\n", i, instances[i].meshId, m_commandCount);
+				m_instanceCount = 0;
+				m_commandCount = 0;
+				return;
+			}
+			capacity[instances[i].meshId]++;
+		}
+		std::vector<DrawElementsIndirectCommand> commands(m_commandCount);
+		std::vector<glm::vec4> bounds(m_commandCount);
+		unsigned int baseInstance = 0;
+		for (unsigned int m = 0; m < m_commandCount; m++) {
+			const MeshRange& mesh = m_megaBuffer.getMesh(m);
+			commands[m].count = mesh.indexCount;
+			commands[m].instanceCount = 0;
+			commands[m].firstIndex = mesh.firstIndex;
+			commands[m].baseVertex = mesh.baseVertex;
+			commands[m].baseInstance = baseInstance;
+			bounds[m] = mesh.boundingSphere;
+			baseInstance += capacity[m];
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_instanceCount * sizeof(CullInstance), instances.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_meshBoundsBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, bounds.size() * sizeof(glm::vec4), bounds.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_visibleBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_instanceCount * sizeof(DrawData), NULL, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_COPY_READ_BUFFER, m_templateCommandBuffer);
+		glBufferData(GL_COPY_READ_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_commandBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_COPY);
+	}
+
+	void GpuCuller::updateInstances(unsigned int first, const CullInstance* instances, unsigned int count) {
+		if (first > m_instanceCount || count > m_instanceCount - first) {
+			printf("ERROR::GPU_CULLER::Update of instances [%u, %u) is past the %u uploaded instances\n", first, first + count, m_instanceCount);
+			return;
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			if (instances[i].meshId >= m_commandCount) {
+				printf("ERROR::GPU_CULLER::Instance %u has mesh id %u, but the MegaBuffer has %u meshes\n", first + i, instances[i].meshId, m_commandCount);
+				return;
+			}
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * sizeof(CullInstance), count * sizeof(CullInstance), instances);
+	}
+
+	void GpuCuller::cull(const glm::mat4& viewProjection) {
+		if (m_instanceCount == 0)
+			return;
+		//Reset instance counts on the GPU by copying the zeroed template
+		glBindBuffer(GL_COPY_READ_BUFFER, m_templateCommandBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_commandBuffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_commandCount * sizeof(DrawElementsIndirectCommand));
+
+		Frustum frustum = extractFrustum(viewProjection);
+		glUseProgram(m_program);
+		glUniform4fv(m_planesLocation, 6, &frustum.planes[0][0]);
+		glUniform1ui(m_instanceCountLocation, m_instanceCount);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_visibleBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_instanceBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_meshBoundsBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_commandBuffer);
+		glDispatchCompute((m_instanceCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	void GpuCuller::draw() {
+		if (m_instanceCount == 0)
+			return;
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MEGABUFFER_DRAW_DATA_BINDING, m_visibleBuffer);
+		glBindVertexArray(m_megaBuffer.getVAO());
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)m_commandCount, 0);
+	}
+
+	unsigned int GpuCuller::readVisibleCount() {
+		std::vector<DrawElementsIndirectCommand> commands(m_commandCount);
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glBindBuffer(GL_COPY_READ_BUFFER, m_commandBuffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+		unsigned int visible = 0;
+		for (const DrawElementsIndirectCommand& cmd : commands)
+			visible += cmd.instanceCount;
+		return visible;
+	}
+}
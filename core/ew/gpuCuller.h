@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "megaBuffer.h"
+
+namespace ew {
+	//Instance as stored on the GPU for culling, std430 layout
+	struct CullInstance {
+		glm::mat4 model;
+		glm::vec4 color;
+		unsigned int meshId;
+		unsigned int pad[3];
+	};
+
+	//Frustum culls instances in a compute shader and compacts survivors straight into the
+	//indirect command buffer of a MegaBuffer pass. The CPU only uploads the camera planes
+	//and dispatches; it never touches individual instances per frame.
+	//
+	//Each mesh gets one command with a fixed output region [baseInstance, baseInstance + capacity).
+	//Visible instances claim a slot with atomicAdd on that command's instanceCount, so the
+	//region is filled densely and drawn with the counter the shader produced.
+	class GpuCuller {
+	public:
+		GpuCuller(const MegaBuffer& megaBuffer);
+		~GpuCuller();
+		GpuCuller(const GpuCuller&) = delete;
+		GpuCuller& operator=(const GpuCuller&) = delete;
+
+		//Uploads the instance set. Only needed again when instances are added, removed or moved.
+		//A set with a meshId the MegaBuffer lacks is rejected, leaving nothing to draw.
+		void setInstances(const std::vector<CullInstance>& instances);
+		//Overwrites a contiguous range of already uploaded instances (e.g. animated transforms).
+		//Ranges past the uploaded instances are rejected with an error.
+		void updateInstances(unsigned int first, const CullInstance* instances, unsigned int count);
+		//Resets the commands and runs the culling dispatch for this camera
+		void cull(const glm::mat4& viewProjection);
+		//Draws the compacted instances with one glMultiDrawElementsIndirect.
+		//Vertex shaders use the MegaBuffer interface unchanged.
+		void draw();
+		//Reads back the visible count. Stalls the pipeline, debug/benchmark only.
+		unsigned int readVisibleCount();
+
+		unsigned int getInstanceCount() const { return m_instanceCount; }
+		//Instances past the MegaBuffer limit left out by the last setInstances()
+		unsigned int getDroppedInstances() const { return m_droppedInstances; }
+
+	private:
+		const MegaBuffer& m_megaBuffer;
+		unsigned int m_program = 0;
+		unsigned int m_instanceBuffer = 0;
+		unsigned int m_meshBoundsBuffer = 0;
+		unsigned int m_templateCommandBuffer = 0;
+		unsigned int m_commandBuffer = 0;
+		unsigned int m_visibleBuffer = 0;
+		unsigned int m_instanceCount = 0;
+		unsigned int m_commandCount = 0;
+		unsigned int m_droppedInstances = 0;
+		bool m_warnedOverflow = false;
+		int m_planesLocation = -1;
+		int m_instanceCountLocation = -1;
+	};
+}
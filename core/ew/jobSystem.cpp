@@ -0,0 +1,95 @@
+#include "jobSystem.h"
+
+namespace ew {
+	JobSystem::JobSystem(unsigned int workerCount) {
+		if (workerCount == 0) {
+			unsigned int hardware = std::thread::hardware_concurrency();
+			workerCount = hardware > 1 ? hardware - 1 : 1;
+		}
+		for (unsigned int i = 0; i < workerCount; i++)
+			m_workers.emplace_back(&JobSystem::workerLoop, this);
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_wake.notify_all();
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	void JobSystem::submit(std::function<void()> job, JobCounter* counter) {
+		if (counter)
+			counter->pending.fetch_add(1);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.push_back({ std::move(job), counter });
+		}
+		m_wake.notify_one();
+	}
+
+	bool JobSystem::tryRunOne() {
+		Job job;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_queue.empty())
+				return false;
+			job = std::move(m_queue.front());
+			m_queue.pop_front();
+		}
+		job.fn();
+		if (job.counter)
+			job.counter->pending.fetch_sub(1);
+		return true;
+	}
+
+	void JobSystem::wait(JobCounter& counter) {
+		while (counter.pending.load() > 0) {
+			if (!tryRunOne())
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::workerLoop() {
+		while (true) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+				if (m_stopping && m_queue.empty())
+					return;
+				job = std::move(m_queue.front());
+				m_queue.pop_front();
+			}
+			job.fn();
+			if (job.counter)
+				job.counter->pending.fetch_sub(1);
+		}
+	}
+
+	void JobSystem::parallelFor(size_t count, size_t minBatch, const std::function<void(size_t, size_t)>& fn) {
+		if (count == 0)
+			return;
+		if (minBatch == 0)
+			minBatch = 1;
+		//Aim for a few batches per thread so uneven batches still balance out
+		size_t threads = m_workers.size() + 1;
+		size_t batch = (count + threads * 4 - 1) / (threads * 4);
+		if (batch < minBatch)
+			batch = minBatch;
+		if (batch >= count) {
+			fn(0, count);
+			return;
+		}
+		JobCounter counter;
+		//The calling thread keeps the first batch for itself
+		for (size_t begin = batch; begin < count; begin += batch) {
+			size_t end = begin + batch < count ? begin + batch : count;
+			submit([&fn, begin, end] { fn(begin, end); }, &counter);
+		}
+		fn(0, batch);
+		wait(counter);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ew {
+	//Counts outstanding jobs so a caller can wait for a group of them
+	struct JobCounter {
+		std::atomic<int> pending{ 0 };
+	};
+
+	//Fixed pool of worker threads pulling from one shared queue. Threads that wait on a
+	//counter help run queued jobs instead of sleeping, so nested waits cannot deadlock.
+	class JobSystem {
+	public:
+		//0 uses one worker per hardware thread minus the calling thread
+		explicit JobSystem(unsigned int workerCount = 0);
+		~JobSystem();
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		void submit(std::function<void()> job, JobCounter* counter = nullptr);
+		//Runs queued jobs on this thread until counter reaches zero
+		void wait(JobCounter& counter);
+		//Splits [0, count) into batches of at least minBatch and runs fn(begin, end) on each.
+		//Small ranges run inline. Returns once every batch has finished.
+		void parallelFor(size_t count, size_t minBatch, const std::function<void(size_t, size_t)>& fn);
+
+		unsigned int getWorkerCount() const { return (unsigned int)m_workers.size(); }
+
+	private:
+		struct Job {
+			std::function<void()> fn;
+			JobCounter* counter;
+		};
+		bool tryRunOne();
+		void workerLoop();
+
+		std::vector<std::thread> m_workers;
+		std::deque<Job> m_queue;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		bool m_stopping = false;
+	};
+}
@@ -0,0 +1,26 @@
+#include "lod.h"
+#include "ewMath/ewMath.h"
+#include <math.h>
+
+namespace ew {
+	float projectedError(float objectError, float distance, float fov, float screenHeight) {
+		//Avoid blowing up when the camera is inside the bounds
+		distance = fmaxf(distance, 1e-3f);
+		float pixelsPerUnit = screenHeight / (2.0f * tanf(Radians(fov) * 0.5f));
+		return objectError / distance * pixelsPerUnit;
+	}
+
+	int selectLod(const std::vector<float>& lodErrors, int currentLod, float distance, float fov, float screenHeight, const LodSettings& settings) {
+		int levels = (int)lodErrors.size();
+		if (levels == 0)
+			return 0;
+		int lod = currentLod < 0 ? 0 : (currentLod >= levels ? levels - 1 : currentLod);
+		float coarsenBelow = settings.maxPixelError * (1.0f - settings.hysteresis);
+		float refineAbove = settings.maxPixelError * (1.0f + settings.hysteresis);
+		while (lod + 1 < levels && projectedError(lodErrors[lod + 1], distance, fov, screenHeight) < coarsenBelow)
+			lod++;
+		while (lod > 0 && projectedError(lodErrors[lod], distance, fov, screenHeight) > refineAbove)
+			lod--;
+		return lod;
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+
+namespace ew {
+	struct LodSettings {
+		//Largest acceptable geometric error once projected to the screen
+		float maxPixelError = 1.0f;
+		//Fraction of maxPixelError used as a dead band around each switch point
+		float hysteresis = 0.25f;
+	};
+
+	//Screen space size in pixels of an object space error seen at distance.
+	//fov is the vertical field of view in degrees, as used by glm::perspective callers.
+	float projectedError(float objectError, float distance, float fov, float screenHeight);
+
+	//Picks a level from a chain's per-level errors (see LodChain::errors) using the current fov.
+	//Levels only coarsen once the coarser error is comfortably under the limit and only refine once
+	//the current error is comfortably over it, so objects near a threshold do not pop back and forth.
+	//currentLod is the level selected last frame; pass 0 for new objects.
+	int selectLod(const std::vector<float>& lodErrors, int currentLod, float distance, float fov, float screenHeight, const LodSettings& settings = LodSettings());
+}
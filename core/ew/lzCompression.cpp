@@ -0,0 +1,179 @@
+#include "lzCompression.h"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace ew {
+	static const size_t MIN_MATCH = 4;
+	static const size_t MAX_OFFSET = 65535;
+	//The format ends with literals: the last match stops this far from the end...
+	static const size_t LAST_LITERALS = 5;
+	//...and can't start closer than this, leaving decoders room to copy in wide chunks
+	static const size_t MATCH_LIMIT = 12;
+	static const int HASH_BITS = 14;
+	//Misses in a row before the search starts skipping ahead faster through incompressible data
+	static const int SKIP_SHIFT = 6;
+
+	static uint32_t read32(const unsigned char* p) {
+		uint32_t value;
+		memcpy(&value, p, 4);
+		return value;
+	}
+
+	static uint64_t read64(const unsigned char* p) {
+		uint64_t value;
+		memcpy(&value, p, 8);
+		return value;
+	}
+
+	static uint32_t hashSequence(uint32_t sequence) {
+		return (sequence * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	//Lengths of 15 or more continue in bytes of 255 and a final remainder
+	static unsigned char* writeLength(unsigned char* op, size_t length) {
+		while (length >= 255) {
+			*op++ = 255;
+			length -= 255;
+		}
+		*op++ = (unsigned char)length;
+		return op;
+	}
+
+	size_t lzCompressBound(size_t size) {
+		return size + size / 255 + 16;
+	}
+
+	size_t lzCompress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity) {
+		unsigned char* op = dst;
+		unsigned char* const opEnd = dst + capacity;
+		size_t anchor = 0;
+		if (size > MATCH_LIMIT) {
+			//Positions are stored plus one so zero means empty
+			std::vector<uint32_t> table((size_t)1 << HASH_BITS, 0);
+			const size_t limit = size - MATCH_LIMIT;
+			size_t position = 0;
+			while (position < limit) {
+				uint32_t sequence = read32(src + position);
+				uint32_t hash = hashSequence(sequence);
+				size_t candidate = table[hash];
+				table[hash] = (uint32_t)(position + 1);
+				if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET || read32(src + candidate - 1) != sequence) {
+					position += 1 + ((position - anchor) >> SKIP_SHIFT);
+					continue;
+				}
+				size_t match = candidate - 1;
+				//Grow backwards over literals that also match
+				while (position > anchor && match > 0 && src[position - 1] == src[match - 1]) {
+					position--;
+					match--;
+				}
+				size_t length = MIN_MATCH;
+				const size_t maxLength = size - LAST_LITERALS - position;
+				//Eight bytes at a time, then the remainder
+				while (length + 8 <= maxLength && read64(src + match + length) == read64(src + position + length))
+					length += 8;
+				while (length < maxLength && src[match + length] == src[position + length])
+					length++;
+
+				size_t literals = position - anchor;
+				if ((size_t)(opEnd - op) < 1 + literals + literals / 255 + 1 + 2 + (length - MIN_MATCH) / 255 + 1)
+					return 0;
+				unsigned char* token = op++;
+				*token = (unsigned char)((literals < 15 ? literals : 15) << 4);
+				if (literals >= 15)
+					op = writeLength(op, literals - 15);
+				memcpy(op, src + anchor, literals);
+				op += literals;
+				size_t offset = position - match;
+				*op++ = (unsigned char)(offset & 0xFF);
+				*op++ = (unsigned char)(offset >> 8);
+				size_t matchCode = length - MIN_MATCH;
+				*token |= (unsigned char)(matchCode < 15 ? matchCode : 15);
+				if (matchCode >= 15)
+					op = writeLength(op, matchCode - 15);
+
+				position += length;
+				anchor = position;
+				//Index a position inside the match so the next search has a recent candidate
+				if (position - 2 < limit)
+					table[hashSequence(read32(src + position - 2))] = (uint32_t)(position - 2 + 1);
+			}
+		}
+
+		size_t literals = size - anchor;
+		if ((size_t)(opEnd - op) < 1 + literals + literals / 255 + 1)
+			return 0;
+		*op++ = (unsigned char)((literals < 15 ? literals : 15) << 4);
+		if (literals >= 15)
+			op = writeLength(op, literals - 15);
+		memcpy(op, src + anchor, literals);
+		op += literals;
+		return (size_t)(op - dst);
+	}
+
+	//Reads a continued length; false if the input ends first
+	static bool readLength(const unsigned char*& ip, const unsigned char* ipEnd, size_t& length) {
+		unsigned char byte;
+		do {
+			if (ip >= ipEnd)
+				return false;
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	bool lzDecompress(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize) {
+		const unsigned char* ip = src;
+		const unsigned char* const ipEnd = src + srcSize;
+		unsigned char* op = dst;
+		unsigned char* const opEnd = dst + dstSize;
+		while (ip < ipEnd) {
+			unsigned char token = *ip++;
+			size_t literals = token >> 4;
+			if (literals == 15 && !readLength(ip, ipEnd, literals))
+				return false;
+			if ((size_t)(ipEnd - ip) < literals || (size_t)(opEnd - op) < literals)
+				return false;
+			//Short runs are the common case; a fixed 16 byte copy beats a variable memcpy when both sides have room
+			if (literals <= 16 && ipEnd - ip >= 16 && opEnd - op >= 16)
+				memcpy(op, ip, 16);
+			else
+				memcpy(op, ip, literals);
+			ip += literals;
+			op += literals;
+			//The last sequence has literals only
+			if (ip == ipEnd)
+				break;
+
+			if (ipEnd - ip < 2)
+				return false;
+			size_t offset = ip[0] | (size_t)ip[1] << 8;
+			ip += 2;
+			size_t length = token & 15;
+			if (length == 15 && !readLength(ip, ipEnd, length))
+				return false;
+			length += MIN_MATCH;
+			if (offset == 0 || offset > (size_t)(op - dst) || (size_t)(opEnd - op) < length)
+				return false;
+			const unsigned char* match = op - offset;
+			if (offset >= 8 && (size_t)(opEnd - op) >= length + 8) {
+				//Each 8 byte chunk reads only bytes already written, so overlap is safe; may write up to 7 bytes past the match
+				for (size_t i = 0; i < length; i += 8)
+					memcpy(op + i, match + i, 8);
+				op += length;
+			}
+			else if (offset >= length) {
+				memcpy(op, match, length);
+				op += length;
+			}
+			else {
+				//Overlapping copy repeats the last offset bytes, e.g. a run when offset is 1
+				for (size_t i = 0; i < length; i++)
+					*op++ = match[i];
+			}
+		}
+		return op == opEnd;
+	}
+}
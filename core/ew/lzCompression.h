@@ -0,0 +1,16 @@
+#pragma once
+#include <stddef.h>
+
+namespace ew {
+	//Byte-oriented LZ77 in the LZ4 block layout: a token holding literal and match lengths,
+	//the literals, then a 16-bit match offset. No entropy coding, so decoding is a few
+	//branches and copies per sequence and runs at memory speed; ratios are well below zlib.
+
+	//Worst case output size for size input bytes
+	size_t lzCompressBound(size_t size);
+	//Returns the compressed size, or 0 if the output would not fit in capacity
+	size_t lzCompress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity);
+	//Decodes exactly dstSize bytes. Every read and write is bounds checked, so corrupt input
+	//returns false instead of touching memory outside either buffer.
+	bool lzDecompress(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize);
+}
@@ -0,0 +1,142 @@
+#include "megaBuffer.h"
+#include "frustum.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <stddef.h>
+
+namespace ew {
+	MegaBuffer::MegaBuffer(unsigned int maxInstances)
+		: m_maxInstances(maxInstances) {
+	}
+
+	MegaBuffer::~MegaBuffer() {
+		glDeleteVertexArrays(1, &m_vao);
+		unsigned int buffers[] = { m_vbo, m_ebo, m_drawIdBuffer, m_drawDataBuffer, m_indirectBuffer };
+		glDeleteBuffers(5, buffers);
+	}
+
+	unsigned int MegaBuffer::addMesh(const MeshData& mesh) {
+		MeshRange range;
+		range.firstIndex = (unsigned int)m_indices.size();
+		range.indexCount = (unsigned int)mesh.indices.size();
+		range.baseVertex = (int)m_vertices.size();
+		range.vertexCount = (unsigned int)mesh.vertices.size();
+		range.boundingSphere = computeBoundingSphere(mesh.vertices.begin(), mesh.vertices.end(),
+			[](const Vertex& v) { return v.pos; });
+		m_vertices.insert(m_vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+		m_indices.insert(m_indices.end(), mesh.indices.begin(), mesh.indices.end());
+		m_meshes.push_back(range);
+		return (unsigned int)m_meshes.size() - 1;
+	}
+
+	void MegaBuffer::build() {
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_vbo);
+		glGenBuffers(1, &m_ebo);
+		glGenBuffers(1, &m_drawIdBuffer);
+		glGenBuffers(1, &m_drawDataBuffer);
+		glGenBuffers(1, &m_indirectBuffer);
+
+		glBindVertexArray(m_vao);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex), m_vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int), m_indices.data(), GL_STATIC_DRAW);
+
+		//Positions
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, pos));
+		glEnableVertexAttribArray(0);
+		//Normals
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+		glEnableVertexAttribArray(1);
+		//UVs
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
+		glEnableVertexAttribArray(2);
+
+		//Draw ID: 0,1,2... advanced once per instance, offset by each command's baseInstance
+		std::vector<unsigned int> drawIds(m_maxInstances);
+		for (unsigned int i = 0; i < m_maxInstances; i++)
+			drawIds[i] = i;
+		glBindBuffer(GL_ARRAY_BUFFER, m_drawIdBuffer);
+		glBufferData(GL_ARRAY_BUFFER, drawIds.size() * sizeof(unsigned int), drawIds.data(), GL_STATIC_DRAW);
+		glVertexAttribIPointer(MEGABUFFER_DRAW_ID_LOCATION, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+		glVertexAttribDivisor(MEGABUFFER_DRAW_ID_LOCATION, 1);
+		glEnableVertexAttribArray(MEGABUFFER_DRAW_ID_LOCATION);
+
+		glBindVertexArray(0);
+
+		//CPU copies are no longer needed once uploaded, but ranges stay valid
+		m_vertices = std::vector<Vertex>();
+		m_indices = std::vector<unsigned int>();
+	}
+
+	void MegaBuffer::begin() {
+		m_commands.clear();
+		m_drawData.clear();
+		m_droppedInstances = 0;
+	}
+
+	void MegaBuffer::dropInstances(unsigned int count) {
+		m_droppedInstances += count;
+		//Once per MegaBuffer; an overflowing scene would otherwise log every frame
+		if (!m_warnedOverflow) {
+			printf("ERROR::MEGABUFFER::Instance limit %u exceeded, excess instances are dropped\n", m_maxInstances);
+			m_warnedOverflow = true;
+		}
+	}
+
+	void MegaBuffer::submit(unsigned int meshId, const DrawData* instances, unsigned int count) {
+		unsigned int baseInstance = pushInstances(instances, count);
+		if (baseInstance != NO_INSTANCES)
+			submitRange(meshId, 0, m_meshes[meshId].indexCount, baseInstance, count);
+	}
+
+	unsigned int MegaBuffer::pushInstances(const DrawData* instances, unsigned int count) {
+		if (m_drawData.size() + count > m_maxInstances) {
+			dropInstances(count);
+			return NO_INSTANCES;
+		}
+		unsigned int baseInstance = (unsigned int)m_drawData.size();
+		m_drawData.insert(m_drawData.end(), instances, instances + count);
+		return baseInstance;
+	}
+
+	void MegaBuffer::submitRange(unsigned int meshId, unsigned int firstIndex, unsigned int indexCount, unsigned int baseInstance, unsigned int instanceCount) {
+		const MeshRange& mesh = m_meshes[meshId];
+		DrawElementsIndirectCommand cmd;
+		cmd.count = indexCount;
+		cmd.instanceCount = instanceCount;
+		cmd.firstIndex = mesh.firstIndex + firstIndex;
+		cmd.baseVertex = mesh.baseVertex;
+		cmd.baseInstance = baseInstance;
+		m_commands.push_back(cmd);
+	}
+
+	void MegaBuffer::upload() {
+		//Orphan and refill so the driver can hand back fresh storage instead of syncing
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawDataBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_drawData.size() * sizeof(DrawData), m_drawData.data(), GL_STREAM_DRAW);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MEGABUFFER_DRAW_DATA_BINDING, m_drawDataBuffer);
+		glBindVertexArray(m_vao);
+	}
+
+	void MegaBuffer::flush() {
+		if (m_commands.empty())
+			return;
+		upload();
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, m_commands.size() * sizeof(DrawElementsIndirectCommand), m_commands.data(), GL_STREAM_DRAW);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)m_commands.size(), 0);
+	}
+
+	void MegaBuffer::flushPerMesh() {
+		if (m_commands.empty())
+			return;
+		upload();
+		for (const DrawElementsIndirectCommand& cmd : m_commands) {
+			glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, cmd.count, GL_UNSIGNED_INT,
+				(void*)(cmd.firstIndex * sizeof(unsigned int)), cmd.instanceCount, cmd.baseVertex, cmd.baseInstance);
+		}
+	}
+}
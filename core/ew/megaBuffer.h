@@ -0,0 +1,107 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "mesh.h"
+
+namespace ew {
+	//Layout matches the GL spec for glMultiDrawElementsIndirect
+	struct DrawElementsIndirectCommand {
+		unsigned int count;
+		unsigned int instanceCount;
+		unsigned int firstIndex;
+		int baseVertex;
+		unsigned int baseInstance;
+	};
+
+	//Location of a mesh inside the shared vertex/index buffers
+	struct MeshRange {
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		int baseVertex;
+		unsigned int vertexCount;
+		//Local space bounding sphere, xyz center and w radius
+		glm::vec4 boundingSphere;
+	};
+
+	//Per-instance data, std430 layout
+	struct DrawData {
+		glm::mat4 model;
+		glm::vec4 color;
+	};
+
+	//Shader interface. Vertex shaders declare:
+	//  layout(location = 0) in vec3 aPos;
+	//  layout(location = 1) in vec3 aNormal;
+	//  layout(location = 2) in vec2 aUV;
+	//  layout(location = 3) in uint aDrawID;
+	//  layout(std430, binding = 0) readonly buffer DrawBuffer { DrawData draws[]; };
+	//aDrawID is an instanced attribute fed from an identity buffer, so with baseInstance it
+	//yields baseInstance + gl_InstanceID. This works on GL 4.5 (llvmpipe) where gl_DrawID
+	//and gl_BaseInstance would need ARB_shader_draw_parameters.
+	const unsigned int MEGABUFFER_DRAW_ID_LOCATION = 3;
+	const unsigned int MEGABUFFER_DRAW_DATA_BINDING = 0;
+
+	//Packs many meshes into one VBO/EBO pair so a whole pass can be issued with a single
+	//glMultiDrawElementsIndirect call.
+	class MegaBuffer {
+	public:
+		//Returned by pushInstances() when the instances did not fit
+		static const unsigned int NO_INSTANCES = ~0u;
+
+		MegaBuffer(unsigned int maxInstances = 65536);
+		~MegaBuffer();
+		MegaBuffer(const MegaBuffer&) = delete;
+		MegaBuffer& operator=(const MegaBuffer&) = delete;
+
+		//Appends mesh data to the shared arrays and returns its mesh id. Call before build().
+		unsigned int addMesh(const MeshData& mesh);
+		//Uploads the packed geometry and creates the VAO
+		void build();
+
+		//Clears queued draws for a new pass
+		void begin();
+		//Queues one indirect command drawing count instances of a mesh
+		void submit(unsigned int meshId, const DrawData* instances, unsigned int count);
+		//Queues instance data without a command and returns its baseInstance, so several
+		//commands (e.g. meshlet ranges) can share the same instances through submitRange().
+		//Returns NO_INSTANCES, queuing nothing, if the instance limit would be exceeded.
+		unsigned int pushInstances(const DrawData* instances, unsigned int count);
+		//Queues a command drawing indexCount indices starting firstIndex indices into a mesh
+		void submitRange(unsigned int meshId, unsigned int firstIndex, unsigned int indexCount, unsigned int baseInstance, unsigned int instanceCount);
+		//Uploads queued draw data and commands and issues them with one glMultiDrawElementsIndirect
+		void flush();
+		//Same draws as flush(), but one glDrawElementsInstancedBaseVertexBaseInstance per command.
+		//Kept for comparison and for drivers without indirect support.
+		void flushPerMesh();
+
+		const MeshRange& getMesh(unsigned int meshId) const { return m_meshes[meshId]; }
+		unsigned int getMeshCount() const { return (unsigned int)m_meshes.size(); }
+		unsigned int getVAO() const { return m_vao; }
+		unsigned int getIndirectBuffer() const { return m_indirectBuffer; }
+		unsigned int getDrawDataBuffer() const { return m_drawDataBuffer; }
+		unsigned int getMaxInstances() const { return m_maxInstances; }
+		const std::vector<DrawElementsIndirectCommand>& getCommands() const { return m_commands; }
+		//Instances dropped since begin() because the instance limit was reached
+		unsigned int getDroppedInstances() const { return m_droppedInstances; }
+
+	private:
+		void upload();
+		void dropInstances(unsigned int count);
+
+		unsigned int m_maxInstances;
+		std::vector<Vertex> m_vertices;
+		std::vector<unsigned int> m_indices;
+		std::vector<MeshRange> m_meshes;
+		std::vector<DrawElementsIndirectCommand> m_commands;
+		std::vector<DrawData> m_drawData;
+		unsigned int m_droppedInstances = 0;
+		bool m_warnedOverflow = false;
+
+		unsigned int m_vao = 0;
+		unsigned int m_vbo = 0;
+		unsigned int m_ebo = 0;
+		unsigned int m_drawIdBuffer = 0;
+		unsigned int m_drawDataBuffer = 0;
+		unsigned int m_indirectBuffer = 0;
+	};
+}
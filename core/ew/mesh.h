@@ -0,0 +1,17 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace ew {
+	struct Vertex {
+		glm::vec3 pos;
+		glm::vec3 normal;
+		glm::vec2 uv;
+	};
+
+	//Indexed triangle list
+	struct MeshData {
+		std::vector<Vertex> vertices;
+		std::vector<unsigned int> indices;
+	};
+}
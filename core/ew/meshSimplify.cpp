@@ -0,0 +1,268 @@
+#include "meshSimplify.h"
+#include "frustum.h"
+#include <algorithm>
+#include <math.h>
+#include <queue>
+#include <stdint.h>
+#include <unordered_map>
+
+namespace ew {
+	//Symmetric 4x4 matrix stored as its upper triangle
+	struct Quadric {
+		double a[10] = {};
+		//Total area of the planes summed in, so errors normalize to object space distances
+		double weight = 0.0;
+
+		static Quadric fromPlane(double nx, double ny, double nz, double d, double weight) {
+			Quadric q;
+			q.a[0] = nx * nx * weight; q.a[1] = nx * ny * weight; q.a[2] = nx * nz * weight; q.a[3] = nx * d * weight;
+			q.a[4] = ny * ny * weight; q.a[5] = ny * nz * weight; q.a[6] = ny * d * weight;
+			q.a[7] = nz * nz * weight; q.a[8] = nz * d * weight;
+			q.a[9] = d * d * weight;
+			return q;
+		}
+		void add(const Quadric& other) {
+			for (int i = 0; i < 10; i++)
+				a[i] += other.a[i];
+			weight += other.weight;
+		}
+		double evaluate(const glm::vec3& p) const {
+			double x = p.x, y = p.y, z = p.z;
+			return a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + 2 * a[3] * x
+				+ a[4] * y * y + 2 * a[5] * y * z + 2 * a[6] * y
+				+ a[7] * z * z + 2 * a[8] * z
+				+ a[9];
+		}
+		//Mean squared distance to the summed planes
+		double error(const glm::vec3& p) const {
+			return weight > 0.0 ? fabs(evaluate(p)) / weight : fabs(evaluate(p));
+		}
+	};
+
+	struct Collapse {
+		double cost;
+		unsigned int from, to;
+		unsigned int fromVersion, toVersion;
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+	//Border constraints are weighted well above any interior plane so silhouettes survive
+	static const double BORDER_WEIGHT = 100.0;
+
+	static uint64_t edgeKey(unsigned int a, unsigned int b) {
+		return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+	}
+
+	MeshData simplifyMesh(const MeshData& mesh, size_t targetIndexCount, float maxError, float* outError) {
+		const std::vector<Vertex>& vertices = mesh.vertices;
+		std::vector<unsigned int> indices = mesh.indices;
+		size_t vertexCount = vertices.size();
+		size_t triangleCount = indices.size() / 3;
+
+		std::vector<Quadric> quadrics(vertexCount);
+		std::vector<std::vector<unsigned int>> vertexTriangles(vertexCount);
+		std::unordered_map<uint64_t, int> edgeUse;
+		edgeUse.reserve(triangleCount * 3);
+		for (size_t t = 0; t < triangleCount; t++) {
+			const unsigned int* tri = &indices[t * 3];
+			glm::vec3 p0 = vertices[tri[0]].pos, p1 = vertices[tri[1]].pos, p2 = vertices[tri[2]].pos;
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(n);
+			if (area > 0.0f)
+				n /= area;
+			Quadric q = Quadric::fromPlane(n.x, n.y, n.z, -glm::dot(n, p0), area * 0.5);
+			q.weight = area * 0.5;
+			for (int k = 0; k < 3; k++) {
+				quadrics[tri[k]].add(q);
+				vertexTriangles[tri[k]].push_back((unsigned int)t);
+				edgeUse[edgeKey(tri[k], tri[(k + 1) % 3])]++;
+			}
+		}
+
+		//Edges used by only one triangle get a plane through them perpendicular to that face
+		for (size_t t = 0; t < triangleCount; t++) {
+			const unsigned int* tri = &indices[t * 3];
+			glm::vec3 faceNormal = glm::cross(vertices[tri[1]].pos - vertices[tri[0]].pos, vertices[tri[2]].pos - vertices[tri[0]].pos);
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = tri[k], b = tri[(k + 1) % 3];
+				if (edgeUse[edgeKey(a, b)] != 1)
+					continue;
+				glm::vec3 edge = vertices[b].pos - vertices[a].pos;
+				glm::vec3 n = glm::cross(edge, faceNormal);
+				float length = glm::length(n);
+				if (length <= 0.0f)
+					continue;
+				n /= length;
+				Quadric q = Quadric::fromPlane(n.x, n.y, n.z, -glm::dot(n, vertices[a].pos), BORDER_WEIGHT * glm::dot(edge, edge));
+				quadrics[a].add(q);
+				quadrics[b].add(q);
+			}
+		}
+
+		//Seams split a vertex into copies at the same position, give or take the rounding of
+		//whatever generated them (sin(2pi) is not 0). Moving one copy without the others would
+		//open a crack, so seam vertices stay put and only take collapses onto them.
+		glm::vec3 boundsMin(INFINITY), boundsMax(-INFINITY);
+		for (const Vertex& v : vertices) {
+			boundsMin = glm::min(boundsMin, v.pos);
+			boundsMax = glm::max(boundsMax, v.pos);
+		}
+		float weldDistance = vertexCount ? glm::length(boundsMax - boundsMin) * 1e-5f : 0.0f;
+		//Buckets of weldDistance, so each vertex only compares against the 27 around it
+		float cellSize = weldDistance > 0.0f ? weldDistance : 1.0f;
+		auto cellKey = [&](int x, int y, int z) {
+			return ((uint64_t)(uint32_t)x * 73856093u) ^ ((uint64_t)(uint32_t)y * 19349663u << 21) ^ ((uint64_t)(uint32_t)z * 83492791u << 42);
+		};
+		std::unordered_map<uint64_t, std::vector<unsigned int>> cells;
+		cells.reserve(vertexCount);
+		std::vector<bool> seam(vertexCount, false);
+		for (size_t i = 0; i < vertexCount; i++) {
+			glm::vec3 p = vertices[i].pos;
+			glm::ivec3 cell = glm::ivec3(glm::floor((p - boundsMin) / cellSize));
+			for (int dz = -1; dz <= 1; dz++) {
+				for (int dy = -1; dy <= 1; dy++) {
+					for (int dx = -1; dx <= 1; dx++) {
+						std::unordered_map<uint64_t, std::vector<unsigned int>>::iterator it = cells.find(cellKey(cell.x + dx, cell.y + dy, cell.z + dz));
+						if (it == cells.end())
+							continue;
+						for (unsigned int other : it->second) {
+							if (glm::length(vertices[other].pos - p) <= weldDistance)
+								seam[i] = seam[other] = true;
+						}
+					}
+				}
+			}
+			cells[cellKey(cell.x, cell.y, cell.z)].push_back((unsigned int)i);
+		}
+
+		std::vector<unsigned int> version(vertexCount, 0);
+		std::vector<bool> removedVertex(vertexCount, false);
+		std::vector<bool> removedTriangle(triangleCount, false);
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+		auto pushEdge = [&](unsigned int a, unsigned int b) {
+			if (seam[a] && seam[b])
+				return;
+			Quadric q = quadrics[a];
+			q.add(quadrics[b]);
+			double costToB = q.error(vertices[b].pos);
+			double costToA = q.error(vertices[a].pos);
+			if (seam[b] || (!seam[a] && costToB <= costToA))
+				heap.push({ costToB, a, b, version[a], version[b] });
+			else
+				heap.push({ costToA, b, a, version[b], version[a] });
+		};
+		for (const auto& edge : edgeUse)
+			pushEdge((unsigned int)(edge.first >> 32), (unsigned int)(edge.first & 0xffffffffu));
+
+		//Moving `from` onto `to` must not flip any surviving triangle around `from`
+		auto flipsTriangle = [&](unsigned int from, unsigned int to) {
+			for (unsigned int t : vertexTriangles[from]) {
+				if (removedTriangle[t])
+					continue;
+				const unsigned int* tri = &indices[t * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to)
+					continue;
+				glm::vec3 p[3], q[3];
+				for (int k = 0; k < 3; k++) {
+					p[k] = vertices[tri[k]].pos;
+					q[k] = tri[k] == from ? vertices[to].pos : p[k];
+				}
+				glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+				glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+				if (glm::dot(before, after) <= 0.0f)
+					return true;
+			}
+			return false;
+		};
+
+		size_t liveTriangles = triangleCount;
+		size_t targetTriangles = targetIndexCount / 3;
+		double maxCost = 0.0;
+		double costLimit = (double)maxError * maxError;
+		while (liveTriangles > targetTriangles && !heap.empty()) {
+			Collapse c = heap.top();
+			if (c.cost > costLimit)
+				break;
+			heap.pop();
+			if (removedVertex[c.from] || removedVertex[c.to] || version[c.from] != c.fromVersion || version[c.to] != c.toVersion)
+				continue;
+			if (flipsTriangle(c.from, c.to))
+				continue;
+
+			maxCost = std::max(maxCost, c.cost);
+			removedVertex[c.from] = true;
+			quadrics[c.to].add(quadrics[c.from]);
+			version[c.to]++;
+			for (unsigned int t : vertexTriangles[c.from]) {
+				if (removedTriangle[t])
+					continue;
+				unsigned int* tri = &indices[t * 3];
+				bool hasTo = tri[0] == c.to || tri[1] == c.to || tri[2] == c.to;
+				if (hasTo) {
+					removedTriangle[t] = true;
+					liveTriangles--;
+					continue;
+				}
+				for (int k = 0; k < 3; k++) {
+					if (tri[k] == c.from)
+						tri[k] = c.to;
+				}
+				vertexTriangles[c.to].push_back(t);
+			}
+			vertexTriangles[c.from].clear();
+
+			//Refresh collapse candidates around the merged vertex
+			std::vector<unsigned int>& around = vertexTriangles[c.to];
+			around.erase(std::remove_if(around.begin(), around.end(), [&](unsigned int t) { return removedTriangle[t]; }), around.end());
+			for (unsigned int t : around) {
+				for (int k = 0; k < 3; k++) {
+					unsigned int other = indices[t * 3 + k];
+					if (other != c.to)
+						pushEdge(c.to, other);
+				}
+			}
+		}
+
+		//Compact surviving triangles and the vertices they reference
+		MeshData result;
+		std::vector<unsigned int> remap(vertexCount, ~0u);
+		result.indices.reserve(liveTriangles * 3);
+		for (size_t t = 0; t < triangleCount; t++) {
+			if (removedTriangle[t])
+				continue;
+			for (int k = 0; k < 3; k++) {
+				unsigned int v = indices[t * 3 + k];
+				if (remap[v] == ~0u) {
+					remap[v] = (unsigned int)result.vertices.size();
+					result.vertices.push_back(vertices[v]);
+				}
+				result.indices.push_back(remap[v]);
+			}
+		}
+		if (outError)
+			*outError = (float)sqrt(std::max(maxCost, 0.0));
+		return result;
+	}
+
+	LodChain generateLodChain(const MeshData& mesh, int levelCount, float reduction, float maxRelativeError) {
+		glm::vec4 bounds = computeBoundingSphere(mesh.vertices.begin(), mesh.vertices.end(), [](const Vertex& v) { return v.pos; });
+		float maxError = maxRelativeError * bounds.w;
+		LodChain chain;
+		chain.levels.push_back(mesh);
+		chain.errors.push_back(0.0f);
+		for (int i = 1; i < levelCount; i++) {
+			const MeshData& previous = chain.levels.back();
+			size_t target = (size_t)(previous.indices.size() / 3 * reduction) * 3;
+			float error = 0.0f;
+			//Simplify from the source each time so errors do not compound
+			MeshData level = simplifyMesh(mesh, target, maxError, &error);
+			//Stop once the error budget prevents any meaningful reduction
+			if (level.indices.empty() || level.indices.size() > previous.indices.size() * 9 / 10)
+				break;
+			chain.errors.push_back(std::max(error, chain.errors.back()));
+			chain.levels.push_back(std::move(level));
+		}
+		return chain;
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+namespace ew {
+	//Quadric error metric edge collapse (Garland & Heckbert). Vertices collapse onto one of
+	//their edge's endpoints, so normals and UVs stay valid without interpolation.
+	//Open borders are held in place by border quadrics. UV/normal seams (split vertices sharing
+	//a position) are locked, since moving one side of a seam alone would open a crack.
+	//Stops at targetIndexCount or when the next collapse would exceed maxError (object space units).
+	//Returns the simplified mesh; outError receives the error of the worst collapse performed.
+	MeshData simplifyMesh(const MeshData& mesh, size_t targetIndexCount, float maxError = 1e30f, float* outError = nullptr);
+
+	//LOD 0 is the source mesh; each following level keeps `reduction` of the previous one's triangles
+	struct LodChain {
+		std::vector<MeshData> levels;
+		//Object space geometric error per level, non decreasing. levels[0] is always 0.
+		std::vector<float> errors;
+	};
+	//maxRelativeError caps every level's error as a fraction of the mesh's bounding radius.
+	//The chain may end up shorter than levelCount if that cap stops simplification.
+	LodChain generateLodChain(const MeshData& mesh, int levelCount, float reduction = 0.5f, float maxRelativeError = 0.1f);
+}
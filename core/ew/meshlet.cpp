@@ -0,0 +1,132 @@
+#include "meshlet.h"
+#include "frustum.h"
+#include <algorithm>
+#include <math.h>
+
+namespace ew {
+	static void finishMeshlet(const MeshData& mesh, const std::vector<unsigned int>& indices, Meshlet& meshlet) {
+		const unsigned int* first = &indices[meshlet.firstIndex];
+		const unsigned int* last = first + meshlet.triangleCount * 3;
+		meshlet.boundingSphere = computeBoundingSphere(first, last, [&](unsigned int i) { return mesh.vertices[i].pos; });
+
+		//Cone axis is the average face normal; the cutoff is the sine of the widest deviation from it
+		glm::vec3 axis(0.0f);
+		std::vector<glm::vec3> normals(meshlet.triangleCount);
+		for (unsigned int t = 0; t < meshlet.triangleCount; t++) {
+			glm::vec3 p0 = mesh.vertices[first[t * 3]].pos;
+			glm::vec3 n = glm::cross(mesh.vertices[first[t * 3 + 1]].pos - p0, mesh.vertices[first[t * 3 + 2]].pos - p0);
+			float length = glm::length(n);
+			normals[t] = length > 0.0f ? n / length : glm::vec3(0.0f);
+			axis += normals[t];
+		}
+		float axisLength = glm::length(axis);
+		if (axisLength <= 1e-6f) {
+			meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+			meshlet.coneCutoff = 1.0f;
+			return;
+		}
+		axis /= axisLength;
+		float minDot = 1.0f;
+		for (const glm::vec3& n : normals)
+			minDot = std::min(minDot, glm::dot(n, axis));
+		meshlet.coneAxis = axis;
+		//Normals more than 90 degrees apart can always see the camera from some side
+		meshlet.coneCutoff = minDot <= 0.0f ? 1.0f : sqrtf(1.0f - minDot * minDot);
+	}
+
+	std::vector<Meshlet> buildMeshlets(MeshData& mesh, unsigned int maxVertices, unsigned int maxTriangles) {
+		size_t triangleCount = mesh.indices.size() / 3;
+		std::vector<std::vector<unsigned int>> vertexTriangles(mesh.vertices.size());
+		for (size_t t = 0; t < triangleCount; t++) {
+			for (int k = 0; k < 3; k++)
+				vertexTriangles[mesh.indices[t * 3 + k]].push_back((unsigned int)t);
+		}
+
+		std::vector<Meshlet> meshlets;
+		std::vector<unsigned int> reordered;
+		reordered.reserve(mesh.indices.size());
+		std::vector<bool> used(triangleCount, false);
+		//Marks vertices already in the current meshlet with that meshlet's id + 1
+		std::vector<unsigned int> vertexOwner(mesh.vertices.size(), 0);
+		std::vector<unsigned int> candidates;
+		size_t nextSeed = 0;
+
+		while (true) {
+			while (nextSeed < triangleCount && used[nextSeed])
+				nextSeed++;
+			if (nextSeed >= triangleCount)
+				break;
+
+			Meshlet meshlet = {};
+			meshlet.firstIndex = (unsigned int)reordered.size();
+			unsigned int owner = (unsigned int)meshlets.size() + 1;
+			candidates.clear();
+			unsigned int current = (unsigned int)nextSeed;
+			while (true) {
+				const unsigned int* tri = &mesh.indices[current * 3];
+				used[current] = true;
+				for (int k = 0; k < 3; k++) {
+					reordered.push_back(tri[k]);
+					if (vertexOwner[tri[k]] != owner) {
+						vertexOwner[tri[k]] = owner;
+						meshlet.vertexCount++;
+						candidates.insert(candidates.end(), vertexTriangles[tri[k]].begin(), vertexTriangles[tri[k]].end());
+					}
+				}
+				meshlet.triangleCount++;
+				if (meshlet.triangleCount >= maxTriangles)
+					break;
+
+				//Next triangle: the neighbour adding the fewest new vertices that still fits
+				unsigned int best = ~0u;
+				int bestNew = 4;
+				size_t write = 0;
+				for (size_t i = 0; i < candidates.size(); i++) {
+					unsigned int t = candidates[i];
+					if (used[t])
+						continue;
+					candidates[write++] = t;
+					int newVertices = 0;
+					for (int k = 0; k < 3; k++)
+						newVertices += vertexOwner[mesh.indices[t * 3 + k]] != owner;
+					if (newVertices < bestNew && meshlet.vertexCount + newVertices <= maxVertices) {
+						best = t;
+						bestNew = newVertices;
+					}
+				}
+				candidates.resize(write);
+				if (best == ~0u)
+					break;
+				current = best;
+			}
+			finishMeshlet(mesh, reordered, meshlet);
+			meshlets.push_back(meshlet);
+		}
+		mesh.indices.swap(reordered);
+		return meshlets;
+	}
+
+	void cullMeshlets(const std::vector<Meshlet>& meshlets, const glm::mat4& model, const glm::mat4& viewProjection,
+		const glm::vec3& cameraPos, std::vector<unsigned int>& visible) {
+		//Test in local space: planes and camera move into the mesh's frame once per instance,
+		//which keeps the sphere test exact even under non-uniform scale
+		Frustum frustum = extractFrustum(viewProjection * model);
+		glm::vec3 localCamera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPos, 1.0f));
+		float sx = glm::length(glm::vec3(model[0])), sy = glm::length(glm::vec3(model[1])), sz = glm::length(glm::vec3(model[2]));
+		bool uniformScale = fabsf(sx - sy) < 0.01f * sx && fabsf(sx - sz) < 0.01f * sx;
+
+		for (unsigned int i = 0; i < (unsigned int)meshlets.size(); i++) {
+			const Meshlet& meshlet = meshlets[i];
+			glm::vec3 center = glm::vec3(meshlet.boundingSphere);
+			float radius = meshlet.boundingSphere.w;
+			if (!sphereInFrustum(frustum, center, radius))
+				continue;
+			if (uniformScale && meshlet.coneCutoff < 1.0f) {
+				glm::vec3 toCenter = center - localCamera;
+				if (glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + radius)
+					continue;
+			}
+			visible.push_back(i);
+		}
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "mesh.h"
+
+namespace ew {
+	//A cluster of up to maxVertices unique vertices / maxTriangles triangles, stored as a
+	//contiguous index range so visible clusters can be drawn straight from the mesh's EBO.
+	struct Meshlet {
+		unsigned int firstIndex;
+		unsigned int triangleCount;
+		unsigned int vertexCount;
+		//Local space bounding sphere, xyz center and w radius
+		glm::vec4 boundingSphere;
+		//Normal cone: every triangle normal lies within asin(coneCutoff) of (90 degrees off) coneAxis.
+		//coneCutoff >= 1 means the cone is too wide to ever back-face cull.
+		glm::vec3 coneAxis;
+		float coneCutoff;
+	};
+
+	//Splits a mesh into meshlets, growing each cluster through shared vertices for locality.
+	//Reorders mesh.indices in place so each meshlet covers a contiguous range of it.
+	std::vector<Meshlet> buildMeshlets(MeshData& mesh, unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
+
+	//Culls meshlets of one instance against the camera frustum and by normal cone, appending
+	//surviving meshlet indices to visible. Cone culling assumes the model matrix has uniform
+	//scale and is skipped otherwise.
+	void cullMeshlets(const std::vector<Meshlet>& meshlets, const glm::mat4& model, const glm::mat4& viewProjection,
+		const glm::vec3& cameraPos, std::vector<unsigned int>& visible);
+}
@@ -0,0 +1,78 @@
+#include "normalMatrix.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EW_NORMAL_MATRIX_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace ew {
+	glm::mat3 computeNormalMatrix(const glm::mat4& model) {
+		glm::vec3 c0(model[0]), c1(model[1]), c2(model[2]);
+		glm::vec3 n0 = glm::cross(c1, c2);
+		float invDet = 1.0f / glm::dot(c0, n0);
+		return glm::mat3(n0 * invDet, glm::cross(c2, c0) * invDet, glm::cross(c0, c1) * invDet);
+	}
+
+	static void storeScalar(const glm::mat4& model, NormalMatrix& out) {
+		glm::mat3 normalMatrix = computeNormalMatrix(model);
+		for (int c = 0; c < 3; c++)
+			out.columns[c] = glm::vec4(normalMatrix[c], 0.0f);
+	}
+
+#ifdef EW_NORMAL_MATRIX_SSE
+	//Structure-of-arrays cross product: each register holds one component of four vectors
+	static inline void cross4(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz, __m128& x, __m128& y, __m128& z) {
+		x = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+		y = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+		z = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+	}
+
+	void computeNormalMatrices(const glm::mat4* models, NormalMatrix* out, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const float* m0 = &models[i][0][0];
+			const float* m1 = &models[i + 1][0][0];
+			const float* m2 = &models[i + 2][0][0];
+			const float* m3 = &models[i + 3][0][0];
+			//Transposing column c of four matrices gives its x, y and z for all four at once
+			__m128 cx[3], cy[3], cz[3];
+			for (int c = 0; c < 3; c++) {
+				__m128 r0 = _mm_loadu_ps(m0 + c * 4);
+				__m128 r1 = _mm_loadu_ps(m1 + c * 4);
+				__m128 r2 = _mm_loadu_ps(m2 + c * 4);
+				__m128 r3 = _mm_loadu_ps(m3 + c * 4);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				cx[c] = r0;
+				cy[c] = r1;
+				cz[c] = r2;
+			}
+
+			__m128 nx[3], ny[3], nz[3];
+			cross4(cx[1], cy[1], cz[1], cx[2], cy[2], cz[2], nx[0], ny[0], nz[0]);
+			cross4(cx[2], cy[2], cz[2], cx[0], cy[0], cz[0], nx[1], ny[1], nz[1]);
+			cross4(cx[0], cy[0], cz[0], cx[1], cy[1], cz[1], nx[2], ny[2], nz[2]);
+			__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx[0], nx[0]), _mm_mul_ps(cy[0], ny[0])), _mm_mul_ps(cz[0], nz[0]));
+			//Full precision divide; _mm_rcp_ps alone is only good to ~12 bits
+			__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+			for (int c = 0; c < 3; c++) {
+				__m128 r0 = _mm_mul_ps(nx[c], invDet);
+				__m128 r1 = _mm_mul_ps(ny[c], invDet);
+				__m128 r2 = _mm_mul_ps(nz[c], invDet);
+				__m128 r3 = _mm_setzero_ps();
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(&out[i].columns[c].x, r0);
+				_mm_storeu_ps(&out[i + 1].columns[c].x, r1);
+				_mm_storeu_ps(&out[i + 2].columns[c].x, r2);
+				_mm_storeu_ps(&out[i + 3].columns[c].x, r3);
+			}
+		}
+		for (; i < count; i++)
+			storeScalar(models[i], out[i]);
+	}
+#else
+	void computeNormalMatrices(const glm::mat4* models, NormalMatrix* out, size_t count) {
+		for (size_t i = 0; i < count; i++)
+			storeScalar(models[i], out[i]);
+	}
+#endif
+}
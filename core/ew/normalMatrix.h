@@ -0,0 +1,20 @@
+#pragma once
+#include <stddef.h>
+#include <glm/glm.hpp>
+
+namespace ew {
+	//mat3 with each column padded to a vec4, the std140/std430 layout of a GLSL mat3.
+	//Usable directly in an SSBO/UBO array, or as a per-instance attribute with a 48 byte stride.
+	struct NormalMatrix {
+		glm::vec4 columns[3];
+	};
+
+	//transpose(inverse(mat3(model))), computed from the cofactors: the cross products of the
+	//model's columns divided by the determinant. Cheaper than a general inverse and exact
+	//for any invertible transform, including mirroring.
+	glm::mat3 computeNormalMatrix(const glm::mat4& model);
+
+	//Batch version for per-instance streams. Processes four matrices at a time with SSE when
+	//available (x86-64, or -msse2 on 32 bit), falling back to computeNormalMatrix otherwise.
+	void computeNormalMatrices(const glm::mat4* models, NormalMatrix* out, size_t count);
+}
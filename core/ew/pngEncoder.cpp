@@ -0,0 +1,243 @@
+#include "pngEncoder.h"
+#include <array>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace ew {
+	static const int WINDOW_SIZE = 32768;
+	static const int HASH_BITS = 15;
+	static const int MIN_MATCH = 3;
+	static const int MAX_MATCH = 258;
+	//Candidates tried per position; more finds longer matches but costs time
+	static const int MAX_CHAIN = 16;
+
+	static const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	static const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	static const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	static const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	//Deflate packs bits LSB first; Huffman codes go in MSB first, so they are reversed on the way in
+	class BitWriter {
+	public:
+		explicit BitWriter(std::vector<unsigned char>& out) : m_out(out) {}
+		void write(uint32_t bits, int count) {
+			m_buffer |= bits << m_count;
+			m_count += count;
+			while (m_count >= 8) {
+				m_out.push_back((unsigned char)(m_buffer & 0xFF));
+				m_buffer >>= 8;
+				m_count -= 8;
+			}
+		}
+		void writeCode(uint32_t code, int length) {
+			uint32_t reversed = 0;
+			for (int i = 0; i < length; i++)
+				reversed |= ((code >> i) & 1) << (length - 1 - i);
+			write(reversed, length);
+		}
+		void flush() {
+			if (m_count > 0)
+				m_out.push_back((unsigned char)(m_buffer & 0xFF));
+			m_buffer = 0;
+			m_count = 0;
+		}
+	private:
+		std::vector<unsigned char>& m_out;
+		uint32_t m_buffer = 0;
+		int m_count = 0;
+	};
+
+	//Fixed literal/length code from RFC 1951 section 3.2.6
+	static void writeLiteral(BitWriter& bits, int symbol) {
+		if (symbol < 144)
+			bits.writeCode(0x30 + symbol, 8);
+		else if (symbol < 256)
+			bits.writeCode(0x190 + symbol - 144, 9);
+		else if (symbol < 280)
+			bits.writeCode(symbol - 256, 7);
+		else
+			bits.writeCode(0xC0 + symbol - 280, 8);
+	}
+
+	static void writeMatch(BitWriter& bits, int length, int distance) {
+		int lengthCode = 28;
+		while (LENGTH_BASE[lengthCode] > length)
+			lengthCode--;
+		writeLiteral(bits, 257 + lengthCode);
+		bits.write(length - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+		int distanceCode = 29;
+		while (DISTANCE_BASE[distanceCode] > distance)
+			distanceCode--;
+		bits.writeCode(distanceCode, 5);
+		bits.write(distance - DISTANCE_BASE[distanceCode], DISTANCE_EXTRA[distanceCode]);
+	}
+
+	static uint32_t hash3(const unsigned char* p) {
+		return ((uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2]) * 2654435761u >> (32 - HASH_BITS);
+	}
+
+	//zlib stream holding one fixed Huffman deflate block
+	static void deflate(const unsigned char* data, size_t size, std::vector<unsigned char>& out) {
+		out.push_back(0x78);
+		out.push_back(0x01);
+		BitWriter bits(out);
+		bits.write(1, 1);
+		bits.write(1, 2);
+
+		std::vector<int32_t> head((size_t)1 << HASH_BITS, -1);
+		std::vector<int32_t> previous(WINDOW_SIZE, -1);
+		size_t position = 0;
+		while (position < size) {
+			int bestLength = 0, bestDistance = 0;
+			if (position + MIN_MATCH <= size) {
+				uint32_t hash = hash3(data + position);
+				int32_t candidate = head[hash];
+				int maxLength = (int)(size - position < (size_t)MAX_MATCH ? size - position : MAX_MATCH);
+				for (int chain = 0; chain < MAX_CHAIN && candidate >= 0 && position - candidate <= (size_t)WINDOW_SIZE; chain++) {
+					const unsigned char* a = data + candidate;
+					const unsigned char* b = data + position;
+					if (a[bestLength] == b[bestLength]) {
+						int length = 0;
+						while (length < maxLength && a[length] == b[length])
+							length++;
+						if (length > bestLength) {
+							bestLength = length;
+							bestDistance = (int)(position - candidate);
+							if (length == maxLength)
+								break;
+						}
+					}
+					int32_t next = previous[candidate % WINDOW_SIZE];
+					//Slots are reused as the window slides; a stale link points forward
+					if (next >= candidate)
+						break;
+					candidate = next;
+				}
+			}
+			size_t advance = bestLength >= MIN_MATCH ? (size_t)bestLength : 1;
+			if (bestLength >= MIN_MATCH)
+				writeMatch(bits, bestLength, bestDistance);
+			else
+				writeLiteral(bits, data[position]);
+			for (size_t i = 0; i < advance; i++, position++) {
+				if (position + MIN_MATCH <= size) {
+					uint32_t hash = hash3(data + position);
+					previous[position % WINDOW_SIZE] = head[hash];
+					head[hash] = (int32_t)position;
+				}
+			}
+		}
+		writeLiteral(bits, 256);
+		bits.flush();
+
+		uint32_t a = 1, b = 0;
+		for (size_t i = 0; i < size; i++) {
+			a = (a + data[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		uint32_t adler = (b << 16) | a;
+		for (int shift = 24; shift >= 0; shift -= 8)
+			out.push_back((unsigned char)(adler >> shift));
+	}
+
+	static std::array<uint32_t, 256> makeCrcTable() {
+		std::array<uint32_t, 256> table;
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++)
+				c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[n] = c;
+		}
+		return table;
+	}
+
+	static uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+		//Workers encode concurrently; a function-local static is initialized exactly once
+		static const std::array<uint32_t, 256> table = makeCrcTable();
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	static void writeChunk(std::vector<unsigned char>& png, const char type[4], const unsigned char* data, size_t size) {
+		for (int shift = 24; shift >= 0; shift -= 8)
+			png.push_back((unsigned char)(size >> shift));
+		size_t start = png.size();
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data, data + size);
+		uint32_t crc = crc32(&png[start], size + 4);
+		for (int shift = 24; shift >= 0; shift -= 8)
+			png.push_back((unsigned char)(crc >> shift));
+	}
+
+	static int paeth(int a, int b, int c) {
+		int p = a + b - c;
+		int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+		if (pa <= pb && pa <= pc)
+			return a;
+		return pb <= pc ? b : c;
+	}
+
+	std::vector<unsigned char> encodePNG(const unsigned char* pixels, int width, int height, int channels) {
+		size_t stride = (size_t)width * channels;
+		std::vector<unsigned char> filtered((stride + 1) * height);
+		std::vector<unsigned char> candidate(stride);
+		for (int y = 0; y < height; y++) {
+			const unsigned char* row = pixels + y * stride;
+			const unsigned char* above = y > 0 ? row - stride : nullptr;
+			unsigned char* out = &filtered[y * (stride + 1)];
+			long bestScore = -1;
+			for (int filter = 0; filter < 5; filter++) {
+				long score = 0;
+				for (size_t i = 0; i < stride; i++) {
+					int left = i >= (size_t)channels ? row[i - channels] : 0;
+					int up = above ? above[i] : 0;
+					int upLeft = above && i >= (size_t)channels ? above[i - channels] : 0;
+					int predicted = 0;
+					switch (filter) {
+					case 1: predicted = left; break;
+					case 2: predicted = up; break;
+					case 3: predicted = (left + up) / 2; break;
+					case 4: predicted = paeth(left, up, upLeft); break;
+					}
+					candidate[i] = (unsigned char)(row[i] - predicted);
+					score += abs((int)(signed char)candidate[i]);
+				}
+				if (bestScore < 0 || score < bestScore) {
+					bestScore = score;
+					out[0] = (unsigned char)filter;
+					memcpy(out + 1, candidate.data(), stride);
+				}
+			}
+		}
+
+		std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		unsigned char header[13] = {
+			(unsigned char)(width >> 24), (unsigned char)(width >> 16), (unsigned char)(width >> 8), (unsigned char)width,
+			(unsigned char)(height >> 24), (unsigned char)(height >> 16), (unsigned char)(height >> 8), (unsigned char)height,
+			//Bit depth 8, color type 2 (RGB) or 6 (RGBA), default compression, filtering, no interlace
+			8, (unsigned char)(channels == 4 ? 6 : 2), 0, 0, 0
+		};
+		writeChunk(png, "IHDR", header, sizeof(header));
+		std::vector<unsigned char> compressed;
+		deflate(filtered.data(), filtered.size(), compressed);
+		writeChunk(png, "IDAT", compressed.data(), compressed.size());
+		writeChunk(png, "IEND", nullptr, 0);
+		return png;
+	}
+
+	bool writePNG(const std::string& path, const unsigned char* pixels, int width, int height, int channels) {
+		std::vector<unsigned char> png = encodePNG(pixels, width, height, channels);
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file) {
+			printf("ERROR::PNG::Failed to open %s for writing\n", path.c_str());
+			return false;
+		}
+		bool ok = fwrite(png.data(), 1, png.size(), file) == png.size();
+		fclose(file);
+		return ok;
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace ew {
+	//Encodes 8-bit RGB (channels 3) or RGBA (channels 4) pixels, top row first, as a PNG file
+	//in memory. Each row gets the PNG filter with the smallest sum of absolute residuals and
+	//the result is deflated with fixed Huffman codes and a greedy hash-chain LZ77 matcher:
+	//much smaller than raw output, fast enough for frame capture, not as small as zlib -9.
+	std::vector<unsigned char> encodePNG(const unsigned char* pixels, int width, int height, int channels);
+	bool writePNG(const std::string& path, const unsigned char* pixels, int width, int height, int channels);
+}
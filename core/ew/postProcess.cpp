@@ -0,0 +1,367 @@
+#include "postProcess.h"
+#include "external/glad.h"
+#include "shader.h"
+#include <stdio.h>
+
+namespace ew {
+	static const char* fullscreenVertexSource = R"(
+		#version 450 core
+		out vec2 UV;
+		void main() {
+			UV = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+			gl_Position = vec4(UV * 2.0 - 1.0, 0.0, 1.0);
+		}
+	)";
+
+	//13 bilinear taps covering 36 texels (Jimenez, "Next Generation Post Processing in Call of Duty").
+	//The first level also applies the soft threshold.
+	static const char* downsampleFragmentSource = R"(
+		#version 450 core
+		in vec2 UV;
+		out vec4 FragColor;
+		layout(binding = 0) uniform sampler2D source;
+		uniform vec2 texelSize;
+		//x threshold, y threshold - knee, z 2 * knee, w 0.25 / knee
+		uniform vec4 threshold;
+		uniform bool prefilter;
+
+		vec3 softThreshold(vec3 color) {
+			float brightness = max(color.r, max(color.g, color.b));
+			float soft = clamp(brightness - threshold.y, 0.0, threshold.z);
+			soft = soft * soft * threshold.w;
+			return color * max(soft, brightness - threshold.x) / max(brightness, 1e-4);
+		}
+
+		void main() {
+			vec3 a = texture(source, UV + texelSize * vec2(-2.0, -2.0)).rgb;
+			vec3 b = texture(source, UV + texelSize * vec2( 0.0, -2.0)).rgb;
+			vec3 c = texture(source, UV + texelSize * vec2( 2.0, -2.0)).rgb;
+			vec3 d = texture(source, UV + texelSize * vec2(-1.0, -1.0)).rgb;
+			vec3 e = texture(source, UV + texelSize * vec2( 1.0, -1.0)).rgb;
+			vec3 f = texture(source, UV + texelSize * vec2(-2.0,  0.0)).rgb;
+			vec3 g = texture(source, UV).rgb;
+			vec3 h = texture(source, UV + texelSize * vec2( 2.0,  0.0)).rgb;
+			vec3 i = texture(source, UV + texelSize * vec2(-1.0,  1.0)).rgb;
+			vec3 j = texture(source, UV + texelSize * vec2( 1.0,  1.0)).rgb;
+			vec3 k = texture(source, UV + texelSize * vec2(-2.0,  2.0)).rgb;
+			vec3 l = texture(source, UV + texelSize * vec2( 0.0,  2.0)).rgb;
+			vec3 m = texture(source, UV + texelSize * vec2( 2.0,  2.0)).rgb;
+			vec3 color = (d + e + i + j) * 0.125;
+			color += (a + b + f + g) * 0.03125;
+			color += (b + c + g + h) * 0.03125;
+			color += (f + g + k + l) * 0.03125;
+			color += (g + h + l + m) * 0.03125;
+			if (prefilter)
+				color = softThreshold(color);
+			//Keeps a single very bright pixel from flooding the whole chain
+			FragColor = vec4(min(color, vec3(65000.0)), 1.0);
+		}
+	)";
+
+	//9 tap tent, added onto the next larger level with GL_ONE, GL_ONE blending
+	static const char* upsampleFragmentSource = R"(
+		#version 450 core
+		in vec2 UV;
+		out vec4 FragColor;
+		layout(binding = 0) uniform sampler2D source;
+		uniform vec2 texelSize;
+
+		void main() {
+			vec3 color = texture(source, UV).rgb * 4.0;
+			color += (texture(source, UV + texelSize * vec2(-1.0, 0.0)).rgb + texture(source, UV + texelSize * vec2(1.0, 0.0)).rgb +
+				texture(source, UV + texelSize * vec2(0.0, -1.0)).rgb + texture(source, UV + texelSize * vec2(0.0, 1.0)).rgb) * 2.0;
+			color += texture(source, UV + texelSize * vec2(-1.0, -1.0)).rgb + texture(source, UV + texelSize * vec2(1.0, -1.0)).rgb +
+				texture(source, UV + texelSize * vec2(-1.0, 1.0)).rgb + texture(source, UV + texelSize * vec2(1.0, 1.0)).rgb;
+			FragColor = vec4(color / 16.0, 1.0);
+		}
+	)";
+
+	static const char* tonemapFragmentSource = R"(
+		#version 450 core
+		in vec2 UV;
+		out vec4 FragColor;
+		layout(binding = 0) uniform sampler2D hdr;
+		layout(binding = 1) uniform sampler2D bloom;
+		uniform float exposure;
+		uniform float bloomIntensity;
+		uniform vec2 bloomTexelSize;
+
+		//Narkowicz's fit of the ACES filmic curve
+		vec3 tonemapACES(vec3 x) {
+			return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+		}
+
+		void main() {
+			vec3 color = texture(hdr, UV).rgb;
+			if (bloomIntensity > 0.0) {
+				//Last tent upsample from half resolution happens here instead of in its own pass
+				vec3 glow = texture(bloom, UV).rgb * 4.0;
+				glow += (texture(bloom, UV + bloomTexelSize * vec2(-1.0, 0.0)).rgb + texture(bloom, UV + bloomTexelSize * vec2(1.0, 0.0)).rgb +
+					texture(bloom, UV + bloomTexelSize * vec2(0.0, -1.0)).rgb + texture(bloom, UV + bloomTexelSize * vec2(0.0, 1.0)).rgb) * 2.0;
+				glow += texture(bloom, UV + bloomTexelSize * vec2(-1.0, -1.0)).rgb + texture(bloom, UV + bloomTexelSize * vec2(1.0, -1.0)).rgb +
+					texture(bloom, UV + bloomTexelSize * vec2(-1.0, 1.0)).rgb + texture(bloom, UV + bloomTexelSize * vec2(1.0, 1.0)).rgb;
+				color += glow / 16.0 * bloomIntensity;
+			}
+			color = pow(tonemapACES(color * exposure), vec3(1.0 / 2.2));
+			//Perceptual luma for FXAA, so it does not have to compute it per tap
+			FragColor = vec4(color, dot(color, vec3(0.299, 0.587, 0.114)));
+		}
+	)";
+
+	//FXAA (Lottes) reduced to the four diagonal neighbors plus two or four taps along the edge
+	static const char* fxaaFragmentSource = R"(
+		#version 450 core
+		in vec2 UV;
+		out vec4 FragColor;
+		layout(binding = 0) uniform sampler2D source;
+		uniform vec2 texelSize;
+
+		const float REDUCE_MIN = 1.0 / 128.0;
+		const float REDUCE_MUL = 1.0 / 8.0;
+		const float SPAN_MAX = 8.0;
+
+		void main() {
+			vec4 center = texture(source, UV);
+			float lumaNW = texture(source, UV + texelSize * vec2(-1.0, -1.0)).a;
+			float lumaNE = texture(source, UV + texelSize * vec2( 1.0, -1.0)).a;
+			float lumaSW = texture(source, UV + texelSize * vec2(-1.0,  1.0)).a;
+			float lumaSE = texture(source, UV + texelSize * vec2( 1.0,  1.0)).a;
+			float lumaMin = min(center.a, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+			float lumaMax = max(center.a, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+			//Most pixels have no edge; skip the directional taps for them
+			if (lumaMax - lumaMin < max(0.0312, lumaMax * 0.125)) {
+				FragColor = vec4(center.rgb, 1.0);
+				return;
+			}
+
+			vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+			float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);
+			float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+			dir = clamp(dir * rcpDirMin, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texelSize;
+
+			vec3 rgbA = 0.5 * (texture(source, UV + dir * (1.0 / 3.0 - 0.5)).rgb + texture(source, UV + dir * (2.0 / 3.0 - 0.5)).rgb);
+			vec3 rgbB = rgbA * 0.5 + 0.25 * (texture(source, UV - dir * 0.5).rgb + texture(source, UV + dir * 0.5).rgb);
+			float lumaB = dot(rgbB, vec3(0.299, 0.587, 0.114));
+			FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+		}
+	)";
+
+	PostProcessStack::PostProcessStack(int width, int height)
+		: m_width(width), m_height(height) {
+		m_downsampleProgram = createShaderProgram(fullscreenVertexSource, downsampleFragmentSource);
+		m_upsampleProgram = createShaderProgram(fullscreenVertexSource, upsampleFragmentSource);
+		m_tonemapProgram = createShaderProgram(fullscreenVertexSource, tonemapFragmentSource);
+		m_fxaaProgram = createShaderProgram(fullscreenVertexSource, fxaaFragmentSource);
+		m_downsampleTexelLocation = glGetUniformLocation(m_downsampleProgram, "texelSize");
+		m_downsampleThresholdLocation = glGetUniformLocation(m_downsampleProgram, "threshold");
+		m_downsamplePrefilterLocation = glGetUniformLocation(m_downsampleProgram, "prefilter");
+		m_upsampleTexelLocation = glGetUniformLocation(m_upsampleProgram, "texelSize");
+		m_tonemapExposureLocation = glGetUniformLocation(m_tonemapProgram, "exposure");
+		m_tonemapBloomLocation = glGetUniformLocation(m_tonemapProgram, "bloomIntensity");
+		m_tonemapBloomTexelLocation = glGetUniformLocation(m_tonemapProgram, "bloomTexelSize");
+		m_fxaaTexelLocation = glGetUniformLocation(m_fxaaProgram, "texelSize");
+		glGenVertexArrays(1, &m_emptyVAO);
+		createTargets();
+	}
+
+	PostProcessStack::~PostProcessStack() {
+		destroyTargets();
+		glDeleteProgram(m_downsampleProgram);
+		glDeleteProgram(m_upsampleProgram);
+		glDeleteProgram(m_tonemapProgram);
+		glDeleteProgram(m_fxaaProgram);
+		glDeleteVertexArrays(1, &m_emptyVAO);
+	}
+
+	PostProcessStack::Target PostProcessStack::createTarget(unsigned int internalFormat, int width, int height) {
+		Target target;
+		target.width = width;
+		target.height = height;
+		glGenTextures(1, &target.texture);
+		glBindTexture(GL_TEXTURE_2D, target.texture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glGenFramebuffers(1, &target.framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			printf("ERROR::FRAMEBUFFER::POSTPROCESS_INCOMPLETE\n");
+		return target;
+	}
+
+	void PostProcessStack::destroyTarget(Target& target) {
+		glDeleteFramebuffers(1, &target.framebuffer);
+		glDeleteTextures(1, &target.texture);
+		target = Target();
+	}
+
+	void PostProcessStack::createTargets() {
+		glGenTextures(1, &m_hdrColor);
+		glBindTexture(GL_TEXTURE_2D, m_hdrColor);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, m_width, m_height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glGenTextures(1, &m_hdrDepth);
+		glBindTexture(GL_TEXTURE_2D, m_hdrDepth);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, m_width, m_height);
+		glGenFramebuffers(1, &m_hdrFramebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_hdrFramebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_hdrColor, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_hdrDepth, 0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			printf("ERROR::FRAMEBUFFER::HDR_INCOMPLETE\n");
+
+		//Bloom starts at half resolution and stops before a level gets too small to blur
+		int width = m_width / 2, height = m_height / 2;
+		for (int i = 0; i < m_settings.bloomLevels && width >= 4 && height >= 4; i++) {
+			m_bloomLevels.push_back(createTarget(GL_R11F_G11F_B10F, width, height));
+			width /= 2;
+			height /= 2;
+		}
+		m_ldr = createTarget(GL_RGBA8, m_width, m_height);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void PostProcessStack::destroyTargets() {
+		glDeleteFramebuffers(1, &m_hdrFramebuffer);
+		unsigned int textures[] = { m_hdrColor, m_hdrDepth };
+		glDeleteTextures(2, textures);
+		for (Target& target : m_bloomLevels)
+			destroyTarget(target);
+		m_bloomLevels.clear();
+		destroyTarget(m_ldr);
+	}
+
+	void PostProcessStack::resize(int width, int height) {
+		if (width == m_width && height == m_height)
+			return;
+		destroyTargets();
+		m_width = width;
+		m_height = height;
+		createTargets();
+	}
+
+	void PostProcessStack::beginScene() {
+		//The bloom chain length is fixed at creation; pick up a changed setting here
+		int levels = 0;
+		for (int w = m_width / 2, h = m_height / 2; levels < m_settings.bloomLevels && w >= 4 && h >= 4; w /= 2, h /= 2)
+			levels++;
+		if (levels != (int)m_bloomLevels.size()) {
+			destroyTargets();
+			createTargets();
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, m_hdrFramebuffer);
+		glViewport(0, 0, m_width, m_height);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	void PostProcessStack::endScene() {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void PostProcessStack::bindTarget(const Target& target) {
+		glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+		glViewport(0, 0, target.width, target.height);
+	}
+
+	void PostProcessStack::drawFullscreen() {
+		glBindVertexArray(m_emptyVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+
+	void PostProcessStack::applyBloom() {
+		float knee = m_settings.bloomKnee > 1e-4f ? m_settings.bloomKnee : 1e-4f;
+		glUseProgram(m_downsampleProgram);
+		glUniform4f(m_downsampleThresholdLocation, m_settings.bloomThreshold, m_settings.bloomThreshold - knee, 2.0f * knee, 0.25f / knee);
+		unsigned int source = m_hdrColor;
+		int sourceWidth = m_width, sourceHeight = m_height;
+		for (size_t i = 0; i < m_bloomLevels.size(); i++) {
+			const Target& target = m_bloomLevels[i];
+			bindTarget(target);
+			glUniform2f(m_downsampleTexelLocation, 1.0f / sourceWidth, 1.0f / sourceHeight);
+			glUniform1i(m_downsamplePrefilterLocation, i == 0);
+			glBindTextureUnit(0, source);
+			drawFullscreen();
+			source = target.texture;
+			sourceWidth = target.width;
+			sourceHeight = target.height;
+		}
+
+		glUseProgram(m_upsampleProgram);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		for (size_t i = m_bloomLevels.size() - 1; i > 0; i--) {
+			const Target& smaller = m_bloomLevels[i];
+			bindTarget(m_bloomLevels[i - 1]);
+			glUniform2f(m_upsampleTexelLocation, 1.0f / smaller.width, 1.0f / smaller.height);
+			glBindTextureUnit(0, smaller.texture);
+			drawFullscreen();
+		}
+		glDisable(GL_BLEND);
+	}
+
+	void PostProcessStack::apply(unsigned int outputFramebuffer) {
+		GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+		glDisable(GL_DEPTH_TEST);
+
+		bool bloom = m_settings.bloom && !m_bloomLevels.empty();
+		if (bloom) {
+			m_bloomTimer.begin();
+			applyBloom();
+			m_bloomTimer.end();
+		}
+
+		m_tonemapTimer.begin();
+		if (m_settings.fxaa) {
+			bindTarget(m_ldr);
+		}
+		else {
+			glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+			glViewport(0, 0, m_width, m_height);
+		}
+		glUseProgram(m_tonemapProgram);
+		glUniform1f(m_tonemapExposureLocation, m_settings.exposure);
+		glUniform1f(m_tonemapBloomLocation, bloom ? m_settings.bloomIntensity : 0.0f);
+		if (!m_bloomLevels.empty())
+			glUniform2f(m_tonemapBloomTexelLocation, 1.0f / m_bloomLevels[0].width, 1.0f / m_bloomLevels[0].height);
+		glBindTextureUnit(0, m_hdrColor);
+		glBindTextureUnit(1, m_bloomLevels.empty() ? 0 : m_bloomLevels[0].texture);
+		drawFullscreen();
+		m_tonemapTimer.end();
+
+		if (m_settings.fxaa) {
+			m_fxaaTimer.begin();
+			glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+			glViewport(0, 0, m_width, m_height);
+			glUseProgram(m_fxaaProgram);
+			glUniform2f(m_fxaaTexelLocation, 1.0f / m_width, 1.0f / m_height);
+			glBindTextureUnit(0, m_ldr.texture);
+			drawFullscreen();
+			m_fxaaTimer.end();
+		}
+
+		if (depthTest)
+			glEnable(GL_DEPTH_TEST);
+	}
+
+	void PostProcessStack::resolveTimings() {
+		if (m_settings.bloom && !m_bloomLevels.empty())
+			m_bloomTimer.resolve();
+		m_tonemapTimer.resolve();
+		if (m_settings.fxaa)
+			m_fxaaTimer.resolve();
+	}
+
+	PostProcessTimings PostProcessStack::getTimings() const {
+		PostProcessTimings timings;
+		timings.bloomMs = m_settings.bloom ? m_bloomTimer.getMs() : 0.0;
+		timings.tonemapMs = m_tonemapTimer.getMs();
+		timings.fxaaMs = m_settings.fxaa ? m_fxaaTimer.getMs() : 0.0;
+		return timings;
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include "profiler.h"
+
+namespace ew {
+	struct PostProcessSettings {
+		float exposure = 1.0f;
+		bool bloom = true;
+		//Luminance where bloom starts, with a soft knee of bloomKnee around it
+		float bloomThreshold = 1.0f;
+		float bloomKnee = 0.5f;
+		float bloomIntensity = 0.05f;
+		//Levels of the half resolution downsample chain, fewer if the screen runs out of texels
+		int bloomLevels = 6;
+		bool fxaa = true;
+	};
+
+	//Most recent GPU time per effect in milliseconds, a few frames late unless resolved
+	struct PostProcessTimings {
+		double bloomMs = 0.0;
+		double tonemapMs = 0.0;
+		double fxaaMs = 0.0;
+	};
+
+	//Scene -> HDR target -> bloom -> tonemap -> FXAA -> output framebuffer.
+	//
+	//Each effect runs at the lowest resolution it can get away with:
+	//	- bloom never touches full resolution. The HDR image is thresholded and downsampled to
+	//	  half resolution, then down a mip chain with a 13 tap filter (36 texels through bilinear
+	//	  fetches) and back up with a 9 tap tent, accumulating each level additively. A wide glow
+	//	  costs roughly one half resolution pass in total.
+	//	- tonemapping is one full resolution pass that also applies bloom and writes luma in alpha
+	//	- FXAA reads that luma and exits early on pixels without local contrast
+	//Formats follow the same idea: R11F_G11F_B10F for the bloom chain, RGBA8 after tonemapping.
+	class PostProcessStack {
+	public:
+		PostProcessStack(int width, int height);
+		~PostProcessStack();
+		PostProcessStack(const PostProcessStack&) = delete;
+		PostProcessStack& operator=(const PostProcessStack&) = delete;
+
+		void resize(int width, int height);
+		//Binds and clears the HDR target (RGBA16F color, 32 bit float depth)
+		void beginScene();
+		void endScene();
+		//Runs the chain on the HDR target and writes the result into outputFramebuffer
+		void apply(unsigned int outputFramebuffer = 0);
+		//Blocks until every effect's timer has answered. Only for benchmarks.
+		void resolveTimings();
+
+		PostProcessSettings& getSettings() { return m_settings; }
+		PostProcessTimings getTimings() const;
+		unsigned int getHdrTexture() const { return m_hdrColor; }
+		int getBloomLevelCount() const { return (int)m_bloomLevels.size(); }
+
+	private:
+		struct Target {
+			unsigned int texture = 0;
+			unsigned int framebuffer = 0;
+			int width = 0;
+			int height = 0;
+		};
+
+		void createTargets();
+		void destroyTargets();
+		Target createTarget(unsigned int internalFormat, int width, int height);
+		void destroyTarget(Target& target);
+		void bindTarget(const Target& target);
+		void drawFullscreen();
+		void applyBloom();
+
+		int m_width = 0;
+		int m_height = 0;
+		PostProcessSettings m_settings;
+
+		unsigned int m_hdrFramebuffer = 0;
+		unsigned int m_hdrColor = 0;
+		unsigned int m_hdrDepth = 0;
+		std::vector<Target> m_bloomLevels;
+		Target m_ldr;
+		//Core profile needs a bound VAO even for the attributeless fullscreen triangle
+		unsigned int m_emptyVAO = 0;
+
+		unsigned int m_downsampleProgram = 0;
+		unsigned int m_upsampleProgram = 0;
+		unsigned int m_tonemapProgram = 0;
+		unsigned int m_fxaaProgram = 0;
+		int m_downsampleTexelLocation = -1;
+		int m_downsampleThresholdLocation = -1;
+		int m_downsamplePrefilterLocation = -1;
+		int m_upsampleTexelLocation = -1;
+		int m_tonemapExposureLocation = -1;
+		int m_tonemapBloomLocation = -1;
+		int m_tonemapBloomTexelLocation = -1;
+		int m_fxaaTexelLocation = -1;
+
+		GpuTimer m_bloomTimer;
+		GpuTimer m_tonemapTimer;
+		GpuTimer m_fxaaTimer;
+	};
+}
@@ -0,0 +1,97 @@
+#include "procGen.h"
+#include "ewMath/ewMath.h"
+
+namespace ew {
+	static void createCubeFace(glm::vec3 normal, float size, MeshData* mesh) {
+		unsigned int startVertex = (unsigned int)mesh->vertices.size();
+		glm::vec3 a = glm::vec3(normal.z, normal.x, normal.y);
+		glm::vec3 b = glm::cross(normal, a);
+		for (int i = 0; i < 4; i++) {
+			int col = i % 2;
+			int row = i / 2;
+			glm::vec3 pos = normal * size * 0.5f;
+			pos -= (a + b) * size * 0.5f;
+			pos += (a * (float)col + b * (float)row) * size;
+			Vertex vertex;
+			vertex.pos = pos;
+			vertex.normal = normal;
+			vertex.uv = glm::vec2(col, row);
+			mesh->vertices.push_back(vertex);
+		}
+		mesh->indices.push_back(startVertex);
+		mesh->indices.push_back(startVertex + 1);
+		mesh->indices.push_back(startVertex + 3);
+		mesh->indices.push_back(startVertex + 3);
+		mesh->indices.push_back(startVertex + 2);
+		mesh->indices.push_back(startVertex);
+	}
+
+	MeshData createCube(float size) {
+		MeshData mesh;
+		mesh.vertices.reserve(24);
+		mesh.indices.reserve(36);
+		createCubeFace(glm::vec3{ +0.0f,+0.0f,+1.0f }, size, &mesh);
+		createCubeFace(glm::vec3{ +1.0f,+0.0f,+0.0f }, size, &mesh);
+		createCubeFace(glm::vec3{ +0.0f,+1.0f,+0.0f }, size, &mesh);
+		createCubeFace(glm::vec3{ -1.0f,+0.0f,+0.0f }, size, &mesh);
+		createCubeFace(glm::vec3{ +0.0f,-1.0f,+0.0f }, size, &mesh);
+		createCubeFace(glm::vec3{ +0.0f,+0.0f,-1.0f }, size, &mesh);
+		return mesh;
+	}
+
+	MeshData createSphere(float radius, int segments) {
+		MeshData mesh;
+		float thetaStep = TAU / segments;
+		float phiStep = PI / segments;
+		for (int row = 0; row <= segments; row++) {
+			float phi = row * phiStep;
+			for (int col = 0; col <= segments; col++) {
+				float theta = col * thetaStep;
+				Vertex v;
+				v.normal = glm::vec3(cosf(theta) * sinf(phi), cosf(phi), sinf(theta) * sinf(phi));
+				v.pos = v.normal * radius;
+				v.uv = glm::vec2((float)col / segments, 1.0f - (float)row / segments);
+				mesh.vertices.push_back(v);
+			}
+		}
+		int columns = segments + 1;
+		for (int row = 0; row < segments; row++) {
+			for (int col = 0; col < segments; col++) {
+				unsigned int start = row * columns + col;
+				mesh.indices.push_back(start);
+				mesh.indices.push_back(start + 1);
+				mesh.indices.push_back(start + columns);
+				mesh.indices.push_back(start + 1);
+				mesh.indices.push_back(start + columns + 1);
+				mesh.indices.push_back(start + columns);
+			}
+		}
+		return mesh;
+	}
+
+	MeshData createPlane(float width, float height, int subdivisions) {
+		MeshData mesh;
+		int columns = subdivisions + 1;
+		for (int row = 0; row <= subdivisions; row++) {
+			for (int col = 0; col <= subdivisions; col++) {
+				Vertex v;
+				v.uv = glm::vec2((float)col / subdivisions, (float)row / subdivisions);
+				v.pos = glm::vec3((v.uv.x - 0.5f) * width, 0.0f, (0.5f - v.uv.y) * height);
+				v.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+				mesh.vertices.push_back(v);
+			}
+		}
+		for (int row = 0; row < subdivisions; row++) {
+			for (int col = 0; col < subdivisions; col++) {
+				unsigned int start = row * columns + col;
+				mesh.indices.push_back(start);
+				mesh.indices.push_back(start + 1);
+				mesh.indices.push_back(start + columns + 1);
+				mesh.indices.push_back(start + columns + 1);
+				mesh.indices.push_back(start + columns);
+				mesh.indices.push_back(start);
+			}
+		}
+		return mesh;
+	}
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "mesh.h"
+
+namespace ew {
+	MeshData createCube(float size);
+	//UV sphere. Triangle count is 2 * segments * segments, so this doubles as a high-poly test mesh.
+	MeshData createSphere(float radius, int segments);
+	//XZ plane facing +Y
+	MeshData createPlane(float width, float height, int subdivisions);
+}
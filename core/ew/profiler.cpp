@@ -0,0 +1,85 @@
+#include "profiler.h"
+#include <stdio.h>
+
+namespace ew {
+	GpuTimer::GpuTimer() {
+		glGenQueries(RING_SIZE, m_queries);
+	}
+
+	GpuTimer::~GpuTimer() {
+		glDeleteQueries(RING_SIZE, m_queries);
+	}
+
+	void GpuTimer::begin() {
+		collect(false);
+		//Ring is full of unanswered queries; wait rather than overwrite one in flight
+		if (m_pending[m_next])
+			collect(true);
+		glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+	}
+
+	void GpuTimer::end() {
+		glEndQuery(GL_TIME_ELAPSED);
+		m_pending[m_next] = true;
+		m_next = (m_next + 1) % RING_SIZE;
+	}
+
+	double GpuTimer::resolve() {
+		collect(true);
+		return m_lastMs;
+	}
+
+	void GpuTimer::collect(bool wait) {
+		//Oldest query first so m_lastMs ends on the newest result
+		for (int i = 0; i < RING_SIZE; i++) {
+			int slot = (m_next + i) % RING_SIZE;
+			if (!m_pending[slot])
+				continue;
+			int available = 0;
+			if (!wait) {
+				glGetQueryObjectiv(m_queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+				if (!available)
+					continue;
+			}
+			GLuint64 ns = 0;
+			glGetQueryObjectui64v(m_queries[slot], GL_QUERY_RESULT, &ns);
+			m_lastMs = ns / 1000000.0;
+			m_pending[slot] = false;
+		}
+	}
+
+	std::map<std::string, long long>& ProfilerCounters::counters() {
+		static std::map<std::string, long long> values;
+		return values;
+	}
+
+	std::mutex& ProfilerCounters::mutex() {
+		static std::mutex lock;
+		return lock;
+	}
+
+	void ProfilerCounters::add(const char* name, long long value) {
+		std::lock_guard<std::mutex> lock(mutex());
+		counters()[name] += value;
+	}
+
+	void ProfilerCounters::set(const char* name, long long value) {
+		std::lock_guard<std::mutex> lock(mutex());
+		counters()[name] = value;
+	}
+
+	long long ProfilerCounters::get(const char* name) {
+		std::lock_guard<std::mutex> lock(mutex());
+		auto found = counters().find(name);
+		return found == counters().end() ? 0 : found->second;
+	}
+
+	void ProfilerCounters::print(bool reset) {
+		std::lock_guard<std::mutex> lock(mutex());
+		for (auto& counter : counters()) {
+			printf("  %-40s %lld\n", counter.first.c_str(), counter.second);
+			if (reset)
+				counter.second = 0;
+		}
+	}
+}
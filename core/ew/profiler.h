@@ -0,0 +1,58 @@
+#pragma once
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include "external/glad.h"
+
+namespace ew {
+	//Wall clock timer for CPU-side sections
+	class CpuTimer {
+	public:
+		void start() { m_start = std::chrono::high_resolution_clock::now(); }
+		//Milliseconds since start()
+		double stop() const {
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - m_start;
+			return elapsed.count();
+		}
+	private:
+		std::chrono::high_resolution_clock::time_point m_start;
+	};
+
+	//GL_TIME_ELAPSED query ring. Results are read back a few frames late so the
+	//CPU never waits on the GPU to answer a query.
+	class GpuTimer {
+	public:
+		static const int RING_SIZE = 4;
+		GpuTimer();
+		~GpuTimer();
+		GpuTimer(const GpuTimer&) = delete;
+		GpuTimer& operator=(const GpuTimer&) = delete;
+		void begin();
+		void end();
+		//Most recent available result in milliseconds
+		double getMs() const { return m_lastMs; }
+		//Blocks until every issued query is available. Only for benchmarks.
+		double resolve();
+	private:
+		void collect(bool wait);
+		unsigned int m_queries[RING_SIZE];
+		bool m_pending[RING_SIZE] = {};
+		int m_next = 0;
+		double m_lastMs = 0.0;
+	};
+
+	//Named per-frame counters (allocations, draw calls...) reported next to timings.
+	//Systems publish totals once per frame rather than per event, so the lock stays cold.
+	class ProfilerCounters {
+	public:
+		static void add(const char* name, long long value);
+		static void set(const char* name, long long value);
+		static long long get(const char* name);
+		//Prints every counter, then resets them for the next frame if requested
+		static void print(bool reset = true);
+	private:
+		static std::map<std::string, long long>& counters();
+		static std::mutex& mutex();
+	};
+}
@@ -0,0 +1,379 @@
+#include "renderGraph.h"
+#include "textureFormat.h"
+#include <algorithm>
+#include <stdio.h>
+
+namespace ew {
+	static bool isDepthFormat(GLenum internalFormat) {
+		return internalFormat == GL_DEPTH_COMPONENT16 || internalFormat == GL_DEPTH_COMPONENT24 ||
+			internalFormat == GL_DEPTH_COMPONENT32F || internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH32F_STENCIL8;
+	}
+
+	static bool isStencilFormat(GLenum internalFormat) {
+		return internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH32F_STENCIL8;
+	}
+
+	static bool sameDesc(const RenderTargetDesc& a, const RenderTargetDesc& b) {
+		return a.width == b.width && a.height == b.height && a.internalFormat == b.internalFormat;
+	}
+
+	static size_t descBytes(const RenderTargetDesc& desc) {
+		return (size_t)desc.width * desc.height * bytesPerTexel(desc.internalFormat);
+	}
+
+	static void addUnique(std::vector<uint32_t>& list, uint32_t value) {
+		if (std::find(list.begin(), list.end(), value) == list.end())
+			list.push_back(value);
+	}
+
+	RenderGraphTexture RenderPassBuilder::create(const char* name, const RenderTargetDesc& desc) {
+		RenderGraphTexture texture;
+		texture.index = (uint32_t)m_graph.m_textures.size();
+		RenderGraph::VirtualTexture virtualTexture;
+		virtualTexture.name = name;
+		virtualTexture.desc = desc;
+		m_graph.m_textures.push_back(virtualTexture);
+		return write(texture);
+	}
+
+	RenderGraphTexture RenderPassBuilder::read(RenderGraphTexture texture) {
+		addUnique(m_graph.m_passes[m_pass].reads, texture.index);
+		addUnique(m_graph.m_textures[texture.index].readers, m_pass);
+		return texture;
+	}
+
+	RenderGraphTexture RenderPassBuilder::write(RenderGraphTexture texture) {
+		addUnique(m_graph.m_passes[m_pass].writes, texture.index);
+		addUnique(m_graph.m_textures[texture.index].writers, m_pass);
+		return texture;
+	}
+
+	void RenderPassBuilder::setSideEffect() {
+		m_graph.m_passes[m_pass].sideEffect = true;
+	}
+
+	unsigned int RenderPassContext::getTexture(RenderGraphTexture texture) const {
+		return m_graph.resolveTexture(texture.index);
+	}
+
+	RenderGraph::~RenderGraph() {
+		releaseTextures();
+	}
+
+	RenderGraphTexture RenderGraph::importTexture(const char* name, unsigned int texture, const RenderTargetDesc& desc) {
+		RenderGraphTexture handle;
+		handle.index = (uint32_t)m_textures.size();
+		VirtualTexture virtualTexture;
+		virtualTexture.name = name;
+		virtualTexture.desc = desc;
+		virtualTexture.imported = true;
+		virtualTexture.importedTexture = texture;
+		m_textures.push_back(virtualTexture);
+		m_compiled = false;
+		return handle;
+	}
+
+	RenderGraphTexture RenderGraph::importBackbuffer(int width, int height) {
+		RenderTargetDesc desc;
+		desc.width = width;
+		desc.height = height;
+		return importTexture("backbuffer", 0, desc);
+	}
+
+	void RenderGraph::addPass(const char* name, const SetupFunction& setup, const ExecuteFunction& execute) {
+		Pass pass;
+		pass.name = name;
+		pass.execute = execute;
+		m_passes.push_back(pass);
+		RenderPassBuilder builder(*this, (uint32_t)m_passes.size() - 1);
+		setup(builder);
+		m_compiled = false;
+	}
+
+	void RenderGraph::buildDependencies() {
+		for (uint32_t p = 0; p < m_passes.size(); p++) {
+			Pass& pass = m_passes[p];
+			pass.dependencies.clear();
+			//A read sees the latest earlier write. With no earlier writer the texture is produced
+			//by a pass declared later, which lets passes be added in any order.
+			for (uint32_t t : pass.reads) {
+				const std::vector<uint32_t>& writers = m_textures[t].writers;
+				bool earlierWriter = false;
+				for (uint32_t w : writers) {
+					if (w < p) {
+						earlierWriter = true;
+						break;
+					}
+				}
+				for (uint32_t w : writers) {
+					if (w != p && (!earlierWriter || w < p))
+						addUnique(pass.dependencies, w);
+				}
+			}
+			//Writes stay in declaration order, after any pass that read the previous contents
+			for (uint32_t t : pass.writes) {
+				const VirtualTexture& texture = m_textures[t];
+				uint32_t firstWriter = texture.writers.empty() ? p : texture.writers[0];
+				for (uint32_t w : texture.writers) {
+					if (w < p)
+						addUnique(pass.dependencies, w);
+				}
+				for (uint32_t r : texture.readers) {
+					if (r < p && firstWriter < r)
+						addUnique(pass.dependencies, r);
+				}
+			}
+		}
+	}
+
+	void RenderGraph::cullPasses() {
+		std::vector<uint32_t> stack;
+		for (uint32_t p = 0; p < m_passes.size(); p++) {
+			Pass& pass = m_passes[p];
+			pass.culled = true;
+			bool root = pass.sideEffect;
+			for (uint32_t t : pass.writes)
+				root = root || m_textures[t].imported;
+			if (root)
+				stack.push_back(p);
+		}
+		while (!stack.empty()) {
+			uint32_t p = stack.back();
+			stack.pop_back();
+			if (!m_passes[p].culled)
+				continue;
+			m_passes[p].culled = false;
+			for (uint32_t d : m_passes[p].dependencies)
+				stack.push_back(d);
+		}
+	}
+
+	bool RenderGraph::sortPasses() {
+		//Kahn's algorithm, always taking the earliest declared ready pass
+		m_order.clear();
+		std::vector<int> remaining(m_passes.size(), 0);
+		std::vector<std::vector<uint32_t>> dependents(m_passes.size());
+		size_t liveCount = 0;
+		for (uint32_t p = 0; p < m_passes.size(); p++) {
+			if (m_passes[p].culled)
+				continue;
+			liveCount++;
+			for (uint32_t d : m_passes[p].dependencies) {
+				remaining[p]++;
+				dependents[d].push_back(p);
+			}
+		}
+		std::vector<bool> done(m_passes.size(), false);
+		while (m_order.size() < liveCount) {
+			uint32_t next = ~0u;
+			for (uint32_t p = 0; p < m_passes.size(); p++) {
+				if (!m_passes[p].culled && !done[p] && remaining[p] == 0) {
+					next = p;
+					break;
+				}
+			}
+			if (next == ~0u)
+				return false;
+			done[next] = true;
+			m_order.push_back(next);
+			for (uint32_t dependent : dependents[next])
+				remaining[dependent]--;
+		}
+		return true;
+	}
+
+	void RenderGraph::assignPhysicalTextures() {
+		//Lifetime of each transient as the range of execution slots that use it
+		std::vector<int> first(m_textures.size(), -1), last(m_textures.size(), -1);
+		for (int slot = 0; slot < (int)m_order.size(); slot++) {
+			const Pass& pass = m_passes[m_order[slot]];
+			for (const std::vector<uint32_t>* list : { &pass.reads, &pass.writes }) {
+				for (uint32_t t : *list) {
+					if (first[t] < 0)
+						first[t] = slot;
+					last[t] = slot;
+				}
+			}
+		}
+		std::vector<uint32_t> transients;
+		for (uint32_t t = 0; t < m_textures.size(); t++) {
+			m_textures[t].physical = -1;
+			if (!m_textures[t].imported && first[t] >= 0)
+				transients.push_back(t);
+		}
+		std::stable_sort(transients.begin(), transients.end(), [&](uint32_t a, uint32_t b) { return first[a] < first[b]; });
+
+		for (PhysicalTexture& physical : m_physical) {
+			physical.busyUntil = -1;
+			physical.usedThisFrame = false;
+		}
+		m_stats.transientTextures = (unsigned int)transients.size();
+		m_stats.unaliasedBytes = 0;
+		for (uint32_t t : transients) {
+			VirtualTexture& texture = m_textures[t];
+			m_stats.unaliasedBytes += descBytes(texture.desc);
+			//Prefer a texture already used this frame so lifetimes pack into as few as possible
+			int chosen = -1;
+			for (int i = 0; i < (int)m_physical.size(); i++) {
+				const PhysicalTexture& physical = m_physical[i];
+				if (!sameDesc(physical.desc, texture.desc) || physical.busyUntil >= first[t])
+					continue;
+				if (chosen < 0 || (physical.usedThisFrame && !m_physical[chosen].usedThisFrame))
+					chosen = i;
+			}
+			if (chosen < 0) {
+				PhysicalTexture physical;
+				physical.desc = texture.desc;
+				glGenTextures(1, &physical.texture);
+				glBindTexture(GL_TEXTURE_2D, physical.texture);
+				glTexStorage2D(GL_TEXTURE_2D, 1, texture.desc.internalFormat, texture.desc.width, texture.desc.height);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+				m_physical.push_back(physical);
+				chosen = (int)m_physical.size() - 1;
+			}
+			m_physical[chosen].busyUntil = last[t];
+			m_physical[chosen].usedThisFrame = true;
+			texture.physical = chosen;
+		}
+
+		//Textures no transient needed this time belong to an old resolution or a pass that went
+		//away; free them along with every framebuffer they are attached to
+		std::vector<int> remap(m_physical.size(), -1);
+		size_t kept = 0;
+		for (size_t i = 0; i < m_physical.size(); i++) {
+			if (m_physical[i].usedThisFrame) {
+				remap[i] = (int)kept;
+				m_physical[kept++] = m_physical[i];
+				continue;
+			}
+			unsigned int stale = m_physical[i].texture;
+			for (std::map<std::vector<unsigned int>, unsigned int>::iterator it = m_framebuffers.begin(); it != m_framebuffers.end();) {
+				if (std::find(it->first.begin(), it->first.end(), stale) != it->first.end()) {
+					glDeleteFramebuffers(1, &it->second);
+					it = m_framebuffers.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+			glDeleteTextures(1, &stale);
+		}
+		m_physical.resize(kept);
+		for (uint32_t t : transients)
+			m_textures[t].physical = remap[m_textures[t].physical];
+
+		m_stats.physicalTextures = (unsigned int)m_physical.size();
+		m_stats.aliasedBytes = 0;
+		for (const PhysicalTexture& physical : m_physical)
+			m_stats.aliasedBytes += descBytes(physical.desc);
+	}
+
+	bool RenderGraph::compile() {
+		buildDependencies();
+		cullPasses();
+		m_stats.passCount = (unsigned int)m_passes.size();
+		m_stats.culledPassCount = 0;
+		for (const Pass& pass : m_passes)
+			m_stats.culledPassCount += pass.culled ? 1 : 0;
+		if (!sortPasses()) {
+			printf("ERROR::RENDERGRAPH::DEPENDENCY_CYCLE\n");
+			m_order.clear();
+			return false;
+		}
+		assignPhysicalTextures();
+		m_compiled = true;
+		return true;
+	}
+
+	unsigned int RenderGraph::resolveTexture(uint32_t texture) const {
+		const VirtualTexture& virtualTexture = m_textures[texture];
+		if (virtualTexture.imported)
+			return virtualTexture.importedTexture;
+		return virtualTexture.physical < 0 ? 0 : m_physical[virtualTexture.physical].texture;
+	}
+
+	unsigned int RenderGraph::getFramebuffer(const Pass& pass) {
+		std::vector<unsigned int> attachments;
+		for (uint32_t t : pass.writes)
+			attachments.push_back(resolveTexture(t));
+		if (std::find(attachments.begin(), attachments.end(), 0u) != attachments.end()) {
+			if (attachments.size() > 1)
+				printf("ERROR::RENDERGRAPH::BACKBUFFER_WITH_OTHER_ATTACHMENTS %s\n", pass.name.c_str());
+			return 0;
+		}
+		std::map<std::vector<unsigned int>, unsigned int>::iterator it = m_framebuffers.find(attachments);
+		if (it != m_framebuffers.end())
+			return it->second;
+
+		unsigned int framebuffer;
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		std::vector<GLenum> drawBuffers;
+		for (size_t i = 0; i < pass.writes.size(); i++) {
+			GLenum format = m_textures[pass.writes[i]].desc.internalFormat;
+			GLenum attachment;
+			if (isDepthFormat(format)) {
+				attachment = isStencilFormat(format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+			}
+			else {
+				attachment = GL_COLOR_ATTACHMENT0 + (GLenum)drawBuffers.size();
+				drawBuffers.push_back(attachment);
+			}
+			glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, attachments[i], 0);
+		}
+		if (drawBuffers.empty())
+			glDrawBuffer(GL_NONE);
+		else
+			glDrawBuffers((GLsizei)drawBuffers.size(), drawBuffers.data());
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			printf("ERROR::RENDERGRAPH::FRAMEBUFFER_INCOMPLETE %s\n", pass.name.c_str());
+		m_framebuffers[attachments] = framebuffer;
+		return framebuffer;
+	}
+
+	void RenderGraph::execute() {
+		if (!m_compiled && !compile())
+			return;
+		RenderPassContext context(*this);
+		for (uint32_t p : m_order) {
+			const Pass& pass = m_passes[p];
+			//Passes without attachments (compute, uploads) run with whatever is bound
+			if (!pass.writes.empty()) {
+				glBindFramebuffer(GL_FRAMEBUFFER, getFramebuffer(pass));
+				const RenderTargetDesc& desc = m_textures[pass.writes[0]].desc;
+				glViewport(0, 0, desc.width, desc.height);
+			}
+			pass.execute(context);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void RenderGraph::reset() {
+		m_passes.clear();
+		m_textures.clear();
+		m_order.clear();
+		m_compiled = false;
+	}
+
+	void RenderGraph::releaseTextures() {
+		for (const std::pair<const std::vector<unsigned int>, unsigned int>& framebuffer : m_framebuffers)
+			glDeleteFramebuffers(1, &framebuffer.second);
+		m_framebuffers.clear();
+		for (const PhysicalTexture& physical : m_physical)
+			glDeleteTextures(1, &physical.texture);
+		m_physical.clear();
+		for (VirtualTexture& texture : m_textures)
+			texture.physical = -1;
+		m_compiled = false;
+	}
+
+	std::vector<std::string> RenderGraph::getExecutionOrder() const {
+		std::vector<std::string> names;
+		for (uint32_t p : m_order)
+			names.push_back(m_passes[p].name);
+		return names;
+	}
+}
@@ -0,0 +1,151 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "external/glad.h"
+
+namespace ew {
+	struct RenderTargetDesc {
+		int width = 1;
+		int height = 1;
+		GLenum internalFormat = GL_RGBA8;
+	};
+
+	//Virtual texture of a RenderGraph, valid until the graph is reset
+	struct RenderGraphTexture {
+		uint32_t index = ~0u;
+		bool isValid() const { return index != ~0u; }
+	};
+
+	struct RenderGraphStats {
+		unsigned int passCount = 0;
+		unsigned int culledPassCount = 0;
+		unsigned int transientTextures = 0;
+		//Textures actually backing the transients after aliasing
+		unsigned int physicalTextures = 0;
+		//Render target memory if every transient had its own texture
+		size_t unaliasedBytes = 0;
+		//Render target memory of the physical textures used this frame
+		size_t aliasedBytes = 0;
+	};
+
+	class RenderGraph;
+
+	//Handed to a pass's setup function to declare what it touches
+	class RenderPassBuilder {
+	public:
+		//New transient texture, written by this pass
+		RenderGraphTexture create(const char* name, const RenderTargetDesc& desc);
+		//Sampled by this pass
+		RenderGraphTexture read(RenderGraphTexture texture);
+		//Rendered to by this pass; every written texture becomes an attachment of its framebuffer
+		RenderGraphTexture write(RenderGraphTexture texture);
+		//Never culled, even if nothing reads its output (readbacks, timers, debug output)
+		void setSideEffect();
+	private:
+		friend class RenderGraph;
+		RenderPassBuilder(RenderGraph& graph, uint32_t pass) : m_graph(graph), m_pass(pass) {}
+		RenderGraph& m_graph;
+		uint32_t m_pass;
+	};
+
+	//Handed to a pass's execute function. The pass's framebuffer and viewport are already bound.
+	class RenderPassContext {
+	public:
+		//GL texture backing a virtual texture, 0 for the imported backbuffer
+		unsigned int getTexture(RenderGraphTexture texture) const;
+	private:
+		friend class RenderGraph;
+		explicit RenderPassContext(const RenderGraph& graph) : m_graph(graph) {}
+		const RenderGraph& m_graph;
+	};
+
+	//Frame graph. Each frame passes are added with the textures they read and write, then the
+	//graph is compiled and executed:
+	//	- passes are ordered by their dependencies (declaration order breaks ties)
+	//	- passes whose output never reaches an imported texture or a side effect are culled
+	//	- transient textures with non-overlapping lifetimes share one physical texture
+	//
+	//GL has no memory heaps to place different resources in one allocation, so aliasing is done
+	//at the texture level: transients of identical description reuse the same texture object.
+	//Physical textures and their framebuffers are kept between frames, so rebuilding the graph
+	//every frame does not allocate GL objects once the frame has been seen. Those the latest
+	//compile() did not use (e.g. after a resolution change) are deleted.
+	class RenderGraph {
+	public:
+		typedef std::function<void(RenderPassBuilder&)> SetupFunction;
+		typedef std::function<void(const RenderPassContext&)> ExecuteFunction;
+
+		RenderGraph() = default;
+		~RenderGraph();
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+
+		//Texture owned elsewhere whose contents outlive the frame. Passes writing it are never culled.
+		RenderGraphTexture importTexture(const char* name, unsigned int texture, const RenderTargetDesc& desc);
+		//The default framebuffer, as an imported color target
+		RenderGraphTexture importBackbuffer(int width, int height);
+		void addPass(const char* name, const SetupFunction& setup, const ExecuteFunction& execute);
+
+		//Orders and culls passes and assigns physical textures. Returns false on a dependency cycle.
+		bool compile();
+		void execute();
+		//Clears passes and virtual textures for the next frame. Physical textures are kept until a compile() leaves them unused.
+		void reset();
+		//Deletes pooled physical textures and framebuffers
+		void releaseTextures();
+
+		const RenderGraphStats& getStats() const { return m_stats; }
+		//Passes in execution order, culled passes omitted. Valid after compile().
+		std::vector<std::string> getExecutionOrder() const;
+
+	private:
+		friend class RenderPassBuilder;
+		friend class RenderPassContext;
+
+		struct VirtualTexture {
+			std::string name;
+			RenderTargetDesc desc;
+			bool imported = false;
+			unsigned int importedTexture = 0;
+			//Index into m_physical for transients
+			int physical = -1;
+			std::vector<uint32_t> writers;
+			std::vector<uint32_t> readers;
+		};
+		struct Pass {
+			std::string name;
+			ExecuteFunction execute;
+			std::vector<uint32_t> reads;
+			std::vector<uint32_t> writes;
+			std::vector<uint32_t> dependencies;
+			bool sideEffect = false;
+			bool culled = false;
+		};
+		struct PhysicalTexture {
+			RenderTargetDesc desc;
+			unsigned int texture = 0;
+			//Execution slot after which the texture is free again while compiling
+			int busyUntil = -1;
+			bool usedThisFrame = false;
+		};
+
+		void buildDependencies();
+		void cullPasses();
+		bool sortPasses();
+		void assignPhysicalTextures();
+		unsigned int getFramebuffer(const Pass& pass);
+		unsigned int resolveTexture(uint32_t texture) const;
+
+		std::vector<VirtualTexture> m_textures;
+		std::vector<Pass> m_passes;
+		std::vector<uint32_t> m_order;
+		std::vector<PhysicalTexture> m_physical;
+		std::map<std::vector<unsigned int>, unsigned int> m_framebuffers;
+		RenderGraphStats m_stats;
+		bool m_compiled = false;
+	};
+}
@@ -0,0 +1,380 @@
+#include "resourceManager.h"
+#include "profiler.h"
+#include "textureFormat.h"
+#include <algorithm>
+#include <string>
+
+namespace ew {
+	static const uint32_t MIN_BUFFER_CLASS = 8;
+
+	static uint32_t bufferSizeClass(size_t size) {
+		uint32_t sizeClass = MIN_BUFFER_CLASS;
+		while (((size_t)1 << sizeClass) < size)
+			sizeClass++;
+		return sizeClass;
+	}
+
+	static size_t textureBytes(const TextureDesc& desc) {
+		size_t bytes = 0;
+		int width = desc.width, height = desc.height, depth = desc.depth;
+		for (int level = 0; level < desc.levels; level++) {
+			bytes += (size_t)width * height * depth * bytesPerTexel(desc.internalFormat);
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+			//A 3D texture's depth shrinks with its mips; array layers do not
+			if (desc.target == GL_TEXTURE_3D)
+				depth = depth > 1 ? depth / 2 : 1;
+		}
+		if (desc.target == GL_TEXTURE_CUBE_MAP)
+			bytes *= 6;
+		return bytes;
+	}
+
+	ResourceManager::ResourceManager() {
+	}
+
+	ResourceManager::~ResourceManager() {
+		for (int type = 0; type < (int)ResourceType::Count; type++) {
+			for (const Slot& slot : m_slots[type]) {
+				if (slot.alive)
+					deleteObject((ResourceType)type, slot.name);
+			}
+		}
+		for (Frame& frame : m_frames) {
+			for (const Retired& object : frame.objects)
+				deleteObject(object.type, object.name);
+			glDeleteSync(frame.fence);
+		}
+		for (const Retired& object : m_retiring)
+			deleteObject(object.type, object.name);
+		for (auto& bucket : m_bufferPool)
+			glDeleteBuffers((GLsizei)bucket.second.size(), bucket.second.data());
+		for (auto& bucket : m_texturePool)
+			glDeleteTextures((GLsizei)bucket.second.size(), bucket.second.data());
+		glDeleteVertexArrays((GLsizei)m_vertexArrayPool.size(), m_vertexArrayPool.data());
+	}
+
+	uint32_t ResourceManager::allocateSlot(ResourceType type) {
+		std::vector<uint32_t>& freeSlots = m_freeSlots[(int)type];
+		uint32_t index;
+		if (!freeSlots.empty()) {
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else {
+			index = (uint32_t)m_slots[(int)type].size();
+			m_slots[(int)type].push_back(Slot());
+		}
+		m_slots[(int)type][index].alive = true;
+		return index;
+	}
+
+	const ResourceManager::Slot* ResourceManager::lookup(ResourceType type, uint32_t index, uint32_t generation) const {
+		const std::vector<Slot>& slots = m_slots[(int)type];
+		if (index >= slots.size() || !slots[index].alive || slots[index].generation != generation)
+			return nullptr;
+		return &slots[index];
+	}
+
+	uint32_t ResourceManager::bufferKeyIndex(uint32_t sizeClass, GLenum usage) {
+		BufferKey key(sizeClass, usage);
+		for (size_t i = 0; i < m_bufferKeys.size(); i++) {
+			if (m_bufferKeys[i] == key)
+				return (uint32_t)i;
+		}
+		m_bufferKeys.push_back(key);
+		return (uint32_t)m_bufferKeys.size() - 1;
+	}
+
+	BufferHandle ResourceManager::createBuffer(const BufferDesc& desc) {
+		uint32_t sizeClass = bufferSizeClass(desc.size);
+		uint32_t key = bufferKeyIndex(sizeClass, desc.usage);
+		size_t capacity = (size_t)1 << sizeClass;
+		ResourceStats& stats = m_stats[(int)ResourceType::Buffer];
+		unsigned int name = 0;
+		std::vector<unsigned int>& pool = m_bufferPool[key];
+		if (!pool.empty()) {
+			name = pool.back();
+			pool.pop_back();
+			stats.pooledCount--;
+			stats.pooledBytes -= capacity;
+			if (desc.data) {
+				glBindBuffer(GL_COPY_WRITE_BUFFER, name);
+				glBufferSubData(GL_COPY_WRITE_BUFFER, 0, desc.size, desc.data);
+			}
+		}
+		else {
+			glGenBuffers(1, &name);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, name);
+			glBufferData(GL_COPY_WRITE_BUFFER, capacity, NULL, desc.usage);
+			if (desc.data)
+				glBufferSubData(GL_COPY_WRITE_BUFFER, 0, desc.size, desc.data);
+			stats.glCreates++;
+		}
+
+		uint32_t index = allocateSlot(ResourceType::Buffer);
+		Slot& slot = m_slots[(int)ResourceType::Buffer][index];
+		slot.name = name;
+		slot.bytes = capacity;
+		slot.poolKey = key;
+		stats.liveCount++;
+		stats.liveBytes += capacity;
+		BufferHandle handle;
+		handle.index = index;
+		handle.generation = slot.generation;
+		return handle;
+	}
+
+	uint32_t ResourceManager::textureKeyIndex(const TextureDesc& desc) {
+		TextureKey key(desc.target, desc.internalFormat, desc.width, desc.height, desc.depth, desc.levels);
+		for (size_t i = 0; i < m_textureKeys.size(); i++) {
+			if (m_textureKeys[i] == key)
+				return (uint32_t)i;
+		}
+		m_textureKeys.push_back(key);
+		m_textureDescs.push_back(desc);
+		return (uint32_t)m_textureKeys.size() - 1;
+	}
+
+	TextureHandle ResourceManager::createTexture(const TextureDesc& desc) {
+		uint32_t key = textureKeyIndex(desc);
+		size_t bytes = textureBytes(desc);
+		ResourceStats& stats = m_stats[(int)ResourceType::Texture];
+		unsigned int name = 0;
+		std::vector<unsigned int>& pool = m_texturePool[key];
+		if (!pool.empty()) {
+			name = pool.back();
+			pool.pop_back();
+			stats.pooledCount--;
+			stats.pooledBytes -= bytes;
+		}
+		else {
+			glGenTextures(1, &name);
+			glBindTexture(desc.target, name);
+			switch (desc.target) {
+			case GL_TEXTURE_1D:
+				glTexStorage1D(desc.target, desc.levels, desc.internalFormat, desc.width);
+				break;
+			case GL_TEXTURE_2D_ARRAY:
+			case GL_TEXTURE_3D:
+			case GL_TEXTURE_CUBE_MAP_ARRAY:
+				glTexStorage3D(desc.target, desc.levels, desc.internalFormat, desc.width, desc.height, desc.depth);
+				break;
+			default:
+				glTexStorage2D(desc.target, desc.levels, desc.internalFormat, desc.width, desc.height);
+				break;
+			}
+			glBindTexture(desc.target, 0);
+			stats.glCreates++;
+		}
+
+		uint32_t index = allocateSlot(ResourceType::Texture);
+		Slot& slot = m_slots[(int)ResourceType::Texture][index];
+		slot.name = name;
+		slot.bytes = bytes;
+		slot.poolKey = key;
+		stats.liveCount++;
+		stats.liveBytes += bytes;
+		TextureHandle handle;
+		handle.index = index;
+		handle.generation = slot.generation;
+		return handle;
+	}
+
+	VertexArrayHandle ResourceManager::createVertexArray() {
+		ResourceStats& stats = m_stats[(int)ResourceType::VertexArray];
+		unsigned int name = 0;
+		if (!m_vertexArrayPool.empty()) {
+			name = m_vertexArrayPool.back();
+			m_vertexArrayPool.pop_back();
+			stats.pooledCount--;
+		}
+		else {
+			glGenVertexArrays(1, &name);
+			stats.glCreates++;
+		}
+		uint32_t index = allocateSlot(ResourceType::VertexArray);
+		Slot& slot = m_slots[(int)ResourceType::VertexArray][index];
+		slot.name = name;
+		slot.bytes = 0;
+		stats.liveCount++;
+		VertexArrayHandle handle;
+		handle.index = index;
+		handle.generation = slot.generation;
+		return handle;
+	}
+
+	ProgramHandle ResourceManager::adoptProgram(unsigned int program) {
+		uint32_t index = allocateSlot(ResourceType::Program);
+		Slot& slot = m_slots[(int)ResourceType::Program][index];
+		slot.name = program;
+		slot.bytes = 0;
+		m_stats[(int)ResourceType::Program].liveCount++;
+		ProgramHandle handle;
+		handle.index = index;
+		handle.generation = slot.generation;
+		return handle;
+	}
+
+	unsigned int ResourceManager::get(BufferHandle handle) const {
+		const Slot* slot = lookup(ResourceType::Buffer, handle.index, handle.generation);
+		return slot ? slot->name : 0;
+	}
+
+	unsigned int ResourceManager::get(TextureHandle handle) const {
+		const Slot* slot = lookup(ResourceType::Texture, handle.index, handle.generation);
+		return slot ? slot->name : 0;
+	}
+
+	unsigned int ResourceManager::get(VertexArrayHandle handle) const {
+		const Slot* slot = lookup(ResourceType::VertexArray, handle.index, handle.generation);
+		return slot ? slot->name : 0;
+	}
+
+	unsigned int ResourceManager::get(ProgramHandle handle) const {
+		const Slot* slot = lookup(ResourceType::Program, handle.index, handle.generation);
+		return slot ? slot->name : 0;
+	}
+
+	size_t ResourceManager::getBufferSize(BufferHandle handle) const {
+		const Slot* slot = lookup(ResourceType::Buffer, handle.index, handle.generation);
+		return slot ? slot->bytes : 0;
+	}
+
+	void ResourceManager::retire(ResourceType type, uint32_t index, uint32_t generation) {
+		if (!lookup(type, index, generation))
+			return;
+		Slot& slot = m_slots[(int)type][index];
+		m_retiring.push_back({ type, slot.name, slot.bytes, slot.poolKey });
+		ResourceStats& stats = m_stats[(int)type];
+		stats.liveCount--;
+		stats.liveBytes -= slot.bytes;
+		stats.pendingCount++;
+		//Bumping the generation invalidates every outstanding handle immediately
+		slot.alive = false;
+		slot.generation++;
+		slot.name = 0;
+		m_freeSlots[(int)type].push_back(index);
+	}
+
+	void ResourceManager::destroy(BufferHandle handle) { retire(ResourceType::Buffer, handle.index, handle.generation); }
+	void ResourceManager::destroy(TextureHandle handle) { retire(ResourceType::Texture, handle.index, handle.generation); }
+	void ResourceManager::destroy(VertexArrayHandle handle) { retire(ResourceType::VertexArray, handle.index, handle.generation); }
+	void ResourceManager::destroy(ProgramHandle handle) { retire(ResourceType::Program, handle.index, handle.generation); }
+
+	void ResourceManager::deleteObject(ResourceType type, unsigned int name) {
+		switch (type) {
+		case ResourceType::Buffer: glDeleteBuffers(1, &name); break;
+		case ResourceType::Texture: glDeleteTextures(1, &name); break;
+		case ResourceType::VertexArray: glDeleteVertexArrays(1, &name); break;
+		case ResourceType::Program: glDeleteProgram(name); break;
+		default: break;
+		}
+		m_stats[(int)type].glDeletes++;
+	}
+
+	void ResourceManager::recycle(const Retired& object) {
+		ResourceStats& stats = m_stats[(int)object.type];
+		stats.pendingCount--;
+		switch (object.type) {
+		case ResourceType::Buffer:
+			m_bufferPool[object.poolKey].push_back(object.name);
+			break;
+		case ResourceType::Texture:
+			m_texturePool[object.poolKey].push_back(object.name);
+			break;
+		case ResourceType::VertexArray: {
+			//Clear attribute state so the next owner starts from a fresh VAO
+			int maxAttribs = 0;
+			glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+			glBindVertexArray(object.name);
+			for (int i = 0; i < maxAttribs; i++) {
+				glDisableVertexAttribArray(i);
+				glVertexAttribDivisor(i, 0);
+			}
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+			glBindVertexArray(0);
+			m_vertexArrayPool.push_back(object.name);
+			break;
+		}
+		default:
+			//Programs are not worth pooling
+			deleteObject(object.type, object.name);
+			return;
+		}
+		stats.pooledCount++;
+		stats.pooledBytes += object.bytes;
+	}
+
+	void ResourceManager::endFrame() {
+		if (!m_retiring.empty()) {
+			Frame frame;
+			frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			frame.objects.swap(m_retiring);
+			m_frames.push_back(std::move(frame));
+		}
+		//Fences signal in submission order, so stop at the first one still pending
+		size_t done = 0;
+		for (; done < m_frames.size(); done++) {
+			Frame& frame = m_frames[done];
+			GLenum status = glClientWaitSync(frame.fence, frame.flushed ? 0 : GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			frame.flushed = true;
+			if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+				break;
+			for (const Retired& object : frame.objects)
+				recycle(object);
+			glDeleteSync(frame.fence);
+		}
+		m_frames.erase(m_frames.begin(), m_frames.begin() + done);
+	}
+
+	void ResourceManager::trim(size_t maxPooledBytes) {
+		ResourceStats& buffers = m_stats[(int)ResourceType::Buffer];
+		ResourceStats& textures = m_stats[(int)ResourceType::Texture];
+		//Largest size classes first, they free the most memory per delete
+		std::vector<uint32_t> bufferOrder;
+		for (auto& bucket : m_bufferPool)
+			bufferOrder.push_back(bucket.first);
+		std::sort(bufferOrder.begin(), bufferOrder.end(), [this](uint32_t a, uint32_t b) {
+			return m_bufferKeys[a].first > m_bufferKeys[b].first;
+		});
+		for (uint32_t key : bufferOrder) {
+			std::vector<unsigned int>& pool = m_bufferPool[key];
+			size_t capacity = (size_t)1 << m_bufferKeys[key].first;
+			while (!pool.empty() && buffers.pooledBytes + textures.pooledBytes > maxPooledBytes) {
+				deleteObject(ResourceType::Buffer, pool.back());
+				pool.pop_back();
+				buffers.pooledCount--;
+				buffers.pooledBytes -= capacity;
+			}
+		}
+		for (auto& bucket : m_texturePool) {
+			size_t bytes = textureBytes(m_textureDescs[bucket.first]);
+			while (!bucket.second.empty() && buffers.pooledBytes + textures.pooledBytes > maxPooledBytes) {
+				deleteObject(ResourceType::Texture, bucket.second.back());
+				bucket.second.pop_back();
+				textures.pooledCount--;
+				textures.pooledBytes -= bytes;
+			}
+		}
+		if (maxPooledBytes == 0) {
+			ResourceStats& vertexArrays = m_stats[(int)ResourceType::VertexArray];
+			for (unsigned int name : m_vertexArrayPool)
+				deleteObject(ResourceType::VertexArray, name);
+			vertexArrays.pooledCount = 0;
+			m_vertexArrayPool.clear();
+		}
+	}
+
+	void ResourceManager::publishStats() const {
+		static const char* names[] = { "gpu.buffers", "gpu.textures", "gpu.vertexArrays", "gpu.programs" };
+		for (int type = 0; type < (int)ResourceType::Count; type++) {
+			std::string prefix = names[type];
+			const ResourceStats& stats = m_stats[type];
+			ProfilerCounters::set((prefix + ".live").c_str(), (long long)stats.liveCount);
+			ProfilerCounters::set((prefix + ".liveBytes").c_str(), (long long)stats.liveBytes);
+			ProfilerCounters::set((prefix + ".pooledBytes").c_str(), (long long)stats.pooledBytes);
+			ProfilerCounters::set((prefix + ".pending").c_str(), (long long)stats.pendingCount);
+		}
+	}
+}
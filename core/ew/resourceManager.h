@@ -0,0 +1,152 @@
+#pragma once
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <vector>
+#include "external/glad.h"
+
+namespace ew {
+	//Generational handle. A stale handle (its resource destroyed, slot reused) never
+	//resolves to a GL name, so use-after-free shows up as 0 instead of another object.
+	template<typename Tag>
+	struct Handle {
+		uint32_t index = ~0u;
+		uint32_t generation = 0;
+		bool isValid() const { return index != ~0u; }
+		bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Handle& other) const { return !(*this == other); }
+	};
+	typedef Handle<struct BufferTag> BufferHandle;
+	typedef Handle<struct TextureTag> TextureHandle;
+	typedef Handle<struct VertexArrayTag> VertexArrayHandle;
+	typedef Handle<struct ProgramTag> ProgramHandle;
+
+	enum class ResourceType {
+		Buffer,
+		Texture,
+		VertexArray,
+		Program,
+		Count
+	};
+
+	struct BufferDesc {
+		size_t size = 0;
+		GLenum usage = GL_STATIC_DRAW;
+		//Optional initial contents, size bytes
+		const void* data = nullptr;
+	};
+
+	struct TextureDesc {
+		GLenum target = GL_TEXTURE_2D;
+		GLenum internalFormat = GL_RGBA8;
+		int width = 1;
+		int height = 1;
+		//Layers for array targets, depth for GL_TEXTURE_3D
+		int depth = 1;
+		int levels = 1;
+	};
+
+	struct ResourceStats {
+		size_t liveCount = 0;
+		size_t liveBytes = 0;
+		//Objects kept for reuse instead of deleted
+		size_t pooledCount = 0;
+		size_t pooledBytes = 0;
+		//Destroyed but possibly still in use by queued GPU work
+		size_t pendingCount = 0;
+		size_t glCreates = 0;
+		size_t glDeletes = 0;
+	};
+
+	//Owns GL buffers, textures, VAOs and programs behind generational handles.
+	//Destroyed objects are retired with the frame's fence and only recycled into pools once
+	//the GPU has passed that fence, so streaming content neither leaks nor stalls on
+	//glDelete* of objects still in flight. Pools are trimmed explicitly with trim().
+	class ResourceManager {
+	public:
+		ResourceManager();
+		~ResourceManager();
+		ResourceManager(const ResourceManager&) = delete;
+		ResourceManager& operator=(const ResourceManager&) = delete;
+
+		//Buffers are allocated in power-of-two size classes so recycled storage can be reused
+		//for any request of the same class and usage without reallocating
+		BufferHandle createBuffer(const BufferDesc& desc);
+		//Immutable storage (glTexStorage*); recycled only for an identical description
+		TextureHandle createTexture(const TextureDesc& desc);
+		VertexArrayHandle createVertexArray();
+		//Takes ownership of a program linked elsewhere (e.g. ew::createShaderProgram)
+		ProgramHandle adoptProgram(unsigned int program);
+
+		//GL names, 0 for stale or invalid handles
+		unsigned int get(BufferHandle handle) const;
+		unsigned int get(TextureHandle handle) const;
+		unsigned int get(VertexArrayHandle handle) const;
+		unsigned int get(ProgramHandle handle) const;
+		size_t getBufferSize(BufferHandle handle) const;
+
+		void destroy(BufferHandle handle);
+		void destroy(TextureHandle handle);
+		void destroy(VertexArrayHandle handle);
+		void destroy(ProgramHandle handle);
+
+		//Fences this frame's retired objects and recycles those whose fence has signaled.
+		//Call once per frame after the frame's draws are submitted.
+		void endFrame();
+		//Deletes pooled objects until at most maxPooledBytes of pooled buffers/textures remain
+		void trim(size_t maxPooledBytes = 0);
+
+		const ResourceStats& getStats(ResourceType type) const { return m_stats[(int)type]; }
+		//Publishes per-type stats to ProfilerCounters
+		void publishStats() const;
+
+	private:
+		struct Slot {
+			unsigned int name = 0;
+			uint32_t generation = 0;
+			bool alive = false;
+			size_t bytes = 0;
+			//Index into m_bufferKeys or m_textureKeys
+			uint32_t poolKey = 0;
+		};
+		struct Retired {
+			ResourceType type;
+			unsigned int name;
+			size_t bytes;
+			uint32_t poolKey;
+		};
+		struct Frame {
+			GLsync fence;
+			//The first wait on a fence must flush it or it may never signal
+			bool flushed = false;
+			std::vector<Retired> objects;
+		};
+		//Size class and usage
+		typedef std::pair<uint32_t, GLenum> BufferKey;
+		typedef std::tuple<GLenum, GLenum, int, int, int, int> TextureKey;
+
+		uint32_t allocateSlot(ResourceType type);
+		const Slot* lookup(ResourceType type, uint32_t index, uint32_t generation) const;
+		void retire(ResourceType type, uint32_t index, uint32_t generation);
+		void recycle(const Retired& object);
+		void deleteObject(ResourceType type, unsigned int name);
+		uint32_t bufferKeyIndex(uint32_t sizeClass, GLenum usage);
+		uint32_t textureKeyIndex(const TextureDesc& desc);
+
+		std::vector<Slot> m_slots[(int)ResourceType::Count];
+		std::vector<uint32_t> m_freeSlots[(int)ResourceType::Count];
+		ResourceStats m_stats[(int)ResourceType::Count];
+
+		//Pools of recycled GL names
+		std::map<uint32_t, std::vector<unsigned int>> m_bufferPool;
+		std::map<uint32_t, std::vector<unsigned int>> m_texturePool;
+		std::vector<unsigned int> m_vertexArrayPool;
+		std::vector<BufferKey> m_bufferKeys;
+		std::vector<TextureKey> m_textureKeys;
+		std::vector<TextureDesc> m_textureDescs;
+
+		std::vector<Retired> m_retiring;
+		std::vector<Frame> m_frames;
+	};
+}
@@ -0,0 +1,50 @@
+#include "samplerCache.h"
+#include <algorithm>
+#include <tuple>
+
+namespace ew {
+	bool SamplerCache::DescLess::operator()(const SamplerDesc& a, const SamplerDesc& b) const {
+		return std::tie(a.minFilter, a.magFilter, a.wrapS, a.wrapT, a.wrapR, a.maxAnisotropy, a.lodBias, a.minLod, a.maxLod,
+			a.compareMode, a.compareFunc, a.borderColor.r, a.borderColor.g, a.borderColor.b, a.borderColor.a)
+			< std::tie(b.minFilter, b.magFilter, b.wrapS, b.wrapT, b.wrapR, b.maxAnisotropy, b.lodBias, b.minLod, b.maxLod,
+			b.compareMode, b.compareFunc, b.borderColor.r, b.borderColor.g, b.borderColor.b, b.borderColor.a);
+	}
+
+	SamplerCache::SamplerCache() {
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &m_anisotropyLimit);
+		m_anisotropyLimit = std::max(m_anisotropyLimit, 1.0f);
+	}
+
+	SamplerCache::~SamplerCache() {
+		clear();
+	}
+
+	unsigned int SamplerCache::get(const SamplerDesc& desc) {
+		std::map<SamplerDesc, unsigned int, DescLess>::iterator it = m_samplers.find(desc);
+		if (it != m_samplers.end())
+			return it->second;
+
+		unsigned int sampler;
+		glGenSamplers(1, &sampler);
+		glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, desc.minFilter);
+		glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, desc.magFilter);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, desc.wrapS);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, desc.wrapT);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, desc.wrapR);
+		glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, std::min(std::max(desc.maxAnisotropy, 1.0f), m_anisotropyLimit));
+		glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, desc.lodBias);
+		glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, desc.minLod);
+		glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, desc.maxLod);
+		glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_MODE, desc.compareMode);
+		glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, desc.compareFunc);
+		glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, &desc.borderColor[0]);
+		m_samplers[desc] = sampler;
+		return sampler;
+	}
+
+	void SamplerCache::clear() {
+		for (auto& entry : m_samplers)
+			glDeleteSamplers(1, &entry.second);
+		m_samplers.clear();
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <map>
+#include <glm/glm.hpp>
+#include "external/glad.h"
+
+namespace ew {
+	struct SamplerDesc {
+		GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+		GLenum magFilter = GL_LINEAR;
+		GLenum wrapS = GL_REPEAT;
+		GLenum wrapT = GL_REPEAT;
+		GLenum wrapR = GL_REPEAT;
+		//Clamped to the driver's limit; 1 disables anisotropic filtering
+		float maxAnisotropy = 1.0f;
+		float lodBias = 0.0f;
+		float minLod = -1000.0f;
+		float maxLod = 1000.0f;
+		//GL_COMPARE_REF_TO_TEXTURE for shadow samplers
+		GLenum compareMode = GL_NONE;
+		GLenum compareFunc = GL_LEQUAL;
+		glm::vec4 borderColor = glm::vec4(0.0f);
+	};
+
+	//Shares one GL sampler object per distinct SamplerDesc.
+	//Sampling state then lives in a handful of samplers bound per unit, instead of being set
+	//with glTexParameter on every texture, and binding a texture no longer implies its filtering.
+	class SamplerCache {
+	public:
+		SamplerCache();
+		~SamplerCache();
+		SamplerCache(const SamplerCache&) = delete;
+		SamplerCache& operator=(const SamplerCache&) = delete;
+
+		//Sampler for desc, created on first use
+		unsigned int get(const SamplerDesc& desc);
+		void bind(unsigned int unit, const SamplerDesc& desc) { glBindSampler(unit, get(desc)); }
+		size_t getCount() const { return m_samplers.size(); }
+		//Deletes every sampler; names returned earlier become invalid
+		void clear();
+
+	private:
+		struct DescLess {
+			bool operator()(const SamplerDesc& a, const SamplerDesc& b) const;
+		};
+
+		std::map<SamplerDesc, unsigned int, DescLess> m_samplers;
+		float m_anisotropyLimit = 1.0f;
+	};
+}
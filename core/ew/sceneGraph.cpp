@@ -0,0 +1,140 @@
+#include "sceneGraph.h"
+#include "jobSystem.h"
+#include <algorithm>
+#include <numeric>
+
+namespace ew {
+	//Levels smaller than this are not worth handing to other threads
+	static const size_t MIN_NODES_PER_JOB = 2048;
+
+	unsigned int SceneGraph::createNode(unsigned int parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+		unsigned int id = (unsigned int)m_idToIndex.size();
+		unsigned int index = (unsigned int)m_parents.size();
+		unsigned int parentIndex = parent == NO_PARENT ? NO_PARENT : m_idToIndex[parent];
+		unsigned int depth = parent == NO_PARENT ? 0 : m_depths[parentIndex] + 1;
+
+		m_idToIndex.push_back(index);
+		m_indexToId.push_back(id);
+		m_positions.push_back(position);
+		m_rotations.push_back(rotation);
+		m_scales.push_back(scale);
+		m_world.push_back(glm::mat4(1.0f));
+		m_parents.push_back(parentIndex);
+		m_depths.push_back(depth);
+		m_dirty.push_back(1);
+		m_worldChanged.push_back(0);
+		m_depthCount = std::max(m_depthCount, depth + 1);
+		//Appending keeps parent-before-child, but only a new deepest node keeps levels contiguous
+		if (depth + 1 == m_levelStart.size())
+			m_levelStart.push_back(m_parents.size());
+		else if (depth + 2 == m_levelStart.size() && m_levelStart.back() == index)
+			m_levelStart.back()++;
+		else
+			m_needsSort = true;
+		return id;
+	}
+
+	void SceneGraph::setPosition(unsigned int node, const glm::vec3& position) {
+		unsigned int i = m_idToIndex[node];
+		m_positions[i] = position;
+		m_dirty[i] = 1;
+	}
+
+	void SceneGraph::setRotation(unsigned int node, const glm::quat& rotation) {
+		unsigned int i = m_idToIndex[node];
+		m_rotations[i] = rotation;
+		m_dirty[i] = 1;
+	}
+
+	void SceneGraph::setScale(unsigned int node, const glm::vec3& scale) {
+		unsigned int i = m_idToIndex[node];
+		m_scales[i] = scale;
+		m_dirty[i] = 1;
+	}
+
+	void SceneGraph::markAllDirty() {
+		std::fill(m_dirty.begin(), m_dirty.end(), (uint8_t)1);
+	}
+
+	template<typename T>
+	static void permute(std::vector<T>& values, const std::vector<unsigned int>& order) {
+		std::vector<T> sorted(values.size());
+		for (size_t i = 0; i < order.size(); i++)
+			sorted[i] = values[order[i]];
+		values.swap(sorted);
+	}
+
+	void SceneGraph::sortByDepth() {
+		size_t count = m_parents.size();
+		//Stable sort keeps siblings in creation order
+		std::vector<unsigned int> order(count);
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) { return m_depths[a] < m_depths[b]; });
+		std::vector<unsigned int> newIndex(count);
+		for (size_t i = 0; i < count; i++)
+			newIndex[order[i]] = (unsigned int)i;
+
+		permute(m_positions, order);
+		permute(m_rotations, order);
+		permute(m_scales, order);
+		permute(m_world, order);
+		permute(m_parents, order);
+		permute(m_depths, order);
+		permute(m_indexToId, order);
+		permute(m_dirty, order);
+		permute(m_worldChanged, order);
+		for (unsigned int& parent : m_parents) {
+			if (parent != NO_PARENT)
+				parent = newIndex[parent];
+		}
+		for (size_t i = 0; i < count; i++)
+			m_idToIndex[m_indexToId[i]] = (unsigned int)i;
+
+		//Depths are contiguous since every node sits one below its parent
+		m_levelStart.clear();
+		for (size_t i = 0; i < count; i++) {
+			while (m_levelStart.size() <= m_depths[i])
+				m_levelStart.push_back(i);
+		}
+		m_levelStart.push_back(count);
+		m_needsSort = false;
+	}
+
+	void SceneGraph::updateRange(size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			unsigned int parent = m_parents[i];
+			bool parentChanged = parent != NO_PARENT && m_worldChanged[parent];
+			if (!m_dirty[i] && !parentChanged) {
+				m_worldChanged[i] = 0;
+				continue;
+			}
+			glm::mat3 rotationScale = glm::mat3_cast(m_rotations[i]);
+			rotationScale[0] *= m_scales[i].x;
+			rotationScale[1] *= m_scales[i].y;
+			rotationScale[2] *= m_scales[i].z;
+			glm::mat4 local(rotationScale);
+			local[3] = glm::vec4(m_positions[i], 1.0f);
+			m_world[i] = parent == NO_PARENT ? local : m_world[parent] * local;
+			m_dirty[i] = 0;
+			m_worldChanged[i] = 1;
+		}
+	}
+
+	void SceneGraph::update(JobSystem* jobs) {
+		if (m_needsSort)
+			sortByDepth();
+		//Levels must run in order: a level reads the world matrices written by the one above
+		for (size_t level = 0; level + 1 < m_levelStart.size(); level++) {
+			size_t begin = m_levelStart[level];
+			size_t end = m_levelStart[level + 1];
+			if (jobs && end - begin > MIN_NODES_PER_JOB) {
+				jobs->parallelFor(end - begin, MIN_NODES_PER_JOB, [this, begin](size_t first, size_t last) {
+					updateRange(begin + first, begin + last);
+				});
+			}
+			else {
+				updateRange(begin, end);
+			}
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace ew {
+	class JobSystem;
+
+	//Transform hierarchy stored as parallel arrays (SoA) sorted by depth, so every parent
+	//precedes its children and each depth level is one contiguous range.
+	//Nodes are addressed by stable ids; storage order is internal and may change when
+	//nodes are added. World matrices are only recomputed for nodes whose local transform
+	//changed and their descendants.
+	class SceneGraph {
+	public:
+		static const unsigned int NO_PARENT = ~0u;
+
+		//Parent must already exist, which keeps the hierarchy acyclic
+		unsigned int createNode(unsigned int parent, const glm::vec3& position = glm::vec3(0.0f),
+			const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+
+		void setPosition(unsigned int node, const glm::vec3& position);
+		void setRotation(unsigned int node, const glm::quat& rotation);
+		void setScale(unsigned int node, const glm::vec3& scale);
+		const glm::vec3& getPosition(unsigned int node) const { return m_positions[m_idToIndex[node]]; }
+		const glm::quat& getRotation(unsigned int node) const { return m_rotations[m_idToIndex[node]]; }
+		const glm::vec3& getScale(unsigned int node) const { return m_scales[m_idToIndex[node]]; }
+
+		//Recomputes world matrices of dirty subtrees, level by level. With a job system
+		//each level is split across threads; levels themselves run in order.
+		void update(JobSystem* jobs = nullptr);
+		//Marks every node dirty, e.g. for a full rebuild comparison
+		void markAllDirty();
+
+		const glm::mat4& getWorldMatrix(unsigned int node) const { return m_world[m_idToIndex[node]]; }
+		//True if the node's world matrix changed in the last update()
+		bool worldChanged(unsigned int node) const { return m_worldChanged[m_idToIndex[node]] != 0; }
+		size_t size() const { return m_parents.size(); }
+		//Tracked as nodes are added, so it is current before the next update() regroups levels
+		unsigned int getDepthCount() const { return m_depthCount; }
+
+	private:
+		void sortByDepth();
+		void updateRange(size_t begin, size_t end);
+
+		//SoA, indexed by storage index
+		std::vector<glm::vec3> m_positions;
+		std::vector<glm::quat> m_rotations;
+		std::vector<glm::vec3> m_scales;
+		std::vector<glm::mat4> m_world;
+		std::vector<unsigned int> m_parents;
+		std::vector<unsigned int> m_depths;
+		std::vector<unsigned int> m_indexToId;
+		std::vector<uint8_t> m_dirty;
+		std::vector<uint8_t> m_worldChanged;
+
+		std::vector<unsigned int> m_idToIndex;
+		//Storage range of depth d is [m_levelStart[d], m_levelStart[d + 1])
+		std::vector<size_t> m_levelStart = { 0 };
+		bool m_needsSort = false;
+		unsigned int m_depthCount = 0;
+	};
+}
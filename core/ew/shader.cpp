@@ -0,0 +1,131 @@
+#include "shader.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace ew {
+	unsigned int startShaderStage(unsigned int type, const char* source) {
+		unsigned int shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, NULL);
+		glCompileShader(shader);
+		return shader;
+	}
+
+	bool checkCompileErrors(unsigned int shader, const char* context) {
+		int success;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (success)
+			return false;
+		char infoLog[512];
+		glGetShaderInfoLog(shader, 512, NULL, infoLog);
+		if (context)
+			printf("ERROR::SHADER::COMPILATION_FAILED %s\n%s\n", context, infoLog);
+		else
+			printf("ERROR::SHADER::COMPILATION_FAILED\n%s\n", infoLog);
+		return true;
+	}
+
+	unsigned int compileShader(unsigned int type, const char* source) {
+		unsigned int shader = startShaderStage(type, source);
+		checkCompileErrors(shader);
+		return shader;
+	}
+
+	bool checkLinkErrors(unsigned int program) {
+		int success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success) {
+			char infoLog[512];
+			glGetProgramInfoLog(program, 512, NULL, infoLog);
+			printf("ERROR::PROGRAM::LINKING_FAILED\n%s\n", infoLog);
+			return true;
+		}
+		return false;
+	}
+
+	unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+		unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+		unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+		unsigned int program = glCreateProgram();
+		glAttachShader(program, vertexShader);
+		glAttachShader(program, fragmentShader);
+		glLinkProgram(program);
+
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		if (checkLinkErrors(program)) {
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	unsigned int createComputeProgram(const char* computeSource) {
+		unsigned int computeShader = compileShader(GL_COMPUTE_SHADER, computeSource);
+
+		unsigned int program = glCreateProgram();
+		glAttachShader(program, computeShader);
+		glLinkProgram(program);
+		glDeleteShader(computeShader);
+
+		if (checkLinkErrors(program)) {
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	std::string loadShaderFile(const char* path) {
+		FILE* file = fopen(path, "rb");
+		if (!file) {
+			printf("ERROR::SHADER::FILE_NOT_READ %s\n", path);
+			return std::string();
+		}
+		std::string source;
+		char chunk[4096];
+		size_t read;
+		while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+			source.append(chunk, read);
+		fclose(file);
+		return source;
+	}
+
+	typedef void (GLAD_API_PTR* PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+	static bool s_parallelCompile = false;
+
+	static bool hasExtension(const char* name) {
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i = 0; i < count; i++) {
+			const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+			if (extension && strcmp(extension, name) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	bool enableParallelShaderCompile(GLADloadfunc load, unsigned int maxThreads) {
+		PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads = nullptr;
+		if (hasExtension("GL_KHR_parallel_shader_compile"))
+			maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+		else if (hasExtension("GL_ARB_parallel_shader_compile"))
+			maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+		s_parallelCompile = maxShaderCompilerThreads != nullptr;
+		if (s_parallelCompile)
+			maxShaderCompilerThreads(maxThreads);
+		return s_parallelCompile;
+	}
+
+	bool isParallelShaderCompileEnabled() {
+		return s_parallelCompile;
+	}
+
+	bool isProgramBuildComplete(unsigned int program) {
+		if (!s_parallelCompile)
+			return true;
+		int complete = 0;
+		glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+		return complete != 0;
+	}
+}
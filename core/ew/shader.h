@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include "external/glad.h"
+
+//GL_KHR_parallel_shader_compile is not part of the generated glad header.
+//The ARB variant uses the same values.
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace ew {
+	//Compiles a single shader stage. Errors are printed, matching the assignments' setup code.
+	unsigned int compileShader(unsigned int type, const char* source);
+	//Creates a stage and starts compiling it without querying the result, which would wait
+	//for the driver. Check it later with checkCompileErrors().
+	unsigned int startShaderStage(unsigned int type, const char* source);
+	//Returns true and prints the info log if the stage failed to compile. context, when given,
+	//follows ERROR::SHADER::COMPILATION_FAILED on the header line (a program name, defines...).
+	bool checkCompileErrors(unsigned int shader, const char* context = nullptr);
+	//Compiles and links a vertex + fragment program. Returns 0 if linking failed.
+	unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource);
+	//Compiles and links a compute program. Returns 0 if linking failed.
+	unsigned int createComputeProgram(const char* computeSource);
+	//Returns true and prints the info log if the program failed to link
+	bool checkLinkErrors(unsigned int program);
+
+	//Reads a whole shader file. Prints an error and returns an empty string if it can't be opened.
+	std::string loadShaderFile(const char* path);
+
+	//Turns on GL_KHR_parallel_shader_compile (or GL_ARB_parallel_shader_compile) when the driver
+	//exposes it. load is the function given to gladLoadGL, e.g. glfwGetProcAddress.
+	bool enableParallelShaderCompile(GLADloadfunc load, unsigned int maxThreads = 0xFFFFFFFFu);
+	bool isParallelShaderCompileEnabled();
+	//True once the driver has finished compiling and linking program, so querying its link
+	//status won't block. Always true without parallel compile.
+	bool isProgramBuildComplete(unsigned int program);
+}
@@ -0,0 +1,87 @@
+#include "shaderBuildQueue.h"
+#include "shader.h"
+
+namespace ew {
+	ShaderBuildQueue::~ShaderBuildQueue() {
+		for (Build& build : m_builds) {
+			if (build.done)
+				continue;
+			for (int i = 0; i < build.shaderCount; i++)
+				glDeleteShader(build.shaders[i]);
+			glDeleteProgram(build.program);
+		}
+	}
+
+	int ShaderBuildQueue::submit(Build& build) {
+		//Only issue work here: any status query would wait for the compiler
+		build.program = glCreateProgram();
+		for (int i = 0; i < build.shaderCount; i++)
+			glAttachShader(build.program, build.shaders[i]);
+		glLinkProgram(build.program);
+		m_builds.push_back(build);
+		m_pendingCount++;
+		return (int)m_builds.size() - 1;
+	}
+
+	int ShaderBuildQueue::addProgram(const char* vertexSource, const char* fragmentSource, const char* name) {
+		Build build;
+		build.name = name;
+		build.shaders[0] = startShaderStage(GL_VERTEX_SHADER, vertexSource);
+		build.shaders[1] = startShaderStage(GL_FRAGMENT_SHADER, fragmentSource);
+		build.shaderCount = 2;
+		return submit(build);
+	}
+
+	int ShaderBuildQueue::addComputeProgram(const char* computeSource, const char* name) {
+		Build build;
+		build.name = name;
+		build.shaders[0] = startShaderStage(GL_COMPUTE_SHADER, computeSource);
+		build.shaderCount = 1;
+		return submit(build);
+	}
+
+	void ShaderBuildQueue::complete(Build& build) {
+		bool failed = false;
+		for (int i = 0; i < build.shaderCount; i++)
+			failed |= checkCompileErrors(build.shaders[i], build.name.c_str());
+		if (!failed)
+			failed = checkLinkErrors(build.program);
+		for (int i = 0; i < build.shaderCount; i++)
+			glDeleteShader(build.shaders[i]);
+		if (failed) {
+			glDeleteProgram(build.program);
+			build.program = 0;
+		}
+		build.done = true;
+		m_pendingCount--;
+	}
+
+	bool ShaderBuildQueue::poll() {
+		bool parallel = isParallelShaderCompileEnabled();
+		for (size_t i = m_firstPending; i < m_builds.size(); i++) {
+			Build& build = m_builds[i];
+			if (build.done)
+				continue;
+			if (parallel) {
+				if (isProgramBuildComplete(build.program))
+					complete(build);
+			}
+			else {
+				//The first status query blocks for the whole build, so do one per call
+				complete(build);
+				break;
+			}
+		}
+		while (m_firstPending < m_builds.size() && m_builds[m_firstPending].done)
+			m_firstPending++;
+		return isDone();
+	}
+
+	void ShaderBuildQueue::finish() {
+		for (size_t i = m_firstPending; i < m_builds.size(); i++) {
+			if (!m_builds[i].done)
+				complete(m_builds[i]);
+		}
+		m_firstPending = m_builds.size();
+	}
+}
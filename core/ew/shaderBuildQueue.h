@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace ew {
+	//Submits every compile and link up front and lets the caller poll for completion instead of
+	//building programs one at a time. With parallel shader compile enabled
+	//(ew::enableParallelShaderCompile) the driver builds them on its own threads while the
+	//application keeps rendering, e.g. a loading screen. Without it, poll() finishes one
+	//program per call so loading frames still get drawn between builds.
+	class ShaderBuildQueue {
+	public:
+		ShaderBuildQueue() = default;
+		//Deletes programs still building. Finished programs belong to the caller.
+		~ShaderBuildQueue();
+		ShaderBuildQueue(const ShaderBuildQueue&) = delete;
+		ShaderBuildQueue& operator=(const ShaderBuildQueue&) = delete;
+
+		//Returns an id for get(). name is only used in error messages.
+		int addProgram(const char* vertexSource, const char* fragmentSource, const char* name = "");
+		int addComputeProgram(const char* computeSource, const char* name = "");
+
+		//Collects finished builds without blocking on ones still in progress. Returns isDone().
+		bool poll();
+		//Blocks until every program has finished
+		void finish();
+		bool isDone() const { return m_pendingCount == 0; }
+		int getPendingCount() const { return m_pendingCount; }
+		int getProgramCount() const { return (int)m_builds.size(); }
+		//Linked program, 0 while still building or if the build failed
+		unsigned int get(int id) const { return m_builds[id].done ? m_builds[id].program : 0; }
+		bool failed(int id) const { return m_builds[id].done && m_builds[id].program == 0; }
+
+	private:
+		struct Build {
+			std::string name;
+			unsigned int program = 0;
+			unsigned int shaders[2] = { 0, 0 };
+			int shaderCount = 0;
+			bool done = false;
+		};
+		int submit(Build& build);
+		void complete(Build& build);
+
+		std::vector<Build> m_builds;
+		int m_pendingCount = 0;
+		//Builds before this index are all done, so poll() can skip them
+		size_t m_firstPending = 0;
+	};
+}
@@ -0,0 +1,158 @@
+#include "shaderPreprocessor.h"
+#include "shader.h"
+#include <algorithm>
+#include <stdio.h>
+
+namespace ew {
+	ShaderDefines& ShaderDefines::set(const std::string& name, const std::string& value) {
+		auto it = std::lower_bound(m_defines.begin(), m_defines.end(), name,
+			[](const std::pair<std::string, std::string>& define, const std::string& key) { return define.first < key; });
+		if (it != m_defines.end() && it->first == name)
+			it->second = value;
+		else
+			m_defines.insert(it, std::make_pair(name, value));
+		return *this;
+	}
+
+	ShaderDefines& ShaderDefines::set(const std::string& name, int value) {
+		return set(name, std::to_string(value));
+	}
+
+	ShaderDefines& ShaderDefines::set(const std::string& name, double value) {
+		char literal[64];
+		snprintf(literal, sizeof(literal), "%.9g", value);
+		std::string text = literal;
+		if (text.find_first_of(".en") == std::string::npos)
+			text += ".0";
+		return set(name, text);
+	}
+
+	void ShaderDefines::remove(const std::string& name) {
+		for (auto it = m_defines.begin(); it != m_defines.end(); ++it) {
+			if (it->first == name) {
+				m_defines.erase(it);
+				return;
+			}
+		}
+	}
+
+	uint64_t hashString(const std::string& text, uint64_t seed) {
+		uint64_t hash = seed;
+		for (char c : text) {
+			hash ^= (unsigned char)c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	uint64_t ShaderDefines::hash() const {
+		uint64_t hash = hashString("");
+		for (const auto& define : m_defines) {
+			//Separators keep ("AB","C") and ("A","BC") apart
+			hash = hashString(define.first, hash);
+			hash = hashString("=", hash);
+			hash = hashString(define.second, hash);
+			hash = hashString(";", hash);
+		}
+		return hash;
+	}
+
+	std::string ShaderDefines::toString() const {
+		std::string text;
+		for (const auto& define : m_defines) {
+			if (!text.empty())
+				text += ' ';
+			text += define.first + '=' + define.second;
+		}
+		return text;
+	}
+
+	static std::string directoryOf(const std::string& path) {
+		size_t slash = path.find_last_of("/\\");
+		return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+	}
+
+	//Returns the quoted file name if line is an #include directive
+	static bool parseInclude(const std::string& line, std::string& file) {
+		size_t pos = line.find_first_not_of(" \t");
+		if (pos == std::string::npos || line[pos] != '#')
+			return false;
+		pos = line.find_first_not_of(" \t", pos + 1);
+		if (pos == std::string::npos || line.compare(pos, 7, "include") != 0)
+			return false;
+		size_t open = line.find('"', pos + 7);
+		size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+		if (close == std::string::npos)
+			return false;
+		file = line.substr(open + 1, close - open - 1);
+		return true;
+	}
+
+	static bool isVersionLine(const std::string& line) {
+		size_t pos = line.find_first_not_of(" \t");
+		return pos != std::string::npos && line.compare(pos, 8, "#version") == 0;
+	}
+
+	static std::string defineBlock(const ShaderDefines& defines) {
+		std::string block;
+		for (const auto& define : defines.getDefines())
+			block += "#define " + define.first + ' ' + define.second + '\n';
+		return block;
+	}
+
+	static bool appendFile(const std::string& path, const ShaderDefines* defines, std::vector<std::string>& files, std::string& output) {
+		int fileIndex = (int)files.size();
+		files.push_back(path);
+		//loadShaderFile has already printed the error
+		std::string source = loadShaderFile(path.c_str());
+		if (source.empty())
+			return false;
+
+		size_t start = 0;
+		int lineNumber = 0;
+		while (start < source.size()) {
+			size_t end = source.find('\n', start);
+			if (end == std::string::npos)
+				end = source.size();
+			std::string line = source.substr(start, end - start);
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			start = end + 1;
+			lineNumber++;
+
+			std::string include;
+			if (isVersionLine(line)) {
+				//Only the top-level file keeps its #version, which must stay first
+				if (!defines)
+					continue;
+				output += line + '\n' + defineBlock(*defines);
+				output += "#line " + std::to_string(lineNumber + 1) + ' ' + std::to_string(fileIndex) + '\n';
+			}
+			else if (parseInclude(line, include)) {
+				std::string includePath = directoryOf(path) + include;
+				if (std::find(files.begin(), files.end(), includePath) == files.end()) {
+					output += "#line 1 " + std::to_string(files.size()) + '\n';
+					if (!appendFile(includePath, nullptr, files, output))
+						return false;
+				}
+				output += "#line " + std::to_string(lineNumber + 1) + ' ' + std::to_string(fileIndex) + '\n';
+			}
+			else {
+				output += line + '\n';
+			}
+		}
+		return true;
+	}
+
+	std::string preprocessShader(const std::string& path, const ShaderDefines& defines, std::vector<std::string>* dependencies) {
+		std::vector<std::string> files;
+		std::string output;
+		bool success = appendFile(path, &defines, files, output);
+		//Without a #version line the defines go first
+		if (success && output.find("#version") == std::string::npos)
+			output = defineBlock(defines) + "#line 1 0\n" + output;
+		if (dependencies)
+			*dependencies = files;
+		return success ? output : std::string();
+	}
+}
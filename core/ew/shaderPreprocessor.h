@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ew {
+	//Set of #defines for one shader permutation, kept sorted by name so equal sets hash equally.
+	//Numbers are written as literals, letting the driver fold them like any other constant.
+	class ShaderDefines {
+	public:
+		ShaderDefines& set(const std::string& name, const std::string& value = "1");
+		ShaderDefines& set(const std::string& name, const char* value) { return set(name, std::string(value)); }
+		ShaderDefines& set(const std::string& name, int value);
+		//Always written with a decimal point so it is a float literal in GLSL
+		ShaderDefines& set(const std::string& name, double value);
+		void remove(const std::string& name);
+
+		const std::vector<std::pair<std::string, std::string>>& getDefines() const { return m_defines; }
+		//FNV-1a over the sorted name=value pairs
+		uint64_t hash() const;
+		//"NAME=value NAME2=value2", for logs
+		std::string toString() const;
+
+	private:
+		std::vector<std::pair<std::string, std::string>> m_defines;
+	};
+
+	uint64_t hashString(const std::string& text, uint64_t seed = 14695981039346656037ull);
+
+	//Loads a shader file and resolves #include "file" relative to the including file. Each file
+	//is included once. defines are injected right after #version. #line directives keep compiler
+	//errors pointing at the right line; the source-string number is the file's index in
+	//dependencies, which lists every file read (the shader itself first).
+	//Returns an empty string after printing an error if a file can't be read.
+	std::string preprocessShader(const std::string& path, const ShaderDefines& defines, std::vector<std::string>* dependencies = nullptr);
+}
@@ -0,0 +1,122 @@
+#include "shaderReloader.h"
+#include "shader.h"
+#include <algorithm>
+#include <stdio.h>
+
+namespace ew {
+	static bool printCompileErrors(unsigned int shader, const std::vector<std::string>& files, const ShaderDefines& defines) {
+		//Log lines read "<file index>(<line>)", so list the files under the header
+		std::string context = "[" + defines.toString() + "]";
+		for (size_t i = 0; i < files.size(); i++)
+			context += "\n  " + std::to_string(i) + ": " + files[i];
+		return checkCompileErrors(shader, context.c_str());
+	}
+
+	ShaderReloader::~ShaderReloader() {
+		clear();
+	}
+
+	void ShaderReloader::clear() {
+		for (Program& program : m_programs) {
+			if (program.pending.program) {
+				glDeleteShader(program.pending.vertexShader);
+				glDeleteShader(program.pending.fragmentShader);
+				glDeleteProgram(program.pending.program);
+			}
+			glDeleteProgram(program.program);
+		}
+		m_programs.clear();
+		m_variants.clear();
+	}
+
+	ShaderReloader::Build ShaderReloader::startBuild(Program& program) {
+		//No status queries here: each of them would wait for the driver
+		Build build;
+		build.vertexShader = startShaderStage(GL_VERTEX_SHADER, preprocessShader(program.vertexPath, program.defines, &program.vertexFiles).c_str());
+		build.fragmentShader = startShaderStage(GL_FRAGMENT_SHADER, preprocessShader(program.fragmentPath, program.defines, &program.fragmentFiles).c_str());
+		//Includes can change between builds; watch() ignores files already watched
+		for (const std::string& file : program.vertexFiles)
+			m_watcher.watch(file);
+		for (const std::string& file : program.fragmentFiles)
+			m_watcher.watch(file);
+		build.program = glCreateProgram();
+		glAttachShader(build.program, build.vertexShader);
+		glAttachShader(build.program, build.fragmentShader);
+		glLinkProgram(build.program);
+		return build;
+	}
+
+	unsigned int ShaderReloader::finishBuild(const Build& build, const Program& program) {
+		bool failed = printCompileErrors(build.vertexShader, program.vertexFiles, program.defines);
+		failed |= printCompileErrors(build.fragmentShader, program.fragmentFiles, program.defines);
+		if (!failed)
+			failed = checkLinkErrors(build.program);
+		glDeleteShader(build.vertexShader);
+		glDeleteShader(build.fragmentShader);
+		if (failed) {
+			glDeleteProgram(build.program);
+			return 0;
+		}
+		return build.program;
+	}
+
+	int ShaderReloader::add(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines) {
+		uint64_t key = hashString(fragmentPath, hashString(vertexPath, defines.hash()));
+		auto range = m_variants.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it) {
+			const Program& existing = m_programs[it->second];
+			if (existing.vertexPath == vertexPath && existing.fragmentPath == fragmentPath && existing.defines.getDefines() == defines.getDefines())
+				return it->second;
+		}
+
+		Program program;
+		program.vertexPath = vertexPath;
+		program.fragmentPath = fragmentPath;
+		program.defines = defines;
+		//The source files are watched even if preprocessing failed, so fixing them recovers
+		m_watcher.watch(vertexPath);
+		m_watcher.watch(fragmentPath);
+		program.program = finishBuild(startBuild(program), program);
+		m_programs.push_back(program);
+		int id = (int)m_programs.size() - 1;
+		m_variants.insert(std::make_pair(key, id));
+		return id;
+	}
+
+	bool ShaderReloader::dependsOn(const Program& program, const std::string& path) {
+		return std::find(program.vertexFiles.begin(), program.vertexFiles.end(), path) != program.vertexFiles.end()
+			|| std::find(program.fragmentFiles.begin(), program.fragmentFiles.end(), path) != program.fragmentFiles.end()
+			|| path == program.vertexPath || path == program.fragmentPath;
+	}
+
+	bool ShaderReloader::update() {
+		for (const std::string& path : m_watcher.poll()) {
+			for (Program& program : m_programs) {
+				if (!dependsOn(program, path))
+					continue;
+				//A newer edit supersedes a build still in flight
+				if (program.pending.program) {
+					glDeleteShader(program.pending.vertexShader);
+					glDeleteShader(program.pending.fragmentShader);
+					glDeleteProgram(program.pending.program);
+				}
+				printf("Reloading %s + %s\n", program.vertexPath.c_str(), program.fragmentPath.c_str());
+				program.pending = startBuild(program);
+			}
+		}
+
+		bool swapped = false;
+		for (Program& program : m_programs) {
+			if (!program.pending.program || !isProgramBuildComplete(program.pending.program))
+				continue;
+			unsigned int linked = finishBuild(program.pending, program);
+			program.pending = Build();
+			if (linked) {
+				glDeleteProgram(program.program);
+				program.program = linked;
+				swapped = true;
+			}
+		}
+		return swapped;
+	}
+}
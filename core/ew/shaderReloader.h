@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "fileWatcher.h"
+#include "shaderPreprocessor.h"
+
+namespace ew {
+	//Vertex + fragment programs loaded from files and rebuilt when either file is saved.
+	//Rebuilds are issued without waiting on the driver; with parallel shader compile enabled
+	//(see ew::enableParallelShaderCompile) they finish in the background and are polled each
+	//update(). The program returned by get() is only replaced after a successful link, so a
+	//typo leaves the last working version on screen.
+	//Sources go through ew::preprocessShader, so edits to included files trigger rebuilds too,
+	//and each define set is a separate permutation cached by its hash.
+	class ShaderReloader {
+	public:
+		ShaderReloader() = default;
+		~ShaderReloader();
+		ShaderReloader(const ShaderReloader&) = delete;
+		ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+		//Builds the permutation immediately and starts watching its files. Returns its id for get().
+		//Adding a permutation that already exists returns the cached id without compiling, so
+		//variants can be requested on demand when a feature is first switched on.
+		int add(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines = ShaderDefines());
+		//Current program, 0 if it has never linked successfully
+		unsigned int get(int id) const { return m_programs[id].program; }
+		//Call once per frame: starts rebuilds for edited files and swaps in finished ones.
+		//Returns true if any program was replaced, so callers can refresh uniform locations.
+		bool update();
+		//Deletes every program now, for mains that destroy the GL context before this goes out of scope
+		void clear();
+
+	private:
+		struct Build {
+			unsigned int program = 0;
+			unsigned int vertexShader = 0;
+			unsigned int fragmentShader = 0;
+		};
+		struct Program {
+			std::string vertexPath;
+			std::string fragmentPath;
+			ShaderDefines defines;
+			//Files each stage was built from, indexed by #line source-string number
+			std::vector<std::string> vertexFiles;
+			std::vector<std::string> fragmentFiles;
+			unsigned int program = 0;
+			Build pending;
+		};
+		Build startBuild(Program& program);
+		//Returns the linked program, or 0 after printing the logs of whichever stage failed
+		static unsigned int finishBuild(const Build& build, const Program& program);
+		static bool dependsOn(const Program& program, const std::string& path);
+
+		std::vector<Program> m_programs;
+		//Hash of paths + defines to program ids. Collisions are resolved by comparing.
+		std::unordered_multimap<uint64_t, int> m_variants;
+		FileWatcher m_watcher;
+	};
+}
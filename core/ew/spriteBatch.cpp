@@ -0,0 +1,199 @@
+#include "spriteBatch.h"
+#include "shader.h"
+#include <algorithm>
+#include <math.h>
+#include <stddef.h>
+
+namespace ew {
+	static const char* spriteVertexSource = R"(
+		#version 450 core
+		layout(location = 0) in vec2 aPos;
+		layout(location = 1) in vec2 aUV;
+		layout(location = 2) in vec4 aColor;
+		layout(location = 3) in float aLayer;
+		uniform mat4 projection;
+		out vec3 UV;
+		out vec4 Color;
+		void main() {
+			UV = vec3(aUV, aLayer);
+			Color = aColor;
+			gl_Position = projection * vec4(aPos, 0.0, 1.0);
+		}
+	)";
+
+	static const char* spriteFragmentSource = R"(
+		#version 450 core
+		in vec3 UV;
+		in vec4 Color;
+		out vec4 FragColor;
+		layout(binding = 0) uniform sampler2DArray sprites;
+		void main() {
+			FragColor = texture(sprites, UV) * Color;
+		}
+	)";
+
+	static uint32_t packColor(const glm::vec4& color) {
+		glm::vec4 c = glm::clamp(color, 0.0f, 1.0f) * 255.0f + glm::vec4(0.5f);
+		return (uint32_t)c.r | ((uint32_t)c.g << 8) | ((uint32_t)c.b << 16) | ((uint32_t)c.a << 24);
+	}
+
+	SpriteBatch::SpriteBatch(unsigned int maxSprites)
+		: m_maxSprites(maxSprites) {
+		m_program = createShaderProgram(spriteVertexSource, spriteFragmentSource);
+		m_projectionLocation = glGetUniformLocation(m_program, "projection");
+
+		//Every quad uses the same index pattern; baseVertex picks the quad range in the ring
+		std::vector<uint32_t> indices((size_t)maxSprites * 6);
+		for (uint32_t i = 0; i < maxSprites; i++) {
+			uint32_t v = i * 4;
+			uint32_t* quad = &indices[(size_t)i * 6];
+			quad[0] = v;
+			quad[1] = v + 1;
+			quad[2] = v + 2;
+			quad[3] = v + 2;
+			quad[4] = v + 3;
+			quad[5] = v;
+		}
+
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_vertexBuffer);
+		glGenBuffers(1, &m_indexBuffer);
+		glBindVertexArray(m_vao);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		GLsizeiptr ringBytes = (GLsizeiptr)maxSprites * 4 * sizeof(SpriteVertex) * RING_SECTIONS;
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, ringBytes, NULL, flags);
+		m_mapped = (SpriteVertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, ringBytes, flags);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (const void*)offsetof(SpriteVertex, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (const void*)offsetof(SpriteVertex, uv));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), (const void*)offsetof(SpriteVertex, color));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (const void*)offsetof(SpriteVertex, layer));
+		glEnableVertexAttribArray(3);
+		glBindVertexArray(0);
+
+		const unsigned char white[4] = { 255, 255, 255, 255 };
+		glGenTextures(1, &m_whiteTexture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_whiteTexture);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, 1, 1, 1);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, white);
+	}
+
+	SpriteBatch::~SpriteBatch() {
+		for (GLsync fence : m_fences) {
+			if (fence)
+				glDeleteSync(fence);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		unsigned int buffers[] = { m_vertexBuffer, m_indexBuffer };
+		glDeleteBuffers(2, buffers);
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteTextures(1, &m_whiteTexture);
+		glDeleteProgram(m_program);
+	}
+
+	void SpriteBatch::begin(const glm::mat4& projection, SpriteSortMode sortMode) {
+		m_projection = projection;
+		m_sortMode = sortMode;
+		m_sprites.clear();
+	}
+
+	void SpriteBatch::draw(const Sprite& sprite) {
+		m_sprites.push_back(sprite);
+	}
+
+	void SpriteBatch::end() {
+		m_drawCount = 0;
+		m_spriteCount = (unsigned int)m_sprites.size();
+		if (m_sprites.empty())
+			return;
+
+		m_order.resize(m_sprites.size());
+		if (m_sortMode == SpriteSortMode::Texture) {
+			//Key = texture rank << 32 | submission index: unique keys make std::sort stable.
+			//Ranks come from a linear scan; a frame only ever uses a handful of arrays.
+			m_textureIds.clear();
+			m_keys.resize(m_sprites.size());
+			unsigned int lastTexture = ~0u;
+			uint64_t lastRank = 0;
+			for (size_t i = 0; i < m_sprites.size(); i++) {
+				unsigned int texture = m_sprites[i].texture;
+				if (texture != lastTexture) {
+					std::vector<unsigned int>::iterator it = std::find(m_textureIds.begin(), m_textureIds.end(), texture);
+					lastRank = (uint64_t)(it - m_textureIds.begin());
+					if (it == m_textureIds.end())
+						m_textureIds.push_back(texture);
+					lastTexture = texture;
+				}
+				m_keys[i] = (lastRank << 32) | (uint64_t)i;
+			}
+			std::sort(m_keys.begin(), m_keys.end());
+			for (size_t i = 0; i < m_keys.size(); i++)
+				m_order[i] = (uint32_t)(m_keys[i] & 0xFFFFFFFFu);
+		}
+		else {
+			for (size_t i = 0; i < m_sprites.size(); i++)
+				m_order[i] = (uint32_t)i;
+		}
+
+		GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glUseProgram(m_program);
+		glUniformMatrix4fv(m_projectionLocation, 1, GL_FALSE, &m_projection[0][0]);
+		glBindVertexArray(m_vao);
+		for (size_t first = 0; first < m_order.size(); first += m_maxSprites) {
+			size_t count = std::min((size_t)m_maxSprites, m_order.size() - first);
+			flushChunk(&m_order[first], (unsigned int)count);
+		}
+		glBindVertexArray(0);
+		glDisable(GL_BLEND);
+		if (depthTest)
+			glEnable(GL_DEPTH_TEST);
+	}
+
+	void SpriteBatch::flushChunk(const uint32_t* order, unsigned int count) {
+		//The section was last drawn RING_SECTIONS chunks ago; normally its fence has long passed
+		if (m_fences[m_section]) {
+			glClientWaitSync(m_fences[m_section], GL_SYNC_FLUSH_COMMANDS_BIT, ~0ull);
+			glDeleteSync(m_fences[m_section]);
+			m_fences[m_section] = 0;
+		}
+		unsigned int sectionFirstVertex = (unsigned int)m_section * m_maxSprites * 4;
+		SpriteVertex* vertices = m_mapped + sectionFirstVertex;
+
+		for (unsigned int i = 0; i < count; i++) {
+			const Sprite& sprite = m_sprites[order[i]];
+			float c = cosf(sprite.rotation), s = sinf(sprite.rotation);
+			glm::vec2 halfX = glm::vec2(c, s) * (sprite.size.x * 0.5f);
+			glm::vec2 halfY = glm::vec2(-s, c) * (sprite.size.y * 0.5f);
+			uint32_t color = packColor(sprite.color);
+			float layer = (float)sprite.layer;
+			SpriteVertex* quad = vertices + (size_t)i * 4;
+			quad[0] = { sprite.position - halfX - halfY, glm::vec2(sprite.uvRect.x, sprite.uvRect.y), color, layer };
+			quad[1] = { sprite.position + halfX - halfY, glm::vec2(sprite.uvRect.z, sprite.uvRect.y), color, layer };
+			quad[2] = { sprite.position + halfX + halfY, glm::vec2(sprite.uvRect.z, sprite.uvRect.w), color, layer };
+			quad[3] = { sprite.position - halfX + halfY, glm::vec2(sprite.uvRect.x, sprite.uvRect.w), color, layer };
+		}
+
+		//One draw per run of equal textures
+		unsigned int runStart = 0;
+		for (unsigned int i = 1; i <= count; i++) {
+			unsigned int texture = m_sprites[order[runStart]].texture;
+			if (i < count && m_sprites[order[i]].texture == texture)
+				continue;
+			glBindTextureUnit(0, texture ? texture : m_whiteTexture);
+			glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(i - runStart) * 6, GL_UNSIGNED_INT, (void*)0, (GLint)(sectionFirstVertex + runStart * 4));
+			m_drawCount++;
+			runStart = i;
+		}
+		m_fences[m_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_section = (m_section + 1) % RING_SECTIONS;
+	}
+}
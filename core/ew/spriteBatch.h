@@ -0,0 +1,89 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include "external/glad.h"
+
+namespace ew {
+	struct Sprite {
+		//Center and full extent, in the space of the projection passed to begin()
+		glm::vec2 position = glm::vec2(0.0f);
+		glm::vec2 size = glm::vec2(1.0f);
+		//Radians, counter-clockwise around the center
+		float rotation = 0.0f;
+		//u0, v0, u1, v1 within the layer
+		glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		glm::vec4 color = glm::vec4(1.0f);
+		//GL_TEXTURE_2D_ARRAY name, 0 for untextured
+		unsigned int texture = 0;
+		unsigned int layer = 0;
+	};
+
+	enum class SpriteSortMode {
+		//Grouped by texture array, submission order kept within a texture. Fewest draws.
+		Texture,
+		//Exactly in submission order, a new draw whenever the texture array changes
+		Submission
+	};
+
+	//Vertex as streamed to the GPU, 24 bytes
+	struct SpriteVertex {
+		glm::vec2 position;
+		glm::vec2 uv;
+		//RGBA8, normalized in the shader
+		uint32_t color;
+		float layer;
+	};
+
+	//Batches textured quads into as few draws as possible.
+	//
+	//Sprites are queued between begin() and end(). end() sorts them, expands each to four vertices
+	//on the CPU and writes them straight into a persistently mapped vertex ring, then issues one
+	//glDrawElementsBaseVertex per run of sprites sharing a texture array. Because the layer travels
+	//with each vertex, every image packed into one array (sprite sheets, animation frames, tiles)
+	//costs no extra draw. The ring holds three frames' worth of vertices guarded by fences, so
+	//writing a frame never waits for the GPU to finish reading an earlier one.
+	class SpriteBatch {
+	public:
+		//maxSprites is the capacity of one ring section; larger frames are drawn in several chunks
+		explicit SpriteBatch(unsigned int maxSprites = 131072);
+		~SpriteBatch();
+		SpriteBatch(const SpriteBatch&) = delete;
+		SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+		void begin(const glm::mat4& projection, SpriteSortMode sortMode = SpriteSortMode::Texture);
+		void draw(const Sprite& sprite);
+		//Sorts, streams and draws everything queued since begin(). Uses alpha blending.
+		void end();
+
+		//Draw calls and sprites of the last end()
+		unsigned int getDrawCount() const { return m_drawCount; }
+		unsigned int getSpriteCount() const { return m_spriteCount; }
+
+	private:
+		static const int RING_SECTIONS = 3;
+
+		void flushChunk(const uint32_t* order, unsigned int count);
+
+		unsigned int m_maxSprites = 0;
+		unsigned int m_vao = 0;
+		unsigned int m_vertexBuffer = 0;
+		unsigned int m_indexBuffer = 0;
+		SpriteVertex* m_mapped = nullptr;
+		GLsync m_fences[RING_SECTIONS] = {};
+		int m_section = 0;
+		unsigned int m_program = 0;
+		int m_projectionLocation = -1;
+		//1x1 white array bound for untextured sprites
+		unsigned int m_whiteTexture = 0;
+
+		glm::mat4 m_projection = glm::mat4(1.0f);
+		SpriteSortMode m_sortMode = SpriteSortMode::Texture;
+		std::vector<Sprite> m_sprites;
+		std::vector<uint64_t> m_keys;
+		std::vector<uint32_t> m_order;
+		std::vector<unsigned int> m_textureIds;
+		unsigned int m_drawCount = 0;
+		unsigned int m_spriteCount = 0;
+	};
+}
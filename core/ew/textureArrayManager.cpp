@@ -0,0 +1,132 @@
+#include "textureArrayManager.h"
+#include "textureFormat.h"
+#include "external/stb_image.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+namespace ew {
+	static int fullMipCount(int width, int height) {
+		int levels = 1;
+		while ((width | height) >> levels)
+			levels++;
+		return levels;
+	}
+
+	TextureArrayManager::TextureArrayManager(int layersPerArray) {
+		int maxLayers = 256;
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+		m_layersPerArray = std::max(1, std::min(layersPerArray, maxLayers));
+	}
+
+	TextureArrayManager::~TextureArrayManager() {
+		for (const Array& array : m_arrays)
+			glDeleteTextures(1, &array.texture);
+	}
+
+	TextureLayer TextureArrayManager::add(int width, int height, GLenum internalFormat, const void* pixels, GLenum format, GLenum type, int levels) {
+		if (levels <= 0)
+			levels = fullMipCount(width, height);
+		std::vector<size_t>& group = m_groups[GroupKey(internalFormat, width, height, levels)];
+		Array* array = nullptr;
+		for (size_t index : group) {
+			if (!m_arrays[index].freeLayers.empty()) {
+				array = &m_arrays[index];
+				break;
+			}
+		}
+		if (!array) {
+			Array created;
+			glGenTextures(1, &created.texture);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, created.texture);
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, internalFormat, width, height, m_layersPerArray);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			created.width = width;
+			created.height = height;
+			created.dirty = false;
+			created.hasMips = levels > 1;
+			//Popped from the back, so layer 0 is handed out first
+			for (int layer = m_layersPerArray - 1; layer >= 0; layer--)
+				created.freeLayers.push_back((unsigned int)layer);
+			group.push_back(m_arrays.size());
+			m_arrays.push_back(created);
+			array = &m_arrays.back();
+
+			size_t bytes = 0;
+			for (int level = 0; level < levels; level++)
+				bytes += (size_t)std::max(width >> level, 1) * std::max(height >> level, 1) * bytesPerTexel(internalFormat);
+			m_stats.arrays++;
+			m_stats.layersAllocated += m_layersPerArray;
+			m_stats.bytes += bytes * m_layersPerArray;
+		}
+
+		TextureLayer result;
+		result.texture = array->texture;
+		result.layer = array->freeLayers.back();
+		array->freeLayers.pop_back();
+		m_stats.layersUsed++;
+		if (pixels)
+			update(result, pixels, format, type);
+		return result;
+	}
+
+	TextureLayer TextureArrayManager::addFile(const std::string& path, int levels) {
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+		if (!pixels) {
+			printf("ERROR::TEXTURE_ARRAY::Failed to load %s\n", path.c_str());
+			return TextureLayer();
+		}
+		//Flip in place; stb_image's global flip flag would leak into other loaders
+		std::vector<unsigned char> row((size_t)width * 4);
+		for (int y = 0; y < height / 2; y++) {
+			unsigned char* top = pixels + (size_t)y * width * 4;
+			unsigned char* bottom = pixels + (size_t)(height - 1 - y) * width * 4;
+			memcpy(row.data(), top, row.size());
+			memcpy(top, bottom, row.size());
+			memcpy(bottom, row.data(), row.size());
+		}
+		TextureLayer result = add(width, height, GL_RGBA8, pixels, GL_RGBA, GL_UNSIGNED_BYTE, levels);
+		stbi_image_free(pixels);
+		return result;
+	}
+
+	void TextureArrayManager::update(TextureLayer texture, const void* pixels, GLenum format, GLenum type) {
+		Array* array = findArray(texture.texture);
+		if (!array)
+			return;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, array->texture);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, texture.layer, array->width, array->height, 1, format, type, pixels);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		array->dirty = array->hasMips;
+	}
+
+	void TextureArrayManager::remove(TextureLayer texture) {
+		Array* array = findArray(texture.texture);
+		//A layer removed twice would be handed out to two textures
+		if (!array || texture.layer >= (unsigned int)m_layersPerArray ||
+			std::find(array->freeLayers.begin(), array->freeLayers.end(), texture.layer) != array->freeLayers.end())
+			return;
+		array->freeLayers.push_back(texture.layer);
+		m_stats.layersUsed--;
+	}
+
+	void TextureArrayManager::generateMipmaps() {
+		for (Array& array : m_arrays) {
+			if (!array.dirty)
+				continue;
+			glBindTexture(GL_TEXTURE_2D_ARRAY, array.texture);
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			array.dirty = false;
+		}
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	TextureArrayManager::Array* TextureArrayManager::findArray(unsigned int texture) {
+		for (Array& array : m_arrays) {
+			if (array.texture == texture)
+				return &array;
+		}
+		return nullptr;
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "external/glad.h"
+
+namespace ew {
+	//A texture as seen by shaders: which array to bind and which layer to sample
+	struct TextureLayer {
+		unsigned int texture = 0;
+		unsigned int layer = 0;
+		bool isValid() const { return texture != 0; }
+	};
+
+	struct TextureArrayStats {
+		size_t arrays = 0;
+		size_t layersUsed = 0;
+		size_t layersAllocated = 0;
+		//GPU memory of every array, all layers and mips
+		size_t bytes = 0;
+	};
+
+	//Groups textures of the same format, size and mip count into layers of GL_TEXTURE_2D_ARRAY
+	//objects. A draw over many textures then binds one array and passes a layer per instance
+	//rather than rebinding a texture between draws.
+	//
+	//Arrays use immutable storage, so a full array is never resized: the group gets another
+	//array. Freed layers are reused by the next texture of the same group. Sampling state is not
+	//set here; pair with a SamplerCache.
+	class TextureArrayManager {
+	public:
+		//layersPerArray is capped at GL_MAX_ARRAY_TEXTURE_LAYERS
+		explicit TextureArrayManager(int layersPerArray = 64);
+		~TextureArrayManager();
+		TextureArrayManager(const TextureArrayManager&) = delete;
+		TextureArrayManager& operator=(const TextureArrayManager&) = delete;
+
+		//Copies level 0 from pixels (may be NULL to only reserve the layer). levels 0 means a full
+		//mip chain, filled in by generateMipmaps().
+		TextureLayer add(int width, int height, GLenum internalFormat, const void* pixels,
+			GLenum format = GL_RGBA, GLenum type = GL_UNSIGNED_BYTE, int levels = 0);
+		//RGBA8 through stb_image, rows flipped so v = 0 is the bottom of the image
+		TextureLayer addFile(const std::string& path, int levels = 0);
+		//Replaces level 0 of an existing layer
+		void update(TextureLayer texture, const void* pixels, GLenum format = GL_RGBA, GLenum type = GL_UNSIGNED_BYTE);
+		void remove(TextureLayer texture);
+
+		//Rebuilds mips of every array written since the last call, one glGenerateMipmap per array
+		void generateMipmaps();
+
+		const TextureArrayStats& getStats() const { return m_stats; }
+
+	private:
+		//internalFormat, width, height, levels
+		typedef std::tuple<GLenum, int, int, int> GroupKey;
+		struct Array {
+			unsigned int texture;
+			int width;
+			int height;
+			std::vector<unsigned int> freeLayers;
+			bool dirty;
+			bool hasMips;
+		};
+
+		Array* findArray(unsigned int texture);
+
+		int m_layersPerArray;
+		std::vector<Array> m_arrays;
+		std::map<GroupKey, std::vector<size_t>> m_groups;
+		TextureArrayStats m_stats;
+	};
+}
@@ -0,0 +1,461 @@
+#include "textureAtlas.h"
+#include "external/glad.h"
+#include "external/stb_image.h"
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace ew {
+	static const uint32_t COOKED_MAGIC = 0x54415745; //"EWAT"
+	static const uint32_t COOKED_VERSION = 1;
+
+	//Skyline bottom-left packer for one page. The skyline is the top edge of everything placed
+	//so far, kept as horizontal segments sorted by x.
+	class SkylinePacker {
+	public:
+		SkylinePacker(int width, int height)
+			: m_width(width), m_height(height) {
+			m_nodes.push_back({ 0, 0, width });
+		}
+
+		bool insert(int width, int height, int& outX, int& outY) {
+			int bestIndex = -1;
+			int bestTop = m_height + 1;
+			int bestWidth = m_width + 1;
+			for (int i = 0; i < (int)m_nodes.size(); i++) {
+				int y = fit(i, width, height);
+				if (y < 0)
+					continue;
+				//Lowest top edge first, then the narrowest segment to keep wide gaps for wide images
+				if (y + height < bestTop || (y + height == bestTop && m_nodes[i].width < bestWidth)) {
+					bestIndex = i;
+					bestTop = y + height;
+					bestWidth = m_nodes[i].width;
+					outX = m_nodes[i].x;
+					outY = y;
+				}
+			}
+			if (bestIndex < 0)
+				return false;
+
+			Node node = { outX, outY + height, width };
+			m_nodes.insert(m_nodes.begin() + bestIndex, node);
+			//Trim or remove the segments now covered by the new one
+			for (size_t i = bestIndex + 1; i < m_nodes.size(); i++) {
+				int shadowEnd = m_nodes[i - 1].x + m_nodes[i - 1].width;
+				if (m_nodes[i].x >= shadowEnd)
+					break;
+				int shrink = shadowEnd - m_nodes[i].x;
+				m_nodes[i].x += shrink;
+				m_nodes[i].width -= shrink;
+				if (m_nodes[i].width > 0)
+					break;
+				m_nodes.erase(m_nodes.begin() + i);
+				i--;
+			}
+			for (size_t i = 0; i + 1 < m_nodes.size(); i++) {
+				if (m_nodes[i].y == m_nodes[i + 1].y) {
+					m_nodes[i].width += m_nodes[i + 1].width;
+					m_nodes.erase(m_nodes.begin() + i + 1);
+					i--;
+				}
+			}
+			return true;
+		}
+
+		//Highest used y, so a lone page can be cropped
+		int getUsedHeight() const {
+			int height = 0;
+			for (const Node& node : m_nodes)
+				height = std::max(height, node.y);
+			return height;
+		}
+
+	private:
+		struct Node {
+			int x;
+			int y;
+			int width;
+		};
+
+		//y where a width x height rect rests if its left edge is at node index, -1 if it does not fit
+		int fit(int index, int width, int height) const {
+			if (m_nodes[index].x + width > m_width)
+				return -1;
+			int remaining = width;
+			int y = 0;
+			for (int i = index; remaining > 0; i++) {
+				y = std::max(y, m_nodes[i].y);
+				if (y + height > m_height)
+					return -1;
+				remaining -= m_nodes[i].width;
+			}
+			return y;
+		}
+
+		int m_width;
+		int m_height;
+		std::vector<Node> m_nodes;
+	};
+
+	static int alignUp(int value, int alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	static int nextPowerOfTwo(int value) {
+		int result = 1;
+		while (result < value)
+			result <<= 1;
+		return result;
+	}
+
+	//floor(log2(max(width, height))) + 1, the levels of a full chain
+	static int fullMipCount(int width, int height) {
+		int levels = 1;
+		while ((width | height) >> levels)
+			levels++;
+		return levels;
+	}
+
+	void TextureAtlas::addImage(const std::string& name, int width, int height, const unsigned char* rgba) {
+		SourceImage image;
+		image.name = name;
+		image.width = width;
+		image.height = height;
+		image.pixels.assign(rgba, rgba + (size_t)width * height * 4);
+		m_sources.push_back(std::move(image));
+	}
+
+	bool TextureAtlas::addFile(const std::string& path) {
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+		if (!pixels) {
+			printf("ERROR::TEXTUREATLAS::Failed to load %s\n", path.c_str());
+			return false;
+		}
+		size_t start = path.find_last_of("/\\");
+		start = start == std::string::npos ? 0 : start + 1;
+		size_t end = path.find_last_of('.');
+		if (end == std::string::npos || end < start)
+			end = path.size();
+		addImage(path.substr(start, end - start), width, height, pixels);
+		stbi_image_free(pixels);
+		return true;
+	}
+
+	void TextureAtlas::addGrid(const std::string& name, int width, int height, const unsigned char* rgba, int frameWidth, int frameHeight) {
+		if (frameWidth <= 0 || frameHeight <= 0) {
+			printf("ERROR::TEXTUREATLAS::%s has an invalid %dx%d frame size\n", name.c_str(), frameWidth, frameHeight);
+			return;
+		}
+		int columns = width / frameWidth;
+		int rows = height / frameHeight;
+		std::vector<unsigned char> frame((size_t)frameWidth * frameHeight * 4);
+		for (int row = 0; row < rows; row++) {
+			for (int column = 0; column < columns; column++) {
+				for (int y = 0; y < frameHeight; y++) {
+					const unsigned char* src = rgba + (((size_t)row * frameHeight + y) * width + (size_t)column * frameWidth) * 4;
+					memcpy(&frame[(size_t)y * frameWidth * 4], src, (size_t)frameWidth * 4);
+				}
+				addImage(name + "_" + std::to_string(row * columns + column), frameWidth, frameHeight, frame.data());
+			}
+		}
+	}
+
+	bool TextureAtlas::build(const AtlasSettings& settings) {
+		m_regions.clear();
+		m_regionIndices.clear();
+		m_pages.clear();
+		m_mipLevels = std::max(settings.mipLevels, 1);
+		int alignment = std::min(1 << (m_mipLevels - 1), 16);
+		int gutter = std::max(settings.gutter, 0);
+		int pageSize = settings.pageSize;
+
+		//Tallest first, then widest: the skyline stays flat and wastes less space
+		std::vector<int> order(m_sources.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = (int)i;
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+			if (m_sources[a].height != m_sources[b].height)
+				return m_sources[a].height > m_sources[b].height;
+			return m_sources[a].width > m_sources[b].width;
+		});
+
+		//Regions keep the order images were added in, so indices are predictable
+		m_regions.resize(m_sources.size());
+		std::vector<SkylinePacker> packers;
+		bool success = true;
+		for (int index : order) {
+			const SourceImage& image = m_sources[index];
+			int paddedWidth = alignUp(image.width + gutter * 2, alignment);
+			int paddedHeight = alignUp(image.height + gutter * 2, alignment);
+			AtlasRegion& region = m_regions[index];
+			region.name = image.name;
+			region.width = image.width;
+			region.height = image.height;
+			if (paddedWidth > pageSize || paddedHeight > pageSize) {
+				printf("ERROR::TEXTUREATLAS::%s (%dx%d) does not fit a %d page\n", image.name.c_str(), image.width, image.height, pageSize);
+				region.page = -1;
+				success = false;
+				continue;
+			}
+			int x = 0, y = 0;
+			size_t page = 0;
+			while (page < packers.size() && !packers[page].insert(paddedWidth, paddedHeight, x, y))
+				page++;
+			if (page == packers.size()) {
+				packers.push_back(SkylinePacker(pageSize, pageSize));
+				packers.back().insert(paddedWidth, paddedHeight, x, y);
+			}
+			region.page = (int)page;
+			region.x = x + gutter;
+			region.y = y + gutter;
+		}
+
+		m_pageWidth = pageSize;
+		m_pageHeight = pageSize;
+		if (packers.size() == 1) {
+			int usedWidth = 0;
+			for (const AtlasRegion& region : m_regions) {
+				if (region.page == 0)
+					usedWidth = std::max(usedWidth, alignUp(region.x + region.width + gutter, alignment));
+			}
+			m_pageWidth = nextPowerOfTwo(usedWidth);
+			m_pageHeight = nextPowerOfTwo(packers[0].getUsedHeight());
+		}
+		//A cropped page may be too small for the requested chain, which glTexStorage3D rejects
+		m_mipLevels = std::min(m_mipLevels, fullMipCount(m_pageWidth, m_pageHeight));
+
+		//Copy each image with its edges extruded into the gutter. Source rows are top-down, page
+		//rows bottom-up, so images are flipped on the way in.
+		m_pages.assign(packers.size(), std::vector<unsigned char>((size_t)m_pageWidth * m_pageHeight * 4, 0));
+		for (size_t i = 0; i < m_sources.size(); i++) {
+			const SourceImage& image = m_sources[i];
+			const AtlasRegion& region = m_regions[i];
+			if (region.page < 0)
+				continue;
+			unsigned char* page = m_pages[region.page].data();
+			for (int py = -gutter; py < image.height + gutter; py++) {
+				int srcRow = std::min(std::max(image.height - 1 - py, 0), image.height - 1);
+				unsigned char* dst = page + ((size_t)(region.y + py) * m_pageWidth + region.x) * 4;
+				const unsigned char* src = &image.pixels[(size_t)srcRow * image.width * 4];
+				for (int px = -gutter; px < 0; px++)
+					memcpy(dst + px * 4, src, 4);
+				memcpy(dst, src, (size_t)image.width * 4);
+				for (int px = image.width; px < image.width + gutter; px++)
+					memcpy(dst + px * 4, src + (image.width - 1) * 4, 4);
+			}
+		}
+		computeUVs();
+		return success;
+	}
+
+	void TextureAtlas::computeUVs() {
+		m_regionIndices.clear();
+		for (size_t i = 0; i < m_regions.size(); i++) {
+			AtlasRegion& region = m_regions[i];
+			region.uvRect = glm::vec4(
+				(float)region.x / m_pageWidth,
+				(float)region.y / m_pageHeight,
+				(float)(region.x + region.width) / m_pageWidth,
+				(float)(region.y + region.height) / m_pageHeight);
+			m_regionIndices[region.name] = (int)i;
+		}
+	}
+
+	unsigned int TextureAtlas::createTexture() const {
+		if (m_pages.empty())
+			return 0;
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_mipLevels, GL_RGBA8, m_pageWidth, m_pageHeight, (GLsizei)m_pages.size());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		for (size_t i = 0; i < m_pages.size(); i++)
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, (GLint)i, m_pageWidth, m_pageHeight, 1, GL_RGBA, GL_UNSIGNED_BYTE, m_pages[i].data());
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		if (m_mipLevels > 1) {
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, m_mipLevels - 1);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		}
+		else {
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		}
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		return texture;
+	}
+
+	//Cooked layout, native endianness:
+	//magic, version, pageWidth, pageHeight, pageCount, mipLevels, regionCount (uint32 each),
+	//then per region nameLength (uint32), name, page, x, y, width, height (int32 each),
+	//then every page's RGBA8 texels
+	bool TextureAtlas::saveCooked(const std::string& path) const {
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file) {
+			printf("ERROR::TEXTUREATLAS::Failed to open %s for writing\n", path.c_str());
+			return false;
+		}
+		uint32_t header[7] = { COOKED_MAGIC, COOKED_VERSION, (uint32_t)m_pageWidth, (uint32_t)m_pageHeight,
+			(uint32_t)m_pages.size(), (uint32_t)m_mipLevels, (uint32_t)m_regions.size() };
+		fwrite(header, sizeof(header), 1, file);
+		for (const AtlasRegion& region : m_regions) {
+			uint32_t nameLength = (uint32_t)region.name.size();
+			int32_t rect[5] = { region.page, region.x, region.y, region.width, region.height };
+			fwrite(&nameLength, sizeof(nameLength), 1, file);
+			fwrite(region.name.data(), 1, nameLength, file);
+			fwrite(rect, sizeof(rect), 1, file);
+		}
+		for (const std::vector<unsigned char>& page : m_pages)
+			fwrite(page.data(), 1, page.size(), file);
+		bool ok = ferror(file) == 0;
+		fclose(file);
+		return ok;
+	}
+
+	bool TextureAtlas::loadCooked(const std::string& path) {
+		FILE* file = fopen(path.c_str(), "rb");
+		if (!file) {
+			printf("ERROR::TEXTUREATLAS::Failed to open %s\n", path.c_str());
+			return false;
+		}
+		fseek(file, 0, SEEK_END);
+		uint64_t fileSize = (uint64_t)ftell(file);
+		fseek(file, 0, SEEK_SET);
+		uint32_t header[7];
+		if (fread(header, sizeof(header), 1, file) != 1 || header[0] != COOKED_MAGIC || header[1] != COOKED_VERSION) {
+			printf("ERROR::TEXTUREATLAS::%s is not a cooked atlas\n", path.c_str());
+			fclose(file);
+			return false;
+		}
+		//Counts are checked against the file size before anything is allocated, so a corrupt
+		//header fails here rather than in a huge allocation or upload
+		uint64_t pageBytes = (uint64_t)header[2] * header[3] * 4;
+		uint64_t minRegionBytes = sizeof(uint32_t) + sizeof(int32_t) * 5;
+		bool valid = header[2] > 0 && header[2] <= 65536 && header[3] > 0 && header[3] <= 65536 &&
+			header[5] >= 1 && (int)header[5] <= fullMipCount((int)header[2], (int)header[3]) &&
+			header[4] <= fileSize / pageBytes &&
+			header[6] <= fileSize / minRegionBytes &&
+			sizeof(header) + pageBytes * header[4] + minRegionBytes * header[6] <= fileSize;
+		if (!valid) {
+			printf("ERROR::TEXTUREATLAS::%s has an invalid header\n", path.c_str());
+			fclose(file);
+			return false;
+		}
+		m_pageWidth = (int)header[2];
+		m_pageHeight = (int)header[3];
+		m_mipLevels = (int)header[5];
+		uint32_t pageCount = header[4];
+		m_regions.assign(header[6], AtlasRegion());
+		bool ok = true;
+		for (AtlasRegion& region : m_regions) {
+			uint32_t nameLength = 0;
+			int32_t rect[5];
+			ok = ok && fread(&nameLength, sizeof(nameLength), 1, file) == 1;
+			ok = ok && nameLength <= fileSize;
+			region.name.resize(ok ? nameLength : 0);
+			ok = ok && (nameLength == 0 || fread(&region.name[0], 1, nameLength, file) == nameLength);
+			ok = ok && fread(rect, sizeof(rect), 1, file) == 1;
+			//Unplaced regions are stored with page -1
+			ok = ok && rect[0] < (int32_t)pageCount;
+			if (!ok)
+				break;
+			region.page = rect[0];
+			region.x = rect[1];
+			region.y = rect[2];
+			region.width = rect[3];
+			region.height = rect[4];
+		}
+		ok = ok && (uint64_t)ftell(file) + pageBytes * pageCount <= fileSize;
+		m_pages.assign(ok ? pageCount : 0, std::vector<unsigned char>((size_t)pageBytes));
+		for (std::vector<unsigned char>& page : m_pages)
+			ok = ok && fread(page.data(), 1, page.size(), file) == page.size();
+		fclose(file);
+		if (!ok) {
+			printf("ERROR::TEXTUREATLAS::%s is truncated\n", path.c_str());
+			m_regions.clear();
+			m_pages.clear();
+			m_regionIndices.clear();
+			return false;
+		}
+		computeUVs();
+		return true;
+	}
+
+	int TextureAtlas::find(const std::string& name) const {
+		std::map<std::string, int>::const_iterator it = m_regionIndices.find(name);
+		return it == m_regionIndices.end() ? -1 : it->second;
+	}
+
+	std::vector<int> TextureAtlas::findSequence(const std::string& prefix) const {
+		std::vector<int> frames;
+		for (int i = 0;; i++) {
+			int region = find(prefix + "_" + std::to_string(i));
+			if (region < 0)
+				break;
+			frames.push_back(region);
+		}
+		return frames;
+	}
+
+	float TextureAtlas::getOccupancy() const {
+		if (m_pages.empty())
+			return 0.0f;
+		double used = 0.0;
+		for (const AtlasRegion& region : m_regions)
+			used += (double)region.width * region.height;
+		return (float)(used / ((double)m_pageWidth * m_pageHeight * m_pages.size()));
+	}
+
+	void SpriteAnimator::play(const SpriteAnimation* animation, bool restart) {
+		if (animation == m_animation && !restart)
+			return;
+		m_animation = animation;
+		m_frame = 0;
+		m_time = 0.0f;
+		m_finished = false;
+	}
+
+	void SpriteAnimator::update(float deltaTime) {
+		if (!m_animation || m_finished || m_animation->frames.empty() || m_animation->frameDuration <= 0.0f)
+			return;
+		m_time += deltaTime;
+		int frameCount = (int)m_animation->frames.size();
+		//A long hitch may skip several frames at once
+		while (m_time >= m_animation->frameDuration) {
+			m_time -= m_animation->frameDuration;
+			if (m_frame + 1 < frameCount) {
+				m_frame++;
+			}
+			else if (m_animation->loop) {
+				m_frame = 0;
+			}
+			else {
+				m_finished = true;
+				m_time = 0.0f;
+				break;
+			}
+		}
+	}
+
+	int SpriteAnimator::getRegion() const {
+		if (!m_animation || m_animation->frames.empty())
+			return -1;
+		return m_animation->frames[m_frame];
+	}
+
+	void SpriteAnimator::apply(const TextureAtlas& atlas, unsigned int texture, Sprite& sprite) const {
+		int region = getRegion();
+		if (region < 0)
+			return;
+		const AtlasRegion& frame = atlas.getRegion(region);
+		if (frame.page < 0)
+			return;
+		sprite.uvRect = frame.uvRect;
+		sprite.layer = (unsigned int)frame.page;
+		sprite.texture = texture;
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "spriteBatch.h"
+
+namespace ew {
+	struct AtlasSettings {
+		//Every page is pageSize x pageSize; a single page shrinks to the smallest power of two that fits
+		int pageSize = 1024;
+		//Edge texels repeated around each image, so filtering never reads a neighbor
+		int gutter = 2;
+		//Levels the texture will have. With more than one level, rects are aligned to
+		//2^(mipLevels - 1) texels (up to 16) so each mip texel stays inside one image.
+		int mipLevels = 1;
+	};
+
+	struct AtlasRegion {
+		std::string name;
+		//Layer of the texture array
+		int page = 0;
+		//Texels, without gutter. Stored bottom-up like any GL texture.
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+		//u0, v0 (bottom left), u1, v1, matching ew::Sprite::uvRect
+		glm::vec4 uvRect = glm::vec4(0.0f);
+	};
+
+	//Packs many RGBA8 images into the layers of one texture array, so sprites from different
+	//source images are drawn with one bind (and, through SpriteBatch, one draw).
+	//
+	//Packing is skyline bottom-left: images are sorted tallest first and each goes where its top
+	//edge ends lowest. Overflow opens another page. build() runs at load time; saveCooked() and
+	//loadCooked() store the packed result so shipping builds skip decoding and packing entirely.
+	class TextureAtlas {
+	public:
+		//Copies width * height RGBA8 texels, top row first as image files store them
+		void addImage(const std::string& name, int width, int height, const unsigned char* rgba);
+		//Loads a file through stb_image; the region is named after the file without directory or extension
+		bool addFile(const std::string& path);
+		//Splits a sprite sheet into frameWidth x frameHeight cells named name_0, name_1... row by row
+		void addGrid(const std::string& name, int width, int height, const unsigned char* rgba, int frameWidth, int frameHeight);
+
+		//Packs every added image. Returns false if an image is larger than a page.
+		bool build(const AtlasSettings& settings = AtlasSettings());
+		//GL_TEXTURE_2D_ARRAY holding the pages, with mipmaps if requested. Owned by the caller.
+		unsigned int createTexture() const;
+
+		bool saveCooked(const std::string& path) const;
+		bool loadCooked(const std::string& path);
+
+		//Index of a region by name, -1 if missing
+		int find(const std::string& name) const;
+		//Regions named prefix_0, prefix_1... in order, as created by addGrid()
+		std::vector<int> findSequence(const std::string& prefix) const;
+		const AtlasRegion& getRegion(int index) const { return m_regions[index]; }
+		int getRegionCount() const { return (int)m_regions.size(); }
+		int getPageCount() const { return (int)m_pages.size(); }
+		int getPageWidth() const { return m_pageWidth; }
+		int getPageHeight() const { return m_pageHeight; }
+		//Fraction of page area covered by images, gutters excluded
+		float getOccupancy() const;
+
+	private:
+		struct SourceImage {
+			std::string name;
+			int width;
+			int height;
+			std::vector<unsigned char> pixels;
+		};
+
+		void computeUVs();
+
+		std::vector<SourceImage> m_sources;
+		std::vector<AtlasRegion> m_regions;
+		std::map<std::string, int> m_regionIndices;
+		std::vector<std::vector<unsigned char>> m_pages;
+		int m_pageWidth = 0;
+		int m_pageHeight = 0;
+		int m_mipLevels = 1;
+	};
+
+	struct SpriteAnimation {
+		//Atlas region indices, e.g. from TextureAtlas::findSequence()
+		std::vector<int> frames;
+		float frameDuration = 0.1f;
+		bool loop = true;
+	};
+
+	//Plays a SpriteAnimation by switching the sprite's uvRect and layer. Every frame already lives
+	//in the atlas, so animating costs no texture uploads; the new UVs simply ride along with the
+	//vertices SpriteBatch streams anyway.
+	class SpriteAnimator {
+	public:
+		void play(const SpriteAnimation* animation, bool restart = true);
+		void update(float deltaTime);
+		//True once a non-looping animation has shown its last frame for a full duration
+		bool isFinished() const { return m_finished; }
+		//Atlas region of the current frame, -1 with no animation
+		int getRegion() const;
+		//Points sprite at the current frame of atlas (uploaded as texture)
+		void apply(const TextureAtlas& atlas, unsigned int texture, Sprite& sprite) const;
+
+	private:
+		const SpriteAnimation* m_animation = nullptr;
+		int m_frame = 0;
+		float m_time = 0.0f;
+		bool m_finished = false;
+	};
+}
@@ -0,0 +1,16 @@
+#include "textureFormat.h"
+
+namespace ew {
+	size_t bytesPerTexel(GLenum internalFormat) {
+		switch (internalFormat) {
+		case GL_R8: return 1;
+		case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: return 2;
+		case GL_RGB8: return 3;
+		case GL_RGBA16F: case GL_RG32F: return 8;
+		case GL_RGB32F: return 12;
+		case GL_RGBA32F: return 16;
+		//RGBA8, SRGB8_ALPHA8, RG16F, R32F, R11F_G11F_B10F, RGB10_A2, depth 24/32 formats
+		default: return 4;
+		}
+	}
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <stddef.h>
+#include "external/glad.h"
+
+namespace ew {
+	//Bytes per texel of the uncompressed formats used in core, 4 for anything unknown
+	size_t bytesPerTexel(GLenum internalFormat);
+}
@@ -0,0 +1,578 @@
+#include "virtualTexture.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <glm/glm.hpp>
+
+namespace ew {
+	static const uint32_t VIRTUAL_TEXTURE_MAGIC = 0x54565745; //"EWVT"
+	static const uint32_t VIRTUAL_TEXTURE_VERSION = 1;
+	static const int VIRTUAL_TEXTURE_BORDER = 1;
+	//Feedback alpha of pixels virtualFeedback() wrote
+	static const unsigned char FEEDBACK_WRITTEN = 255;
+
+	//File header: magic, version, width, height, tileSize, border, tilesPerSide, levelCount
+	//(uint32 each, native endianness), then every tile of level 0, 1... in row-major order, each
+	//(tileSize + 2 * border)^2 RGBA8 texels
+	struct VirtualTextureHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t tileSize;
+		uint32_t border;
+		uint32_t tilesPerSide;
+		uint32_t levelCount;
+	};
+
+	//std140 mirror of the VirtualTextureParams block
+	struct VirtualTextureParams {
+		//x tiles per side, y level count, z tile size, w border
+		glm::vec4 layout;
+		//x cache texture size, y padded tile size, z feedback level bias
+		glm::vec4 cache;
+		//xy part of the square the image covers
+		glm::vec4 uvScale;
+	};
+
+	static const char* virtualTextureSource = R"(
+		layout(std140, binding = 2) uniform VirtualTextureParams {
+			vec4 vtLayout;
+			vec4 vtCache;
+			vec4 vtUVScale;
+		};
+		layout(binding = 5) uniform sampler2D vtPhysicalCache;
+		layout(binding = 6) uniform sampler2D vtIndirection;
+
+		vec2 vtVirtualUV(vec2 uv) {
+			return clamp(uv * vtUVScale.xy, vec2(0.0), vec2(0.99999));
+		}
+
+		float vtMipLevel(vec2 virtualUV, float bias) {
+			vec2 texels = virtualUV * vtLayout.x * vtLayout.z;
+			vec2 dx = dFdx(texels), dy = dFdy(texels);
+			float rho = max(dot(dx, dx), dot(dy, dy));
+			return clamp(floor(0.5 * log2(max(rho, 1e-8)) + bias), 0.0, vtLayout.y - 1.0);
+		}
+
+		vec4 sampleVirtual(vec2 uv) {
+			vec2 virtualUV = vtVirtualUV(uv);
+			int level = int(vtMipLevel(virtualUV, 0.0));
+			int tiles = int(vtLayout.x) >> level;
+			vec4 entry = texelFetch(vtIndirection, ivec2(virtualUV * float(tiles)), level) * 255.0;
+			//entry.z is the level actually resident, possibly coarser than requested
+			vec2 inTile = fract(virtualUV * vtLayout.x / exp2(entry.z));
+			vec2 texel = entry.xy * vtCache.y + vtLayout.w + inTile * vtLayout.z;
+			return textureLod(vtPhysicalCache, texel / vtCache.x, 0.0);
+		}
+
+		vec4 virtualFeedback(vec2 uv) {
+			vec2 virtualUV = vtVirtualUV(uv);
+			float level = vtMipLevel(virtualUV, vtCache.z);
+			vec2 tile = floor(virtualUV * vtLayout.x / exp2(level));
+			return vec4(tile, level, 255.0) / 255.0;
+		}
+	)";
+
+	const char* virtualTextureGlsl() {
+		return virtualTextureSource;
+	}
+
+	static uint32_t packEntry(int slotX, int slotY, int level) {
+		return (uint32_t)slotX | ((uint32_t)slotY << 8) | ((uint32_t)level << 16) | (255u << 24);
+	}
+
+	static int entryLevel(uint32_t entry) {
+		return (entry >> 16) & 0xFF;
+	}
+
+	bool buildVirtualTexture(const std::string& path, const unsigned char* rgba, int width, int height, int tileSize) {
+		int tilesPerSide = 1;
+		while (tilesPerSide * tileSize < width || tilesPerSide * tileSize < height)
+			tilesPerSide *= 2;
+		int levelCount = 1;
+		while ((tilesPerSide >> (levelCount - 1)) > 1)
+			levelCount++;
+		if (tilesPerSide > 256) {
+			printf("ERROR::VIRTUAL_TEXTURE::%dx%d needs %d tiles per side, more than 256\n", width, height, tilesPerSide);
+			return false;
+		}
+
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file) {
+			printf("ERROR::VIRTUAL_TEXTURE::Failed to open %s for writing\n", path.c_str());
+			return false;
+		}
+		VirtualTextureHeader header = { VIRTUAL_TEXTURE_MAGIC, VIRTUAL_TEXTURE_VERSION, (uint32_t)width, (uint32_t)height,
+			(uint32_t)tileSize, (uint32_t)VIRTUAL_TEXTURE_BORDER, (uint32_t)tilesPerSide, (uint32_t)levelCount };
+		fwrite(&header, sizeof(header), 1, file);
+
+		int padded = tileSize + VIRTUAL_TEXTURE_BORDER * 2;
+		std::vector<unsigned char> tile((size_t)padded * padded * 4);
+		//Only the current level is kept: the image itself, then each 2x2 box filtered level.
+		//Texels past the image edge repeat it.
+		std::vector<unsigned char> levelPixels;
+		const unsigned char* level = rgba;
+		int levelWidth = width, levelHeight = height;
+		for (int l = 0; l < levelCount; l++) {
+			int tiles = tilesPerSide >> l;
+			for (int ty = 0; ty < tiles; ty++) {
+				for (int tx = 0; tx < tiles; tx++) {
+					for (int y = 0; y < padded; y++) {
+						int sy = std::min(std::max(ty * tileSize + y - VIRTUAL_TEXTURE_BORDER, 0), levelHeight - 1);
+						for (int x = 0; x < padded; x++) {
+							int sx = std::min(std::max(tx * tileSize + x - VIRTUAL_TEXTURE_BORDER, 0), levelWidth - 1);
+							memcpy(&tile[((size_t)y * padded + x) * 4], &level[((size_t)sy * levelWidth + sx) * 4], 4);
+						}
+					}
+					fwrite(tile.data(), 1, tile.size(), file);
+				}
+			}
+
+			int nextWidth = std::max((levelWidth + 1) / 2, 1), nextHeight = std::max((levelHeight + 1) / 2, 1);
+			std::vector<unsigned char> next((size_t)nextWidth * nextHeight * 4);
+			for (int y = 0; y < nextHeight; y++) {
+				int y0 = std::min(y * 2, levelHeight - 1), y1 = std::min(y * 2 + 1, levelHeight - 1);
+				for (int x = 0; x < nextWidth; x++) {
+					int x0 = std::min(x * 2, levelWidth - 1), x1 = std::min(x * 2 + 1, levelWidth - 1);
+					for (int c = 0; c < 4; c++) {
+						int sum = level[((size_t)y0 * levelWidth + x0) * 4 + c] + level[((size_t)y0 * levelWidth + x1) * 4 + c]
+							+ level[((size_t)y1 * levelWidth + x0) * 4 + c] + level[((size_t)y1 * levelWidth + x1) * 4 + c];
+						next[((size_t)y * nextWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+					}
+				}
+			}
+			levelPixels.swap(next);
+			level = levelPixels.data();
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+		bool ok = ferror(file) == 0;
+		fclose(file);
+		return ok;
+	}
+
+	//Pyramids of large images pass 2 GB, beyond what fseek's long can address on every platform
+	static bool seek64(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+		return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+		return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+	}
+
+	static uint64_t fileSize64(FILE* file) {
+#ifdef _WIN32
+		_fseeki64(file, 0, SEEK_END);
+		__int64 size = _ftelli64(file);
+#else
+		fseeko(file, 0, SEEK_END);
+		off_t size = ftello(file);
+#endif
+		return size > 0 ? (uint64_t)size : 0;
+	}
+
+	VirtualTexture::VirtualTexture(const std::string& path, JobSystem& jobs, const VirtualTextureSettings& settings)
+		: m_jobs(jobs), m_settings(settings), m_path(path) {
+		FILE* file = fopen(path.c_str(), "rb");
+		if (!file) {
+			printf("ERROR::VIRTUAL_TEXTURE::Failed to open %s\n", path.c_str());
+			return;
+		}
+		VirtualTextureHeader header;
+		bool ok = fread(&header, sizeof(header), 1, file) == 1 && header.magic == VIRTUAL_TEXTURE_MAGIC && header.version == VIRTUAL_TEXTURE_VERSION;
+		uint64_t fileSize = fileSize64(file);
+		fclose(file);
+		if (!ok) {
+			printf("ERROR::VIRTUAL_TEXTURE::%s is not a virtual texture\n", path.c_str());
+			return;
+		}
+		//Feedback pixels hold 8 bit tile coordinates, so at most 256 tiles per side,
+		//and the level count is fixed by the power of two tile grid
+		int maxTextureSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+		int expectedLevels = 1;
+		while (expectedLevels <= 9 && (header.tilesPerSide >> (expectedLevels - 1)) > 1)
+			expectedLevels++;
+		bool valid = header.tilesPerSide > 0 && header.tilesPerSide <= 256 && (header.tilesPerSide & (header.tilesPerSide - 1)) == 0 &&
+			header.levelCount == (uint32_t)expectedLevels && header.tileSize > 0 && header.tileSize <= 65536 && header.border <= header.tileSize &&
+			header.width > 0 && header.height > 0 && header.width <= (uint64_t)header.tilesPerSide * header.tileSize &&
+			header.height <= (uint64_t)header.tilesPerSide * header.tileSize;
+		//The physical cache must hold at least 2x2 padded tiles
+		valid = valid && (uint64_t)(header.tileSize + header.border * 2) * 2 <= (uint64_t)maxTextureSize;
+		if (!valid) {
+			printf("ERROR::VIRTUAL_TEXTURE::%s has an invalid header\n", path.c_str());
+			return;
+		}
+		uint64_t padded64 = header.tileSize + header.border * 2;
+		uint64_t expectedBytes = sizeof(header);
+		for (uint32_t l = 0; l < header.levelCount; l++) {
+			uint64_t tiles = header.tilesPerSide >> l;
+			expectedBytes += tiles * tiles * padded64 * padded64 * 4;
+		}
+		if (expectedBytes > fileSize) {
+			printf("ERROR::VIRTUAL_TEXTURE::%s is truncated\n", path.c_str());
+			return;
+		}
+		m_width = (int)header.width;
+		m_height = (int)header.height;
+		m_tileSize = (int)header.tileSize;
+		m_border = (int)header.border;
+		m_tilesPerSide = (int)header.tilesPerSide;
+		m_levelCount = (int)header.levelCount;
+		m_headerBytes = sizeof(header);
+		int padded = m_tileSize + m_border * 2;
+		m_settings.cacheTilesPerSide = std::min(std::max(m_settings.cacheTilesPerSide, 2), std::min(256, maxTextureSize / padded));
+		m_settings.feedbackScale = std::max(m_settings.feedbackScale, 1);
+
+		int cacheSize = m_settings.cacheTilesPerSide * padded;
+		glGenTextures(1, &m_physicalTexture);
+		glBindTexture(GL_TEXTURE_2D, m_physicalTexture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, cacheSize, cacheSize);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glGenTextures(1, &m_indirectionTexture);
+		glBindTexture(GL_TEXTURE_2D, m_indirectionTexture);
+		glTexStorage2D(GL_TEXTURE_2D, m_levelCount, GL_RGBA8, m_tilesPerSide, m_tilesPerSide);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		VirtualTextureParams params;
+		params.layout = glm::vec4((float)m_tilesPerSide, (float)m_levelCount, (float)m_tileSize, (float)m_border);
+		//Feedback pixels cover feedbackScale^2 screen pixels, so their derivatives are that much larger
+		params.cache = glm::vec4((float)cacheSize, (float)padded, -log2f((float)m_settings.feedbackScale), 0.0f);
+		params.uvScale = glm::vec4((float)m_width / (m_tilesPerSide * m_tileSize), (float)m_height / (m_tilesPerSide * m_tileSize), 0.0f, 0.0f);
+		glGenBuffers(1, &m_paramsBuffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(params), &params, GL_STATIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		int slotCount = m_settings.cacheTilesPerSide * m_settings.cacheTilesPerSide;
+		m_slots.resize(slotCount);
+		for (int slot = slotCount - 1; slot > 0; slot--)
+			m_freeSlots.push_back(slot);
+
+		//The last level's single tile is loaded now and pinned in slot 0, so every entry has a fallback
+		int root = m_levelCount - 1;
+		std::vector<unsigned char> pixels;
+		if (!readTile(tileKey(root, 0, 0), pixels)) {
+			printf("ERROR::VIRTUAL_TEXTURE::%s is truncated\n", path.c_str());
+			glDeleteTextures(1, &m_physicalTexture);
+			m_physicalTexture = 0;
+			return;
+		}
+		m_indirection.resize(m_levelCount);
+		m_indirectionDirty.assign(m_levelCount, true);
+		for (int l = 0; l < m_levelCount; l++) {
+			int tiles = m_tilesPerSide >> l;
+			m_indirection[l].assign((size_t)tiles * tiles, packEntry(0, 0, root));
+		}
+		uploadTile(tileKey(root, 0, 0), pixels.data(), 0);
+		m_stats.tilesLoaded = 0;
+		resizeFeedback(1, 1);
+	}
+
+	VirtualTexture::~VirtualTexture() {
+		m_jobs.wait(m_loadCounter);
+		for (FeedbackReadback& readback : m_readbacks) {
+			if (readback.fence)
+				glDeleteSync(readback.fence);
+			glDeleteBuffers(1, &readback.buffer);
+		}
+		glDeleteFramebuffers(1, &m_feedbackFramebuffer);
+		glDeleteTextures(1, &m_feedbackColor);
+		glDeleteRenderbuffers(1, &m_feedbackDepth);
+		glDeleteTextures(1, &m_physicalTexture);
+		glDeleteTextures(1, &m_indirectionTexture);
+		glDeleteBuffers(1, &m_paramsBuffer);
+	}
+
+	bool VirtualTexture::readTile(uint32_t tile, std::vector<unsigned char>& pixels) const {
+		int level = (int)(tile >> 24), y = (int)((tile >> 12) & 0xFFF), x = (int)(tile & 0xFFF);
+		size_t index = 0;
+		for (int l = 0; l < level; l++)
+			index += (size_t)(m_tilesPerSide >> l) * (m_tilesPerSide >> l);
+		index += (size_t)y * (m_tilesPerSide >> level) + x;
+		int padded = m_tileSize + m_border * 2;
+		size_t tileBytes = (size_t)padded * padded * 4;
+		pixels.resize(tileBytes);
+
+		//A handle per read keeps workers independent of each other
+		FILE* file = fopen(m_path.c_str(), "rb");
+		if (!file)
+			return false;
+		bool ok = seek64(file, m_headerBytes + index * tileBytes) && fread(pixels.data(), 1, tileBytes, file) == tileBytes;
+		fclose(file);
+		return ok;
+	}
+
+	void VirtualTexture::resizeFeedback(int width, int height) {
+		if (width == m_feedbackWidth && height == m_feedbackHeight)
+			return;
+		m_feedbackWidth = width;
+		m_feedbackHeight = height;
+		glDeleteFramebuffers(1, &m_feedbackFramebuffer);
+		glDeleteTextures(1, &m_feedbackColor);
+		glDeleteRenderbuffers(1, &m_feedbackDepth);
+
+		glGenTextures(1, &m_feedbackColor);
+		glBindTexture(GL_TEXTURE_2D, m_feedbackColor);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glGenRenderbuffers(1, &m_feedbackDepth);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_feedbackDepth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		GLint previousFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+		glGenFramebuffers(1, &m_feedbackFramebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_feedbackFramebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_feedbackColor, 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_feedbackDepth);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			printf("ERROR::FRAMEBUFFER::Virtual texture feedback target is not complete\n");
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+		for (FeedbackReadback& readback : m_readbacks) {
+			if (!readback.buffer)
+				glGenBuffers(1, &readback.buffer);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+			glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	void VirtualTexture::beginFeedback(int screenWidth, int screenHeight) {
+		int scale = m_settings.feedbackScale;
+		resizeFeedback(std::max((screenWidth + scale - 1) / scale, 1), std::max((screenHeight + scale - 1) / scale, 1));
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+		glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_feedbackFramebuffer);
+		glViewport(0, 0, m_feedbackWidth, m_feedbackHeight);
+		//Alpha 0 marks pixels nothing was drawn to
+		const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		const float clearDepth = 1.0f;
+		glClearBufferfv(GL_COLOR, 0, clearColor);
+		glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+		bind();
+	}
+
+	void VirtualTexture::endFeedback() {
+		FeedbackReadback& readback = m_readbacks[m_nextReadback];
+		//Still unread after FEEDBACK_BUFFERS frames: newer feedback supersedes it
+		if (readback.fence) {
+			glDeleteSync(readback.fence);
+			readback.fence = nullptr;
+		}
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_feedbackFramebuffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		glReadPixels(0, 0, m_feedbackWidth, m_feedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		readback.width = m_feedbackWidth;
+		readback.height = m_feedbackHeight;
+		m_nextReadback = (m_nextReadback + 1) % FEEDBACK_BUFFERS;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+		glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+	}
+
+	void VirtualTexture::update() {
+		if (!isValid())
+			return;
+		m_frame++;
+
+		//Oldest first; only feedback the GPU has finished is read, so this never waits
+		for (int i = 0; i < FEEDBACK_BUFFERS; i++) {
+			FeedbackReadback& readback = m_readbacks[(m_nextReadback + i) % FEEDBACK_BUFFERS];
+			if (!readback.fence || glClientWaitSync(readback.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+				continue;
+			glDeleteSync(readback.fence);
+			readback.fence = nullptr;
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+			const unsigned char* pixels = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)readback.width * readback.height * 4, GL_MAP_READ_BIT);
+			if (pixels) {
+				processFeedback(pixels, readback.width * readback.height);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+
+		std::vector<LoadedTile> loaded;
+		{
+			std::lock_guard<std::mutex> lock(m_loadedMutex);
+			int count = std::min((int)m_loadedTiles.size(), m_settings.maxUploadsPerFrame);
+			//Coarse tiles were queued first, so uploading in order sharpens gradually
+			loaded.assign(std::make_move_iterator(m_loadedTiles.begin()), std::make_move_iterator(m_loadedTiles.begin() + count));
+			m_loadedTiles.erase(m_loadedTiles.begin(), m_loadedTiles.begin() + count);
+		}
+		m_stats.uploadsLastUpdate = 0;
+		for (const LoadedTile& tile : loaded) {
+			m_pendingTiles.erase(tile.tile);
+			if (tile.pixels.empty() || m_residentTiles.count(tile.tile))
+				continue;
+			int slot = allocateSlot();
+			//Every slot was used this frame; drop the tile and let feedback ask again
+			if (slot < 0)
+				continue;
+			uploadTile(tile.tile, tile.pixels.data(), slot);
+			m_stats.uploadsLastUpdate++;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, m_indirectionTexture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		for (int l = 0; l < m_levelCount; l++) {
+			if (!m_indirectionDirty[l])
+				continue;
+			int tiles = m_tilesPerSide >> l;
+			glTexSubImage2D(GL_TEXTURE_2D, l, 0, 0, tiles, tiles, GL_RGBA, GL_UNSIGNED_BYTE, m_indirection[l].data());
+			m_indirectionDirty[l] = false;
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		m_stats.residentTiles = (unsigned int)m_residentTiles.size();
+		m_stats.pendingLoads = (unsigned int)m_pendingTiles.size();
+	}
+
+	void VirtualTexture::processFeedback(const unsigned char* pixels, int count) {
+		std::vector<uint32_t> requested;
+		requested.reserve(count);
+		for (int i = 0; i < count; i++) {
+			const unsigned char* p = pixels + (size_t)i * 4;
+			if (p[3] != FEEDBACK_WRITTEN)
+				continue;
+			int level = p[2];
+			if (level >= m_levelCount || p[0] >= (m_tilesPerSide >> level) || p[1] >= (m_tilesPerSide >> level))
+				continue;
+			requested.push_back(tileKey(level, p[0], p[1]));
+		}
+		std::sort(requested.begin(), requested.end());
+		requested.erase(std::unique(requested.begin(), requested.end()), requested.end());
+		m_stats.requestedTiles = (unsigned int)requested.size();
+
+		//Missing tiles and their missing ancestors, so a blurry version shows up first
+		std::vector<uint32_t> missing;
+		for (uint32_t tile : requested) {
+			int level = (int)(tile >> 24), y = (int)((tile >> 12) & 0xFFF), x = (int)(tile & 0xFFF);
+			for (; level < m_levelCount; level++, x >>= 1, y >>= 1) {
+				uint32_t key = tileKey(level, x, y);
+				std::unordered_map<uint32_t, int>::iterator resident = m_residentTiles.find(key);
+				if (resident != m_residentTiles.end()) {
+					touch(resident->second);
+					break;
+				}
+				if (!m_pendingTiles.count(key))
+					missing.push_back(key);
+			}
+		}
+		std::sort(missing.begin(), missing.end());
+		missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+		//Keys sort by level first, so walk backwards for coarsest first
+		for (std::vector<uint32_t>::reverse_iterator it = missing.rbegin(); it != missing.rend(); ++it) {
+			if ((int)m_pendingTiles.size() >= m_settings.maxPendingLoads)
+				break;
+			requestTile(*it);
+		}
+	}
+
+	void VirtualTexture::requestTile(uint32_t tile) {
+		m_pendingTiles.insert(tile);
+		m_jobs.submit([this, tile] {
+			LoadedTile loaded;
+			loaded.tile = tile;
+			if (!readTile(tile, loaded.pixels))
+				loaded.pixels.clear();
+			std::lock_guard<std::mutex> lock(m_loadedMutex);
+			m_loadedTiles.push_back(std::move(loaded));
+		}, &m_loadCounter);
+	}
+
+	int VirtualTexture::allocateSlot() {
+		if (!m_freeSlots.empty()) {
+			int slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+			return slot;
+		}
+		if (m_lru.empty())
+			return -1;
+		int slot = m_lru.back();
+		if (m_slots[slot].lastUsedFrame >= m_frame)
+			return -1;
+		m_lru.pop_back();
+
+		//Entries showing the evicted tile fall back to its parent's mapping
+		uint32_t tile = m_slots[slot].tile;
+		int level = (int)(tile >> 24), y = (int)((tile >> 12) & 0xFFF), x = (int)(tile & 0xFFF);
+		int parentTiles = m_tilesPerSide >> (level + 1);
+		uint32_t parent = m_indirection[level + 1][(size_t)(y >> 1) * parentTiles + (x >> 1)];
+		remapDescendants(level, x, y, parent, true);
+		m_residentTiles.erase(tile);
+		m_slots[slot].tile = ~0u;
+		m_stats.tilesEvicted++;
+		return slot;
+	}
+
+	void VirtualTexture::touch(int slot) {
+		m_slots[slot].lastUsedFrame = m_frame;
+		//Slot 0 holds the pinned root and is never in the list
+		if (slot != 0)
+			m_lru.splice(m_lru.begin(), m_lru, m_slots[slot].lruPosition);
+	}
+
+	void VirtualTexture::uploadTile(uint32_t tile, const unsigned char* pixels, int slot) {
+		int level = (int)(tile >> 24), y = (int)((tile >> 12) & 0xFFF), x = (int)(tile & 0xFFF);
+		int padded = m_tileSize + m_border * 2;
+		int slotX = slot % m_settings.cacheTilesPerSide, slotY = slot / m_settings.cacheTilesPerSide;
+		glBindTexture(GL_TEXTURE_2D, m_physicalTexture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, slotX * padded, slotY * padded, padded, padded, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		m_slots[slot].tile = tile;
+		m_slots[slot].lastUsedFrame = m_frame;
+		if (slot != 0) {
+			m_lru.push_front(slot);
+			m_slots[slot].lruPosition = m_lru.begin();
+		}
+		m_residentTiles[tile] = slot;
+		remapDescendants(level, x, y, packEntry(slotX, slotY, level), false);
+		m_stats.tilesLoaded++;
+	}
+
+	void VirtualTexture::remapDescendants(int level, int x, int y, uint32_t entry, bool onlyFromLevel) {
+		for (int l = level; l >= 0; l--) {
+			int scale = 1 << (level - l);
+			int tiles = m_tilesPerSide >> l;
+			std::vector<uint32_t>& entries = m_indirection[l];
+			for (int ty = y * scale; ty < (y + 1) * scale; ty++) {
+				for (int tx = x * scale; tx < (x + 1) * scale; tx++) {
+					uint32_t& current = entries[(size_t)ty * tiles + tx];
+					//Loads replace anything coarser; evictions only what pointed at the evicted tile
+					if (onlyFromLevel ? entryLevel(current) == level : entryLevel(current) > level)
+						current = entry;
+				}
+			}
+			m_indirectionDirty[l] = true;
+		}
+	}
+
+	void VirtualTexture::bind() const {
+		glBindBufferBase(GL_UNIFORM_BUFFER, VIRTUAL_TEXTURE_PARAMS_UBO_BINDING, m_paramsBuffer);
+		glBindTextureUnit(VIRTUAL_TEXTURE_CACHE_UNIT, m_physicalTexture);
+		glBindTextureUnit(VIRTUAL_TEXTURE_INDIRECTION_UNIT, m_indirectionTexture);
+	}
+
+	size_t VirtualTexture::getResidentBytes() const {
+		size_t padded = (size_t)(m_tileSize + m_border * 2) * m_settings.cacheTilesPerSide;
+		size_t bytes = padded * padded * 4;
+		for (int l = 0; l < m_levelCount; l++)
+			bytes += (size_t)(m_tilesPerSide >> l) * (m_tilesPerSide >> l) * 4;
+		return bytes;
+	}
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <list>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "external/glad.h"
+#include "jobSystem.h"
+
+namespace ew {
+	//Bindings used by virtualTextureGlsl(). UBO 0/1 are ClusterParams/ShadowParams, unit 4 the shadow map.
+	const unsigned int VIRTUAL_TEXTURE_PARAMS_UBO_BINDING = 2;
+	const unsigned int VIRTUAL_TEXTURE_CACHE_UNIT = 5;
+	const unsigned int VIRTUAL_TEXTURE_INDIRECTION_UNIT = 6;
+
+	//GLSL (450) for fragment shaders, insert after #version:
+	//	vec4 sampleVirtual(vec2 uv)    texture lookup through the indirection texture
+	//	vec4 virtualFeedback(vec2 uv)  the value the feedback pass must write for uv
+	//uv spans the source image, 0 to 1. Both use screen space derivatives, so call them in
+	//uniform control flow. Filtering is bilinear within one mip level, not trilinear.
+	const char* virtualTextureGlsl();
+
+	//Splits an RGBA8 image into a tiled mip pyramid on disk for VirtualTexture. The pyramid is
+	//square with a power of two tiles per side; the image sits in the lower left and the rest is
+	//never requested. Each tile carries a one texel border from its neighbors for bilinear
+	//filtering. Row 0 of rgba is v = 0.
+	bool buildVirtualTexture(const std::string& path, const unsigned char* rgba, int width, int height, int tileSize = 128);
+
+	struct VirtualTextureSettings {
+		//Physical cache is cacheTilesPerSide^2 tiles in one RGBA8 texture
+		int cacheTilesPerSide = 16;
+		//Feedback is rendered at 1/feedbackScale of the screen resolution
+		int feedbackScale = 8;
+		//Tiles copied into the cache per update(); bounds the upload cost of a frame
+		int maxUploadsPerFrame = 16;
+		//Tiles being read from disk at once
+		int maxPendingLoads = 64;
+	};
+
+	struct VirtualTextureStats {
+		unsigned int residentTiles = 0;
+		unsigned int pendingLoads = 0;
+		//Distinct tiles seen in the last feedback processed
+		unsigned int requestedTiles = 0;
+		unsigned int uploadsLastUpdate = 0;
+		size_t tilesLoaded = 0;
+		size_t tilesEvicted = 0;
+	};
+
+	//Streams a texture far larger than GPU memory, made by buildVirtualTexture().
+	//
+	//Only tiles that are visible, at the mip level they are seen at, live in a fixed-size physical
+	//cache texture. Each frame the scene is drawn at low resolution writing virtualFeedback(uv),
+	//which names the tile every pixel wants. update() reads that back a frame or two later
+	//(through fenced pixel pack buffers, so nothing stalls), queues missing tiles to be read from
+	//disk on JobSystem workers, and copies finished tiles into the least recently used cache
+	//slots.
+	//
+	//An indirection texture with one texel per tile per mip level maps each tile to its cache
+	//slot. Tiles that are not resident map to their nearest resident ancestor, and the single
+	//tile of the last level is always resident, so sampling never misses: detail just sharpens
+	//as tiles arrive.
+	class VirtualTexture {
+	public:
+		VirtualTexture(const std::string& path, JobSystem& jobs, const VirtualTextureSettings& settings = VirtualTextureSettings());
+		//Waits for loads still in progress
+		~VirtualTexture();
+		VirtualTexture(const VirtualTexture&) = delete;
+		VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+		bool isValid() const { return m_physicalTexture != 0; }
+
+		//Binds and clears the feedback target for a screenWidth x screenHeight view. Draw the
+		//virtually textured geometry with a shader writing virtualFeedback(uv) to location 0.
+		void beginFeedback(int screenWidth, int screenHeight);
+		//Starts reading the feedback back and restores the previous framebuffer and viewport
+		void endFeedback();
+		//Processes finished feedback, requests tiles and uploads loaded ones. Once per frame.
+		void update();
+		//Binds the cache, indirection texture and parameters for virtualTextureGlsl()
+		void bind() const;
+
+		int getTileSize() const { return m_tileSize; }
+		int getLevelCount() const { return m_levelCount; }
+		int getWidth() const { return m_width; }
+		int getHeight() const { return m_height; }
+		//GPU memory of the cache and indirection textures
+		size_t getResidentBytes() const;
+		const VirtualTextureStats& getStats() const { return m_stats; }
+
+	private:
+		struct Slot {
+			//Tile key, ~0u if free
+			uint32_t tile = ~0u;
+			uint64_t lastUsedFrame = 0;
+			std::list<int>::iterator lruPosition;
+		};
+		struct LoadedTile {
+			uint32_t tile;
+			std::vector<unsigned char> pixels;
+		};
+		struct FeedbackReadback {
+			unsigned int buffer = 0;
+			GLsync fence = nullptr;
+			int width = 0;
+			int height = 0;
+		};
+		static const int FEEDBACK_BUFFERS = 3;
+
+		static uint32_t tileKey(int level, int x, int y) { return ((uint32_t)level << 24) | ((uint32_t)y << 12) | (uint32_t)x; }
+		bool readTile(uint32_t tile, std::vector<unsigned char>& pixels) const;
+		void processFeedback(const unsigned char* pixels, int count);
+		void requestTile(uint32_t tile);
+		void uploadTile(uint32_t tile, const unsigned char* pixels, int slot);
+		int allocateSlot();
+		void touch(int slot);
+		//Points every entry under tile that currently maps to a coarser level (or to fromLevel,
+		//for evictions) at entry
+		void remapDescendants(int level, int x, int y, uint32_t entry, bool onlyFromLevel);
+		void resizeFeedback(int width, int height);
+
+		JobSystem& m_jobs;
+		VirtualTextureSettings m_settings;
+		std::string m_path;
+		int m_width = 0;
+		int m_height = 0;
+		int m_tileSize = 0;
+		int m_border = 0;
+		int m_tilesPerSide = 0;
+		int m_levelCount = 0;
+		size_t m_headerBytes = 0;
+
+		unsigned int m_physicalTexture = 0;
+		unsigned int m_indirectionTexture = 0;
+		unsigned int m_paramsBuffer = 0;
+		//CPU copy of the indirection texture, per level: x, y slot, resident level, 255
+		std::vector<std::vector<uint32_t>> m_indirection;
+		std::vector<bool> m_indirectionDirty;
+
+		std::vector<Slot> m_slots;
+		//Most recently used first; the pinned root slot is not in the list
+		std::list<int> m_lru;
+		std::vector<int> m_freeSlots;
+		std::unordered_map<uint32_t, int> m_residentTiles;
+		std::unordered_set<uint32_t> m_pendingTiles;
+		uint64_t m_frame = 0;
+
+		//Filled by workers, drained by update()
+		std::mutex m_loadedMutex;
+		std::vector<LoadedTile> m_loadedTiles;
+		JobCounter m_loadCounter;
+
+		unsigned int m_feedbackFramebuffer = 0;
+		unsigned int m_feedbackColor = 0;
+		unsigned int m_feedbackDepth = 0;
+		int m_feedbackWidth = 0;
+		int m_feedbackHeight = 0;
+		FeedbackReadback m_readbacks[FEEDBACK_BUFFERS];
+		int m_nextReadback = 0;
+		int m_previousFramebuffer = 0;
+		int m_previousViewport[4] = { 0, 0, 0, 0 };
+
+		VirtualTextureStats m_stats;
+	};
+}
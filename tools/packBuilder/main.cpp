@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <ew/assetPack.h>
+#include <ew/jobSystem.h>
+#include <ew/profiler.h>
+
+//Bundles files into an asset pack: packBuilder [--store] [--root dir] -o pack.ewpk files...
+//Entries are named by their path relative to --root (forward slashes), or by the path as
+//given when a file is outside it.
+
+static std::string packPath(const std::string& root, const std::string& file) {
+	std::string path = ew::normalizePackPath(file);
+	if (!root.empty() && path.compare(0, root.size(), root) == 0)
+		path = path.substr(root.size());
+	while (!path.empty() && path[0] == '/')
+		path.erase(0, 1);
+	return path;
+}
+
+static void printUsage() {
+	printf("usage: packBuilder [--store] [--root dir] -o pack.ewpk files...\n");
+	printf("  --store keeps every entry uncompressed so all of them can be viewed in place\n");
+}
+
+int main(int argc, char** argv) {
+	bool compress = true;
+	std::string root, output;
+	std::vector<std::string> inputs;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--store") == 0) {
+			compress = false;
+		}
+		else if (strcmp(argv[i], "--root") == 0 && i + 1 < argc) {
+			root = ew::normalizePackPath(argv[++i]);
+			if (!root.empty() && root.back() != '/')
+				root += '/';
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		}
+		else {
+			inputs.push_back(argv[i]);
+		}
+	}
+	if (inputs.empty() || output.empty()) {
+		printUsage();
+		return 1;
+	}
+
+	ew::AssetPackBuilder builder;
+	for (const std::string& input : inputs)
+		builder.addFile(packPath(root, input), input, compress);
+	ew::JobSystem jobs;
+	ew::CpuTimer timer;
+	timer.start();
+	if (!builder.write(output, &jobs))
+		return 1;
+	double ms = timer.stop();
+
+	ew::AssetPack pack(output);
+	if (!pack.isOpen())
+		return 1;
+	size_t originalBytes = 0, storedBytes = 0;
+	for (size_t i = 0; i < pack.getEntryCount(); i++) {
+		const ew::PackEntry& entry = pack.getEntry(i);
+		originalBytes += (size_t)entry.size;
+		storedBytes += (size_t)entry.storedSize;
+		printf("  %-60s %9zu -> %9zu %s\n", pack.getPath(i).c_str(), (size_t)entry.size, (size_t)entry.storedSize,
+			entry.compression == ew::PackCompression::LZ ? "lz" : "stored");
+	}
+	printf("%s: %zu entries, %.1f KB -> %.1f KB, %.2f ms\n", output.c_str(), pack.getEntryCount(),
+		originalBytes / 1024.0, storedBytes / 1024.0, ms);
+	return 0;
+}
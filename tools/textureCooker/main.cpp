@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <ew/blockCompression.h>
+#include <ew/jobSystem.h>
+#include <ew/profiler.h>
+#include <ew/external/stb_image.h>
+
+//Block compresses images for the GPU: textureCooker [-f auto|bc1|bc3|bc4|bc5] [--no-mips] [-o dir] images...
+//Each image is written to dir/<name>.ewbc and its PSNR against the source is printed.
+
+static const char* FORMAT_NAMES[] = { "bc1", "bc3", "bc4", "bc5" };
+
+static std::string outputPath(const std::string& directory, const std::string& input) {
+	size_t start = input.find_last_of("/\\");
+	start = start == std::string::npos ? 0 : start + 1;
+	size_t end = input.find_last_of('.');
+	if (end == std::string::npos || end < start)
+		end = input.size();
+	std::string path = directory.empty() ? "" : directory + "/";
+	return path + input.substr(start, end - start) + ".ewbc";
+}
+
+static void printUsage() {
+	printf("usage: textureCooker [-f auto|bc1|bc3|bc4|bc5] [--no-mips] [-o dir] images...\n");
+	printf("  auto (default) picks bc3 for images with transparency and bc1 otherwise\n");
+}
+
+int main(int argc, char** argv) {
+	int format = -1;
+	bool mipmaps = true;
+	std::string directory;
+	std::vector<std::string> inputs;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			format = -2;
+			for (int f = 0; f < 4; f++) {
+				if (strcmp(name, FORMAT_NAMES[f]) == 0)
+					format = f;
+			}
+			if (strcmp(name, "auto") == 0)
+				format = -1;
+			if (format == -2) {
+				printf("Unknown format %s\n", name);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--no-mips") == 0) {
+			mipmaps = false;
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			directory = argv[++i];
+		}
+		else {
+			inputs.push_back(argv[i]);
+		}
+	}
+	if (inputs.empty()) {
+		printUsage();
+		return 1;
+	}
+
+	ew::JobSystem jobs;
+	int failures = 0;
+	for (const std::string& input : inputs) {
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(input.c_str(), &width, &height, &channels, 4);
+		if (!pixels) {
+			printf("ERROR::COOKER::Failed to load %s\n", input.c_str());
+			failures++;
+			continue;
+		}
+		ew::BlockFormat blockFormat = (ew::BlockFormat)format;
+		if (format < 0) {
+			bool transparent = false;
+			for (size_t p = 0; p < (size_t)width * height && !transparent; p++)
+				transparent = pixels[p * 4 + 3] != 255;
+			blockFormat = transparent ? ew::BlockFormat::BC3 : ew::BlockFormat::BC1;
+		}
+
+		//stb_image rows run top-down but compressImage wants row 0 at v = 0, the same flip
+		//TextureArrayManager and TextureAtlas apply when they load files
+		size_t rowBytes = (size_t)width * 4;
+		std::vector<unsigned char> flipped((size_t)height * rowBytes);
+		for (int y = 0; y < height; y++)
+			memcpy(&flipped[(size_t)y * rowBytes], pixels + (size_t)(height - 1 - y) * rowBytes, rowBytes);
+
+		ew::CpuTimer timer;
+		timer.start();
+		ew::CompressedImage image = ew::compressImage(flipped.data(), width, height, blockFormat, mipmaps, &jobs);
+		double ms = timer.stop();
+		std::vector<unsigned char> decoded = ew::decompressImage(image, 0);
+		int channelCount = ew::blockChannels(blockFormat);
+		double psnr = ew::computePSNR(flipped.data(), decoded.data(), (size_t)width * height, channelCount);
+		stbi_image_free(pixels);
+
+		size_t bytes = 0;
+		for (const std::vector<unsigned char>& level : image.levels)
+			bytes += level.size();
+		std::string output = outputPath(directory, input);
+		if (!ew::saveCompressedImage(output, image)) {
+			failures++;
+			continue;
+		}
+		printf("%s: %dx%d %s, %zu levels, %.1f KB (RGBA8 %.1f KB), PSNR %.2f dB, %.2f ms\n", output.c_str(), width, height,
+			FORMAT_NAMES[(int)blockFormat], image.levels.size(), bytes / 1024.0, width * height * 4 / 1024.0, psnr, ms);
+	}
+	return failures == 0 ? 0 : 1;
+}